@@ -9,6 +9,7 @@
 #include <Engine/Graphics/GpuProgramsManager.h>
 #include <Engine/Graphics/Mesh/Mesh.h>
 #include <Engine/Graphics/Mesh/MeshLoader.h>
+#include <Engine/Graphics/Mesh/AnimationClipLoader.h>
 #include <Engine/Core/Threads/WorkersCommutator.h>
 #include <Engine/Utils/StringHelper.h>
 
@@ -105,19 +106,21 @@ namespace game {
             auto loadAnim = [&assetManager, &animationTree](
                 ref_ptr<Mesh> mainAsset, const std::string & file, uint8_t id, float weight, bool infinity,
                 float speed) {
-                    MeshLoadingParams anim;
+                    AnimationClipLoadingParams anim;
                     anim.file = "resources/assets/" + file;
+                    anim.skeleton = mainAsset->getMeshData(); // only animations are read, channels are remapped to mesh nodes
                     anim.flags->async = 1u;
                     anim.callbackThreadId = static_cast<uint8_t>(Engine::Workers::UPDATE_THREAD);
 
-                    assetManager.loadAsset<Mesh*>(
+                    assetManager.loadAsset<AnimationClip*>(
                         anim, [mainAsset, &animationTree, id, weight, speed, infinity](
-                            std::unique_ptr<Mesh>&& asset,
+                            AnimationClip* const& clip,
                             const AssetLoadingResult result) mutable {
+                                if (result != AssetLoadingResult::LOADING_SUCCESS) return;
                                 animationTree->getAnimator()->assignChild(
                                     id,
                                     new MeshAnimationTree::AnimatorType(
-                                        &asset->getMeshData()->animations[0],
+                                        &clip->animations[0],
                                         weight, mainAsset->getSkeleton()->getLatency(),
                                         speed, infinity));
                         }
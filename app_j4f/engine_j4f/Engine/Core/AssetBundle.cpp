@@ -0,0 +1,279 @@
+#include "AssetBundle.h"
+#include "Engine.h"
+#include "Threads/WorkersCommutator.h"
+#include "Threads/Synchronisations.h"
+#include "../File/FileManager.h"
+#include "../Log/Log.h"
+#include "../Utils/Debug/Profiler.h"
+
+namespace engine {
+
+	void AssetBundleLoader::setEntryLoader(const std::string& type, AssetBundleEntryLoader&& loader) {
+		AtomicLock lock(_entryLoadersLock);
+		_entryLoaders[type] = std::move(loader);
+	}
+
+	void AssetBundleLoader::cleanUp() noexcept {
+		AtomicLock lock(_entryLoadersLock);
+		_entryLoaders.clear();
+	}
+
+	bool AssetBundleLoader::parseManifest(AssetBundle* bundle, const std::string& file, const FileView& data) {
+		if (!data || data.empty()) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "can't read bundle manifest %s", file.c_str());
+			return false;
+		}
+
+		const Json js = Json::parse(data.chars(), data.chars() + data.size(), nullptr, false);
+		if (js.is_discarded() || !js.contains("assets") || !js["assets"].is_array()) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle manifest %s: no assets array", file.c_str());
+			return false;
+		}
+
+		const Json& assets = js["assets"];
+		if (assets.size() >= 0xffffu) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle manifest %s: too many assets", file.c_str());
+			return false;
+		}
+
+		const auto count = static_cast<uint16_t>(assets.size());
+		auto& entries = bundle->_entries;
+		entries.resize(count);
+
+		for (uint16_t i = 0u; i < count; ++i) {
+			const Json& asset = assets[i];
+			AssetBundleEntry& entry = entries[i];
+
+			entry.name = asset.value("name", "");
+			entry.type = asset.value("type", "");
+
+			if (auto it = asset.find("files"); it != asset.end() && it->is_array()) {
+				entry.files = it->get<std::vector<std::string>>();
+			} else if (asset.contains("file")) {
+				entry.files.push_back(asset.value("file", ""));
+			}
+
+			if (auto it = asset.find("params"); it != asset.end()) {
+				entry.params = *it;
+			}
+
+			if (entry.name.empty() || !bundle->_names.emplace(entry.name, i).second) {
+				LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle manifest %s: asset %u has empty or not unique name", file.c_str(), i);
+				return false;
+			}
+		}
+
+		bundle->_dependents.resize(count);
+		bundle->_waitDependencies = std::make_unique<std::atomic_uint16_t[]>(count);
+		bundle->_dependencyFailed = std::make_unique<std::atomic_bool[]>(count);
+		bundle->_started = std::make_unique<std::atomic_bool[]>(count);
+
+		std::vector<uint16_t> waitCounts(count, 0u);
+
+		for (uint16_t i = 0u; i < count; ++i) {
+			auto it = assets[i].find("depends");
+			if (it == assets[i].end() || !it->is_array()) continue;
+
+			for (const Json& dependency : *it) {
+				auto name = bundle->_names.find(dependency.is_string() ? dependency.get<std::string>() : std::string());
+				if (name == bundle->_names.end()) {
+					LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle manifest %s: asset %s depends on unknown asset", file.c_str(), entries[i].name.c_str());
+					return false;
+				}
+
+				entries[i].dependencies.push_back(name->second);
+				bundle->_dependents[name->second].push_back(i);
+				++waitCounts[i];
+			}
+		}
+
+		// cycles check (all assets must be reachable from assets without dependencies)
+		std::vector<uint16_t> ready;
+		std::vector<uint16_t> counts = waitCounts;
+		for (uint16_t i = 0u; i < count; ++i) {
+			if (counts[i] == 0u) ready.push_back(i);
+		}
+
+		size_t sorted = 0u;
+		while (!ready.empty()) {
+			const uint16_t id = ready.back();
+			ready.pop_back();
+			++sorted;
+			for (const uint16_t d : bundle->_dependents[id]) {
+				if (--counts[d] == 0u) ready.push_back(d);
+			}
+		}
+
+		if (sorted != count) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle manifest %s: cyclic dependencies", file.c_str());
+			return false;
+		}
+
+		for (uint16_t i = 0u; i < count; ++i) {
+			bundle->_waitDependencies[i].store(waitCounts[i], std::memory_order_relaxed);
+			bundle->_dependencyFailed[i].store(false, std::memory_order_relaxed);
+			bundle->_started[i].store(false, std::memory_order_relaxed);
+		}
+
+		bundle->_assets.resize(count);
+		bundle->_progress.setStep(0u);
+		bundle->_progress.setTotalSteps(count);
+		bundle->_remaining.store(count, std::memory_order_release);
+
+		return true;
+	}
+
+	void AssetBundleLoader::load(const AssetBundlePtr& bundle, const std::string& file, const FileView& data) {
+		PROFILE_TIME_SCOPED_M(bundleLoading, file)
+
+		if (!parseManifest(bundle.get(), file, data)) {
+			bundle->_failed.store(1u, std::memory_order_release);
+			complete(bundle);
+			return;
+		}
+
+		if (bundle->_entries.empty()) {
+			complete(bundle);
+			return;
+		}
+
+		bundle->_parsed.store(true); // seq_cst with _cancelled: either cancel sees parsed entries, or scheduleEntry sees cancellation
+
+		for (uint16_t i = 0u, count = static_cast<uint16_t>(bundle->_entries.size()); i < count; ++i) {
+			if (bundle->_entries[i].dependencies.empty()) {
+				scheduleEntry(bundle, i);
+			}
+		}
+	}
+
+	void AssetBundleLoader::cancel(const AssetBundlePtr& bundle) {
+		bundle->_cancelled.store(true);
+
+		if (!bundle->_manifestStarted.exchange(true)) { // manifest task is dropped
+			complete(bundle);
+			return;
+		}
+
+		if (!bundle->_parsed.load()) return; // manifest task sees cancellation when it schedules entries
+
+		// entries, which aren't taken by their tasks yet (tasks in queue are dropped), are finished here
+		for (uint16_t i = 0u, count = static_cast<uint16_t>(bundle->_entries.size()); i < count; ++i) {
+			if (!bundle->_started[i].exchange(true, std::memory_order_acq_rel)) {
+				finishEntry(bundle, i, {}, false);
+			}
+		}
+	}
+
+	void AssetBundleLoader::scheduleEntry(const AssetBundlePtr& bundle, const uint16_t id) {
+		if (bundle->_cancelled.load()) {
+			if (!bundle->_started[id].exchange(true, std::memory_order_acq_rel)) {
+				finishEntry(bundle, id, {}, false);
+			}
+			return;
+		}
+
+		Engine::getInstance().getModule<AssetManager>().enqueueLoading(bundle->_loading, [bundle, id](const CancellationToken& token) {
+			if (!bundle->_started[id].exchange(true, std::memory_order_acq_rel)) {
+				startEntry(bundle, id);
+			}
+		});
+	}
+
+	void AssetBundleLoader::startEntry(const AssetBundlePtr& bundle, const uint16_t id) {
+		const AssetBundleEntry& entry = bundle->_entries[id];
+
+		if (bundle->_cancelled.load()) {
+			finishEntry(bundle, id, {}, false);
+			return;
+		}
+
+		if (bundle->_dependencyFailed[id].load(std::memory_order_acquire)) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle asset %s: dependency isn't loaded", entry.name.c_str());
+			finishEntry(bundle, id, {}, false);
+			return;
+		}
+
+		AssetBundleEntryLoader loader;
+		{
+			AtomicLock lock(_entryLoadersLock);
+			if (auto it = _entryLoaders.find(entry.type); it != _entryLoaders.end()) {
+				loader = it->second;
+			}
+		}
+
+		if (!loader) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle asset %s: unknown asset type %s", entry.name.c_str(), entry.type.c_str());
+			finishEntry(bundle, id, {}, false);
+			return;
+		}
+
+		loader(entry, *bundle, [bundle, id](std::any&& asset, const bool success) {
+			finishEntry(bundle, id, std::move(asset), success);
+		});
+	}
+
+	void AssetBundleLoader::finishEntry(const AssetBundlePtr& bundle, const uint16_t id, std::any&& asset, const bool success) {
+		bundle->_assets[id] = std::move(asset);
+
+		if (!success) {
+			bundle->_failed.fetch_add(1u, std::memory_order_release);
+			if (!bundle->_cancelled.load()) {
+				LOG_TAG_LEVEL(LogLevel::L_ERROR, ASSETS, "bundle asset %s isn't loaded", bundle->_entries[id].name.c_str());
+			}
+		}
+
+		for (const uint16_t d : bundle->_dependents[id]) {
+			if (!success) {
+				bundle->_dependencyFailed[d].store(true, std::memory_order_release);
+			}
+
+			if (bundle->_waitDependencies[d].fetch_sub(1u, std::memory_order_acq_rel) == 1u) { // last dependency is loaded
+				scheduleEntry(bundle, d);
+			}
+		}
+
+		bundle->_progress.increaseProgress();
+
+		if (bundle->_remaining.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+			complete(bundle);
+		}
+	}
+
+	void AssetBundleLoader::complete(const AssetBundlePtr& bundle) {
+		if (bundle->_loading.request) {
+			bundle->_loading.request->setCancelHandler([]() {}); // drops handler, it keeps bundle
+		}
+
+		if (!bundle->_callback) return;
+
+		const AssetLoadingResult result = bundle->isCancelled() ? AssetLoadingResult::LOADING_CANCELED :
+			(bundle->failedCount() == 0u ? AssetLoadingResult::LOADING_SUCCESS : AssetLoadingResult::LOADING_ERROR);
+		Engine::getInstance().getModule<WorkerThreadsCommutator>().enqueue(bundle->_callbackThreadId, [bundle, result]() {
+			auto callback = std::move(bundle->_callback); // callback may hold bundle
+			callback(bundle, result);
+		});
+	}
+
+	void AssetBundleLoader::loadAsset(AssetBundlePtr& v, const AssetBundleLoadingParams& params, const AssetBundleLoadingCallback& callback) {
+		v = std::make_shared<AssetBundle>();
+		v->_callback = callback;
+		v->_callbackThreadId = params.callbackThreadId;
+		v->_loading.flags = params.flags;
+		v->_loading.request = params.request;
+
+		if (params.request) {
+			params.request->setCancelHandler([bundle = v]() { cancel(bundle); });
+		}
+
+		if (params.flags->async) {
+			Engine::getInstance().getModule<AssetManager>().enqueueLoadingWithFiles(params, { params.file }, [bundle = v, file = params.file](const CancellationToken&, const std::vector<FileView>& files) {
+				if (!bundle->_manifestStarted.exchange(true)) {
+					load(bundle, file, files[0]);
+				}
+			});
+		} else if (!v->_manifestStarted.exchange(true)) { // manifest is parsed in this thread, assets are loaded on loader pool anyway
+			load(v, params.file, Engine::getInstance().getModule<FileManager>().readFileMapped(params.file));
+		}
+	}
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "AssetManager.h"
+#include "Threads/ProgressTask.h"
+#include "../Utils/Json/Json.h"
+
+#include <any>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// bundle manifest (json):
+// { "assets": [
+//		{ "name": "hero_texture", "type": "texture", "files": ["..."] },
+//		{ "name": "hero", "type": "mesh", "files": ["..."], "depends": ["hero_texture"], "params": { ... } }
+// ] }
+// every asset starts loading after its dependencies, independent assets are loaded concurrently on loader pool,
+// so reading and decoding of one asset overlaps with others (gpu data goes through renderer upload manager);
+// assets with failed dependencies aren't loaded, bundle callback is called once, after all assets
+// (LOADING_CANCELED, if params.request is cancelled: not started assets are skipped, started ones are finished);
+// manifest and every asset are loader pool tasks of params.request, with its priority and cancellation
+
+namespace engine {
+
+	struct AssetBundleEntry {
+		std::string name;
+		std::string type;
+		std::vector<std::string> files;
+		std::vector<uint16_t> dependencies; // indices of entries
+		Json params;
+	};
+
+	class AssetBundle;
+	using AssetBundlePtr = std::shared_ptr<AssetBundle>;
+	using AssetBundleLoadingCallback = AssetLoadingCallback<AssetBundlePtr>;
+
+	class AssetBundle {
+		friend class AssetBundleLoader;
+	public:
+		template <typename T>
+		[[nodiscard]] T* get(const std::string& name) noexcept {
+			auto it = _names.find(name);
+			return it != _names.end() ? std::any_cast<T>(&_assets[it->second]) : nullptr;
+		}
+
+		template <typename T>
+		[[nodiscard]] const T* get(const std::string& name) const noexcept {
+			auto it = _names.find(name);
+			return it != _names.end() ? std::any_cast<T>(&_assets[it->second]) : nullptr;
+		}
+
+		[[nodiscard]] inline const std::vector<AssetBundleEntry>& entries() const noexcept { return _entries; }
+		[[nodiscard]] inline const CommonProgressionTask& getProgress() const noexcept { return _progress; }
+		[[nodiscard]] inline bool isComplete() const noexcept { return _remaining.load(std::memory_order_acquire) == 0u; }
+		[[nodiscard]] inline uint16_t failedCount() const noexcept { return _failed.load(std::memory_order_acquire); }
+		[[nodiscard]] inline bool isCancelled() const noexcept { return _cancelled.load(); }
+
+	private:
+		std::vector<AssetBundleEntry> _entries;
+		std::vector<std::any> _assets; // by entry index, each is written once, before its dependents start
+		std::unordered_map<std::string, uint16_t> _names;
+		std::vector<std::vector<uint16_t>> _dependents;
+
+		std::unique_ptr<std::atomic_uint16_t[]> _waitDependencies;
+		std::unique_ptr<std::atomic_bool[]> _dependencyFailed;
+		std::unique_ptr<std::atomic_bool[]> _started; // entry is taken by its task or by cancellation, it's finished once
+		std::atomic_uint16_t _remaining = 0u;
+		std::atomic_uint16_t _failed = 0u;
+		CommonProgressionTask _progress;
+
+		AssetLoadingFlags _loading; // flags and request of bundle loading for its tasks
+		std::atomic_bool _cancelled = false;
+		std::atomic_bool _manifestStarted = false;
+		std::atomic_bool _parsed = false;
+
+		AssetBundleLoadingCallback _callback;
+		uint8_t _callbackThreadId = 0u;
+	};
+
+	template<>
+	struct AssetLoadingParams<AssetBundle> : public AssetLoadingFlags {
+		std::string file;
+		uint8_t callbackThreadId = 0u;
+	};
+
+	using AssetBundleLoadingParams = AssetLoadingParams<AssetBundle>;
+
+	// loader of one bundle entry type, done may be called from any thread
+	using AssetBundleEntryDone = std::function<void(std::any&& asset, const bool success)>;
+	using AssetBundleEntryLoader = std::function<void(const AssetBundleEntry& entry, AssetBundle& bundle, AssetBundleEntryDone&& done)>;
+
+	// bundle is shared by caller and its loading tasks, so it can be released at any moment;
+	// loadAsset returns before assets are loaded (sync flag only parses manifest in caller thread), callback or isComplete tell when they are
+	class AssetBundleLoader {
+	public:
+		using asset_type = AssetBundlePtr;
+		static void loadAsset(AssetBundlePtr& v, const AssetBundleLoadingParams& params, const AssetBundleLoadingCallback& callback);
+		static void cleanUp() noexcept;
+
+		static void setEntryLoader(const std::string& type, AssetBundleEntryLoader&& loader);
+
+	private:
+		static bool parseManifest(AssetBundle* bundle, const std::string& file, const FileView& data);
+		static void load(const AssetBundlePtr& bundle, const std::string& file, const FileView& data);
+		static void cancel(const AssetBundlePtr& bundle);
+		static void scheduleEntry(const AssetBundlePtr& bundle, const uint16_t id);
+		static void startEntry(const AssetBundlePtr& bundle, const uint16_t id);
+		static void finishEntry(const AssetBundlePtr& bundle, const uint16_t id, std::any&& asset, const bool success);
+		static void complete(const AssetBundlePtr& bundle);
+
+		inline static std::atomic_bool _entryLoadersLock;
+		inline static std::unordered_map<std::string, AssetBundleEntryLoader> _entryLoaders;
+	};
+
+}
@@ -0,0 +1,24 @@
+#include "AssetManager.h"
+#include "Engine.h"
+#include "Threads/WorkersCommutator.h"
+#include "../File/FileManager.h"
+
+namespace engine {
+
+	void enqueueAssetCallback(const uint8_t threadId, std::function<void()>&& f) {
+		Engine::getInstance().getModule<WorkerThreadsCommutator>().enqueue(threadId, std::move(f));
+	}
+
+	void AssetManager::enqueueLoadingWithFiles(const AssetLoadingFlags& params, std::vector<std::string>&& files, FilesLoadingTask&& task) const {
+		AssetLoadingFlags flags; // params can be gone when files are read
+		flags.flags = params.flags;
+		flags.request = params.request;
+
+		Engine::getInstance().getModule<FileManager>().readFilesAsync(std::move(files), [this, flags = std::move(flags), task = std::move(task)](std::vector<FileView>&& data) {
+			enqueueLoading(flags, [task, data = std::move(data)](const CancellationToken& token) {
+				task(token, data);
+			});
+		});
+	}
+
+}
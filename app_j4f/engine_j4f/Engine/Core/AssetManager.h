@@ -5,13 +5,18 @@
 #include "Linked_ptr.h"
 #include "Threads/ThreadPool.h"
 #include "Threads/ThreadPool2.h"
+#include "Threads/Synchronisations.h"
+#include "../File/FileView.h"
 
 #include <cassert>
+#include <concepts>
 #include <type_traits>
 #include <functional>
 #include <memory>
 #include <cstdint>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace engine {
 
@@ -51,7 +56,8 @@ namespace engine {
 	enum class AssetLoadingResult : uint8_t {
 		LOADING_SUCCESS = 0u,
 		LOADING_ERROR = 1u,
-		LOADER_NO_EXIST = 2u
+		LOADER_NO_EXIST = 2u,
+		LOADING_CANCELED = 3u
 	};
 
     template <typename T>
@@ -62,6 +68,67 @@ namespace engine {
 	template <typename T, typename Arg = typename CallbackArgumentType<T>::Type>
 	using AssetLoadingCallback = std::function<void(Arg&& asset, const AssetLoadingResult result)>;
 
+	// control of loading after loadAsset call: priority of its loader pool tasks (can be changed while they wait in queue) and cancellation,
+	// loaders check it between loading stages and token of task in decode loops, callbacks of cancelled loading get LOADING_CANCELED
+	class AssetRequest {
+	public:
+		explicit AssetRequest(const TaskPriority priority = TaskPriority::NORMAL) noexcept : _priority(priority) {}
+
+		void setPriority(const TaskPriority priority) noexcept {
+			_priority.store(priority, std::memory_order_relaxed);
+			AtomicLock lock(_taskLock);
+			if (_task) { _task->setPriority(priority); }
+		}
+
+		[[nodiscard]] inline TaskPriority priority() const noexcept { return _priority.load(std::memory_order_relaxed); }
+
+		void cancel() noexcept {
+			_cancelled.store(true, std::memory_order_seq_cst);
+			std::function<void()> handler;
+			{
+				AtomicLock lock(_taskLock);
+				if (_task) { _task->cancel(); }
+				handler = std::move(_cancelHandler);
+				_cancelHandler = nullptr;
+			}
+
+			if (handler) { handler(); }
+		}
+
+		// for loadings of many tasks (bundles): cancelled task, which waits in queue, is dropped without run,
+		// so handler finishes loading instead of it; called once, by cancel or at once for already cancelled request
+		void setCancelHandler(std::function<void()>&& handler) {
+			{
+				AtomicLock lock(_taskLock);
+				if (!cancelled()) {
+					_cancelHandler = std::move(handler);
+					return;
+				}
+			}
+
+			handler();
+		}
+
+		[[nodiscard]] inline bool cancelled() const noexcept { return _cancelled.load(std::memory_order_acquire); }
+
+		// current stage task of loading
+		void setTask(linked_ptr<TaskBase>&& task) noexcept {
+			AtomicLock lock(_taskLock);
+			_task = std::move(task);
+			_task->setPriority(priority()); // priority could be changed while task was enqueued
+			if (cancelled()) { _task->cancel(); }
+		}
+
+	private:
+		std::atomic<TaskPriority> _priority;
+		std::atomic_bool _cancelled = false;
+		std::atomic_bool _taskLock = false;
+		linked_ptr<TaskBase> _task;
+		std::function<void()> _cancelHandler;
+	};
+
+	using AssetRequestPtr = std::shared_ptr<AssetRequest>;
+
 	struct AssetLoadingFlags {
 		struct Flags {
 			uint8_t async;
@@ -81,7 +148,10 @@ namespace engine {
 
 		virtual ~AssetLoadingFlags() = default;
 
+		[[nodiscard]] inline bool cancelled() const noexcept { return request && request->cancelled(); }
+
 		LoadingFlags flags;
+		AssetRequestPtr request = nullptr; // nullptr - normal priority, not cancellable
 	};
 
 	template<typename T>
@@ -93,8 +163,28 @@ namespace engine {
 		virtual void loadAsset(const AssetLoadingFlags& p, void* data, const void* loadingCallback) const = 0;
     };
 
+	// callback of request, which joined loading of other request, is delivered on this thread (params without callbackThreadId - on thread, which completes loading)
+	void enqueueAssetCallback(const uint8_t threadId, std::function<void()>&& f);
+
 	template <typename Loader>
 	class AssetLoaderT : public IAssetLoader {
+		using type = typename Loader::asset_type;
+		using params_type = AssetLoadingParams<raw_type_name<type>>;
+
+		// loaders with static std::string requestKey(const params_type&) share one async loading between requests with equal not empty keys
+		static constexpr bool coalescing = requires(const params_type& p) { { Loader::requestKey(p) } -> std::convertible_to<std::string>; };
+
+		struct Waiter {
+			AssetLoadingCallback<type> callback;
+			uint8_t threadId = 0u;
+		};
+
+		struct InFlight {
+			type value{};
+			std::atomic_bool started = false; // Loader::loadAsset of first request returned, value is set
+			std::vector<Waiter> waiters;
+		};
+
 	public:
         ~AssetLoaderT() override {
             Loader::cleanUp();
@@ -102,13 +192,91 @@ namespace engine {
 
 		void loadAsset(const AssetLoadingFlags& p, void* data, const void* loadingCallback) const override {
 			// some magic ;)
-			using type = typename Loader::asset_type;
-			using params_type = AssetLoadingParams<raw_type_name<type>>;
 			type& value = *static_cast<type*>(data);
 			const auto& params = static_cast<const params_type&>(p);
 			const AssetLoadingCallback<type>& callback = *(static_cast<const AssetLoadingCallback<type>*>(loadingCallback));
+
+			if constexpr (coalescing) {
+				if (params.flags->async && !params.request) { // request with own control isn't shared
+					loadShared(value, params, callback);
+					return;
+				}
+			}
+
 			Loader::loadAsset(value, params, callback);
 		}
+
+	private:
+		void loadShared(type& value, const params_type& params, const AssetLoadingCallback<type>& callback) const {
+			static_assert(std::is_same_v<typename CallbackArgumentType<type>::Type, const type&>, "only assets, which are passed to callbacks by const reference, can be shared");
+
+			std::string key = Loader::requestKey(params);
+			if (key.empty()) {
+				Loader::loadAsset(value, params, callback);
+				return;
+			}
+
+			std::shared_ptr<InFlight> loading;
+			bool joined = false;
+			{
+				AtomicLock lock(_inFlightLock);
+				auto& entry = _inFlight[key];
+				if (entry) {
+					if (callback) {
+						entry->waiters.push_back({ callback, threadIdOf(params) });
+					}
+					joined = true;
+				} else {
+					entry = std::make_shared<InFlight>();
+				}
+				loading = entry;
+			}
+
+			if (joined) {
+				loading->started.wait(false, std::memory_order_acquire);
+				value = loading->value;
+				return;
+			}
+
+			Loader::loadAsset(value, params, [this, key = std::move(key), loading, callback](const type& asset, const AssetLoadingResult result) {
+				std::vector<Waiter> waiters;
+				{
+					AtomicLock lock(_inFlightLock);
+					waiters.swap(loading->waiters); // repeated call of callback gets no waiters
+					auto it = _inFlight.find(key);
+					if (it != _inFlight.end() && it->second == loading) { // entry may already belong to newer loading of the key
+						_inFlight.erase(it); // next requests go to loader (and its cache)
+					}
+				}
+
+				for (auto&& w : waiters) {
+					if (w.threadId == 0xffu) {
+						w.callback(asset, result);
+					} else {
+						enqueueAssetCallback(w.threadId, [c = std::move(w.callback), asset, result]() { c(asset, result); });
+					}
+				}
+
+				if (callback) {
+					callback(asset, result);
+				}
+			});
+
+			loading->value = value;
+			loading->started.store(true, std::memory_order_release);
+			loading->started.notify_all();
+		}
+
+		static uint8_t threadIdOf(const params_type& params) noexcept {
+			if constexpr (requires { params.callbackThreadId; }) {
+				return params.callbackThreadId;
+			} else {
+				return 0xffu;
+			}
+		}
+
+		mutable std::atomic_bool _inFlightLock = false;
+		mutable std::unordered_map<std::string, std::shared_ptr<InFlight>> _inFlight;
 	};
 
 	class AssetManager final : public IEngineModule {
@@ -187,6 +355,21 @@ namespace engine {
 			return T{};
 		}
 
+		// loader pool task of loading stage, with priority of params.request, which can change it or cancel task
+		template<class F, typename... Args>
+		auto enqueueLoading(const AssetLoadingFlags& params, F&& f, Args&&... args) const {
+			auto task = _loaderPool->enqueue(TaskType::COMMON, params.request ? params.request->priority() : TaskPriority::NORMAL, std::forward<F>(f), std::forward<Args>(args)...);
+			if (params.request) {
+				params.request->setTask(std::static_pointer_cast<TaskBase>(task));
+			}
+			return task;
+		}
+
+		// loader pool task, which is enqueued when all files are read by FileManager, so loader threads don't wait for io
+		// (not read files are empty views)
+		using FilesLoadingTask = std::function<void(const CancellationToken& token, const std::vector<FileView>& files)>;
+		void enqueueLoadingWithFiles(const AssetLoadingFlags& params, std::vector<std::string>&& files, FilesLoadingTask&& task) const;
+
 		ThreadPoolClass* getThreadPool() noexcept { return _loaderPool.get(); }
 		const ThreadPoolClass* getThreadPool() const noexcept { return _loaderPool.get(); }
 
@@ -212,6 +395,9 @@ struct TypeLoader {
 		...
 	}
     static void cleanUp() noexcept {}
+    // optional: async requests with equal keys share one loading, other requesters get the same value and their callbacks on own threads
+    // (loader must call callback on every path, loading is in flight until it)
+    static std::string requestKey(const AssetLoadingParams<raw_type_name<asset_type>>& params) { return params.file; }
 };
 
 // example:
@@ -5,10 +5,17 @@
 #include "Hash.h"
 #include "Threads/TSContainers.h"
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
+#include <optional>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace engine {
 	template <typename T>
@@ -20,54 +27,303 @@ namespace engine {
 		virtual ~ICache() = default;
 	};
 
-	template <typename K, typename V>
+	struct CacheStats {
+		uint64_t hits = 0u;
+		uint64_t misses = 0u;
+		uint64_t evictions = 0u;
+		size_t bytes = 0u;	// accounted bytes of entries
+		size_t budget = 0u;	// 0 - no limit
+	};
+
+	// least recently used order of keys with bytes of entries, isn't thread safe
+	template <typename K, typename H = Hasher<K>>
+	class LruTracker {
+	public:
+		void add(const K& key, const size_t bytes) { // adds or updates entry, it becomes most recent
+			if (auto it = _entries.find(key); it != _entries.end()) {
+				_bytes = _bytes - it->second.bytes + bytes;
+				it->second.bytes = bytes;
+				_order.splice(_order.end(), _order, it->second.position);
+				return;
+			}
+
+			_order.push_back(key);
+			_entries.emplace(key, Entry{ std::prev(_order.end()), bytes });
+			_bytes += bytes;
+		}
+
+		bool touch(const K& key) {
+			auto it = _entries.find(key);
+			if (it == _entries.end()) return false;
+			_order.splice(_order.end(), _order, it->second.position);
+			return true;
+		}
+
+		size_t remove(const K& key) { // returns bytes of removed entry
+			auto it = _entries.find(key);
+			if (it == _entries.end()) return 0u;
+
+			const size_t bytes = it->second.bytes;
+			_bytes -= bytes;
+			_order.erase(it->second.position);
+			_entries.erase(it);
+			return bytes;
+		}
+
+		// removes least recent entries while bytes are over budget, f(key, bytes) is called for every removed entry
+		template <typename F>
+		void popLeastRecent(const size_t budget, F&& f) {
+			while (_bytes > budget && !_order.empty()) {
+				auto it = _entries.find(_order.front());
+				const size_t bytes = it->second.bytes;
+				_bytes -= bytes;
+				_entries.erase(it);
+
+				K key = std::move(_order.front());
+				_order.pop_front();
+				f(std::move(key), bytes);
+			}
+		}
+
+		void clear() {
+			_order.clear();
+			_entries.clear();
+			_bytes = 0u;
+		}
+
+		[[nodiscard]] inline size_t bytes() const noexcept { return _bytes; }
+		[[nodiscard]] inline size_t size() const noexcept { return _entries.size(); }
+
+	private:
+		struct Entry {
+			typename std::list<K>::iterator position;
+			size_t bytes;
+		};
+
+		std::list<K> _order; // least recent first
+		std::unordered_map<K, Entry, H> _entries;
+		size_t _bytes = 0u;
+	};
+
+	// frees values, which are evicted or erased from cache;
+	// owns - cache owns its values and may drop them, budget needs it
+	// inUse(value) - value is referenced outside of cache and isn't evicted, free(value) - frees value and resets it
+	// raw pointers aren't owned by default: existing caches hand them out and their owners free them
+	template <typename V>
+	struct CacheDeleter {
+		static constexpr bool owns = !std::is_pointer<V>::value;
+		[[nodiscard]] static bool inUse(const V&) noexcept { return false; }
+		static void free(V&) noexcept {}
+	};
+
+	template <typename T>
+	struct CacheDeleter<std::shared_ptr<T>> {
+		static constexpr bool owns = true;
+		[[nodiscard]] static bool inUse(const std::shared_ptr<T>& value) noexcept { return value.use_count() > 1; }
+		static void free(std::shared_ptr<T>& value) noexcept { value.reset(); }
+	};
+
+	// explicit policy for new caches, which own their raw pointers: evicted, erased and remaining values are deleted
+	template <typename V>
+	struct CacheOwningDeleter {
+		static_assert(std::is_pointer<V>::value, "CacheOwningDeleter is for raw pointer values");
+		static constexpr bool owns = true;
+		[[nodiscard]] static bool inUse(const V&) noexcept { return false; }
+		static void free(V& value) noexcept {
+			delete value;
+			value = nullptr;
+		}
+	};
+
+	template <typename K, typename V, typename D = CacheDeleter<V>>
 	class Cache final : public ICache {
 	public:
         using key_type = K;
         using value_type = V;
 
         Cache() = default;
-		~Cache() override = default;
+		~Cache() override {
+			_map.execute([](V& value) { D::free(value); });
+		}
 
 		template <typename KEY = K, typename VAL = V>
-		inline void setValue(KEY&& key, VAL&& value) { _map.setValue(key, value); }
+		inline void setValue(KEY&& key, VAL&& value) {
+			if (!budgeted()) {
+				_map.setValue(key, value);
+				return;
+			}
+
+			account(*_map.setValueExt(key, value));
+			evict();
+		}
 
 		template <typename KEY = K>
 		inline bool hasValue(KEY&& key) { return _map.hasValue(key); }
 
 		template <typename KEY = K>
-		inline const V& getValue(KEY&& key) { return _map.getValue(key); }
+		inline V getValue(KEY&& key) { // copy, value may be evicted by other thread
+			V value = _map.getValueCopy(key);
+			if (value) {
+				_hits.fetch_add(1u, std::memory_order_relaxed);
+				if (budgeted()) {
+					AtomicLock lock(_lruLock);
+					_lru.touch(key);
+				}
+			} else {
+				_misses.fetch_add(1u, std::memory_order_relaxed);
+			}
+			return value;
+		}
 
 		template <typename KEY = K>
-		inline void erase(KEY&& key) { _map.erase(key); }
+		inline void erase(KEY&& key) {
+			if (budgeted()) {
+				AtomicLock lock(_lruLock);
+				_lru.remove(key);
+			}
+
+			if (auto value = _map.extractIf(key, [](const V&) { return true; })) {
+				D::free(*value);
+			}
+		}
+
+		template <typename KEY = K, typename P> // takes value out of cache without freeing it, if predicate(value) is true
+		inline std::optional<V> extractIf(KEY&& key, P&& predicate) {
+			auto value = _map.extractIf(key, std::forward<P>(predicate));
+			if (value && budgeted()) {
+				AtomicLock lock(_lruLock);
+				_lru.remove(key);
+			}
+			return value;
+		}
 
 		template <typename KEY = K, typename VAL = V>
-		inline const V& getOrSetValue(KEY&& key, VAL&& value) { return _map.getOrSet(key, value); }
+		inline V getOrSetValue(KEY&& key, VAL&& value) {
+			if (!budgeted()) {
+				return _map.getOrSet(key, value);
+			}
+
+			return getOrSetValueWithCallback(key, [](const V&) {}, [&value]() -> V { return std::move(value); });
+		}
 
 		template <typename KEY = K, typename F, typename ...Args>
-		inline const V& getOrSetValue(KEY&& key, F&& f, Args&&... args) {
-            return _map.getOrCreate(key, std::forward<F>(f), std::forward<Args>(args)...);
-        }
+		inline V getOrSetValue(KEY&& key, F&& f, Args&&... args) {
+			if (!budgeted()) {
+				return _map.getOrCreate(key, std::forward<F>(f), std::forward<Args>(args)...);
+			}
+
+			return getOrSetValueWithCallback(key, [](const V&) {}, std::forward<F>(f), std::forward<Args>(args)...);
+		}
 
 		template <typename KEY = K, typename FC, typename F, typename ...Args>
-		inline const V& getOrSetValueWithCallback(KEY&& key, FC&& callback, F&& f, Args&&... args) {
-            return _map.getOrCreateWithCallback(
-                    key, std::forward<FC>(callback),
-                    std::forward<F>(f), std::forward<Args>(args)...
-                    );
-        }
+		inline V getOrSetValueWithCallback(KEY&& key, FC&& callback, F&& f, Args&&... args) {
+			if (!budgeted()) {
+				return _map.getOrCreateWithCallback(
+						key, std::forward<FC>(callback),
+						std::forward<F>(f), std::forward<Args>(args)...
+						);
+			}
+
+			V result;
+			_map.getOrCreateExtWithCallback(key, [this, &result, &callback](auto& entry, const bool created) {
+				callback(entry.second);
+				if (created) {
+					account(entry);
+				}
+				result = entry.second; // copied under map lock, evict may erase entry
+			}, std::forward<F>(f), std::forward<Args>(args)...);
+
+			evict();
+			return result;
+		}
 
 		template <typename KEY = K, typename F, typename ...Args>
-		inline const V& getValueOrCreate(KEY&& key, F&& f, Args&&... args) {
-			if (auto& value = _map.getValue(key)) {
+		inline V getValueOrCreate(KEY&& key, F&& f, Args&&... args) {
+			if (auto value = getValue(key)) {
 				return value;
 			} else {
-				return _map.getOrCreate(key, std::forward<F>(f), std::forward<Args>(args)...);
+				return getOrSetValueWithCallback(key, [](const V&) {}, std::forward<F>(f), std::forward<Args>(args)...);
 			}
 		}
 
+		// budget of bytes for cached values, sizer returns bytes of value, 0 - no limit;
+		// least recently used values, which aren't in use by D, are freed by D while cache is over budget
+		// set before cache usage
+		inline void setBudget(const size_t budget, std::function<size_t(const V&)>&& sizer) {
+			static_assert(D::owns, "budget needs a deleter policy, which owns cache values");
+			_sizer = std::move(sizer);
+			_budget.store(budget, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] CacheStats getStats() noexcept {
+			CacheStats stats;
+			stats.hits = _hits.load(std::memory_order_relaxed);
+			stats.misses = _misses.load(std::memory_order_relaxed);
+			stats.evictions = _evictions.load(std::memory_order_relaxed);
+			stats.budget = _budget.load(std::memory_order_relaxed);
+			if (stats.budget != 0u) {
+				AtomicLock lock(_lruLock);
+				stats.bytes = _lru.bytes();
+			}
+			return stats;
+		}
+
 	private:
+		[[nodiscard]] inline bool budgeted() const noexcept { return _budget.load(std::memory_order_relaxed) != 0u; }
+
+		template <typename E>
+		inline void account(const E& entry) {
+			if (!entry.second) return;
+			AtomicLock lock(_lruLock);
+			_lru.add(entry.first, _sizer(entry.second));
+		}
+
+		void evict() {
+			const size_t budget = _budget.load(std::memory_order_relaxed);
+			std::vector<std::pair<K, size_t>> pinned;
+			size_t pinnedBytes = 0u;
+
+			while (true) {
+				std::vector<std::pair<K, size_t>> victims;
+				{
+					AtomicLock lock(_lruLock);
+					_lru.popLeastRecent(budget > pinnedBytes ? budget - pinnedBytes : 0u, [&victims](K&& key, const size_t bytes) {
+						victims.emplace_back(std::move(key), bytes);
+					});
+				}
+
+				if (victims.empty()) break;
+
+				for (auto&& [key, bytes] : victims) {
+					bool used = false;
+					if (auto value = _map.extractIf(key, [&used](const V& value) { used = D::inUse(value); return !used; })) {
+						D::free(*value); // out of map lock
+						_evictions.fetch_add(1u, std::memory_order_relaxed);
+					} else if (used) {
+						pinnedBytes += bytes;
+						pinned.emplace_back(std::move(key), bytes);
+					}
+				}
+			}
+
+			if (!pinned.empty()) { // used values stay in cache as most recent
+				AtomicLock lock(_lruLock);
+				for (auto&& [key, bytes] : pinned) {
+					_lru.add(key, bytes);
+				}
+			}
+		}
+
 		TsUnorderedMap<key_type, value_type, Hasher<key_type>> _map;
+
+		std::atomic_uint64_t _hits = 0u;
+		std::atomic_uint64_t _misses = 0u;
+		std::atomic_uint64_t _evictions = 0u;
+
+		std::atomic_size_t _budget = 0u;
+		std::function<size_t(const V&)> _sizer;
+		std::atomic_bool _lruLock = false;
+		LruTracker<key_type> _lru;
 	};
 
 	class CacheManager final : public IEngineModule {
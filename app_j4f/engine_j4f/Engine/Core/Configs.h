@@ -80,6 +80,10 @@ namespace engine {
         } gpu_features;
 
         std::vector<const char *> gpu_extensions;
+
+        uint32_t upload_ring_size = 32u * 1024u * 1024u; // staging ring for loaded buffers and textures data
+        uint32_t upload_frame_budget = 16u * 1024u * 1024u; // bytes copied to gpu per frame, the rest waits for next frames
+        uint32_t texture_cache_budget = 0u; // bytes of unused cached textures kept for next requests, 0 - they are released at once
     };
 
     enum class FpsLimitType : uint8_t {
@@ -102,5 +106,7 @@ namespace engine {
         FpsLimit fpsLimitUpdate;
 
         GraphicConfig graphicsCfg = {};
+
+        uint16_t file_io_queue_depth = 8u; // asynchronous file reads in flight (io_uring queue, io threads count without io_uring); deeper queues were slower on measured loads
     };
 }
\ No newline at end of file
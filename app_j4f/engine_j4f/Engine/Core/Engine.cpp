@@ -10,6 +10,7 @@
 #include "Threads/WorkersCommutator.h"
 #include "Memory/MemoryManager.h"
 #include "AssetManager.h"
+#include "AssetBundle.h"
 #include "../File/FileManager.h"
 #include "../Graphics/Graphics.h"
 #include "../Utils/Statistic.h"
@@ -54,7 +55,7 @@ namespace engine {
         setModule<WorkerThreadsCommutator>();
 		setModule<MemoryManager>();
 		setModule<CacheManager>();
-		setModule<FileManager>();
+		setModule<FileManager>(config.file_io_queue_depth);
 		setModule<AssetManager>(2u);
 		setModule<Input>();
         setModule<Graphics>(config.graphicsCfg);
@@ -67,6 +68,7 @@ namespace engine {
 
 		getModule<FileManager>().createFileSystem<DefaultFileSystem>();
 		getModule<AssetManager>().setLoader<JsonLoader>();
+		getModule<AssetManager>().setLoader<AssetBundleLoader>();
 
         // create application
         _application = std::make_unique<Application>();
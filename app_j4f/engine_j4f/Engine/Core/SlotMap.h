@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace engine {
+
+	struct SlotMapHandle {
+		uint32_t index = 0xffff'ffffu;
+		uint32_t generation = 0u;
+
+		[[nodiscard]] inline bool valid() const noexcept { return index != 0xffff'ffffu; }
+		inline bool operator==(const SlotMapHandle& h) const noexcept = default;
+	};
+
+	// dense values storage with generational handles:
+	// insert, erase (swap and pop) and lookup by handle are O(1), values are iterated as contiguous array
+	// handle of erased value never matches again (slot generation is increased on erase)
+	template <typename T>
+	class SlotMap {
+	public:
+		using Handle = SlotMapHandle;
+
+		template <typename... Args>
+		Handle emplace(Args&&... args) {
+			uint32_t slotIndex;
+			if (_freeHead != 0xffff'ffffu) {
+				slotIndex = _freeHead;
+				_freeHead = _slots[slotIndex].dense;
+			} else {
+				slotIndex = static_cast<uint32_t>(_slots.size());
+				_slots.push_back({ 0u, 1u });
+			}
+
+			Slot& slot = _slots[slotIndex];
+			slot.dense = static_cast<uint32_t>(_values.size());
+			_values.emplace_back(std::forward<Args>(args)...);
+			_denseToSlot.push_back(slotIndex);
+
+			return { slotIndex, slot.generation };
+		}
+
+		bool erase(const Handle h) {
+			if (!contains(h)) return false;
+
+			Slot& slot = _slots[h.index];
+			const uint32_t dense = slot.dense;
+			const uint32_t last = static_cast<uint32_t>(_values.size() - 1u);
+
+			if (dense != last) {
+				_values[dense] = std::move(_values[last]);
+				_denseToSlot[dense] = _denseToSlot[last];
+				_slots[_denseToSlot[dense]].dense = dense;
+			}
+
+			_values.pop_back();
+			_denseToSlot.pop_back();
+
+			++slot.generation;
+			slot.dense = _freeHead;
+			_freeHead = h.index;
+			return true;
+		}
+
+		[[nodiscard]] inline bool contains(const Handle h) const noexcept {
+			return h.index < _slots.size() && _slots[h.index].generation == h.generation;
+		}
+
+		[[nodiscard]] inline T* get(const Handle h) noexcept { return contains(h) ? &_values[_slots[h.index].dense] : nullptr; }
+		[[nodiscard]] inline const T* get(const Handle h) const noexcept { return contains(h) ? &_values[_slots[h.index].dense] : nullptr; }
+
+		// index of contained value in dense storage (valid until next erase)
+		[[nodiscard]] inline size_t index(const Handle h) const noexcept { return _slots[h.index].dense; }
+
+		[[nodiscard]] inline Handle handle(const size_t dense) const noexcept {
+			const uint32_t slotIndex = _denseToSlot[dense];
+			return { slotIndex, _slots[slotIndex].generation };
+		}
+
+		inline void clear() {
+			for (size_t i = _values.size(); i > 0u; --i) {
+				erase(handle(i - 1u));
+			}
+		}
+
+		[[nodiscard]] inline size_t size() const noexcept { return _values.size(); }
+		[[nodiscard]] inline bool empty() const noexcept { return _values.empty(); }
+
+		inline T& operator[](const size_t dense) noexcept { return _values[dense]; }
+		inline const T& operator[](const size_t dense) const noexcept { return _values[dense]; }
+
+		inline auto begin() noexcept { return _values.begin(); }
+		inline auto end() noexcept { return _values.end(); }
+		inline auto begin() const noexcept { return _values.begin(); }
+		inline auto end() const noexcept { return _values.end(); }
+
+	private:
+		struct Slot {
+			uint32_t dense;			// index in values for used slot, next free slot for free one
+			uint32_t generation;
+		};
+
+		std::vector<T> _values;
+		std::vector<uint32_t> _denseToSlot;
+		std::vector<Slot> _slots;
+		uint32_t _freeHead = 0xffff'ffffu;
+	};
+}
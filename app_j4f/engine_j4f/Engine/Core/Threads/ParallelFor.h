@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ThreadPool2.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace engine {
+
+	// splits [0, count) into chunks of at least grain elements and calls f(begin, end) for them on pool workers and calling thread
+	// calling thread also executes chunks which are not taken by workers yet, so it never waits for busy queues
+	template <typename F>
+	inline void parallel_for(ThreadPool2& pool, const size_t count, const size_t grain, F&& f) {
+		if (count == 0u) return;
+
+		const size_t chunksMax = pool.threadsCount() + 1u;
+		const size_t chunk = std::max(std::max(grain, size_t(1u)), (count + chunksMax - 1u) / chunksMax);
+		if (chunk >= count) {
+			f(size_t(0u), count);
+			return;
+		}
+
+		std::vector<linked_ptr<Task2<void>>> tasks;
+		tasks.reserve(count / chunk);
+		for (size_t begin = chunk; begin < count; begin += chunk) {
+			tasks.push_back(pool.enqueue(TaskType::COMMON, [&f, begin, end = std::min(begin + chunk, count)](const CancellationToken&) {
+				f(begin, end);
+			}));
+		}
+
+		f(size_t(0u), chunk);
+
+		for (auto& task : tasks) {
+			if (task->state() == TaskState::IDLE) {
+				task->operator()(); // no-op, if worker has started it meanwhile
+			}
+			task->wait();
+		}
+	}
+}
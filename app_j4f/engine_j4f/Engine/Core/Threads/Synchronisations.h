@@ -25,7 +25,7 @@ namespace engine {
 	public:
 		explicit AtomicLock(std::atomic_bool& l) : _lock(l) {
 			bool free = false;
-			while (!_lock.compare_exchange_weak(free, true, std::memory_order_release, std::memory_order_relaxed)) {
+			while (!_lock.compare_exchange_weak(free, true, std::memory_order_acquire, std::memory_order_relaxed)) {
 				free = false;
 				std::this_thread::yield();
 			}
@@ -91,7 +91,8 @@ namespace engine {
 		}
 
 		inline void waitForEmpty() const {
-			while (_counter.load(std::memory_order_consume) != 0) {
+			std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with fence of entering reader (see TsUnorderedMap)
+			while (_counter.load(std::memory_order_acquire) != 0) {
 				std::this_thread::yield();
 			}
 		}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Synchronisations.h"
+#include <optional>
 #include <unordered_map>
 
 namespace engine {
@@ -25,8 +26,7 @@ namespace engine {
 
         template <typename T>
         void execute(T && executor) {
-            AtomicLock::wait(_writer);
-            _readers.add();
+            addReader();
             for (auto & [_, v] : _map) {
                 executor(v);
             }
@@ -35,9 +35,7 @@ namespace engine {
 
 		template <typename KEY = K> // KEY may be const K& there
 		inline const V& getValue(KEY&& key) {
-			AtomicLock::wait(_writer);
-
-			_readers.add();
+			addReader();
 			auto it = _map.find(key);
 			if (it != _map.end()) {
 				const V& value = it->second;
@@ -54,6 +52,16 @@ namespace engine {
 			}
 		}
 
+		template <typename KEY = K> // value is copied while map can't be changed
+		inline V getValueCopy(KEY&& key) {
+			addReader();
+			auto it = _map.find(key);
+			V value = it != _map.end() ? it->second : V();
+			_readers.sub();
+
+			return value;
+		}
+
 		template <typename KEY = K, typename VAL = V>
 		const V& setValue(KEY&& key, VAL&& val) {
 			AtomicLock lock(_writer);
@@ -128,10 +136,24 @@ namespace engine {
 			return iterator->second;
 		}
 
+		template <typename KEY = K, typename FC, typename F, typename ...Args> // callback(entry, created) is called under lock
+		void getOrCreateExtWithCallback(KEY&& key, FC&& callback, F&& f, Args&&... args) {
+			AtomicLock lock(_writer);
+
+			auto it = _map.find(key);
+			if (it != _map.end()) {
+				callback(*it, false);
+				return;
+			}
+
+			_readers.waitForEmpty();
+			auto && [iterator, result] = _map.emplace(std::move(key), f(std::forward<Args>(args)...));
+			callback(*iterator, true);
+		}
+
 		template <typename KEY = K>
 		bool hasValue(KEY&& key) {
-			AtomicLock::wait(_writer);
-			_readers.add();
+			addReader();
 			auto it = _map.find(key);
 			if (it != _map.end()) {
 				_readers.sub();
@@ -144,16 +166,17 @@ namespace engine {
 
 		template <typename KEY = K>
 		inline void erase(KEY&& key) {
-			AtomicLock::wait(_writer);
-			_readers.add();
+			addReader();
 
-			auto it = _map.find(key);
-			if (it != _map.end()) {
+			if (_map.find(key) != _map.end()) {
 				_readers.sub();
 
 				AtomicLock lock(_writer);
 				_readers.waitForEmpty();
 
+				auto it = _map.find(key); // may be erased by other writer before lock
+				if (it == _map.end()) return;
+
 				if constexpr (std::is_pointer<V>::value) {
 					delete it->second;
 				}
@@ -163,7 +186,49 @@ namespace engine {
 			}
 		}
 
+		template <typename KEY = K, typename P> // value is erased only if predicate(value) is true, nobody reads map while it's checked
+		inline bool eraseIf(KEY&& key, P&& predicate) {
+			AtomicLock lock(_writer);
+			_readers.waitForEmpty();
+
+			auto it = _map.find(key);
+			if (it == _map.end() || !predicate(it->second)) {
+				return false;
+			}
+
+			if constexpr (std::is_pointer<V>::value) {
+				delete it->second;
+			}
+			_map.erase(it);
+			return true;
+		}
+
+		template <typename KEY = K, typename P> // takes value out of map without freeing it, if predicate(value) is true
+		inline std::optional<V> extractIf(KEY&& key, P&& predicate) {
+			AtomicLock lock(_writer);
+			_readers.waitForEmpty();
+
+			auto it = _map.find(key);
+			if (it == _map.end() || !predicate(it->second)) {
+				return std::nullopt;
+			}
+
+			std::optional<V> value(std::move(it->second));
+			_map.erase(it);
+			return value;
+		}
+
 	private:
+		inline void addReader() noexcept { // reader doesn't enter after writer has checked, that there are no readers
+			while (true) {
+				AtomicLock::wait(_writer);
+				_readers.add();
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (!_writer.load(std::memory_order_acquire)) return;
+				_readers.sub();
+			}
+		}
+
 		std::atomic_bool _writer;
 		AtomicCounter _readers;
 		std::unordered_map<K, V, H, E> _map;
@@ -1,12 +1,16 @@
 #pragma once
 
+#include "../Linked_ptr.h"
 #include "Synchronisations.h"
 #include "TaskCommon.h"
 #include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <atomic>
 #include <cstdint>
+#include <vector>
 
 namespace engine {
 
@@ -15,7 +19,7 @@ namespace engine {
         using counter_type = std::atomic_uint32_t;
 
     public:
-        inline uint32_t _decrease_counter() noexcept { return m_counter.fetch_sub(1, std::memory_order_release) - 1; }
+        inline uint32_t _decrease_counter() noexcept { return m_counter.fetch_sub(1, std::memory_order_acq_rel) - 1; } // acquire: last owner deletes task
         inline uint32_t _increase_counter() noexcept { return m_counter.fetch_add(1, std::memory_order_release) + 1; }
         [[nodiscard]] inline uint32_t _use_count() const noexcept { return m_counter.load(std::memory_order_relaxed); }
 
@@ -26,10 +30,26 @@ namespace engine {
     template <typename T>
     class Task2;
 
+    class TaskBase;
+
+    // tasks of one queue, which priorities have been changed while they wait: queue moves only them to buckets of new priorities
+    class TaskPriorityChanges {
+    public:
+        inline void add(TaskBase* task);
+        [[nodiscard]] inline std::vector<linked_ptr<TaskBase>> take();
+        [[nodiscard]] inline bool empty() const noexcept { return _count.load(std::memory_order_acquire) == 0u; }
+
+    private:
+        SpinLock _locker;
+        std::vector<linked_ptr<TaskBase>> _tasks;
+        std::atomic_uint32_t _count = 0u;
+    };
+
     class TaskBase : public task_control_block {
         using Locker = SpinLock;
         using CondVar = std::condition_variable_any;
         friend class ThreadPool2;
+        template <typename, typename> friend class Task2Queue;
     public:
         TaskBase() = default;
         virtual ~TaskBase() {
@@ -56,10 +76,21 @@ namespace engine {
             }
         }
 
-        inline void notify() noexcept {
-            _condition.notify_one();
+        inline void notify() noexcept { // after state change: waiter, which has checked old state under _locker, is already waiting
+            std::lock_guard<Locker> lock(_locker);
+            _condition.notify_all(); // task can be awaited by several owners (batched jobs)
         }
 
+        // can be changed while task is in queue, queue of waiting task moves it to bucket of its new priority
+        inline void setPriority(const TaskPriority priority) noexcept {
+            if (_priority.exchange(priority, std::memory_order_relaxed) != priority && state() == TaskState::IDLE) {
+                if (auto changes = _queueChanges.lock()) {
+                    changes->add(this);
+                }
+            }
+        }
+        [[nodiscard]] inline TaskPriority priority() const noexcept { return _priority.load(std::memory_order_relaxed); }
+
         template<class F, typename... Args>
         TaskBase(const TaskType type, F&& f, Args&&...args) : _type(type) {
             using return_type = typename std::invoke_result_t<std::decay_t<F>, const CancellationToken&, std::decay_t<Args>...>;
@@ -98,10 +129,26 @@ namespace engine {
         CondVar _condition;
         CancellationToken _token;
         std::atomic<TaskState> _state = { TaskState::IDLE };
+        std::atomic<TaskPriority> _priority = { TaskPriority::NORMAL };
+        std::weak_ptr<TaskPriorityChanges> _queueChanges; // set by queue before task is published, expires with queue
 
         std::function<void()> _function = nullptr;
     };
 
+    inline void TaskPriorityChanges::add(TaskBase* task) {
+        std::lock_guard<SpinLock> lock(_locker);
+        _tasks.emplace_back(task);
+        _count.store(static_cast<uint32_t>(_tasks.size()), std::memory_order_release);
+    }
+
+    inline std::vector<linked_ptr<TaskBase>> TaskPriorityChanges::take() {
+        std::lock_guard<SpinLock> lock(_locker);
+        std::vector<linked_ptr<TaskBase>> tasks;
+        tasks.swap(_tasks);
+        _count.store(0u, std::memory_order_release);
+        return tasks;
+    }
+
     template <typename T>
     class Task2 : public TaskBase {
         friend class ThreadPool;
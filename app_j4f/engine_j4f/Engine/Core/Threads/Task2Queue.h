@@ -2,7 +2,12 @@
 
 #include "../Linked_ptr.h"
 #include "Task2.h"
+#include <atomic>
 #include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
 
 namespace engine {
 
@@ -27,7 +32,11 @@ namespace engine {
                     return;
                 }
 
-                _tasks.emplace_back(std::static_pointer_cast<TaskBase>(task));
+                linked_ptr<TaskBase> t = std::static_pointer_cast<TaskBase>(task);
+                t->_queueChanges = _priorityChanges; // task isn't returned to owner yet
+                applyPriorityChanges();
+                push(std::move(t));
+                updateTopPriority();
             }
             _condition.notify_one();
         }
@@ -59,19 +68,98 @@ namespace engine {
 
         inline void cancelTasks(const uint8_t typeMask) {
             std::unique_lock<Locker> lock(_locker);
-            for (auto&& t : _tasks) {
-                if (typeMask & (1 << static_cast<uint8_t>(t->type()))) {
-                    t->cancel();
+            (void)_priorityChanges->take(); // changed tasks are in buckets too
+            for (auto&& [priority, tasks] : _buckets) {
+                for (auto&& t : tasks) {
+                    if (typeMask & (1 << static_cast<uint8_t>(t->type()))) {
+                        t->cancel();
+                    }
                 }
+                tasks.clear();
             }
-            _tasks.clear();
+            _size = 0u;
+            updateTopPriority();
         }
 
+        // under _locker; cancelled tasks are counted until they are taken
+        [[nodiscard]] inline bool empty() const noexcept { return _size == 0u; }
+
+        // highest priority of waiting tasks, -1 - queue is empty; read without lock by other threads
+        [[nodiscard]] inline int16_t topPriority() const noexcept { return _topPriority.load(std::memory_order_relaxed); }
+
     private:
+        // under _locker: takes the first of tasks with highest priority, cancelled (or already executed) tasks are dropped
+        // task with changed priority can be in several buckets, entries of other priorities are moved, extra entries are dropped after run
+        linked_ptr<TaskBase> takeTask() {
+            applyPriorityChanges();
+
+            linked_ptr<TaskBase> task;
+            for (auto it = _buckets.begin(); it != _buckets.end() && !task; ) {
+                auto& tasks = it->second;
+                bool moved = false;
+                while (!tasks.empty()) {
+                    linked_ptr<TaskBase> t = std::move(tasks.front());
+                    tasks.pop_front();
+                    --_size;
+                    if (t->state() != TaskState::IDLE) continue;
+
+                    if (t->priority() != it->first) { // priority is changed after changes were applied
+                        push(std::move(t));
+                        moved = true;
+                        break;
+                    }
+
+                    task = std::move(t);
+                    break;
+                }
+
+                if (moved) {
+                    it = _buckets.begin(); // task may be moved to higher priority
+                } else {
+                    ++it;
+                }
+            }
+
+            updateTopPriority();
+            return task;
+        }
+
+        inline void push(linked_ptr<TaskBase>&& task) {
+            const TaskPriority priority = task->priority();
+            _buckets[priority].emplace_back(std::move(task));
+            ++_size;
+        }
+
+        // changed waiting tasks get entries in buckets of their new priorities, their old entries are moved or dropped by takeTask
+        inline void applyPriorityChanges() {
+            if (_priorityChanges->empty()) return;
+
+            for (auto&& t : _priorityChanges->take()) {
+                if (t->state() == TaskState::IDLE) {
+                    push(std::move(t));
+                }
+            }
+            updateTopPriority();
+        }
+
+        inline void updateTopPriority() noexcept {
+            int16_t top = -1;
+            for (auto&& [priority, tasks] : _buckets) {
+                if (!tasks.empty()) {
+                    top = static_cast<int16_t>(priority);
+                    break;
+                }
+            }
+            _topPriority.store(top, std::memory_order_relaxed);
+        }
+
         ThreadQueueState _state = ThreadQueueState::RUN;
         Locker _locker;
         CondVar _condition;
-        std::deque<linked_ptr<TaskBase>> _tasks;
+        std::map<TaskPriority, std::deque<linked_ptr<TaskBase>>, std::greater<TaskPriority>> _buckets; // empty buckets are kept for reuse
+        size_t _size = 0u;
+        std::shared_ptr<TaskPriorityChanges> _priorityChanges = std::make_shared<TaskPriorityChanges>();
+        std::atomic_int16_t _topPriority = -1;
     };
 
     template <typename Locker>
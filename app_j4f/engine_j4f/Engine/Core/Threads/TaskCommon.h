@@ -24,6 +24,14 @@ namespace engine {
         MAX_VALUE = 8u
     };
 
+    enum class TaskPriority : uint8_t { // any value can be used, task with higher priority is taken from queue first
+        LOWEST = 0u,
+        LOW = 64u,
+        NORMAL = 128u,
+        HIGH = 192u,
+        HIGHEST = 255u
+    };
+
     class CancellationToken final {
         friend class ThreadPool;
         friend class ThreadPool2;
@@ -31,6 +31,8 @@ namespace engine {
             stop();
         }
 
+        [[nodiscard]] inline size_t threadsCount() const noexcept { return _threads_count; }
+
         inline void stop() {
             if (_state.load(std::memory_order_acquire) != TPoolState::STOP) {
                 _state.store(TPoolState::STOP, std::memory_order_release);
@@ -92,6 +94,17 @@ namespace engine {
             return task;
         }
 
+        template<class F, typename... Args>
+        auto enqueue(const TaskType type, const TaskPriority priority, F&& f, Args&&... args) -> linked_ptr<Task2<typename std::invoke_result_t<std::decay_t<F>, const CancellationToken&, std::decay_t<Args>...>>> {
+            const uint8_t idx = _taskIdx.fetch_add(1, std::memory_order_release) % _threads_count;
+            using return_type = typename std::invoke_result_t<std::decay_t<F>, const CancellationToken&, std::decay_t<Args>...>;
+            auto task = make_linked<Task2<return_type>>(type, std::forward<F>(f), std::forward<Args>(args)...);
+            task->_priority.store(priority, std::memory_order_relaxed); // task isn't in queue yet
+            _queues[idx].enqueue(task);
+
+            return task;
+        }
+
         inline void cancelTasks(const uint8_t typeMask) {
             for (auto&& t : _currentTasks) {
                 if (t && (typeMask & (1 << static_cast<uint8_t>(t->_type)))) {
@@ -105,22 +118,27 @@ namespace engine {
         }
 
     private:
-        inline void grabTask(linked_ptr<TaskBase>& task, const uint8_t threadId) {
-            for (size_t i = 0; i < _threads_count; ++i) {
-                if (i == threadId) continue;
-                auto& current = _queues[i];
+        // task from other queue with top priority higher than minPriority (-1 - any task)
+        inline void grabTask(linked_ptr<TaskBase>& task, const uint8_t threadId, const int16_t minPriority) {
+            for (size_t attempt = 0; attempt < _threads_count; ++attempt) {
+                size_t best = threadId;
+                int16_t bestPriority = minPriority;
+                for (size_t i = 0; i < _threads_count; ++i) {
+                    const int16_t priority = _queues[i].topPriority();
+                    if (i != threadId && priority > bestPriority) {
+                        best = i;
+                        bestPriority = priority;
+                    }
+                }
 
-                while (!current._tasks.empty() && (current._tasks.front()->state() != TaskState::IDLE)) { // immediate remove cancelled tasks
-                    current._tasks.pop_front();
+                if (best == threadId) {
+                    return;
                 }
 
-                if (!current._tasks.empty()) {
-                    std::unique_lock<Locker> lock(current._locker);
-                    if (!current._tasks.empty()) {
-                        task = std::move(current._tasks.front());
-                        current._tasks.pop_front();
-                        return;
-                    }
+                auto& queue = _queues[best];
+                std::unique_lock<Locker> lock(queue._locker); // queue is modified only under its lock
+                if ((task = queue.takeTask())) {
+                    return;
                 }
             }
         }
@@ -131,15 +149,20 @@ namespace engine {
                 {
                     auto& current = _queues[threadId];
                     std::unique_lock<Locker> lock(current._locker);
-                    current._condition.wait(lock, [this, threadId] { return (_queues[threadId]._state == ThreadQueueState::STOP) || (!_queues[threadId]._tasks.empty()); });
+                    current._condition.wait(lock, [this, threadId] { return (_queues[threadId]._state == ThreadQueueState::STOP) || !_queues[threadId].empty(); });
+                    const int16_t topPriority = current.topPriority();
+                    lock.unlock();
 
-                    while (!current._tasks.empty() && (current._tasks.front()->state() != TaskState::IDLE)) { // immediate remove cancelled tasks
-                        current._tasks.pop_front();
-                    }
+                    grabTask(task, threadId, topPriority); // other queue has task with higher priority
 
-                    if (current._tasks.empty()) { // try to get task from other queue
+                    if (!task && topPriority >= 0) {
+                        lock.lock();
+                        task = current.takeTask(); // task with highest priority, cancelled ones are removed
                         lock.unlock();
-                        grabTask(task, threadId);
+                    }
+
+                    if (!task) { // try to get task from other queue
+                        grabTask(task, threadId, -1);
                         switch (current._state) {
                             case ThreadQueueState::PAUSE:
                                 if (!task) {
@@ -154,9 +177,6 @@ namespace engine {
                             default:
                                 break;
                         }
-                    } else {
-                        task = std::move(current._tasks.front());
-                        current._tasks.pop_front();
                     }
                 }
 
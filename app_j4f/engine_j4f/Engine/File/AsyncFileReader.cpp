@@ -0,0 +1,421 @@
+#include "AsyncFileReader.h"
+#include "../Log/Log.h"
+
+#include <cstdio>
+#include <filesystem>
+
+#ifdef j4f_PLATFORM_LINUX
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace engine {
+
+#ifdef j4f_PLATFORM_LINUX
+	namespace {
+		// raw syscalls, liburing isn't used
+		int uringSetup(const unsigned entries, io_uring_params* params) {
+			return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+		}
+
+		int uringEnter(const int ring, const unsigned toSubmit, const unsigned minComplete, const unsigned flags) {
+			return static_cast<int>(syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, nullptr, 0));
+		}
+
+		int uringRegister(const int ring, const unsigned opcode, void* arg, const unsigned args) {
+			return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, args));
+		}
+
+		// reads with open, fstat and read stages: open and read go through ring, every slot has one submission in flight at most
+		class IoUringFileReader final : public AsyncFileReader {
+			static constexpr uint64_t kWakeupData = ~0ull;
+			static constexpr size_t kMaxReadSize = 1u << 30u;
+
+			struct Request {
+				std::string path;
+				FileReadCallback callback;
+			};
+
+			struct Slot {
+				Request request;
+				int fd = -1;
+				FileView view;
+				std::byte* data = nullptr;
+				size_t size = 0u;
+				size_t done = 0u;
+			};
+
+		public:
+			IoUringFileReader(const uint32_t queueDepth, FileReadFallback&& fallback) : _slots(std::max(queueDepth, 1u)), _fallback(std::move(fallback)) {
+				io_uring_params params = {};
+				_ring = uringSetup(static_cast<unsigned>(_slots.size()) + 1u, &params); // + eventfd poll
+				if (_ring < 0) return;
+
+				if (!supported() || !map(params)) {
+					close();
+					return;
+				}
+
+				_wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+				if (_wakeup < 0) {
+					close();
+					return;
+				}
+
+				_freeSlots.reserve(_slots.size());
+				for (uint32_t i = static_cast<uint32_t>(_slots.size()); i > 0u; --i) {
+					_freeSlots.push_back(i - 1u);
+				}
+
+				_thread = std::thread(&IoUringFileReader::run, this);
+			}
+
+			~IoUringFileReader() override {
+				if (_thread.joinable()) {
+					_stop.store(true, std::memory_order_release);
+					wakeup();
+					_thread.join();
+				}
+				close();
+			}
+
+			[[nodiscard]] inline bool valid() const noexcept { return _thread.joinable(); }
+
+			void read(std::string&& path, FileReadCallback&& callback) override {
+				bool stopped;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					stopped = _stopped;
+					if (!_failed && !stopped) {
+						_pending.push_back({ std::move(path), std::move(callback) });
+						wakeup();
+						return;
+					}
+				}
+
+				if (stopped) { // reader thread has exited, nobody would take request
+					if (callback) { callback({}); }
+					return;
+				}
+
+				_fallback(std::move(path), std::move(callback));
+			}
+
+		private:
+			bool supported() const {
+				constexpr unsigned kOpsCount = 64u;
+				std::vector<std::byte> memory(sizeof(io_uring_probe) + kOpsCount * sizeof(io_uring_probe_op));
+				auto* probe = reinterpret_cast<io_uring_probe*>(memory.data());
+				if (uringRegister(_ring, IORING_REGISTER_PROBE, probe, kOpsCount) < 0) return false;
+
+				const auto has = [probe](const uint8_t op) { return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED); };
+				return has(IORING_OP_OPENAT) && has(IORING_OP_READ) && has(IORING_OP_POLL_ADD);
+			}
+
+			bool map(const io_uring_params& params) {
+				_sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+				_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+				if (params.features & IORING_FEAT_SINGLE_MMAP) {
+					_sqSize = _cqSize = std::max(_sqSize, _cqSize);
+				}
+
+				_sqPtr = mmap(nullptr, _sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_SQ_RING);
+				if (_sqPtr == MAP_FAILED) { _sqPtr = nullptr; return false; }
+
+				if (params.features & IORING_FEAT_SINGLE_MMAP) {
+					_cqPtr = _sqPtr;
+				} else {
+					_cqPtr = mmap(nullptr, _cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_CQ_RING);
+					if (_cqPtr == MAP_FAILED) { _cqPtr = nullptr; return false; }
+				}
+
+				_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+				void* sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring, IORING_OFF_SQES);
+				if (sqes == MAP_FAILED) return false;
+				_sqes = static_cast<io_uring_sqe*>(sqes);
+
+				auto* sq = static_cast<std::byte*>(_sqPtr);
+				_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+				_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+				_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+				_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+				auto* cq = static_cast<std::byte*>(_cqPtr);
+				_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+				_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+				_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+				_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+				return true;
+			}
+
+			void close() noexcept {
+				if (_sqes) { munmap(_sqes, _sqesSize); _sqes = nullptr; }
+				if (_cqPtr && _cqPtr != _sqPtr) { munmap(_cqPtr, _cqSize); }
+				if (_sqPtr) { munmap(_sqPtr, _sqSize); }
+				_sqPtr = _cqPtr = nullptr;
+				if (_ring >= 0) { ::close(_ring); _ring = -1; }
+				if (_wakeup >= 0) { ::close(_wakeup); _wakeup = -1; }
+			}
+
+			void wakeup() noexcept {
+				const uint64_t one = 1u;
+				[[maybe_unused]] const auto r = ::write(_wakeup, &one, sizeof(one));
+			}
+
+			io_uring_sqe* pushSqe(const uint8_t opcode, const int fd, const uint64_t userData) noexcept {
+				const unsigned tail = *_sqTail; // only reader thread writes tail
+				const unsigned index = tail & _sqMask;
+				io_uring_sqe* sqe = &_sqes[index];
+				memset(sqe, 0, sizeof(io_uring_sqe));
+				sqe->opcode = opcode;
+				sqe->fd = fd;
+				sqe->user_data = userData;
+				_sqArray[index] = index;
+				std::atomic_ref<unsigned>(*_sqTail).store(tail + 1u, std::memory_order_release);
+				++_toSubmit;
+				return sqe;
+			}
+
+			void armWakeup() noexcept {
+				io_uring_sqe* sqe = pushSqe(IORING_OP_POLL_ADD, _wakeup, kWakeupData);
+				sqe->poll32_events = POLLIN;
+			}
+
+			void submitOpen(const uint32_t slotId) noexcept {
+				io_uring_sqe* sqe = pushSqe(IORING_OP_OPENAT, AT_FDCWD, slotId);
+				sqe->addr = reinterpret_cast<uint64_t>(_slots[slotId].request.path.c_str());
+				sqe->open_flags = O_RDONLY | O_CLOEXEC;
+			}
+
+			void submitRead(const uint32_t slotId) noexcept {
+				Slot& slot = _slots[slotId];
+				io_uring_sqe* sqe = pushSqe(IORING_OP_READ, slot.fd, slotId);
+				sqe->addr = reinterpret_cast<uint64_t>(slot.data + slot.done);
+				sqe->len = static_cast<uint32_t>(std::min(slot.size - slot.done, kMaxReadSize));
+				sqe->off = slot.done;
+			}
+
+			void complete(const uint32_t slotId, const bool success) {
+				Slot& slot = _slots[slotId];
+				if (slot.fd >= 0) { ::close(slot.fd); }
+
+				if (!success) {
+					LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "can't read file %s", slot.request.path.c_str());
+				}
+
+				FileReadCallback callback = std::move(slot.request.callback);
+				FileView view = success ? std::move(slot.view) : FileView();
+				slot = Slot();
+				_freeSlots.push_back(slotId);
+
+				if (callback) {
+					callback(std::move(view));
+				}
+			}
+
+			void onOpened(const uint32_t slotId, const int res) {
+				Slot& slot = _slots[slotId];
+				if (res < 0) {
+					complete(slotId, false);
+					return;
+				}
+
+				slot.fd = res;
+				struct stat s;
+				if (fstat(slot.fd, &s) != 0 || s.st_size <= 0) { // empty files are errors as for FileSystem::readFile
+					complete(slotId, false);
+					return;
+				}
+
+				slot.size = static_cast<size_t>(s.st_size);
+				slot.view = FileView::allocate(slot.size, slot.data);
+				submitRead(slotId);
+			}
+
+			void onRead(const uint32_t slotId, const int res) {
+				Slot& slot = _slots[slotId];
+				if (res == -EAGAIN || res == -EINTR) {
+					submitRead(slotId);
+					return;
+				}
+
+				if (res <= 0) { // error or file became shorter
+					complete(slotId, false);
+					return;
+				}
+
+				slot.done += static_cast<size_t>(res);
+				if (slot.done < slot.size) {
+					submitRead(slotId);
+				} else {
+					complete(slotId, true);
+				}
+			}
+
+			void takeRequests() {
+				std::lock_guard<std::mutex> lock(_mutex);
+				while (!_pending.empty() && !_freeSlots.empty()) {
+					const uint32_t slotId = _freeSlots.back();
+					_freeSlots.pop_back();
+					_slots[slotId].request = std::move(_pending.front());
+					_pending.pop_front();
+					submitOpen(slotId);
+				}
+			}
+
+			void run() {
+				armWakeup();
+
+				for (;;) {
+					const bool stop = _stop.load(std::memory_order_acquire);
+					if (!stop) {
+						takeRequests();
+					} else if (_freeSlots.size() == _slots.size()) { // reads in flight are finished, not started requests are dropped on exit
+						break;
+					}
+
+					const int submitted = uringEnter(_ring, _toSubmit, 1u, IORING_ENTER_GETEVENTS);
+					if (submitted < 0) {
+						if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+						LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "io_uring_enter failed: %s, files are read by io threads", strerror(errno));
+						fail();
+						return;
+					}
+					_toSubmit -= std::min(_toSubmit, static_cast<unsigned>(submitted));
+
+					unsigned head = *_cqHead;
+					const unsigned tail = std::atomic_ref<unsigned>(*_cqTail).load(std::memory_order_acquire);
+					for (; head != tail; ++head) {
+						const io_uring_cqe cqe = _cqes[head & _cqMask];
+						std::atomic_ref<unsigned>(*_cqHead).store(head + 1u, std::memory_order_release); // cqe is copied, kernel can reuse it
+
+						if (cqe.user_data == kWakeupData) {
+							uint64_t value;
+							[[maybe_unused]] const auto r = ::read(_wakeup, &value, sizeof(value));
+							armWakeup();
+							continue;
+						}
+
+						const auto slotId = static_cast<uint32_t>(cqe.user_data);
+						if (_slots[slotId].fd < 0) {
+							onOpened(slotId, cqe.res);
+						} else {
+							onRead(slotId, cqe.res);
+						}
+					}
+				}
+
+				std::deque<Request> dropped;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_stopped = true;
+					dropped.swap(_pending);
+				}
+
+				for (Request& request : dropped) {
+					if (request.callback) { request.callback({}); }
+				}
+			}
+
+			// ring can't be used: requests in flight and waiting ones go to fallback, which opens files again,
+			// so opened files are closed; paths and buffers of slots are kept until ring is closed, kernel could still use them
+			void fail() {
+				std::deque<Request> requests;
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					_failed = true;
+					requests.swap(_pending);
+				}
+
+				for (Slot& slot : _slots) {
+					if (slot.fd >= 0) { // reads in flight hold their own reference of file
+						::close(slot.fd);
+						slot.fd = -1;
+					}
+
+					if (slot.request.callback) {
+						requests.push_front({ slot.request.path, std::move(slot.request.callback) });
+					}
+				}
+
+				for (Request& request : requests) {
+					_fallback(std::move(request.path), std::move(request.callback));
+				}
+			}
+
+			int _ring = -1;
+			int _wakeup = -1;
+
+			void* _sqPtr = nullptr;
+			void* _cqPtr = nullptr;
+			size_t _sqSize = 0u;
+			size_t _cqSize = 0u;
+			size_t _sqesSize = 0u;
+			io_uring_sqe* _sqes = nullptr;
+			unsigned* _sqHead = nullptr;
+			unsigned* _sqTail = nullptr;
+			unsigned* _sqArray = nullptr;
+			unsigned _sqMask = 0u;
+			unsigned* _cqHead = nullptr;
+			unsigned* _cqTail = nullptr;
+			io_uring_cqe* _cqes = nullptr;
+			unsigned _cqMask = 0u;
+			unsigned _toSubmit = 0u;
+
+			std::vector<Slot> _slots;
+			std::vector<uint32_t> _freeSlots;
+			FileReadFallback _fallback;
+
+			std::mutex _mutex;
+			std::deque<Request> _pending;
+			bool _failed = false; // under _mutex
+			bool _stopped = false; // under _mutex, reader thread doesn't take requests anymore
+			std::atomic_bool _stop = false;
+			std::thread _thread;
+		};
+	}
+
+	std::unique_ptr<AsyncFileReader> AsyncFileReader::create(const uint32_t queueDepth, FileReadFallback&& fallback) {
+		auto reader = std::make_unique<IoUringFileReader>(queueDepth, std::move(fallback));
+		if (!reader->valid()) return nullptr;
+		return reader;
+	}
+#else
+	std::unique_ptr<AsyncFileReader> AsyncFileReader::create(const uint32_t /*queueDepth*/, FileReadFallback&& /*fallback*/) {
+		return nullptr;
+	}
+#endif
+
+	FileView AsyncFileReader::readBlocking(const std::string& path) {
+		std::error_code error;
+		const auto size = static_cast<size_t>(std::filesystem::file_size(path, error));
+		if (error || size == 0u) return {}; // empty files are errors as for FileSystem::readFile
+
+		if (std::FILE* file = std::fopen(path.c_str(), "rb")) {
+			std::byte* data;
+			FileView view = FileView::allocate(size, data);
+			const bool read = std::fread(data, size, 1u, file) == 1u;
+			std::fclose(file);
+			if (read) return view;
+		}
+
+		LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "can't read file %s", path.c_str());
+		return {};
+	}
+
+}
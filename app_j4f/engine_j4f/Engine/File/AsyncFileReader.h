@@ -0,0 +1,34 @@
+#pragma once
+
+#include "FileView.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace engine {
+
+	// empty view - file can't be read
+	using FileReadCallback = std::function<void(FileView&& data)>;
+	// reads, which reader can't do (its os queue failed), are handed to other reader
+	using FileReadFallback = std::function<void(std::string&& path, FileReadCallback&& callback)>;
+
+	// asynchronous reads of files on disk by os, many reads are in flight at once without blocked threads
+	// callbacks are called on reader thread, so they should only hand data over (enqueue task of loading)
+	class AsyncFileReader {
+	public:
+		virtual ~AsyncFileReader() = default;
+
+		// path is full path of file on disk (FileSystem::diskPath); callback is always called,
+		// with empty view for reads, which weren't started before reader is destroyed
+		virtual void read(std::string&& path, FileReadCallback&& callback) = 0;
+
+		// io_uring reader on linux, nullptr - os doesn't support it, FileManager reads files on its io threads then
+		static std::unique_ptr<AsyncFileReader> create(const uint32_t queueDepth, FileReadFallback&& fallback);
+
+		// blocking read of file on disk, for fallback reads
+		static FileView readBlocking(const std::string& path);
+	};
+
+}
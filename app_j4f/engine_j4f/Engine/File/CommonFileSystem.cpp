@@ -1,4 +1,5 @@
 #include "CommonFileSystem.h"
+#include "MappedFile.h"
 #include "../Utils/StringHelper.h"
 #include <filesystem>
 #include <functional>
@@ -154,6 +155,33 @@ namespace engine {
 		return readFileImpl(this, path, data);
 	}
 
+	FileView CommonFileSystem::readFileMapped(const std::string& path) const {
+		constexpr size_t kMinMappedSize = 256u * 1024u; // reading of smaller files into pooled buffer is faster than mapping
+
+		const std::string full_path = fullPath(path);
+		const size_t fileLength = lengthFile(full_path, true);
+		if (fileLength == 0u) return {};
+
+		if (fileLength >= kMinMappedSize) {
+			auto file = std::make_shared<MappedFile>(full_path);
+			if (*file) {
+				const std::byte* data = file->data();
+				const size_t size = file->size();
+				return { std::move(file), data, size };
+			}
+		}
+
+		if (File* file = file_open(full_path.c_str(), "rb")) {
+			std::byte* data;
+			FileView view = FileView::allocate(fileLength, data);
+			const bool read = file_read(file, fileLength, 1u, data) == 1u;
+			file_close(file);
+			if (read) return view;
+		}
+
+		return {};
+	}
+
 	bool CommonFileSystem::writeFile(const std::string& path, const void* data, const size_t sz, const char* mode) const {
 		const std::string full_path = fullPath(path);
 		const std::filesystem::path pathToFile{ full_path };
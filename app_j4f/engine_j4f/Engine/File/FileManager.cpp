@@ -0,0 +1,107 @@
+#include "FileManager.h"
+#include "../Core/Threads/ThreadPool2.h"
+#include "../Log/Log.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace engine {
+
+	namespace {
+		// callback gets empty view, if io pool is stopped before read task is run
+		class PendingRead {
+		public:
+			explicit PendingRead(FileReadCallback&& callback) noexcept : _callback(std::move(callback)) {}
+
+			~PendingRead() {
+				if (_callback) { _callback({}); }
+			}
+
+			void complete(FileView&& view) {
+				FileReadCallback callback = std::move(_callback);
+				_callback = nullptr;
+				callback(std::move(view));
+			}
+
+		private:
+			FileReadCallback _callback;
+		};
+	}
+
+	FileManager::FileManager(const uint16_t ioQueueDepth) :
+	_asyncReader(AsyncFileReader::create(ioQueueDepth, [this](std::string&& path, FileReadCallback&& callback) { // reader's ring failed
+		auto read = std::make_shared<PendingRead>(std::move(callback));
+		_ioPool->enqueue(TaskType::COMMON, [path = std::move(path), read](const CancellationToken&) {
+			read->complete(AsyncFileReader::readBlocking(path));
+		});
+	})) {
+		// without AsyncFileReader blocking reads of io threads give io depth
+		const size_t ioThreads = _asyncReader ? 2u : std::clamp<size_t>(ioQueueDepth, 2u, 16u);
+		_ioPool = std::make_unique<ThreadPool2>("io_pool", ioThreads);
+
+		LOG_TAG_LEVEL(LogLevel::L_CUSTOM, FILES, "asynchronous file reads: %s, queue depth %zu", _asyncReader ? "io_uring" : "io threads", _asyncReader ? static_cast<size_t>(ioQueueDepth) : ioThreads);
+	}
+
+	FileManager::~FileManager() {
+		_asyncReader.reset(); // reads in flight are finished, their callbacks can use file systems
+		_ioPool->stop(); // not started reads get empty views
+
+		for (auto&& fs : _fileSystems) {
+			delete fs;
+		}
+
+		_fileSystems.clear();
+		_mappedFileSystems.clear();
+		_index.store(nullptr, std::memory_order_relaxed);
+		_indices.clear();
+	}
+
+	void FileManager::readFileAsync(const std::string& path, FileReadCallback&& callback) const {
+		const ResolvedFile file = resolve(path);
+		if (!file.fs) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "can't read file %s", path.c_str());
+			callback({});
+			return;
+		}
+
+		if (_asyncReader) {
+			if (std::string diskPath = file.fs->diskPath(*file.path); !diskPath.empty()) {
+				_asyncReader->read(std::move(diskPath), std::move(callback));
+				return;
+			}
+		}
+
+		auto read = std::make_shared<PendingRead>(std::move(callback));
+		_ioPool->enqueue(TaskType::COMMON, [fs = file.fs, path = *file.path, entry = file.entry, read](const CancellationToken&) {
+			read->complete(fs->readEntryMapped(entry, path));
+		});
+	}
+
+	void FileManager::readFilesAsync(std::vector<std::string>&& paths, FilesReadCallback&& callback) const {
+		if (paths.empty()) {
+			callback({});
+			return;
+		}
+
+		struct Batch {
+			std::vector<FileView> views;
+			std::atomic_size_t left;
+			FilesReadCallback callback;
+		};
+
+		auto batch = std::make_shared<Batch>();
+		batch->views.resize(paths.size());
+		batch->left.store(paths.size(), std::memory_order_relaxed);
+		batch->callback = std::move(callback);
+
+		for (size_t i = 0u; i < paths.size(); ++i) {
+			readFileAsync(paths[i], [batch, i](FileView&& data) {
+				batch->views[i] = std::move(data);
+				if (batch->left.fetch_sub(1u, std::memory_order_acq_rel) == 1u) { // last read, views of other reads are visible
+					batch->callback(std::move(batch->views));
+				}
+			});
+		}
+	}
+
+}
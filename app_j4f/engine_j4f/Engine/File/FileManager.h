@@ -3,16 +3,28 @@
 #include "../Core/Common.h"
 #include "../Core/EngineModule.h"
 #include "../Core/Threads/Synchronisations.h"
+#include "AsyncFileReader.h"
 #include "FileSystem.h"
+#include "PathIndex.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
-#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <string_view>
 
 namespace engine {
 
+	class ThreadPool2;
+
+	// views in order of requested paths, empty views for not read files
+	using FilesReadCallback = std::function<void(std::vector<FileView>&& data)>;
+
 	class FileManager final : public IEngineModule { // todo: syncronisations
 	public:
-		FileManager() {}
+		explicit FileManager(const uint16_t ioQueueDepth = 8u); // reads in flight of asynchronous reads, the same default as EngineConfig::file_io_queue_depth
+		~FileManager() override;
 
 		template<typename T, typename... Args>
 		T* createFileSystem(Args&& ...args) {
@@ -38,29 +50,16 @@ namespace engine {
 			return nullptr;
 		}
 
-		~FileManager() {
-			for (auto&& fs : _fileSystems) {
-				delete fs;
-			}
+		const std::vector<FileSystem*>& getFileSystems() const { return _fileSystems; }
 
-			_fileSystems.clear();
-			_mappedFiles.clear();
+		// file of mapped file systems, case of path and backslash separators are ignored
+		[[nodiscard]] inline const PathIndex::Entry* findFile(const std::string_view path) const noexcept {
+			const PathIndex* index = _index.load(std::memory_order_acquire);
+			return index ? index->find(path) : nullptr;
 		}
 
-		const std::vector<FileSystem*>& getFileSystems() const { return _fileSystems; }
-
 		inline const FileSystem* getFileSystemByFilePath(const std::string& path) const {
-			auto it = _mappedFiles.find(path);
-			if (it != _mappedFiles.end()) {
-				return it->second[0];
-			}
-
-			for (FileSystem* fs : _fileSystems) {
-				if (fs->hasFile(path)) {
-					return fs;
-				}
-			}
-			return nullptr;
+			return resolve(path).fs;
 		}
 
 		bool hasFile(const std::string& path) const {
@@ -68,40 +67,52 @@ namespace engine {
 		}
 
 		size_t lengthFile(const std::string& path) const {
-			if (const FileSystem* fs = getFileSystemByFilePath(path)) {
-				return fs->lengthFile(path);
+			if (const ResolvedFile file = resolve(path); file.fs) {
+				return file.fs->lengthFile(*file.path);
 			}
 			return 0;
 		}
 
 		std::string getFullPath(const std::string& path) const {
-			if (const FileSystem* fs = getFileSystemByFilePath(path)) {
-				return fs->fullPath(path);
+			if (const ResolvedFile file = resolve(path); file.fs) {
+				return file.fs->fullPath(*file.path);
 			}
 			return path;
 		}
 
 		char* readFile(const std::string& path, size_t& fileSize) const {
-			if (const FileSystem* fs = getFileSystemByFilePath(path)) {
-				return fs->readFile(path, fileSize);
+			if (const ResolvedFile file = resolve(path); file.fs) {
+				return file.fs->readFile(*file.path, fileSize);
 			}
 			return nullptr;
 		}
 
 		bool readFile(const std::string& path, std::vector<char>& data) const {
-			if (const FileSystem* fs = getFileSystemByFilePath(path)) {
-				return fs->readFile(path, data);
+			if (const ResolvedFile file = resolve(path); file.fs) {
+				return file.fs->readFile(*file.path, data);
 			}
 			return false;
 		}
 
 		bool readFile(const std::string& path, std::vector<std::byte>& data) const {
-			if (const FileSystem* fs = getFileSystemByFilePath(path)) {
-				return fs->readFile(path, data);
+			if (const ResolvedFile file = resolve(path); file.fs) {
+				return file.fs->readFile(*file.path, data);
 			}
 			return false;
 		}
 
+		FileView readFileMapped(const std::string& path) const {
+			if (const ResolvedFile file = resolve(path); file.fs) {
+				return file.fs->readEntryMapped(file.entry, *file.path);
+			}
+			return {};
+		}
+
+		// files on disk are read by AsyncFileReader (io_uring) when os supports it, others by io threads,
+		// callback is called on reader thread (or at once if there is no file), loader tasks should be enqueued from it
+		void readFileAsync(const std::string& path, FileReadCallback&& callback) const;
+		void readFilesAsync(std::vector<std::string>&& paths, FilesReadCallback&& callback) const;
+
 		const FileSystem* writeFile(const std::string& path, const void* data, const size_t sz, const char* mode) const {
 			for (FileSystem* fs : _fileSystems) {
 				if (fs->writeFile(path, data, sz, mode)) {
@@ -111,28 +122,57 @@ namespace engine {
 			return nullptr;
 		}
 
+		// files of fs are added to path index (only files of fs are listed, index of other mapped file systems is copied)
 		void mapFileSystem(const FileSystem* fs) {
-			std::vector<std::string> files = fs->getFiles();
-			for (const std::string& s : files) {
-				_mappedFiles[s].push_back(fs);
-			}
+			if (std::find(_mappedFileSystems.begin(), _mappedFileSystems.end(), fs) != _mappedFileSystems.end()) return;
+
+			_mappedFileSystems.push_back(fs);
+			setIndex(std::make_unique<PathIndex>(_index.load(std::memory_order_relaxed), std::vector<const FileSystem*>{ fs }));
 		}
 
 		void unmapFileSystem(const FileSystem* fs) {
-			for (auto it = _mappedFiles.begin(); it != _mappedFiles.end(); ) {
-				std::vector<const FileSystem*>& v = it->second;
-				v.erase(std::remove(v.begin(), v.end(), fs), v.end());
-				if (v.empty()) {
-					it = _mappedFiles.erase(it);
-				} else {
-					++it;
+			auto it = std::find(_mappedFileSystems.begin(), _mappedFileSystems.end(), fs);
+			if (it == _mappedFileSystems.end()) return;
+
+			_mappedFileSystems.erase(it);
+			setIndex(_mappedFileSystems.empty() ? nullptr : std::make_unique<PathIndex>(nullptr, _mappedFileSystems));
+		}
+
+	private:
+		struct ResolvedFile {
+			const FileSystem* fs = nullptr;
+			const std::string* path = nullptr; // path in fs
+			uint32_t entry = FileSystem::kNoEntry;
+		};
+
+		// files out of index (of not mapped file systems or created after mapping) are searched in file systems
+		ResolvedFile resolve(const std::string& path) const {
+			if (const PathIndex::Entry* entry = findFile(path)) {
+				return { entry->fs, &entry->path, entry->entry };
+			}
+
+			for (FileSystem* fs : _fileSystems) {
+				if (fs->hasFile(path)) {
+					return { fs, &path, FileSystem::kNoEntry };
 				}
 			}
+			return {};
+		}
+
+		void setIndex(std::unique_ptr<PathIndex>&& index) {
+			_index.store(index.get(), std::memory_order_release);
+			if (index) {
+				_indices.push_back(std::move(index)); // replaced indices are kept, lookups on other threads can still use them
+			}
 		}
 
-	private:
 		// hmmm... use shared pointers for this????
 		std::vector<FileSystem*> _fileSystems;
-		std::unordered_map<std::string, std::vector<const FileSystem*>> _mappedFiles;
+		std::vector<const FileSystem*> _mappedFileSystems; // in order of mapping
+		std::atomic<const PathIndex*> _index = nullptr;
+		std::vector<std::unique_ptr<const PathIndex>> _indices;
+
+		std::unique_ptr<AsyncFileReader> _asyncReader;
+		std::unique_ptr<ThreadPool2> _ioPool; // reads of not disk file systems or of all files without AsyncFileReader
 	};
 }
\ No newline at end of file
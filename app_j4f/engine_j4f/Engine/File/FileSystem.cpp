@@ -0,0 +1,31 @@
+#include "FileSystem.h"
+
+namespace engine {
+
+	std::vector<FileSystem::IndexedFile> FileSystem::getIndexedFiles() const {
+		std::vector<std::string> files = getFiles();
+
+		std::vector<IndexedFile> indexed;
+		indexed.reserve(files.size());
+		for (std::string& file : files) {
+			indexed.push_back({ std::move(file), kNoEntry });
+		}
+		return indexed;
+	}
+
+	FileView FileSystem::readFileMapped(const std::string& path) const {
+		const size_t fileSize = lengthFile(path);
+		if (fileSize == 0u) return {};
+
+		File* file = file_open(path.c_str(), "rb");
+		if (!file) return {};
+
+		std::byte* data;
+		FileView view = FileView::allocate(fileSize, data);
+		const bool read = file_read(file, fileSize, 1u, data) == 1u;
+		file_close(file);
+
+		return read ? view : FileView();
+	}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "FileView.h"
+
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -18,6 +20,13 @@ namespace engine {
 	class FileSystem {
 		friend class FileManager;
 	public:
+		static constexpr uint32_t kNoEntry = ~0u;
+
+		struct IndexedFile {
+			std::string path;
+			uint32_t entry = kNoEntry; // id of file in file system, kNoEntry - file is found by path
+		};
+
 		virtual ~FileSystem() = default;
 
 		// file works
@@ -30,14 +39,18 @@ namespace engine {
 
 		//
 		virtual std::vector<std::string> getFiles() const = 0;
+		virtual std::vector<IndexedFile> getIndexedFiles() const; // files for FileManager path index
 		virtual bool hasFile(const std::string& path) const = 0;
 		virtual size_t lengthFile(const std::string& path) const = 0;
 		virtual char* readFile(const std::string& path, size_t& fileSize) const = 0;
 		virtual bool readFile(const std::string& path, std::vector<char>& data) const = 0;
 		virtual bool readFile(const std::string& path, std::vector<std::byte>& data) const = 0;
+		virtual FileView readFileMapped(const std::string& path) const; // without copies where file system can map files
+		virtual FileView readEntryMapped(const uint32_t /*entry*/, const std::string& path) const { return readFileMapped(path); } // entry of getIndexedFiles, without search by path
 		virtual bool writeFile(const std::string& path, const void* data, const size_t sz, const char* mode = "wb") const = 0;
 
 		virtual std::string fullPath(const std::string& path) const = 0;
+		virtual std::string diskPath(const std::string& /*path*/) const { return {}; } // path for reads by os (AsyncFileReader), empty - file isn't on disk as is
 	private:
 		uint16_t _uniqueId = 0;
 	};
@@ -0,0 +1,79 @@
+#include "FileView.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace engine {
+
+	namespace {
+		// few released buffers are kept for next reads, large buffers are returned to os
+		class BufferPool {
+		public:
+			static constexpr size_t kMaxBuffers = 8u;
+			static constexpr size_t kMaxBufferSize = 16u * 1024u * 1024u;
+
+			struct Buffer {
+				std::unique_ptr<std::byte[]> data;
+				size_t capacity = 0u;
+			};
+
+			Buffer take(const size_t size) {
+				{
+					std::lock_guard<std::mutex> lock(_mutex);
+					// best fit from free buffers
+					auto best = _free.end();
+					for (auto it = _free.begin(); it != _free.end(); ++it) {
+						if (it->capacity >= size && (best == _free.end() || it->capacity < best->capacity)) {
+							best = it;
+						}
+					}
+
+					if (best != _free.end()) {
+						Buffer buffer = std::move(*best);
+						_free.erase(best);
+						return buffer;
+					}
+				}
+
+				return { std::make_unique_for_overwrite<std::byte[]>(size), size };
+			}
+
+			void give(Buffer&& buffer) {
+				if (buffer.capacity > kMaxBufferSize) return;
+
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (_free.size() == kMaxBuffers) { // keep larger ones
+					auto smallest = std::min_element(_free.begin(), _free.end(), [](const Buffer& a, const Buffer& b) { return a.capacity < b.capacity; });
+					if (smallest->capacity >= buffer.capacity) return;
+					_free.erase(smallest);
+				}
+				_free.push_back(std::move(buffer));
+			}
+
+		private:
+			std::mutex _mutex;
+			std::vector<Buffer> _free;
+		};
+
+		// views hold pool, so it outlives static destruction order
+		const std::shared_ptr<BufferPool>& bufferPool() {
+			static const std::shared_ptr<BufferPool> pool = std::make_shared<BufferPool>();
+			return pool;
+		}
+	}
+
+	FileView FileView::allocate(const size_t size, std::byte*& data) {
+		const std::shared_ptr<BufferPool>& pool = bufferPool();
+		auto* buffer = new BufferPool::Buffer(pool->take(size));
+		data = buffer->data.get();
+
+		std::shared_ptr<const void> owner(buffer, [pool](BufferPool::Buffer* b) {
+			pool->give(std::move(*b));
+			delete b;
+		});
+
+		return { std::move(owner), data, size };
+	}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace engine {
+
+	// read only view of file content, backed by memory mapping of file or by pooled buffer with file data
+	// views are cheap to copy and share content, content lives while any view of it exists
+	class FileView {
+	public:
+		FileView() = default;
+		FileView(std::shared_ptr<const void> owner, const std::byte* data, const size_t size) noexcept :
+			_owner(std::move(owner)), _data(data), _size(size) {}
+
+		// view of buffer taken from pool, buffer returns to pool with last view of it
+		// data must be filled before view is shared
+		static FileView allocate(const size_t size, std::byte*& data);
+
+		[[nodiscard]] inline const std::byte* data() const noexcept { return _data; }
+		[[nodiscard]] inline const char* chars() const noexcept { return reinterpret_cast<const char*>(_data); }
+		[[nodiscard]] inline size_t size() const noexcept { return _size; }
+		[[nodiscard]] inline bool empty() const noexcept { return _size == 0u; }
+		[[nodiscard]] inline explicit operator bool() const noexcept { return _data != nullptr; }
+
+		[[nodiscard]] inline const std::byte& operator[](const size_t i) const noexcept { return _data[i]; }
+		[[nodiscard]] inline std::span<const std::byte> span() const noexcept { return { _data, _size }; }
+		[[nodiscard]] inline std::string_view string() const noexcept { return { chars(), _size }; }
+
+		// part of content, keeps whole content alive
+		[[nodiscard]] inline FileView subview(const size_t offset, const size_t size) const noexcept {
+			return { _owner, _data + offset, size };
+		}
+
+	private:
+		std::shared_ptr<const void> _owner;
+		const std::byte* _data = nullptr;
+		size_t _size = 0u;
+	};
+
+}
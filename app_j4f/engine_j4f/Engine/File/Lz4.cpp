@@ -0,0 +1,185 @@
+#include "Lz4.h"
+
+#include <cstring>
+#include <memory>
+
+namespace engine::lz4 {
+
+	namespace {
+		constexpr size_t kMinMatch = 4u;
+		constexpr size_t kLastLiterals = 5u;	// last bytes of block are always literals
+		constexpr size_t kMatchFindLimit = 12u;	// last match starts before this count of bytes to block end
+		constexpr size_t kMaxOffset = 0xffffu;
+		constexpr uint32_t kHashLog = 14u;
+
+		inline uint32_t read32(const uint8_t* p) noexcept {
+			uint32_t v;
+			memcpy(&v, p, sizeof(uint32_t));
+			return v;
+		}
+
+		inline uint32_t hash(const uint32_t v) noexcept { return (v * 2654435761u) >> (32u - kHashLog); }
+
+		inline uint8_t* writeLength(uint8_t* op, size_t length) noexcept { // continuation of length over 15
+			while (length >= 255u) {
+				*op++ = 255u;
+				length -= 255u;
+			}
+			*op++ = static_cast<uint8_t>(length);
+			return op;
+		}
+
+		inline bool readLength(const uint8_t*& ip, const uint8_t* iend, size_t& length) noexcept {
+			uint8_t b;
+			do {
+				if (ip >= iend) return false;
+				b = *ip++;
+				length += b;
+			} while (b == 255u);
+			return true;
+		}
+
+		// literals [anchor, ip) and match (if matchLength != 0)
+		inline uint8_t* writeSequence(uint8_t* op, const uint8_t* oend, const uint8_t* anchor, const uint8_t* ip, const size_t offset, const size_t matchLength) noexcept {
+			const size_t literals = static_cast<size_t>(ip - anchor);
+			if (static_cast<size_t>(oend - op) < 1u + literals / 255u + 1u + literals + 2u + matchLength / 255u + 1u) {
+				return nullptr;
+			}
+
+			uint8_t* token = op++;
+			if (literals >= 15u) {
+				*token = 15u << 4u;
+				op = writeLength(op, literals - 15u);
+			} else {
+				*token = static_cast<uint8_t>(literals << 4u);
+			}
+
+			memcpy(op, anchor, literals);
+			op += literals;
+
+			if (matchLength == 0u) return op;
+
+			*op++ = static_cast<uint8_t>(offset);
+			*op++ = static_cast<uint8_t>(offset >> 8u);
+
+			const size_t length = matchLength - kMinMatch;
+			if (length >= 15u) {
+				*token |= 15u;
+				op = writeLength(op, length - 15u);
+			} else {
+				*token |= static_cast<uint8_t>(length);
+			}
+
+			return op;
+		}
+	}
+
+	size_t compress(const std::byte* src, const size_t srcSize, std::byte* dst, const size_t dstCapacity) noexcept {
+		const auto* const begin = reinterpret_cast<const uint8_t*>(src);
+		const uint8_t* const end = begin + srcSize;
+		auto* op = reinterpret_cast<uint8_t*>(dst);
+		const uint8_t* const oend = op + dstCapacity;
+
+		const uint8_t* anchor = begin;
+
+		if (srcSize > kMatchFindLimit) {
+			const uint8_t* const matchFindLimit = end - kMatchFindLimit;
+			const uint8_t* const matchLimit = end - kLastLiterals;
+
+			auto table = std::make_unique<uint32_t[]>(size_t(1u) << kHashLog); // positions + 1, 0 - empty
+			const uint8_t* ip = begin;
+
+			while (ip < matchFindLimit) {
+				const uint32_t sequence = read32(ip);
+				uint32_t& slot = table[hash(sequence)];
+				const uint8_t* candidate = slot ? begin + slot - 1u : nullptr;
+				slot = static_cast<uint32_t>(ip - begin) + 1u;
+
+				if (!candidate || static_cast<size_t>(ip - candidate) > kMaxOffset || read32(candidate) != sequence) {
+					ip += 1u + (static_cast<size_t>(ip - anchor) >> 6u); // skip faster over not compressible data
+					continue;
+				}
+
+				while (ip > anchor && candidate > begin && ip[-1] == candidate[-1]) { // extend match backwards
+					--ip;
+					--candidate;
+				}
+
+				const uint8_t* matchEnd = ip + kMinMatch;
+				const uint8_t* ref = candidate + kMinMatch;
+				while (matchEnd < matchLimit && *matchEnd == *ref) {
+					++matchEnd;
+					++ref;
+				}
+
+				op = writeSequence(op, oend, anchor, ip, static_cast<size_t>(ip - candidate), static_cast<size_t>(matchEnd - ip));
+				if (!op) return 0u;
+
+				ip = matchEnd;
+				anchor = ip;
+
+				if (ip - 2 > begin && ip < matchFindLimit) {
+					table[hash(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - begin) + 1u;
+				}
+			}
+		}
+
+		op = writeSequence(op, oend, anchor, end, 0u, 0u);
+		return op ? static_cast<size_t>(op - reinterpret_cast<uint8_t*>(dst)) : 0u;
+	}
+
+	bool decompress(const std::byte* src, const size_t srcSize, std::byte* dst, const size_t dstSize) noexcept {
+		const auto* ip = reinterpret_cast<const uint8_t*>(src);
+		const uint8_t* const iend = ip + srcSize;
+		auto* const obegin = reinterpret_cast<uint8_t*>(dst);
+		uint8_t* op = obegin;
+		uint8_t* const oend = op + dstSize;
+
+		while (ip < iend) {
+			const uint8_t token = *ip++;
+
+			size_t literals = token >> 4u;
+			if (literals == 15u && !readLength(ip, iend, literals)) return false;
+			if (literals > static_cast<size_t>(iend - ip) || literals > static_cast<size_t>(oend - op)) return false;
+
+			if (literals <= 16u && iend - ip >= 32 && oend - op >= 32) {
+				memcpy(op, ip, 16u); // fixed size copy, tail is overwritten by next sequence
+			} else {
+				memcpy(op, ip, literals);
+			}
+			op += literals;
+			ip += literals;
+
+			if (ip == iend) break; // last sequence has only literals
+
+			if (iend - ip < 2) return false;
+			const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8u);
+			ip += 2;
+			if (offset == 0u || offset > static_cast<size_t>(op - obegin)) return false;
+
+			size_t length = token & 15u;
+			if (length == 15u && !readLength(ip, iend, length)) return false;
+			length += kMinMatch;
+			if (length > static_cast<size_t>(oend - op)) return false;
+
+			const uint8_t* match = op - offset;
+			if (offset >= 8u && static_cast<size_t>(oend - op) >= length + 8u) {
+				uint8_t* const matchEnd = op + length;
+				for (; op < matchEnd; op += 8u, match += 8u) { // wild copy, may write up to 7 bytes after match
+					memcpy(op, match, 8u);
+				}
+				op = matchEnd;
+			} else if (offset >= length) {
+				memcpy(op, match, length);
+				op += length;
+			} else { // overlapped copy repeats pattern
+				for (const uint8_t* const matchEnd = op + length; op < matchEnd; ) {
+					*op++ = *match++;
+				}
+			}
+		}
+
+		return op == oend;
+	}
+
+}
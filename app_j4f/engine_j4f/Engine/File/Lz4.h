@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// lz4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), compatible with liblz4 blocks:
+// greedy single pass compressor for offline tools and fast bounds checked decompressor for runtime
+
+namespace engine::lz4 {
+
+	[[nodiscard]] inline constexpr size_t compressBound(const size_t size) noexcept { return size + size / 255u + 16u; }
+
+	// returns compressed size, 0 - dst capacity isn't enough
+	size_t compress(const std::byte* src, const size_t srcSize, std::byte* dst, const size_t dstCapacity) noexcept;
+
+	// dstSize is exact size of decompressed data, false - corrupted data
+	bool decompress(const std::byte* src, const size_t srcSize, std::byte* dst, const size_t dstSize) noexcept;
+
+}
@@ -0,0 +1,112 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef j4f_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine {
+
+	MappedFile::MappedFile(MappedFile&& f) noexcept : _data(std::exchange(f._data, nullptr)), _size(std::exchange(f._size, 0u))
+#ifdef j4f_PLATFORM_WINDOWS
+		, _file(std::exchange(f._file, nullptr)), _mapping(std::exchange(f._mapping, nullptr))
+#endif
+	{}
+
+	MappedFile& MappedFile::operator= (MappedFile&& f) noexcept {
+		if (this != &f) {
+			close();
+			_data = std::exchange(f._data, nullptr);
+			_size = std::exchange(f._size, 0u);
+#ifdef j4f_PLATFORM_WINDOWS
+			_file = std::exchange(f._file, nullptr);
+			_mapping = std::exchange(f._mapping, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+#ifdef j4f_PLATFORM_WINDOWS
+	bool MappedFile::open(const std::string& path) {
+		close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			CloseHandle(file);
+			return false;
+		}
+
+		const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		_file = file;
+		_mapping = mapping;
+		_data = static_cast<const std::byte*>(data);
+		_size = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::close() noexcept {
+		if (_data) {
+			UnmapViewOfFile(_data);
+			CloseHandle(_mapping);
+			CloseHandle(_file);
+		}
+
+		_data = nullptr;
+		_size = 0u;
+		_file = nullptr;
+		_mapping = nullptr;
+	}
+#else
+	bool MappedFile::open(const std::string& path) {
+		close();
+
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat s;
+		if (fstat(fd, &s) != 0 || s.st_size == 0) {
+			::close(fd);
+			return false;
+		}
+
+		void* data = mmap(nullptr, static_cast<size_t>(s.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd); // mapping keeps file
+		if (data == MAP_FAILED) return false;
+
+		_data = static_cast<const std::byte*>(data);
+		_size = static_cast<size_t>(s.st_size);
+		return true;
+	}
+
+	void MappedFile::close() noexcept {
+		if (_data) {
+			munmap(const_cast<std::byte*>(_data), _size);
+		}
+
+		_data = nullptr;
+		_size = 0u;
+	}
+#endif
+
+}
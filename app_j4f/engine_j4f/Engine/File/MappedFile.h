@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace engine {
+
+	// read only memory mapping of whole file, pages are loaded by os on access
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& path) { open(path); }
+		~MappedFile() { close(); }
+
+		MappedFile(MappedFile&& f) noexcept;
+		MappedFile& operator= (MappedFile&& f) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator= (const MappedFile&) = delete;
+
+		bool open(const std::string& path);
+		void close() noexcept;
+
+		[[nodiscard]] inline const std::byte* data() const noexcept { return _data; }
+		[[nodiscard]] inline size_t size() const noexcept { return _size; }
+		[[nodiscard]] inline explicit operator bool() const noexcept { return _data != nullptr; }
+
+	private:
+		const std::byte* _data = nullptr;
+		size_t _size = 0u;
+#ifdef j4f_PLATFORM_WINDOWS
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+#endif
+	};
+
+}
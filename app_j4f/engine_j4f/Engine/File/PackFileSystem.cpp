@@ -0,0 +1,240 @@
+#include "PackFileSystem.h"
+#include "Lz4.h"
+#include "../Log/Log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+namespace engine {
+
+	namespace {
+		struct PackedFile { // File handle of pack file system
+			const std::byte* data = nullptr;
+			size_t size = 0u;
+			size_t position = 0u;
+			std::vector<std::byte> unpacked; // for compressed entries
+		};
+	}
+
+	PackFileSystem::PackFileSystem(const std::string& packPath) {
+		if (!_file->open(packPath)) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "can't map pack file %s", packPath.c_str());
+			return;
+		}
+
+		const auto* header = reinterpret_cast<const pack::Header*>(_file->data());
+		const bool valid = _file->size() >= sizeof(pack::Header) &&
+			memcmp(header->magic, pack::kMagic, sizeof(pack::kMagic)) == 0 &&
+			header->version == pack::kVersion &&
+			header->fileSize == _file->size() &&
+			header->indexOffset % alignof(pack::Entry) == 0u &&
+			header->indexOffset <= _file->size() && header->entriesCount <= (_file->size() - header->indexOffset) / sizeof(pack::Entry) &&
+			header->pathsOffset <= _file->size() && header->pathsSize <= _file->size() - header->pathsOffset;
+
+		if (!valid) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "%s isn't a pack file or it's corrupted", packPath.c_str());
+			_file->close();
+			return;
+		}
+
+		_entries = { reinterpret_cast<const pack::Entry*>(_file->data() + header->indexOffset), header->entriesCount };
+		_paths = reinterpret_cast<const char*>(_file->data() + header->pathsOffset);
+
+		for (const pack::Entry& entry : _entries) {
+			if (entry.offset > _file->size() || entry.size > _file->size() - entry.offset ||
+				static_cast<uint64_t>(entry.pathOffset) + entry.pathLength > header->pathsSize ||
+				(entry.codec == pack::Codec::RAW && entry.size != entry.originalSize) || entry.codec > pack::Codec::LZ4) {
+				LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "pack file %s has corrupted entry", packPath.c_str());
+				_entries = {};
+				_paths = nullptr;
+				_file->close();
+				return;
+			}
+		}
+	}
+
+	std::string_view PackFileSystem::entryPath(const pack::Entry& entry) const noexcept {
+		return { _paths + entry.pathOffset, entry.pathLength };
+	}
+
+	const pack::Entry* PackFileSystem::find(const std::string_view path) const noexcept {
+		const uint64_t hash = pack::pathHash(path);
+		auto it = std::lower_bound(_entries.begin(), _entries.end(), std::make_tuple(hash, path), [this](const pack::Entry& entry, const auto& key) {
+			return std::make_tuple(entry.hash, entryPath(entry)) < key;
+		});
+
+		if (it != _entries.end() && it->hash == hash && entryPath(*it) == path) {
+			return &*it;
+		}
+
+		return nullptr;
+	}
+
+	bool PackFileSystem::unpack(const pack::Entry& entry, std::byte* dst) const {
+		const std::byte* src = _file->data() + entry.offset;
+
+		switch (entry.codec) {
+			case pack::Codec::RAW:
+				memcpy(dst, src, entry.size);
+				return true;
+			case pack::Codec::LZ4:
+				if (lz4::decompress(src, entry.size, dst, entry.originalSize)) return true;
+				break;
+		}
+
+		LOG_TAG_LEVEL(LogLevel::L_ERROR, FILES, "can't unpack %s", std::string(entryPath(entry)).c_str());
+		return false;
+	}
+
+	File* PackFileSystem::file_open(const char* path, const char* mode) const {
+		if (strchr(mode, 'w') || strchr(mode, 'a') || strchr(mode, '+')) return nullptr; // read only
+
+		const pack::Entry* entry = find(path);
+		if (!entry) return nullptr;
+
+		auto* f = new PackedFile();
+		f->size = entry->originalSize;
+
+		if (entry->codec == pack::Codec::RAW) {
+			f->data = _file->data() + entry->offset;
+		} else {
+			f->unpacked.resize(entry->originalSize);
+			if (!unpack(*entry, f->unpacked.data())) {
+				delete f;
+				return nullptr;
+			}
+			f->data = f->unpacked.data();
+		}
+
+		return reinterpret_cast<File*>(f);
+	}
+
+	void PackFileSystem::file_close(const File* f) const {
+		delete reinterpret_cast<const PackedFile*>(f);
+	}
+
+	int PackFileSystem::file_seek(File* f, uint64_t offset, const Seek_File seek) const {
+		auto* file = reinterpret_cast<PackedFile*>(f);
+
+		uint64_t position;
+		switch (seek) {
+			case Seek_File::SET:
+				position = offset;
+				break;
+			case Seek_File::CUR:
+				position = file->position + offset;
+				break;
+			case Seek_File::END:
+				position = file->size + offset;
+				break;
+			default:
+				return -1;
+		}
+
+		if (position > file->size) return -1;
+
+		file->position = static_cast<size_t>(position);
+		return 0;
+	}
+
+	size_t PackFileSystem::file_read(File* f, const size_t size, const size_t count, void* ptr) const {
+		if (size == 0u) return 0u;
+
+		auto* file = reinterpret_cast<PackedFile*>(f);
+		const size_t items = std::min(count, (file->size - file->position) / size);
+		memcpy(ptr, file->data + file->position, items * size);
+		file->position += items * size;
+		return items;
+	}
+
+	size_t PackFileSystem::file_write(File* f, const size_t size, const size_t count, const void* ptr) const {
+		return 0u;
+	}
+
+	uint64_t PackFileSystem::file_tell(File* f) const {
+		return reinterpret_cast<PackedFile*>(f)->position;
+	}
+
+	std::vector<std::string> PackFileSystem::getFiles() const {
+		std::vector<std::string> files;
+		files.reserve(_entries.size());
+		for (const pack::Entry& entry : _entries) {
+			files.emplace_back(entryPath(entry));
+		}
+		return files;
+	}
+
+	std::vector<FileSystem::IndexedFile> PackFileSystem::getIndexedFiles() const {
+		std::vector<IndexedFile> files;
+		files.reserve(_entries.size());
+		for (size_t i = 0u; i < _entries.size(); ++i) {
+			files.push_back({ std::string(entryPath(_entries[i])), static_cast<uint32_t>(i) });
+		}
+		return files;
+	}
+
+	bool PackFileSystem::hasFile(const std::string& path) const {
+		return find(path) != nullptr;
+	}
+
+	size_t PackFileSystem::lengthFile(const std::string& path) const {
+		const pack::Entry* entry = find(path);
+		return entry ? static_cast<size_t>(entry->originalSize) : 0u;
+	}
+
+	char* PackFileSystem::readFile(const std::string& path, size_t& fileSize) const {
+		const pack::Entry* entry = find(path);
+		fileSize = entry ? static_cast<size_t>(entry->originalSize) : 0u;
+		if (fileSize == 0u) return nullptr;
+
+		char* data = new char[fileSize + 1u];
+		if (!unpack(*entry, reinterpret_cast<std::byte*>(data))) {
+			delete[] data;
+			return nullptr;
+		}
+
+		data[fileSize] = '\0';
+		return data;
+	}
+
+	bool PackFileSystem::readFile(const std::string& path, std::vector<char>& data) const {
+		const pack::Entry* entry = find(path);
+		if (!entry || entry->originalSize == 0u) return false;
+		data.resize(entry->originalSize);
+		return unpack(*entry, reinterpret_cast<std::byte*>(data.data()));
+	}
+
+	bool PackFileSystem::readFile(const std::string& path, std::vector<std::byte>& data) const {
+		const pack::Entry* entry = find(path);
+		if (!entry || entry->originalSize == 0u) return false;
+		data.resize(entry->originalSize);
+		return unpack(*entry, data.data());
+	}
+
+	FileView PackFileSystem::readMapped(const pack::Entry& entry) const {
+		if (entry.originalSize == 0u) return {};
+
+		if (entry.codec == pack::Codec::RAW) {
+			return { _file, _file->data() + entry.offset, static_cast<size_t>(entry.size) };
+		}
+
+		std::byte* data;
+		FileView view = FileView::allocate(entry.originalSize, data);
+		return unpack(entry, data) ? view : FileView();
+	}
+
+	FileView PackFileSystem::readFileMapped(const std::string& path) const {
+		const pack::Entry* entry = find(path);
+		return entry ? readMapped(*entry) : FileView();
+	}
+
+	FileView PackFileSystem::readEntryMapped(const uint32_t entry, const std::string& path) const {
+		return entry < _entries.size() ? readMapped(_entries[entry]) : readFileMapped(path);
+	}
+
+	bool PackFileSystem::writeFile(const std::string& path, const void* data, const size_t sz, const char* mode) const {
+		return false; // read only, FileManager writes into next file system
+	}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "FileSystem.h"
+#include "MappedFile.h"
+#include "PackFormat.h"
+
+#include <memory>
+#include <span>
+#include <string_view>
+
+// read only file system over one mapped pack file (see PackFormat.h), paths are relative paths of packed files
+// use: fm.mapFileSystem(fm.createFileSystem<PackFileSystem>(fm.getFileSystem<DefaultFileSystem>()->fullPath("data.j4p")));
+// raw entries are copied straight from mapping (readFileMapped doesn't copy them), compressed entries are decompressed on read
+
+namespace engine {
+
+	class PackFileSystem : public FileSystem {
+	public:
+		explicit PackFileSystem(const std::string& packPath);
+
+		[[nodiscard]] inline bool isOpen() const noexcept { return static_cast<bool>(*_file); }
+
+		File* file_open(const char* path, const char* mode) const override;
+		void file_close(const File* f) const override;
+		int file_seek(File* f, uint64_t offset, const Seek_File seek) const override;
+		size_t file_read(File* f, const size_t size, const size_t count, void* ptr) const override;
+		size_t file_write(File* f, const size_t size, const size_t count, const void* ptr) const override;
+		uint64_t file_tell(File* f) const override;
+
+		//
+		std::vector<std::string> getFiles() const override;
+		std::vector<IndexedFile> getIndexedFiles() const override; // entry - index in pack index
+		bool hasFile(const std::string& path) const override;
+		size_t lengthFile(const std::string& path) const override;
+		char* readFile(const std::string& path, size_t& fileSize) const override;
+		bool readFile(const std::string& path, std::vector<char>& data) const override;
+		bool readFile(const std::string& path, std::vector<std::byte>& data) const override;
+		FileView readFileMapped(const std::string& path) const override;
+		FileView readEntryMapped(const uint32_t entry, const std::string& path) const override;
+		bool writeFile(const std::string& path, const void* data, const size_t sz, const char* mode = "wb") const override;
+
+		inline std::string fullPath(const std::string& path) const override { return path; } // packed files have no own paths
+
+	private:
+		[[nodiscard]] const pack::Entry* find(const std::string_view path) const noexcept;
+		[[nodiscard]] std::string_view entryPath(const pack::Entry& entry) const noexcept;
+		bool unpack(const pack::Entry& entry, std::byte* dst) const;
+		FileView readMapped(const pack::Entry& entry) const;
+
+		std::shared_ptr<MappedFile> _file = std::make_shared<MappedFile>(); // shared with views of raw entries
+		std::span<const pack::Entry> _entries;
+		const char* _paths = nullptr;
+	};
+
+}
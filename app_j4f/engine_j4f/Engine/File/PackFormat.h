@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// pack file (.j4p), written by Tools/packer:
+// header, entries data (every entry starts at kAlignment), index of entries sorted by (path hash, path) and paths
+// entry data is stored raw or compressed per file (already compressed formats are stored raw)
+// numbers are little endian
+
+namespace engine::pack {
+
+	inline constexpr char kMagic[4u] = { 'J', '4', 'F', 'P' };
+	inline constexpr uint16_t kVersion = 1u;
+	inline constexpr uint32_t kAlignment = 4096u;
+
+	enum class Codec : uint8_t {
+		RAW = 0u,
+		LZ4 = 1u
+	};
+
+	struct Header {
+		char magic[4u];
+		uint16_t version;
+		uint16_t reserved;
+		uint32_t entriesCount;
+		uint32_t pathsSize;
+		uint64_t indexOffset;	// Entry[entriesCount]
+		uint64_t pathsOffset;	// char[pathsSize], not null terminated
+		uint64_t fileSize;
+	};
+
+	struct Entry {
+		uint64_t hash;		// pathHash(path)
+		uint64_t offset;
+		uint64_t size;		// stored size
+		uint64_t originalSize;
+		uint32_t pathOffset;
+		uint16_t pathLength;
+		Codec codec;
+		uint8_t reserved;
+	};
+
+	static_assert(sizeof(Header) == 40u && sizeof(Entry) == 40u);
+
+	// fnv-1a, stable between platforms and runs
+	[[nodiscard]] inline constexpr uint64_t pathHash(const std::string_view path) noexcept {
+		uint64_t hash = 14695981039346656037ull;
+		for (const char c : path) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+}
@@ -0,0 +1,152 @@
+#include "PathIndex.h"
+#include "FileSystem.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace engine {
+
+	static_assert(std::endian::native == std::endian::little, "path words are loaded as little endian");
+
+	namespace {
+		constexpr uint64_t kBytes01 = 0x0101010101010101ull;
+		constexpr uint64_t kBytes7F = 0x7F7F7F7F7F7F7F7Full;
+		constexpr uint64_t kBytes80 = 0x8080808080808080ull;
+
+		// 8 path chars at once: 'A'-'Z' -> 'a'-'z', '\\' -> '/'
+		inline uint64_t normalize(const uint64_t w) noexcept {
+			const uint64_t low = w & kBytes7F;
+			const uint64_t upper = ((low + kBytes01 * (0x80u - 'A')) ^ (low + kBytes01 * (0x80u - 'Z' - 1u))) & ~w & kBytes80;
+			const uint64_t x = w ^ (kBytes01 * '\\');
+			const uint64_t slash = ~(((x & kBytes7F) + kBytes7F) | x) & kBytes80;
+			return (w | (upper >> 2u)) ^ ((slash - (slash >> 7u)) & (kBytes01 * ('\\' ^ '/')));
+		}
+
+		// chars [offset, offset + 8) of path, zeros after its end
+		inline uint64_t load(const char* data, const size_t offset, const size_t size) noexcept {
+			uint64_t w;
+			if (size - offset >= 8u) {
+				memcpy(&w, data + offset, 8u);
+			} else if (size >= 8u) { // last 8 chars of path, already loaded ones are shifted out
+				memcpy(&w, data + size - 8u, 8u);
+				w >>= (8u - (size - offset)) * 8u;
+			} else {
+				w = 0u;
+				for (size_t i = offset; i < size; ++i) {
+					w |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << ((i - offset) * 8u);
+				}
+			}
+			return w;
+		}
+
+		template <bool Normalize>
+		uint64_t hash(const std::string_view path) noexcept {
+			constexpr uint64_t k0 = 0x9E3779B97F4A7C15ull;
+			constexpr uint64_t k1 = 0xC2B2AE3D27D4EB4Full;
+
+			// words are mixed independently (by their positions), no long dependency chain of multiplications
+			uint64_t h = path.size() * k0;
+			for (size_t i = 0u; i < path.size(); i += 8u) {
+				uint64_t w = load(path.data(), i, path.size());
+				if constexpr (Normalize) { w = normalize(w); }
+				h += std::rotl((w ^ (i * k1)) * k0, 31);
+			}
+			h ^= h >> 32u;
+			h *= k1;
+			return h ^ (h >> 29u);
+		}
+	}
+
+	PathIndex::PathIndex(const PathIndex* base, const std::vector<const FileSystem*>& added) {
+		std::vector<std::vector<FileSystem::IndexedFile>> files;
+		files.reserve(added.size());
+
+		size_t count = base ? base->_entries.size() : 0u;
+		for (const FileSystem* fs : added) {
+			count += files.emplace_back(fs->getIndexedFiles()).size();
+		}
+
+		_entries.reserve(count);
+		_pathSlots.resize(std::bit_ceil(std::max<size_t>(count * 2u, 16u))); // load factor <= 0.5
+		_keySlots.resize(_pathSlots.size());
+		_mask = _pathSlots.size() - 1u;
+
+		if (base) {
+			_keys = base->_keys;
+			for (const Entry& entry : base->_entries) {
+				insert(Entry(entry));
+			}
+		}
+
+		for (size_t i = 0u; i < added.size(); ++i) {
+			for (FileSystem::IndexedFile& file : files[i]) {
+				const std::string_view path = file.path;
+
+				const size_t keyOffset = _keys.size();
+				for (size_t c = 0u; c < path.size(); c += 8u) {
+					const uint64_t w = normalize(load(path.data(), c, path.size()));
+					_keys.append(reinterpret_cast<const char*>(&w), std::min<size_t>(path.size() - c, 8u));
+				}
+
+				Entry entry = { added[i], {}, file.entry, hash<false>(path), hash<true>(path), static_cast<uint32_t>(keyOffset), static_cast<uint32_t>(path.size()) };
+				entry.path = std::move(file.path);
+				if (!insert(std::move(entry))) {
+					_keys.resize(keyOffset); // same path of earlier file system
+				}
+			}
+		}
+	}
+
+	bool PathIndex::insert(Entry&& entry) {
+		size_t pathSlot = entry.pathHash & _mask;
+		for (; _pathSlots[pathSlot] != 0u; pathSlot = (pathSlot + 1u) & _mask) {
+			const Entry& e = _entries[_pathSlots[pathSlot] - 1u];
+			if (e.pathHash == entry.pathHash && e.path == entry.path) {
+				return false;
+			}
+		}
+
+		// paths, which differ by case or separators only, are found as is, normalized key leads to the first of them
+		const std::string_view key(_keys.data() + entry.keyOffset, entry.keyLength);
+
+		size_t keySlot = entry.keyHash & _mask;
+		for (; _keySlots[keySlot] != 0u; keySlot = (keySlot + 1u) & _mask) {
+			const Entry& e = _entries[_keySlots[keySlot] - 1u];
+			if (e.keyHash == entry.keyHash && std::string_view(_keys.data() + e.keyOffset, e.keyLength) == key) {
+				break;
+			}
+		}
+
+		_entries.push_back(std::move(entry));
+		const auto id = static_cast<uint32_t>(_entries.size());
+		_pathSlots[pathSlot] = id;
+		if (_keySlots[keySlot] == 0u) {
+			_keySlots[keySlot] = id;
+		}
+		return true;
+	}
+
+	const PathIndex::Entry* PathIndex::find(const std::string_view path) const noexcept {
+		const uint64_t pathHash = hash<false>(path);
+		for (size_t slot = pathHash & _mask; _pathSlots[slot] != 0u; slot = (slot + 1u) & _mask) {
+			const Entry& e = _entries[_pathSlots[slot] - 1u];
+			if (e.pathHash == pathHash && e.path == path) return &e;
+		}
+
+		// case or separators differ from path in file system
+		const uint64_t keyHash = hash<true>(path);
+		for (size_t slot = keyHash & _mask; _keySlots[slot] != 0u; slot = (slot + 1u) & _mask) {
+			const Entry& e = _entries[_keySlots[slot] - 1u];
+			if (e.keyHash != keyHash || e.keyLength != path.size()) continue;
+
+			const char* key = _keys.data() + e.keyOffset;
+			size_t i = 0u;
+			while (i < path.size() && load(key, i, path.size()) == normalize(load(path.data(), i, path.size()))) { i += 8u; }
+			if (i >= path.size()) return &e;
+		}
+
+		return nullptr;
+	}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace engine {
+
+	class FileSystem;
+
+	// immutable index of mapped files: path -> file system and entry of file in it
+	// paths are found as is or normalized (lower case, '/' separators), normalized keys are interned in one buffer
+	// lookups don't allocate; new index is built on every change of mapped file systems
+	class PathIndex {
+	public:
+		struct Entry {
+			const FileSystem* fs;
+			std::string path;	// path in file system (its case)
+			uint32_t entry;		// id of file in file system (FileSystem::getIndexedFiles)
+			uint64_t pathHash;
+			uint64_t keyHash;
+			uint32_t keyOffset;
+			uint32_t keyLength;
+		};
+
+		// files of base index and files of added file systems, which aren't in it (file of earlier mapped file system wins),
+		// paths, which differ by case or separators only, are different files; normalized path finds the first of them
+		PathIndex(const PathIndex* base, const std::vector<const FileSystem*>& added);
+
+		[[nodiscard]] const Entry* find(const std::string_view path) const noexcept;
+
+		[[nodiscard]] inline size_t size() const noexcept { return _entries.size(); }
+
+	private:
+		// false - path is in index already
+		bool insert(Entry&& entry);
+
+		std::vector<Entry> _entries;
+		std::string _keys;
+		// open addressing, entry index + 1, 0 - empty slot
+		std::vector<uint32_t> _pathSlots;	// by hash of path as is, most lookups use paths of file systems
+		std::vector<uint32_t> _keySlots;	// by hash of normalized path
+		size_t _mask = 0u;
+	};
+
+}
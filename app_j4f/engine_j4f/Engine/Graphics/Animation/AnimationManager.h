@@ -3,6 +3,8 @@
 #include "../../Core/Common.h"
 #include "AnimationUpdater.h"
 #include "ActionAnimation.h"
+#include "TweenSystem.h"
+#include "../Mesh/SkeletonAnimationSystem.h"
 
 #include <vector>
 #include <memory>
@@ -17,46 +19,67 @@ namespace engine {
         ~AnimationManager() = default;
 
         template<typename T>
-        void registerAnimation(T *animation) noexcept {
-            static const auto animId = UniqueTypeId<Animation>::getUniqueId<T>();
-            if (_animUpdaters.size() <= animId) {
-                _animUpdaters.push_back(std::make_unique<AnimationUpdater<T>>());
-            }
-            static_cast<AnimationUpdater<T> *>(_animUpdaters[animId].get())->registerAnimation(animation);
+        AnimationHandle registerAnimation(T *animation) {
+            return getUpdater<T>().registerAnimation(animation);
         }
 
         template<typename T>
         void unregisterAnimation(T *animation) noexcept {
+            if (auto *updater = findUpdater<T>()) {
+                updater->unregisterAnimation(animation);
+            }
+        }
+
+        template<typename T>
+        void unregisterAnimation(const AnimationHandle handle) noexcept {
+            if (auto *updater = findUpdater<T>()) {
+                updater->unregisterAnimation(handle);
+            }
+        }
+
+        template<typename T>
+        [[nodiscard]] AnimationUpdater<T> &getUpdater() {
             static const auto animId = UniqueTypeId<Animation>::getUniqueId<T>();
-            if (_animUpdaters.size() > animId) {
-                static_cast<AnimationUpdater<T> *>(_animUpdaters[animId].get())->unregisterAnimation(animation);
+            if (_animUpdaters.size() <= animId) {
+                _animUpdaters.resize(animId + 1u);
             }
+
+            if (!_animUpdaters[animId]) {
+                _animUpdaters[animId] = std::make_unique<AnimationUpdater<T>>();
+            }
+
+            return *static_cast<AnimationUpdater<T> *>(_animUpdaters[animId].get());
         }
 
         template<typename T> requires AllowTarget<T>
         inline void addTarget(const T *animation, typename T::TargetType target) noexcept {
-            static const auto animId = UniqueTypeId<Animation>::getUniqueId<T>();
-            if (_animUpdaters.size() > animId) {
-                static_cast<AnimationUpdater<T> *>(_animUpdaters[animId].get())->addTarget(animation, target);
+            if (auto *updater = findUpdater<T>()) {
+                updater->addTarget(animation, target);
             }
         }
 
         template<typename T> requires AllowTarget<T>
         inline void removeTarget(const T *animation, typename T::TargetType target) noexcept {
-            static const auto animId = UniqueTypeId<Animation>::getUniqueId<T>();
-            if (_animUpdaters.size() > animId) {
-                static_cast<AnimationUpdater<T> *>(_animUpdaters[animId].get())->removeTarget(animation, target);
+            if (auto *updater = findUpdater<T>()) {
+                updater->removeTarget(animation, target);
             }
         }
 
+        [[nodiscard]] inline SkeletonAnimationSystem& getSkeletonAnimationSystem() noexcept { return _skeletonAnimationSystem; }
+        [[nodiscard]] inline TweenSystem& getTweenSystem() noexcept { return _tweenSystem; }
+
         inline void update(const float delta) noexcept { // virtual update mechanic
             if (delta == 0.0f) { // disable update if delta is 0.0f
                 return;
             }
 
             for (auto & updater : _animUpdaters) {
+                if (!updater) continue;
                 updater->update(delta);
+                _skeletonAnimationSystem.dispatch(); // before other updaters callbacks can destroy submitted skeletons
             }
+
+            _tweenSystem.update(delta);
         }
 
         template<typename T, typename... Args>
@@ -75,13 +98,21 @@ namespace engine {
 
         template<typename T>
         inline void update_strict(const float delta) noexcept {
-            static const auto animId = UniqueTypeId<Animation>::getUniqueId<T>();
-            if (_animUpdaters.size() > animId) {
-                static_cast<AnimationUpdater<T> *>(_animUpdaters[animId].get())->update(delta);
+            if (auto *updater = findUpdater<T>()) {
+                updater->update(delta);
+                _skeletonAnimationSystem.dispatch();
             }
         }
 
+        template<typename T>
+        [[nodiscard]] inline AnimationUpdater<T> *findUpdater() noexcept {
+            static const auto animId = UniqueTypeId<Animation>::getUniqueId<T>();
+            return _animUpdaters.size() > animId ? static_cast<AnimationUpdater<T> *>(_animUpdaters[animId].get()) : nullptr;
+        }
+
         std::vector<std::unique_ptr<IAnimationUpdater>> _animUpdaters;
+        SkeletonAnimationSystem _skeletonAnimationSystem;
+        TweenSystem _tweenSystem; // updated by update(delta), with explicit updaters order call getTweenSystem().update(delta)
     };
 
 }
\ No newline at end of file
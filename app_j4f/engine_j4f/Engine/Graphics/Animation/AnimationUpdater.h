@@ -1,7 +1,11 @@
 #pragma once
 
+#include "../../Core/SlotMap.h"
+#include "../../Core/Threads/ParallelFor.h"
+
 #include <algorithm>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -16,135 +20,199 @@ namespace engine {
         typename T::TargetType;
     };
 
-    template<typename T>
-    class AnimationUpdater final : public IAnimationUpdater {
+    using AnimationHandle = SlotMapHandle;
+
+    // registered animations are stored densely in slot map: register, unregister and lookup are O(1)
+    // animations, which are finished or unregistered during update, are removed (swap and pop) after update loop
+    template<typename T, typename Entry>
+    class AnimationRegistry : public IAnimationUpdater {
     public:
-        inline void registerAnimation(T *animation) noexcept {
-            if (std::find_if(_animations.begin(), _animations.end(),
-                             [animation](const std::pair<T *, float> &p) {
-                                 return p.first == animation;
-                             }) == _animations.end()) {
-                _animations.emplace_back(animation, 0.0f);
+        inline AnimationHandle registerAnimation(T *animation) {
+            if (const auto it = _handles.find(animation); it != _handles.end()) {
+                return it->second;
+            }
+
+            const AnimationHandle handle = _animations.emplace(animation);
+            _handles.emplace(animation, handle);
+            return handle;
+        }
+
+        inline void unregisterAnimation(const T *animation) {
+            if (const auto it = _handles.find(animation); it != _handles.end()) {
+                unregisterAnimation(it->second);
             }
         }
 
-        inline void unregisterAnimation(const T *animation) noexcept {
-            const auto it = std::find_if(_animations.cbegin(), _animations.cend(), [animation](const std::pair<T *, float> &p) {
-                return p.first == animation;
-            });
-            if (it != _animations.cend()) {
-                _animations.erase(std::remove(_animations.begin(), _animations.end(), *it), _animations.end());
+        inline void unregisterAnimation(const AnimationHandle handle) {
+            Entry *entry = _animations.get(handle);
+            if (entry == nullptr || entry->animation == nullptr) return;
+
+            _handles.erase(entry->animation);
+            if (_updating) {
+                entry->animation = nullptr;
+                _removed.push_back(handle);
+            } else {
+                _animations.erase(handle);
             }
         }
 
+        [[nodiscard]] inline bool contains(const AnimationHandle handle) const noexcept {
+            const Entry *entry = _animations.get(handle);
+            return entry && entry->animation;
+        }
+
+        [[nodiscard]] inline size_t size() const noexcept { return _handles.size(); }
+
+    protected:
+        inline Entry *find(const T *animation) noexcept {
+            const auto it = _handles.find(animation);
+            return it != _handles.end() ? _animations.get(it->second) : nullptr;
+        }
+
+        inline void finish(const size_t dense) {
+            Entry &entry = _animations[dense];
+            _handles.erase(entry.animation);
+            entry.animation = nullptr;
+            _removed.push_back(_animations.handle(dense));
+        }
+
+        inline void compact() {
+            for (const AnimationHandle handle : _removed) {
+                _animations.erase(handle);
+            }
+            _removed.clear();
+        }
+
+        SlotMap<Entry> _animations;
+        std::unordered_map<const T *, AnimationHandle> _handles;
+        std::vector<AnimationHandle> _removed;
+        bool _updating = false;
+    };
+
+    template<typename T>
+    struct AnimationEntry {
+        explicit AnimationEntry(T *a) noexcept : animation(a) {}
+
+        T *animation;
+        float accumulator = 0.0f;
+        bool finished = false;
+    };
+
+    template<typename T>
+    class AnimationUpdater final : public AnimationRegistry<T, AnimationEntry<T>> {
+    public:
+        // registries with at least threshold animations are updated with parallel_for on pool
+        // (animations must not touch shared state and must not (un)register animations in their updates)
+        inline void setParallel(ThreadPool2 *pool, const size_t threshold, const size_t grain = 256u) noexcept {
+            _pool = pool;
+            _parallelThreshold = threshold;
+            _parallelGrain = grain;
+        }
+
         inline void update(const float delta) noexcept override {
-            size_t i = 0;
-            std::vector<uint32_t> toRemove;
-            toRemove.reserve(_animations.size());
-            for (auto && [anim, accum]: _animations) {
-                if (anim->finished()) {
-                    toRemove.emplace_back(i);
-                    ++i;
-                    continue;
+            auto &animations = this->_animations;
+            const size_t count = animations.size();
+
+            this->_updating = true;
+
+            if (_pool && _parallelThreshold > 0u && count >= _parallelThreshold) {
+                parallel_for(*_pool, count, _parallelGrain, [this, delta](const size_t begin, const size_t end) {
+                    updateRange(delta, begin, end);
+                });
+            } else {
+                updateRange(delta, 0u, count);
+            }
+
+            for (size_t i = 0u; i < count; ++i) {
+                if (animations[i].animation && animations[i].finished) {
+                    this->finish(i);
                 }
+            }
+
+            this->compact();
+            this->_updating = false;
+        }
+
+    private:
+        inline void updateRange(const float delta, const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto &entry = this->_animations[i];
+                T *anim = entry.animation;
+                if (anim == nullptr) continue;
 
-                if (!anim->isActive()) {
-                    ++i;
+                if (anim->finished()) {
+                    entry.finished = true;
                     continue;
                 }
 
+                if (!anim->isActive()) continue;
+
                 if (anim->forceUpdate()) {
-                    anim->updateAnimation(delta + accum);
-                    accum = 0.0f;
+                    anim->updateAnimation(delta + entry.accumulator);
+                    this->_animations[i].accumulator = 0.0f; // entry can be moved, if animation has been registered in update
                 } else {
-                    accum += delta;
+                    entry.accumulator += delta;
                 }
-                ++i;
-            }
-
-            for (auto n : toRemove) {
-                _animations.erase(_animations.begin() + n);
             }
         }
 
-    private:
-        std::vector<std::pair<T *, float>> _animations;
+        ThreadPool2 *_pool = nullptr;
+        size_t _parallelThreshold = 0u;
+        size_t _parallelGrain = 256u;
     };
 
     /////////////////////////////////////////////////////////////////////////////////
     template<AllowTarget T>
-    class AnimationUpdater<T> final : public IAnimationUpdater {
-    public:
-        inline void registerAnimation(T *animation) noexcept {
-            if (std::find_if(_animations.begin(), _animations.end(),
-                             [animation](const std::pair<T *, float> &p) {
-                                 return p.first == animation;
-                             }) == _animations.end()) {
-                _animations.emplace_back(animation, 0.0f);
-                _animationsTargets.emplace_back();
-            }
-        }
+    struct AnimationTargetsEntry {
+        explicit AnimationTargetsEntry(T *a) noexcept : animation(a) {}
 
-        inline void unregisterAnimation(const T *animation) noexcept {
-            auto it = std::find_if(_animations.begin(), _animations.end(), [animation](const std::pair<T *, float> &p) {
-                return p.first == animation;
-            });
-            if (it != _animations.end()) {
-                const auto i = std::distance(_animations.begin(), it);
-//                _animationsTargets.erase(
-//                        std::remove(_animationsTargets.begin(), _animationsTargets.end(), _animationsTargets[i]),
-//                        _animationsTargets.end());
-                _animationsTargets.erase(_animationsTargets.begin() + i);
-                //std::swap(*it, _animations.back());
-                //_animations.pop_back();
-                _animations.erase(std::remove(_animations.begin(), _animations.end(), *it), _animations.end());
-            }
-        }
+        T *animation;
+        float accumulator = 0.0f;
+        std::vector<typename T::TargetType> targets;
+    };
 
+    template<AllowTarget T>
+    class AnimationUpdater<T> final : public AnimationRegistry<T, AnimationTargetsEntry<T>> {
+    public:
         inline void addTarget(const T *animation, typename T::TargetType target) noexcept {
-            auto it = std::find_if(_animations.begin(), _animations.end(), [animation](const std::pair<T *, float> &p) {
-                return p.first == animation;
-            });
-            if (it != _animations.end()) {
-                const auto i = std::distance(_animations.begin(), it);
-                _animationsTargets[i].push_back(target);
+            if (auto *entry = this->find(animation)) {
+                entry->targets.push_back(target);
             }
         }
 
         inline void removeTarget(const T *animation, typename T::TargetType target) noexcept {
-            auto it = std::find_if(_animations.begin(), _animations.end(), [animation](const std::pair<T *, float> &p) {
-                return p.first == animation;
-            });
-            if (it != _animations.end()) {
-                const auto i = std::distance(_animations.begin(), it);
-                _animationsTargets[i].erase(
-                        std::remove(_animationsTargets[i].begin(), _animationsTargets[i].end(), target),
-                        _animationsTargets[i].end());
+            if (auto *entry = this->find(animation)) {
+                auto &targets = entry->targets;
+                if (const auto it = std::find(targets.begin(), targets.end(), target); it != targets.end()) {
+                    *it = targets.back();
+                    targets.pop_back();
+                }
             }
         }
 
         inline void update(const float delta) noexcept override {
-            size_t i = 0u;
-            std::vector<uint32_t> toRemove;
-            toRemove.reserve(_animations.size());
-            for (auto && [anim, accum]: _animations) {
+            auto &animations = this->_animations;
+            const size_t count = animations.size();
+
+            this->_updating = true;
+
+            for (size_t i = 0u; i < count; ++i) {
+                T *anim = animations[i].animation;
+                if (anim == nullptr) continue;
+
                 if (anim->finished()) {
-                    toRemove.emplace_back(i);
-                    ++i;
+                    this->finish(i);
                     continue;
                 }
 
-                if (!anim->isActive()) {
-                    ++i;
-                    continue;
-                }
+                if (!anim->isActive()) continue;
 
                 bool requestUpdate = false;
-                for (auto&& target : _animationsTargets[i]) {
+                for (auto &&target : animations[i].targets) {
                     if (target->requestAnimUpdate()) {
                         if (!requestUpdate) {
-                            anim->updateAnimation(delta + accum);
-                            accum = 0.0f;
+                            anim->updateAnimation(delta + animations[i].accumulator);
+                            animations[i].accumulator = 0.0f;
                             requestUpdate = true;
                         }
 
@@ -155,24 +223,16 @@ namespace engine {
 
                 if (!requestUpdate) {
                     if (anim->forceUpdate()) {
-                        anim->updateAnimation(delta + accum);
-                        accum = 0.0f;
+                        anim->updateAnimation(delta + animations[i].accumulator);
+                        animations[i].accumulator = 0.0f;
                     } else {
-                        accum += delta;
+                        animations[i].accumulator += delta;
                     }
                 }
-
-                ++i;
             }
 
-            for (auto n : toRemove) {
-                _animationsTargets.erase(_animationsTargets.begin() + n);
-                _animations.erase(_animations.begin() + n);
-            }
+            this->compact();
+            this->_updating = false;
         }
-
-    private:
-        std::vector<std::pair<T *, float>> _animations;
-        std::vector<std::vector<typename T::TargetType>> _animationsTargets;
     };
 }
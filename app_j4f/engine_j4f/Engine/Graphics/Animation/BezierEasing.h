@@ -6,6 +6,7 @@
 // source code - https://github.com/gre/bezier-easing/blob/master/src/index.js
 ////////////////////////////////////////////////////////////////////////////
 
+#include <array>
 #include <cstdint>
 #include <cmath>
 #include <functional>
@@ -103,4 +104,45 @@ namespace engine::easing {
         };
         return func;
     }
+
+    // the same curve with samples table in place (no allocations, copyable), for batched easing of tweens
+    struct CubicBezierEasing {
+        CubicBezierEasing() = default;
+        CubicBezierEasing(const float x1_, const float y1_, const float x2_, const float y2_) noexcept : x1(x1_), y1(y1_), x2(x2_), y2(y2_) {
+            for (uint8_t i = 0u; i < kSplineTableSize; ++i) {
+                samples[i] = calcBezier(static_cast<float>(i) * kSampleStepSize, x1, x2);
+            }
+        }
+
+        [[nodiscard]] inline float operator()(const float x) const noexcept {
+            if (x1 == y1 && x2 == y2) {
+                return x; // linear
+            }
+
+            float intervalStart = 0.0f;
+            uint8_t currentSample = 1u;
+            for (; currentSample != kSplineTableSize - 1u && samples[currentSample] <= x; ++currentSample) {
+                intervalStart += kSampleStepSize;
+            }
+            --currentSample;
+
+            const float dist = (x - samples[currentSample]) / (samples[currentSample + 1u] - samples[currentSample]);
+            const float guessForT = intervalStart + dist * kSampleStepSize;
+
+            float t;
+            const float initialSlope = getSlope(guessForT, x1, x2);
+            if (initialSlope >= 0.001f) {
+                t = newtonRaphsonIterate(x, guessForT, x1, x2);
+            } else if (initialSlope == 0.0f) {
+                t = guessForT;
+            } else {
+                t = binarySubdivide(x, intervalStart, intervalStart + kSampleStepSize, x1, x2);
+            }
+
+            return calcBezier(t, y1, y2);
+        }
+
+        float x1 = 0.0f, y1 = 0.0f, x2 = 1.0f, y2 = 1.0f;
+        std::array<float, kSplineTableSize> samples = {};
+    };
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include "../../Core/Math/mathematic.h"
 #include "BezierEasing.h"
@@ -290,4 +291,100 @@ namespace engine::easing {
         }
         return 0.0f;
     }
+
+    // batch version: one dispatch for all values, per easing loop is inlined (and vectorized for polynomial easings)
+    inline void calculateProgress(float* values, const size_t count, const Easing e) noexcept {
+        const auto apply = [values, count](auto&& f) noexcept {
+            for (size_t i = 0u; i < count; ++i) {
+                values[i] = f(values[i]);
+            }
+        };
+
+        switch (e) {
+            case Easing::Linear:
+                return;
+            case Easing::QuadIn:
+                return apply([](const float t) noexcept { return easeInQuad(t); });
+            case Easing::QuadOut:
+                return apply([](const float t) noexcept { return easeOutQuad(t); });
+            case Easing::QuadInOut:
+                return apply([](const float t) noexcept { return easeInOutQuad(t); });
+            case Easing::QuadOutIn:
+                return apply([](const float t) noexcept { return easeOutInQuad(t); });
+            case Easing::CubicIn:
+                return apply([](const float t) noexcept { return easeInCubic(t); });
+            case Easing::CubicOut:
+                return apply([](const float t) noexcept { return easeOutCubic(t); });
+            case Easing::CubicInOut:
+                return apply([](const float t) noexcept { return easeInOutCubic(t); });
+            case Easing::CubicOutIn:
+                return apply([](const float t) noexcept { return easeOutInCubic(t); });
+            case Easing::QuartIn:
+                return apply([](const float t) noexcept { return easeInQuart(t); });
+            case Easing::QuartOut:
+                return apply([](const float t) noexcept { return easeOutQuart(t); });
+            case Easing::QuartInOut:
+                return apply([](const float t) noexcept { return easeInOutQuart(t); });
+            case Easing::QuartOutIn:
+                return apply([](const float t) noexcept { return easeOutInQuart(t); });
+            case Easing::QuintIn:
+                return apply([](const float t) noexcept { return easeInQuint(t); });
+            case Easing::QuintOut:
+                return apply([](const float t) noexcept { return easeOutQuint(t); });
+            case Easing::QuintInOut:
+                return apply([](const float t) noexcept { return easeInOutQuint(t); });
+            case Easing::QuintOutIn:
+                return apply([](const float t) noexcept { return easeOutInQuint(t); });
+            case Easing::SineIn:
+                return apply([](const float t) noexcept { return easeInSine(t); });
+            case Easing::SineOut:
+                return apply([](const float t) noexcept { return easeOutSine(t); });
+            case Easing::SineInOut:
+                return apply([](const float t) noexcept { return easeInOutSine(t); });
+            case Easing::SineOutIn:
+                return apply([](const float t) noexcept { return easeOutInSine(t); });
+            case Easing::ExpIn:
+                return apply([](const float t) noexcept { return easeInExpo(t); });
+            case Easing::ExpOut:
+                return apply([](const float t) noexcept { return easeOutExpo(t); });
+            case Easing::ExpInOut:
+                return apply([](const float t) noexcept { return easeInOutExpo(t); });
+            case Easing::ExpOutIn:
+                return apply([](const float t) noexcept { return easeOutInExpo(t); });
+            case Easing::CircIn:
+                return apply([](const float t) noexcept { return easeInCirc(t); });
+            case Easing::CircOut:
+                return apply([](const float t) noexcept { return easeOutCirc(t); });
+            case Easing::CircInOut:
+                return apply([](const float t) noexcept { return easeInOutCirc(t); });
+            case Easing::CircOutIn:
+                return apply([](const float t) noexcept { return easeOutInCirc(t); });
+            case Easing::ElasticIn:
+                return apply([](const float t) noexcept { return easeInElastic(t); });
+            case Easing::ElasticOut:
+                return apply([](const float t) noexcept { return easeOutElastic(t); });
+            case Easing::ElasticInOut:
+                return apply([](const float t) noexcept { return easeInOutElastic(t); });
+            case Easing::ElasticOutIn:
+                return apply([](const float t) noexcept { return easeOutInElastic(t); });
+            case Easing::BackIn:
+                return apply([](const float t) noexcept { return easeInBack(t); });
+            case Easing::BackOut:
+                return apply([](const float t) noexcept { return easeOutBack(t); });
+            case Easing::BackInOut:
+                return apply([](const float t) noexcept { return easeInOutBack(t); });
+            case Easing::BackOutIn:
+                return apply([](const float t) noexcept { return easeOutInBack(t); });
+            case Easing::BounceIn:
+                return apply([](const float t) noexcept { return easeInBounce(t); });
+            case Easing::BounceOut:
+                return apply([](const float t) noexcept { return easeOutBounce(t); });
+            case Easing::BounceInOut:
+                return apply([](const float t) noexcept { return easeInOutBounce(t); });
+            case Easing::BounceOutIn:
+                return apply([](const float t) noexcept { return easeOutInBounce(t); });
+            default:
+                return;
+        }
+    }
 }
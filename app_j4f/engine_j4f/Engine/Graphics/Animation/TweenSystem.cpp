@@ -0,0 +1,78 @@
+#include "TweenSystem.h"
+
+#include <array>
+
+namespace engine {
+
+    size_t TweenSystem::size() const noexcept {
+        size_t result = 0u;
+        for (const auto& pool : _pools) {
+            if (pool) {
+                result += pool->size();
+            }
+        }
+        return result;
+    }
+
+    void TweenSystem::update(const float dt) {
+        for (auto& pool : _pools) {
+            if (pool) {
+                pool->update(dt, *this);
+            }
+        }
+
+        if (_completed.empty()) return;
+
+        std::vector<std::function<void()>> completed;
+        completed.swap(_completed);
+        for (auto& callback : completed) {
+            callback();
+        }
+
+        if (_completed.empty()) { // keep capacity
+            completed.clear();
+            _completed.swap(completed);
+        }
+    }
+
+    void TweenSystem::ease(float* values, const uint8_t* easings, const uint16_t* curves, const size_t count) {
+        constexpr size_t kCustom = static_cast<size_t>(easing::Easing::Custom);
+
+        // counting sort by easing id, then one batch per easing
+        std::array<uint32_t, kCustom + 2u> offsets = {};
+        for (size_t i = 0u; i < count; ++i) {
+            ++offsets[std::min(static_cast<size_t>(easings[i]), kCustom) + 1u];
+        }
+
+        if (offsets[static_cast<size_t>(easing::Easing::Linear) + 1u] == count) return;
+
+        for (size_t b = 1u; b < offsets.size(); ++b) {
+            offsets[b] += offsets[b - 1u];
+        }
+
+        _order.resize(count);
+        _sorted.resize(count);
+
+        auto cursor = offsets;
+        for (size_t i = 0u; i < count; ++i) {
+            const uint32_t k = cursor[std::min(static_cast<size_t>(easings[i]), kCustom)]++;
+            _order[k] = static_cast<uint32_t>(i);
+            _sorted[k] = values[i];
+        }
+
+        for (size_t b = 1u; b < kCustom; ++b) { // linear bucket is unchanged
+            easing::calculateProgress(&_sorted[offsets[b]], offsets[b + 1u] - offsets[b], static_cast<easing::Easing>(b));
+        }
+
+        for (uint32_t k = offsets[kCustom]; k < offsets[kCustom + 1u]; ++k) {
+            const uint16_t curve = curves[_order[k]];
+            if (curve < _curves.size()) {
+                _sorted[k] = _curves[curve](_sorted[k]);
+            }
+        }
+
+        for (size_t k = 0u; k < count; ++k) {
+            values[_order[k]] = _sorted[k];
+        }
+    }
+}
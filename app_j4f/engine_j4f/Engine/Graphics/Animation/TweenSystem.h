@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Easings.h"
+#include "../../Core/Common.h"
+#include "../../Core/SlotMap.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace engine {
+
+    struct TweenHandle {
+        SlotMapHandle handle;
+        uint16_t pool = 0xffffu;
+
+        [[nodiscard]] inline bool valid() const noexcept { return pool != 0xffffu; }
+    };
+
+    class TweenSystem;
+
+    class ITweenPool {
+    public:
+        virtual ~ITweenPool() = default;
+        virtual void update(const float dt, TweenSystem& system) = 0;
+        virtual bool cancel(const SlotMapHandle handle) = 0;
+        [[nodiscard]] virtual bool contains(const SlotMapHandle handle) const noexcept = 0;
+        [[nodiscard]] virtual size_t size() const noexcept = 0;
+    };
+
+    // tweens of one value type (float, vec2f, vec3f, vec4f...: T must support from + (to - from) * progress)
+    // cold data (target, values, callback) is in slot map, hot columns for progress pass are stored separately in the same dense order
+    template<typename T>
+    class TweenPool final : public ITweenPool {
+    public:
+        SlotMapHandle add(T* target, const T& from, const T& to, const float duration, const uint8_t easing, const uint16_t curve, std::function<void()>&& onComplete) {
+            const SlotMapHandle handle = _tweens.emplace(Tween{ target, from, to, std::move(onComplete) });
+            _elapsed.push_back(0.0f);
+            _duration.push_back(std::max(duration, 1e-6f));
+            _easing.push_back(easing);
+            _curve.push_back(curve);
+            *target = from;
+            return handle;
+        }
+
+        void update(const float dt, TweenSystem& system) override;
+
+        bool cancel(const SlotMapHandle handle) override {
+            if (!_tweens.contains(handle)) return false;
+            erase(_tweens.index(handle));
+            return true;
+        }
+
+        [[nodiscard]] bool contains(const SlotMapHandle handle) const noexcept override { return _tweens.contains(handle); }
+        [[nodiscard]] size_t size() const noexcept override { return _tweens.size(); }
+
+    private:
+        struct Tween {
+            T* target;
+            T from;
+            T to;
+            std::function<void()> onComplete;
+        };
+
+        inline void erase(const size_t index) {
+            _tweens.erase(_tweens.handle(index)); // swap and pop, columns are moved the same way
+            _elapsed[index] = _elapsed.back();
+            _duration[index] = _duration.back();
+            _easing[index] = _easing.back();
+            _curve[index] = _curve.back();
+
+            _elapsed.pop_back();
+            _duration.pop_back();
+            _easing.pop_back();
+            _curve.pop_back();
+        }
+
+        SlotMap<Tween> _tweens;
+        std::vector<float> _elapsed;
+        std::vector<float> _duration;
+        std::vector<uint8_t> _easing;
+        std::vector<uint16_t> _curve;	// bezier curve id for easing::Easing::Custom
+        std::vector<float> _progress;
+    };
+
+    // pooled tweens without per tween allocations and indirect calls:
+    // progress of all tweens is calculated in one pass per value type, easings are evaluated grouped by easing id,
+    // completion callbacks are called after all pools are updated (callbacks can add and cancel tweens)
+    class TweenSystem {
+        template<typename T> friend class TweenPool;
+    public:
+        template<typename T>
+        TweenHandle tween(T* target, const T& from, const T& to, const float duration,
+                          const easing::Easing e = easing::Easing::Linear, std::function<void()> onComplete = nullptr) {
+            const uint16_t poolId = UniqueTypeId<TweenSystem>::getUniqueId<T>();
+            return { getPool<T>(poolId).add(target, from, to, duration, static_cast<uint8_t>(e), 0xffffu, std::move(onComplete)), poolId };
+        }
+
+        // curve - id of addCurve result
+        template<typename T>
+        TweenHandle tween(T* target, const T& from, const T& to, const float duration,
+                          const uint16_t curve, std::function<void()> onComplete = nullptr) {
+            const uint16_t poolId = UniqueTypeId<TweenSystem>::getUniqueId<T>();
+            return { getPool<T>(poolId).add(target, from, to, duration, static_cast<uint8_t>(easing::Easing::Custom), curve, std::move(onComplete)), poolId };
+        }
+
+        // cubic bezier easing with control points (x1, y1), (x2, y2), as css transition timing function
+        uint16_t addCurve(const float x1, const float y1, const float x2, const float y2) {
+            _curves.emplace_back(x1, y1, x2, y2);
+            return static_cast<uint16_t>(_curves.size() - 1u);
+        }
+
+        // target keeps current value, callback is not called
+        bool cancel(const TweenHandle handle) {
+            return handle.pool < _pools.size() && _pools[handle.pool] && _pools[handle.pool]->cancel(handle.handle);
+        }
+
+        [[nodiscard]] bool active(const TweenHandle handle) const noexcept {
+            return handle.pool < _pools.size() && _pools[handle.pool] && _pools[handle.pool]->contains(handle.handle);
+        }
+
+        [[nodiscard]] size_t size() const noexcept;
+
+        void update(const float dt);
+
+    private:
+        template<typename T>
+        TweenPool<T>& getPool(const uint16_t poolId) {
+            if (_pools.size() <= poolId) {
+                _pools.resize(poolId + 1u);
+            }
+
+            if (!_pools[poolId]) {
+                _pools[poolId] = std::make_unique<TweenPool<T>>();
+            }
+
+            return *static_cast<TweenPool<T>*>(_pools[poolId].get());
+        }
+
+        // values: linear progress [0.0f, 1.0f] -> eased progress
+        void ease(float* values, const uint8_t* easings, const uint16_t* curves, const size_t count);
+
+        std::vector<std::unique_ptr<ITweenPool>> _pools;
+        std::vector<easing::CubicBezierEasing> _curves;
+        std::vector<std::function<void()>> _completed;
+
+        std::vector<uint32_t> _order;	// ease scratch buffers
+        std::vector<float> _sorted;
+    };
+
+    template<typename T>
+    void TweenPool<T>::update(const float dt, TweenSystem& system) {
+        const size_t count = _tweens.size();
+        if (count == 0u) return;
+
+        _progress.resize(count);
+        float* progress = _progress.data();
+        float* elapsed = _elapsed.data();
+        const float* duration = _duration.data();
+
+        for (size_t i = 0u; i < count; ++i) {
+            elapsed[i] += dt;
+            progress[i] = std::min(elapsed[i] / duration[i], 1.0f);
+        }
+
+        system.ease(progress, _easing.data(), _curve.data(), count);
+
+        for (size_t i = 0u; i < count; ++i) {
+            const Tween& tween = _tweens[i];
+            *tween.target = tween.from + (tween.to - tween.from) * progress[i];
+        }
+
+        for (size_t i = count; i > 0u; --i) { // backward: erase moves only already checked tweens
+            const size_t index = i - 1u;
+            if (_elapsed[index] >= _duration[index]) {
+                Tween& tween = _tweens[index];
+                *tween.target = tween.to;
+                if (tween.onComplete) {
+                    system._completed.push_back(std::move(tween.onComplete));
+                }
+                erase(index);
+            }
+        }
+    }
+}
@@ -1,9 +1,12 @@
 #include "Graphics.h"
 
 #include "../Core/AssetManager.h"
+#include "../Core/AssetBundle.h"
 #include "Texture/TextureLoader.h"
 #include "Texture/TexturePtrLoader.h"
 #include "Mesh/MeshLoader.h"
+#include "Mesh/AnimationClipLoader.h"
+#include "Mesh/Mesh.h"
 #include "Text/FontLoader.h"
 
 #include "../Core/Engine.h"
@@ -14,11 +17,116 @@
 #include "Features/Shadows/CascadeShadowMap.h"
 #include "Animation/AnimationManager.h"
 #include "Texture/TextureCache.h"
+#include "Texture/TextureHandler.h"
 
 #include <cstdint>
+#include <memory>
 
 namespace engine {
 
+    namespace {
+        // bundle entries of graphics assets, gpu data of meshes and textures goes through renderer upload manager
+        void setBundleEntryLoaders() {
+            const uint8_t renderThreadId = Engine::getInstance().getThreadCommutationId(Engine::Workers::RENDER_THREAD);
+
+            // params: { "vertices": bytes, "indices": bytes }
+            AssetBundleLoader::setEntryLoader("mesh_buffer", [](const AssetBundleEntry& entry, AssetBundle&, AssetBundleEntryDone&& done) {
+                auto buffer = std::make_shared<MeshGraphicsDataBuffer>(entry.params.value("vertices", size_t(0u)), entry.params.value("indices", size_t(0u)));
+                done(std::move(buffer), true);
+            });
+
+            // params: { "buffer": mesh_buffer entry, "semanticMask", "quantizationMask", "latency" }
+            AssetBundleLoader::setEntryLoader("mesh", [renderThreadId](const AssetBundleEntry& entry, AssetBundle& bundle, AssetBundleEntryDone&& done) {
+                const auto* buffer = bundle.get<std::shared_ptr<MeshGraphicsDataBuffer>>(entry.params.value("buffer", ""));
+                if (entry.files.empty() || buffer == nullptr) {
+                    done({}, false);
+                    return;
+                }
+
+                MeshLoadingParams params;
+                params.file = entry.files.front();
+                params.semanticMask = entry.params.value("semanticMask", uint16_t(0u));
+                params.quantizationMask = entry.params.value("quantizationMask", uint8_t(0u));
+                params.latency = entry.params.value("latency", uint8_t(1u));
+                params.graphicsBuffer = buffer->get();
+                params.flags->async = 0; // entry is already on loader pool
+                params.callbackThreadId = renderThreadId;
+
+                Engine::getInstance().getModule<AssetManager>().loadAsset<Mesh*>(params, [done = std::move(done)](std::unique_ptr<Mesh>&& mesh, const AssetLoadingResult result) {
+                    done(std::shared_ptr<Mesh>(std::move(mesh)), result == AssetLoadingResult::LOADING_SUCCESS);
+                });
+            });
+
+            // params: { "mipmaps": bool, "cache": bool }
+            AssetBundleLoader::setEntryLoader("texture", [renderThreadId](const AssetBundleEntry& entry, AssetBundle&, AssetBundleEntryDone&& done) {
+                TexturePtrLoadingParams params;
+                params.files = entry.files;
+                params.flags->async = 1; // texture, which is created in other bundle, is completed with callback of async loading only
+                params.flags->use_cache = entry.params.value("cache", true) ? 1 : 0;
+                params.textureFlags->deffered = 1;
+                params.textureFlags->useMipMaps = entry.params.value("mipmaps", true) ? 1 : 0;
+                params.callbackThreadId = renderThreadId;
+
+                Engine::getInstance().getModule<AssetManager>().loadAsset<TexturePtr>(params, [done = std::move(done)](const TexturePtr& texture, const AssetLoadingResult result) {
+                    done(texture, result == AssetLoadingResult::LOADING_SUCCESS);
+                });
+            });
+
+            AssetBundleLoader::setEntryLoader("font", [](const AssetBundleEntry& entry, AssetBundle&, AssetBundleEntryDone&& done) {
+                if (entry.files.empty()) {
+                    done({}, false);
+                    return;
+                }
+
+                Font* font = Engine::getInstance().getModule<AssetManager>().loadAsset<Font*>(FontLoadingParams(entry.files.front()));
+                done(font, font != nullptr);
+            });
+
+            // stages are chosen by file extension
+            AssetBundleLoader::setEntryLoader("program", [](const AssetBundleEntry& entry, AssetBundle&, AssetBundleEntryDone&& done) {
+                std::vector<ProgramStageInfo> stages;
+                stages.reserve(entry.files.size());
+                for (const std::string& file : entry.files) {
+                    if (file.ends_with(".vsh")) {
+                        stages.emplace_back(ProgramStage::VERTEX, file);
+                    } else if (file.ends_with(".psh")) {
+                        stages.emplace_back(ProgramStage::FRAGMENT, file);
+                    } else if (file.ends_with(".gsh")) {
+                        stages.emplace_back(ProgramStage::GEOMETRY, file);
+                    } else if (file.ends_with(".csh")) {
+                        stages.emplace_back(ProgramStage::COMPUTE, file);
+                    } else {
+                        done({}, false);
+                        return;
+                    }
+                }
+
+                GpuProgram* program = stages.empty() ? nullptr : Engine::getInstance().getModule<Graphics>().getGpuProgramsManager()->getProgram(stages);
+                done(program, program != nullptr);
+            });
+
+            // params: { "skeleton": mesh entry }
+            AssetBundleLoader::setEntryLoader("animation", [renderThreadId](const AssetBundleEntry& entry, AssetBundle& bundle, AssetBundleEntryDone&& done) {
+                if (entry.files.empty()) {
+                    done({}, false);
+                    return;
+                }
+
+                AnimationClipLoadingParams params;
+                params.file = entry.files.front();
+                params.flags->async = 0;
+                params.callbackThreadId = renderThreadId;
+                if (const auto* mesh = bundle.get<std::shared_ptr<Mesh>>(entry.params.value("skeleton", ""))) {
+                    params.skeleton = (*mesh)->getMeshData();
+                }
+
+                Engine::getInstance().getModule<AssetManager>().loadAsset<AnimationClip*>(params, [done = std::move(done)](AnimationClip* clip, const AssetLoadingResult result) {
+                    done(clip, result == AssetLoadingResult::LOADING_SUCCESS);
+                });
+            });
+        }
+    }
+
     Graphics::Graphics(const GraphicConfig &cfg) :
             _config(cfg),
             _renderer(new Renderer()),
@@ -83,9 +191,11 @@ namespace engine {
 
     void Graphics::createLoaders() {
         // create texture cache
+        auto textureCache = std::make_unique<TextureCache>();
+        textureCache->setBudget(_config.texture_cache_budget);
         Engine::getInstance().getModule<CacheManager>()
                 .emplaceCache<TextureCache::value_type, TextureCache::key_type>(
-                        std::make_unique<TextureCache>()
+                        std::move(textureCache)
                                 );
 
         auto && assetManager = Engine::getInstance().getModule<AssetManager>();
@@ -93,7 +203,10 @@ namespace engine {
         assetManager.setLoader<TexturePtrLoader>();
         assetManager.setLoader<TextureLoader>();
         assetManager.setLoader<MeshLoader>();
+        assetManager.setLoader<AnimationClipLoader>();
         assetManager.setLoader<FontLoader>();
+
+        setBundleEntryLoaders();
     }
 
     void Graphics::createRenderHelper() {
@@ -0,0 +1,97 @@
+#include "AnimationBaker.h"
+#include "Mesh.h"
+#include "MeshData.h"
+
+#include <cmath>
+
+namespace engine {
+
+	namespace {
+		inline void packMatrix(const mat4f& m, vec4f* out) noexcept { // glm matrices are column major
+			out[0u] = vec4f(m[0u][0u], m[1u][0u], m[2u][0u], m[3u][0u]);
+			out[1u] = vec4f(m[0u][1u], m[1u][1u], m[2u][1u], m[3u][1u]);
+			out[2u] = vec4f(m[0u][2u], m[1u][2u], m[2u][2u], m[3u][2u]);
+		}
+
+		inline void packDualQuaternion(const mat4f& m, vec4f* out) noexcept {
+			const glm::mat3 rotation(glm::normalize(vec3f(m[0u])), glm::normalize(vec3f(m[1u])), glm::normalize(vec3f(m[2u])));
+			const quatf q = glm::normalize(glm::quat_cast(rotation));
+			const quatf t(0.0f, m[3u][0u], m[3u][1u], m[3u][2u]);
+			const quatf d = (t * q) * 0.5f;
+
+			out[0u] = vec4f(q.x, q.y, q.z, q.w);
+			out[1u] = vec4f(d.x, d.y, d.z, d.w);
+		}
+	}
+
+	uint32_t BakedAnimation::frame(const uint32_t clip, const float time, const bool loop) const noexcept {
+		const Clip& c = clips[clip];
+		if (c.framesCount < 2u) return c.firstFrame;
+
+		const auto f = static_cast<uint32_t>(std::max(time, 0.0f) * sampleRate + 0.5f);
+		return c.firstFrame + (loop ? f % (c.framesCount - 1u) : std::min(f, c.framesCount - 1u));
+	}
+
+	mat4f BakedAnimation::jointMatrix(const uint32_t frame, const uint32_t joint) const noexcept {
+		const vec4f* t = &texels[(static_cast<size_t>(frame) * jointsCount + joint) * texelsPerJoint()];
+
+		if (format == Format::Matrix3x4) {
+			mat4f m(1.0f);
+			for (uint8_t c = 0u; c < 4u; ++c) {
+				m[c] = vec4f(t[0u][c], t[1u][c], t[2u][c], c == 3u ? 1.0f : 0.0f);
+			}
+			return m;
+		}
+
+		const quatf q(t[0u].w, t[0u].x, t[0u].y, t[0u].z);
+		const quatf d(t[1u].w, t[1u].x, t[1u].y, t[1u].z);
+		const quatf translation = (d * 2.0f) * glm::conjugate(q);
+
+		mat4f m = glm::mat4_cast(q);
+		m[3u] = vec4f(translation.x, translation.y, translation.z, 1.0f);
+		return m;
+	}
+
+	BakedAnimation bakeAnimations(Mesh_Data* meshData, const std::vector<const Mesh_Animation*>& clips, const uint16_t skinId,
+								  const float sampleRate, const BakedAnimation::Format format) {
+		BakedAnimation result;
+		result.format = format;
+		result.sampleRate = sampleRate;
+
+		if (skinId >= meshData->skins.size()) return result;
+
+		result.jointsCount = static_cast<uint32_t>(meshData->skins[skinId].joints.size());
+		result.clips.reserve(clips.size());
+
+		const uint8_t texelsPerJoint = result.texelsPerJoint();
+		const CancellationToken token;
+
+		for (const Mesh_Animation* animation : clips) {
+			MeshSkeleton skeleton(meshData, 1u); // from bind pose, nodes not animated by clip mustn't keep previous clip transforms
+			BakedAnimation::Clip& clip = result.clips.emplace_back();
+			clip.firstFrame = result.height();
+			clip.duration = animation->duration;
+			clip.framesCount = static_cast<uint32_t>(std::ceil(animation->duration * sampleRate)) + 1u;
+
+			result.texels.resize(result.texels.size() + static_cast<size_t>(clip.framesCount) * result.width());
+
+			for (uint32_t f = 0u; f < clip.framesCount; ++f) {
+				const float time = animation->start + std::min(static_cast<float>(f) / sampleRate, animation->duration);
+				updateSkeletonAnimation(token, &skeleton, time, animation, 0u);
+
+				const std::vector<mat4f>& palette = skeleton.getSkinMatrices(0u, skinId);
+				vec4f* row = &result.texels[static_cast<size_t>(clip.firstFrame + f) * result.width()];
+
+				for (uint32_t j = 0u; j < result.jointsCount; ++j) {
+					if (format == BakedAnimation::Format::Matrix3x4) {
+						packMatrix(palette[j], &row[j * texelsPerJoint]);
+					} else {
+						packDualQuaternion(palette[j], &row[j * texelsPerJoint]);
+					}
+				}
+			}
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../../Core/Math/mathematic.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace engine {
+
+	struct Mesh_Data;
+	struct Mesh_Animation;
+
+	// skin palettes of mesh clips sampled with fixed rate, for gpu side animation of instanced crowds
+	// layout: row per frame, row is jointsCount * texelsPerJoint() vec4f texels (RGBA32F texture or std430 vec4 array in storage buffer)
+	struct BakedAnimation {
+		enum class Format : uint8_t {
+			Matrix3x4 = 0u,			// 3 texels: rows of affine joint matrix
+			DualQuaternion = 1u		// 2 texels: real and dual parts (rigid joints, scale is ignored)
+		};
+
+		struct Clip {
+			uint32_t firstFrame = 0u;
+			uint32_t framesCount = 0u;	// first and last frames of clip are both stored
+			float duration = 0.0f;
+		};
+
+		// limits of one instanced draw, sizes of arrays in mesh_skin_instance_baked.vsh (BAKED_MAX_INSTANCES, BAKED_MAX_CLIPS)
+		static constexpr uint32_t maxInstances = 100u;
+		static constexpr uint32_t maxClips = 16u;
+
+		Format format = Format::Matrix3x4;
+		float sampleRate = 30.0f;
+		uint32_t jointsCount = 0u;
+		std::vector<Clip> clips;
+		std::vector<vec4f> texels;
+
+		[[nodiscard]] inline uint8_t texelsPerJoint() const noexcept { return format == Format::Matrix3x4 ? 3u : 2u; }
+		[[nodiscard]] inline uint32_t width() const noexcept { return jointsCount * texelsPerJoint(); }
+		[[nodiscard]] inline uint32_t height() const noexcept { return static_cast<uint32_t>(texels.size() / std::max(width(), 1u)); }
+
+		// frame row for clip time, the same calculation does vertex shader with per instance (clip, timeOffset)
+		[[nodiscard]] uint32_t frame(const uint32_t clip, const float time, const bool loop = true) const noexcept;
+
+		// joint matrix restored from packed data
+		[[nodiscard]] mat4f jointMatrix(const uint32_t frame, const uint32_t joint) const noexcept;
+	};
+
+	struct BakedAnimationInstance { // per instance data
+		uint32_t clip = 0u;
+		float timeOffset = 0.0f;
+	};
+
+	// evaluates clips through MeshSkeleton of meshData (on cpu, no gpu resources are used)
+	BakedAnimation bakeAnimations(Mesh_Data* meshData, const std::vector<const Mesh_Animation*>& clips, const uint16_t skinId = 0u,
+								  const float sampleRate = 30.0f, const BakedAnimation::Format format = BakedAnimation::Format::Matrix3x4);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "MeshData.h"
+
+#include <string>
+#include <vector>
+
+namespace engine {
+
+	// animations of file without geometry (AnimationClipLoader), shared through cache for every skeleton they are loaded for
+	struct AnimationClip {
+		std::vector<Mesh_Animation> animations; // channels target nodes of skeleton, channels of nodes skeleton has not are dropped
+		std::vector<std::string> nodeNames;		// nodes of file
+	};
+
+}
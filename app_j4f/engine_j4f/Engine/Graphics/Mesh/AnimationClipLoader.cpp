@@ -0,0 +1,225 @@
+#include "AnimationClipLoader.h"
+#include "AnimationCompression.h"
+#include "Loader_gltf.h"
+#include "Loader_j4m.h"
+#include "../../Core/Engine.h"
+#include "../../Core/Cache.h"
+#include "../../Core/Hash.h"
+#include "../../Core/Threads/WorkersCommutator.h"
+#include "../../Core/Threads/Synchronisations.h"
+#include "../../File/FileManager.h"
+#include "../../Utils/StringHelper.h"
+#include "../../Utils/Debug/Profiler.h"
+
+#include <string_view>
+
+namespace engine {
+
+	void AnimationClipLoader::executeCallbacks(AnimationClip* clip, const AssetLoadingResult result) {
+		std::vector<DataLoadingCallback> callbacks;
+		{
+			AtomicLock lock(_callbacksLock);
+			auto it = _callbacks.find(clip);
+			if (it != _callbacks.end()) {
+				callbacks = std::move(it->second);
+				_callbacks.erase(it);
+			}
+		}
+
+		auto&& threadCommutator = Engine::getInstance().getModule<WorkerThreadsCommutator>();
+		for (auto&& c : callbacks) {
+			threadCommutator.enqueue(c.targetThreadId, [callback = std::move(c.callback), clip, result]() {
+				callback(clip, result);
+			});
+		}
+	}
+
+	bool AnimationClipLoader::fillClip(AnimationClip* clip, const AnimationClipLoadingParams& params, const SkeletonNodes& skeletonNodes, const FileView& file) {
+		PROFILE_TIME_SCOPED_M(animationClipLoading, params.file)
+
+		if (params.file.ends_with(".j4m")) {
+			const FileView bytes = file ? file : Engine::getInstance().getModule<FileManager>().readFileMapped(params.file);
+			j4m::View view;
+			std::vector<uint16_t> sceneNodes;
+			std::vector<gltf::Node> nodes;
+			std::vector<CompressedAnimation> compressed;
+
+			if (!bytes || !view.open(bytes.data(), bytes.size()) ||
+				!view.readNodes(sceneNodes, nodes) || !view.readAnimations(compressed)) {
+				LOG_TAG_LEVEL(LogLevel::L_ERROR, ANIMATION, "can't load j4m file %s", params.file.c_str());
+				return false;
+			}
+
+			clip->nodeNames.reserve(nodes.size());
+			for (gltf::Node& node : nodes) {
+				clip->nodeNames.push_back(std::move(node.name));
+			}
+
+			clip->animations.reserve(compressed.size());
+			for (const CompressedAnimation& animation : compressed) {
+				clip->animations.push_back(decompressAnimation(animation));
+			}
+		} else {
+			const gltf::Layout layout = gltf::Parser::loadAnimations(params.file);
+
+			clip->nodeNames.reserve(layout.nodes.size());
+			for (const gltf::Node& node : layout.nodes) {
+				clip->nodeNames.push_back(node.name);
+			}
+
+			loadMeshAnimations(layout, clip->animations);
+		}
+
+		if (skeletonNodes) {
+			remapClip(clip, *skeletonNodes);
+		}
+
+		if (clip->animations.empty()) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, ANIMATION, "no animations are loaded from %s", params.file.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	void AnimationClipLoader::remapClip(AnimationClip* clip, const std::vector<std::string>& names) {
+		std::unordered_map<std::string_view, uint16_t> skeletonNodes;
+		skeletonNodes.reserve(names.size());
+		for (size_t i = 0u; i < names.size(); ++i) {
+			skeletonNodes.emplace(names[i], static_cast<uint16_t>(i)); // first node with the name is used
+		}
+
+		std::erase_if(clip->animations, [clip, &skeletonNodes](Mesh_Animation& animation) {
+			auto& channels = animation.channels;
+			size_t count = 0u;
+
+			animation.minTargetNodeId = 0xffffu;
+			animation.maxTargetNodeId = 0u;
+
+			for (Mesh_Animation::AnimationChannel channel : channels) {
+				if (channel.target_node >= clip->nodeNames.size()) continue;
+
+				auto it = skeletonNodes.find(clip->nodeNames[channel.target_node]);
+				if (it == skeletonNodes.end()) continue;
+
+				channel.target_node = it->second;
+				animation.minTargetNodeId = std::min(animation.minTargetNodeId, channel.target_node);
+				animation.maxTargetNodeId = std::max(animation.maxTargetNodeId, channel.target_node);
+				channels[count++] = channel;
+			}
+
+			channels.resize(count);
+
+			if (channels.empty()) {
+				LOG_TAG_LEVEL(LogLevel::L_ERROR, ANIMATION, "animation %s: no nodes of skeleton are animated, animation is dropped", animation.name.c_str());
+				return true;
+			}
+
+			return false;
+		});
+	}
+
+	void AnimationClipLoader::finishLoading(AnimationClip* clip, const std::string& key, const bool loaded) {
+		if (!loaded) { // failed clip leaves cache and next request loads it again, clip stays alive for receivers of error
+			auto&& cache = Engine::getInstance().getModule<CacheManager>().getCache<std::string, AnimationClip*>();
+			if (cache->extractIf(key, [clip](AnimationClip* const& v) { return v == clip; })) {
+				AtomicLock lock(_callbacksLock);
+				_failedClips[key].emplace_back(clip);
+			}
+		} else { // clip is loaded again, earlier failed attempts aren't needed
+			AtomicLock lock(_callbacksLock);
+			_failedClips.erase(key);
+		}
+
+		executeCallbacks(clip, loaded ? AssetLoadingResult::LOADING_SUCCESS : AssetLoadingResult::LOADING_ERROR);
+	}
+
+	std::string AnimationClipLoader::requestKey(const AnimationClipLoadingParams& params) {
+		if (params.skeleton == nullptr) {
+			return params.file;
+		}
+
+		// channels are remapped by node names only, so skeletons with the same names share clip
+		size_t skeletonId = params.skeleton->nodes.size();
+		for (const gltf::Node& node : params.skeleton->nodes) {
+			hash_combine(skeletonId, node.name);
+		}
+
+		return fmtString("{}@{:x}", params.file, skeletonId);
+	}
+
+	void AnimationClipLoader::loadAsset(AnimationClip*& v, const AnimationClipLoadingParams& params, const AnimationClipLoadingCallback& callback) {
+		auto&& engine = Engine::getInstance();
+		auto&& cache = engine.getModule<CacheManager>().getCache<std::string, AnimationClip*>();
+
+		const std::string key = requestKey(params);
+
+		bool created = false;
+		v = cache->getValue(key);
+		if (v == nullptr) {
+			v = cache->getOrSetValue(key, [&created](const AnimationClipLoadingCallback& callback, const uint8_t threadId) {
+				auto* clip = new AnimationClip();
+				{
+					AtomicLock lock(_callbacksLock);
+					auto& callbacks = _callbacks[clip]; // clip is in loading while it has entry
+					if (callback) {
+						callbacks.push_back({ callback, threadId });
+					}
+				}
+				created = true;
+				return clip;
+			}, callback, params.callbackThreadId);
+		}
+
+		if (!created) {
+			{
+				AtomicLock lock(_callbacksLock);
+				if (auto it = _callbacks.find(v); it != _callbacks.end()) {
+					if (callback) {
+						it->second.push_back({ callback, params.callbackThreadId });
+					}
+					return;
+				}
+			}
+
+			if (callback) {
+				const AssetLoadingResult result = v->animations.empty() ? AssetLoadingResult::LOADING_ERROR : AssetLoadingResult::LOADING_SUCCESS;
+				engine.getModule<WorkerThreadsCommutator>().enqueue(params.callbackThreadId, [callback, clip = v, result]() {
+					callback(clip, result);
+				});
+			}
+			return;
+		}
+
+		SkeletonNodes skeletonNodes; // copied now, loading jobs don't touch params.skeleton
+		if (params.skeleton) {
+			auto names = std::make_shared<std::vector<std::string>>();
+			names->reserve(params.skeleton->nodes.size());
+			for (const gltf::Node& node : params.skeleton->nodes) {
+				names->push_back(node.name);
+			}
+			skeletonNodes = std::move(names);
+		}
+
+		if (params.flags->async) {
+			auto&& assetManager = engine.getModule<AssetManager>();
+			if (params.file.ends_with(".j4m")) { // single file, loader thread starts when it is read
+				assetManager.enqueueLoadingWithFiles(params, { params.file }, [params, key, skeletonNodes, v](const CancellationToken&, const std::vector<FileView>& files) {
+					finishLoading(v, key, fillClip(v, params, skeletonNodes, files[0]));
+				});
+			} else {
+				assetManager.enqueueLoading(params, [key, skeletonNodes](const CancellationToken& token, const AnimationClipLoadingParams params, AnimationClip* clip) {
+					finishLoading(clip, key, fillClip(clip, params, skeletonNodes));
+				}, params, v);
+			}
+		} else {
+			finishLoading(v, key, fillClip(v, params, skeletonNodes));
+		}
+	}
+
+	void AnimationClipLoader::cleanUp() noexcept {
+		AtomicLock lock(_callbacksLock);
+		_callbacks.clear();
+		_failedClips.clear();
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "AnimationClip.h"
+#include "../../Core/AssetManager.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace engine {
+
+	template<>
+	struct AssetLoadingParams<AnimationClip> : public AssetLoadingFlags {
+		std::string file;
+		// channels are remapped to skeleton nodes with the same names, nullptr - nodes of file are used;
+		// names are copied by loadAsset, so skeleton may be released while clip is loading
+		const Mesh_Data* skeleton = nullptr;
+		uint8_t callbackThreadId = 0u;
+	};
+
+	using AnimationClipLoadingParams = AssetLoadingParams<AnimationClip>;
+	using AnimationClipLoadingCallback = AssetLoadingCallback<AnimationClip*>;
+
+	// .gltf / .glb: only nodes names, accessors, buffer views and animations are parsed, .j4m: only nodes and animations sections are read
+	class AnimationClipLoader {
+	public:
+		using asset_type = AnimationClip*;
+		static void loadAsset(AnimationClip*& v, const AnimationClipLoadingParams& params, const AnimationClipLoadingCallback& callback);
+		static void cleanUp() noexcept;
+		static std::string requestKey(const AnimationClipLoadingParams& params); // one clip for pair of file and skeleton nodes names
+	private:
+		struct DataLoadingCallback {
+			AnimationClipLoadingCallback callback;
+			uint8_t targetThreadId = 0u;
+		};
+
+		using SkeletonNodes = std::shared_ptr<const std::vector<std::string>>; // names of params.skeleton nodes, nullptr - no remap
+
+		static void executeCallbacks(AnimationClip*, const AssetLoadingResult);
+		static void finishLoading(AnimationClip*, const std::string& key, const bool loaded);
+
+		// file - already read content of params.file (empty - file is read here)
+		static bool fillClip(AnimationClip*, const AnimationClipLoadingParams&, const SkeletonNodes& skeletonNodes, const FileView& file = {});
+		static void remapClip(AnimationClip*, const std::vector<std::string>& skeletonNodes);
+
+		inline static std::atomic_bool _callbacksLock;
+		inline static std::unordered_map<AnimationClip*, std::vector<DataLoadingCallback>> _callbacks; // clips in loading
+		// evicted from cache by request key, under _callbacksLock; failed clip stays alive until the same clip is loaded successfully
+		inline static std::unordered_map<std::string, std::vector<std::unique_ptr<AnimationClip>>> _failedClips;
+	};
+}
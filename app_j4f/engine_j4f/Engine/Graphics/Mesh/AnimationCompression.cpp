@@ -0,0 +1,341 @@
+#include "AnimationCompression.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace engine {
+
+	namespace {
+		constexpr float kSqrt2 = 1.41421356237f;
+		constexpr float kQuat15 = 32766.0f; // even, so 0.0f is restored exactly
+		constexpr float kRange16 = 65535.0f;
+
+		// rotations are stored in sampler outputs as vec4f(x, y, z, w)
+		inline quatf toQuat(const vec4f& v) noexcept { return quatf(v.w, v.x, v.y, v.z); }
+		inline vec4f fromQuat(const quatf& q) noexcept { return vec4f(q.x, q.y, q.z, q.w); }
+
+		inline vec4f interpolate(const Mesh_Animation::AnimationChannelPath path, const vec4f& v0, const vec4f& v1, const float t) noexcept {
+			if (path == Mesh_Animation::AnimationChannelPath::ROTATION) {
+				return fromQuat(glm::normalize(glm::slerp(toQuat(v0), toQuat(v1), t)));
+			}
+			return glm::mix(v0, v1, t);
+		}
+
+		inline float difference(const Mesh_Animation::AnimationChannelPath path, const vec4f& v0, const vec4f& v1) noexcept {
+			if (path == Mesh_Animation::AnimationChannelPath::ROTATION) { // angle between rotations
+				const float lengths = std::sqrt(glm::dot(v0, v0) * glm::dot(v1, v1));
+				const float d = lengths > 0.0f ? std::min(std::abs(glm::dot(v0, v1)) / lengths, 1.0f) : 1.0f;
+				return 2.0f * std::acos(d);
+			}
+			return glm::length(vec3f(v0) - vec3f(v1));
+		}
+
+		inline void packQuat(vec4f q, uint16_t* out) noexcept {
+			q /= std::sqrt(glm::dot(q, q)); // without simd normalize approximation
+
+			uint8_t largest = 0u;
+			for (uint8_t i = 1u; i < 4u; ++i) {
+				if (std::abs(q[i]) > std::abs(q[largest])) { largest = i; }
+			}
+
+			if (q[largest] < 0.0f) { q = -q; }
+
+			uint16_t packed[3u];
+			for (uint8_t i = 0u, j = 0u; i < 4u; ++i) {
+				if (i == largest) continue;
+				const float v = std::clamp(q[i] * kSqrt2 * 0.5f + 0.5f, 0.0f, 1.0f); // [-1/sqrt(2), 1/sqrt(2)] -> [0, 1]
+				packed[j++] = static_cast<uint16_t>(std::lround(v * kQuat15));
+			}
+
+			out[0u] = static_cast<uint16_t>(packed[0u] | ((largest >> 1u) << 15u));
+			out[1u] = static_cast<uint16_t>(packed[1u] | ((largest & 1u) << 15u));
+			out[2u] = packed[2u];
+		}
+
+		inline vec4f unpackQuat(const uint16_t* in) noexcept {
+			const uint8_t largest = static_cast<uint8_t>(((in[0u] >> 15u) << 1u) | (in[1u] >> 15u));
+			const float a = (static_cast<float>(in[0u] & 0x7fffu) / kQuat15 - 0.5f) * kSqrt2;
+			const float b = (static_cast<float>(in[1u] & 0x7fffu) / kQuat15 - 0.5f) * kSqrt2;
+			const float c = (static_cast<float>(in[2u] & 0x7fffu) / kQuat15 - 0.5f) * kSqrt2;
+			const float d = std::sqrt(std::max(0.0f, 1.0f - a * a - b * b - c * c));
+
+			switch (largest) {
+				case 0u: return vec4f(d, a, b, c);
+				case 1u: return vec4f(a, d, b, c);
+				case 2u: return vec4f(a, b, d, c);
+				default: return vec4f(a, b, c, d);
+			}
+		}
+
+		inline float tolerance(const Mesh_Animation::AnimationChannelPath path, const AnimationCompressionParams& params) noexcept {
+			switch (path) {
+				case Mesh_Animation::AnimationChannelPath::ROTATION:
+					return params.rotationTolerance;
+				case Mesh_Animation::AnimationChannelPath::SCALE:
+					return params.scaleTolerance;
+				default:
+					return params.translationTolerance;
+			}
+		}
+
+		// source sampling without cursors, for reference values
+		inline bool sampleSource(const Mesh_Animation::AnimationSampler& sampler, const Mesh_Animation::AnimationChannelPath path, const float time, vec4f& result) noexcept {
+			uint32_t key = 0u;
+			if (!sampler.keyFrame(time, key)) return false;
+
+			if (sampler.interpolation == Mesh_Animation::Interpolation::STEP) {
+				result = sampler.outputs[key];
+			} else {
+				const float t0 = sampler.inputs[key];
+				const float t1 = sampler.inputs[key + 1u];
+				result = interpolate(path, sampler.outputs[key], sampler.outputs[key + 1u], t1 > t0 ? (time - t0) / (t1 - t0) : 0.0f);
+			}
+			return true;
+		}
+	}
+
+	vec4f CompressedAnimation::decodeKey(const Track& track, const uint32_t key) const noexcept {
+		const uint16_t* v = &values[key * 3u];
+		if (track.path == Mesh_Animation::AnimationChannelPath::ROTATION) {
+			return unpackQuat(v);
+		}
+		return vec4f(track.rangeMin + vec3f(v[0u], v[1u], v[2u]) * track.rangeScale, 0.0f);
+	}
+
+	bool CompressedAnimation::sample(const Track& track, const float time, uint32_t& cursor, vec4f& result) const noexcept {
+		if (track.keysCount == 1u) {
+			result = track.constant;
+			return true;
+		}
+
+		const uint16_t* keys = &times[track.firstKey];
+		const uint32_t keysCount = track.keysCount;
+		const float firstTime = keys[0u];
+		const float lastTime = keys[keysCount - 1u];
+
+		// key times are rounded to quantization steps, so time at track bounds (clip duration too) can be up to half step out of them
+		float qt = duration > 0.0f ? (time - start) * (kTimeQuantization / duration) : 0.0f;
+		if (qt < firstTime - 0.5f || qt > lastTime + 0.5f) return false;
+		qt = std::clamp(qt, firstTime, lastTime);
+
+		bool found = false;
+		if (cursor < keysCount - 1u && static_cast<float>(keys[cursor]) <= qt) {
+			for (uint8_t step = 0u; step < Mesh_Animation::AnimationSampler::kCursorMaxSteps; ++step) {
+				if (qt <= static_cast<float>(keys[cursor + 1u])) { found = true; break; }
+				if (++cursor == keysCount - 1u) break;
+			}
+		}
+
+		if (!found) {
+			const auto it = std::upper_bound(keys, keys + keysCount, qt, [](const float t, const uint16_t k) { return t < static_cast<float>(k); });
+			cursor = static_cast<uint32_t>(std::min<ptrdiff_t>(std::max<ptrdiff_t>((it - keys) - 1, 0), keysCount - 2u));
+		}
+
+		const vec4f v0 = decodeKey(track, track.firstKey + cursor);
+		if (track.interpolation == Mesh_Animation::Interpolation::STEP) {
+			result = v0;
+			return true;
+		}
+
+		const float t0 = keys[cursor];
+		const float t1 = keys[cursor + 1u];
+		result = interpolate(track.path, v0, decodeKey(track, track.firstKey + cursor + 1u), t1 > t0 ? (qt - t0) / (t1 - t0) : 0.0f);
+		return true;
+	}
+
+	CompressedAnimation compressAnimation(const Mesh_Animation& animation, const AnimationCompressionParams& params, AnimationCompressionReport* report) {
+		CompressedAnimation result;
+		result.name = animation.name;
+		result.start = animation.start;
+		result.end = animation.end;
+		result.duration = animation.duration;
+		result.tracks.reserve(animation.channels.size());
+
+		AnimationCompressionReport statistic;
+		statistic.sourceBytes = sizeof(Mesh_Animation) + animation.name.size() + animation.channels.size() * sizeof(Mesh_Animation::AnimationChannel);
+
+		for (const auto& sampler : animation.samplers) {
+			statistic.sourceBytes += sizeof(Mesh_Animation::AnimationSampler) + sampler.inputs.size() * sizeof(float) + sampler.outputs.size() * sizeof(vec4f);
+			statistic.sourceKeys += sampler.inputs.size();
+		}
+
+		std::vector<uint32_t> keptKeys;
+
+		for (const auto& channel : animation.channels) {
+			if (channel.sampler == 0xffffu || channel.target_node == 0xffffu) continue;
+
+			const Mesh_Animation::AnimationSampler& sampler = animation.samplers[channel.sampler];
+			if (sampler.interpolation == Mesh_Animation::Interpolation::CUBICSPLINE || channel.path == Mesh_Animation::AnimationChannelPath::WEIGHTS || sampler.inputs.empty()) {
+				++statistic.skippedChannels;
+				continue;
+			}
+
+			CompressedAnimation::Track& track = result.tracks.emplace_back();
+			track.target_node = channel.target_node;
+			track.path = channel.path;
+			track.interpolation = sampler.interpolation;
+			result.minTargetNodeId = std::min(result.minTargetNodeId, channel.target_node);
+			result.maxTargetNodeId = std::max(result.maxTargetNodeId, channel.target_node);
+
+			const float eps = tolerance(channel.path, params);
+			const size_t keysCount = sampler.inputs.size();
+
+			// constant track
+			bool constant = true;
+			for (size_t k = 1u; k < keysCount && constant; ++k) {
+				constant = difference(channel.path, sampler.outputs[0u], sampler.outputs[k]) <= eps;
+			}
+
+			if (constant) {
+				track.keysCount = 1u;
+				track.constant = sampler.outputs[0u];
+				++statistic.constantTracks;
+				++statistic.compressedKeys;
+				continue;
+			}
+
+			// keys reduction: extend segment from last kept key while all skipped keys are restored within tolerance
+			keptKeys.clear();
+			keptKeys.push_back(0u);
+
+			for (size_t k = 1u; k < keysCount - 1u; ++k) {
+				const uint32_t first = keptKeys.back();
+				const size_t next = k + 1u;
+				bool keep = false;
+
+				for (size_t m = first + 1u; m < next && !keep; ++m) {
+					vec4f restored;
+					if (sampler.interpolation == Mesh_Animation::Interpolation::STEP) {
+						restored = sampler.outputs[first];
+					} else {
+						const float t0 = sampler.inputs[first];
+						const float t1 = sampler.inputs[next];
+						restored = interpolate(channel.path, sampler.outputs[first], sampler.outputs[next], t1 > t0 ? (sampler.inputs[m] - t0) / (t1 - t0) : 0.0f);
+					}
+					keep = difference(channel.path, restored, sampler.outputs[m]) > eps;
+				}
+
+				if (keep) {
+					keptKeys.push_back(static_cast<uint32_t>(k));
+				}
+			}
+
+			keptKeys.push_back(static_cast<uint32_t>(keysCount - 1u));
+
+			// quantization bounds
+			vec3f rangeMin(std::numeric_limits<float>::max());
+			vec3f rangeMax(-std::numeric_limits<float>::max());
+			for (const uint32_t k : keptKeys) {
+				rangeMin = glm::min(rangeMin, vec3f(sampler.outputs[k]));
+				rangeMax = glm::max(rangeMax, vec3f(sampler.outputs[k]));
+			}
+
+			track.rangeMin = rangeMin;
+			track.rangeScale = (rangeMax - rangeMin) / kRange16;
+			track.firstKey = static_cast<uint32_t>(result.times.size());
+			track.keysCount = static_cast<uint32_t>(keptKeys.size());
+
+			for (const uint32_t k : keptKeys) {
+				const float t = result.duration > 0.0f ? (sampler.inputs[k] - result.start) / result.duration : 0.0f;
+				result.times.push_back(static_cast<uint16_t>(std::lround(std::clamp(t, 0.0f, 1.0f) * CompressedAnimation::kTimeQuantization)));
+
+				uint16_t packed[3u];
+				if (channel.path == Mesh_Animation::AnimationChannelPath::ROTATION) {
+					packQuat(sampler.outputs[k], packed);
+				} else {
+					for (uint8_t c = 0u; c < 3u; ++c) {
+						const float range = rangeMax[c] - rangeMin[c];
+						const float v = range > 0.0f ? (sampler.outputs[k][c] - rangeMin[c]) / range : 0.0f;
+						packed[c] = static_cast<uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * kRange16));
+					}
+				}
+				result.values.insert(result.values.end(), packed, packed + 3u);
+			}
+
+			statistic.compressedKeys += keptKeys.size();
+		}
+
+		result.times.shrink_to_fit();
+		result.values.shrink_to_fit();
+
+		if (report) {
+			statistic.compressedBytes = result.sizeInBytes();
+			measureCompressionError(animation, result, statistic);
+			*report = statistic;
+		}
+
+		return result;
+	}
+
+	Mesh_Animation decompressAnimation(const CompressedAnimation& compressed) {
+		Mesh_Animation result;
+		result.name = compressed.name;
+		result.start = compressed.start;
+		result.end = compressed.end;
+		result.duration = compressed.duration;
+		result.minTargetNodeId = compressed.minTargetNodeId;
+		result.maxTargetNodeId = compressed.maxTargetNodeId;
+		result.samplers.resize(compressed.tracks.size());
+		result.channels.resize(compressed.tracks.size());
+
+		for (size_t i = 0u; i < compressed.tracks.size(); ++i) {
+			const CompressedAnimation::Track& track = compressed.tracks[i];
+			Mesh_Animation::AnimationSampler& sampler = result.samplers[i];
+			sampler.interpolation = track.interpolation;
+
+			if (track.keysCount == 1u) {
+				sampler.inputs = { compressed.start, compressed.end };
+				sampler.outputs = { track.constant, track.constant };
+			} else {
+				sampler.inputs.resize(track.keysCount);
+				sampler.outputs.resize(track.keysCount);
+				for (uint32_t k = 0u; k < track.keysCount; ++k) {
+					sampler.inputs[k] = compressed.keyTime(track.firstKey + k);
+					sampler.outputs[k] = compressed.decodeKey(track, track.firstKey + k);
+				}
+			}
+
+			Mesh_Animation::AnimationChannel& channel = result.channels[i];
+			channel.sampler = static_cast<uint16_t>(i);
+			channel.target_node = track.target_node;
+			channel.path = track.path;
+		}
+
+		return result;
+	}
+
+	void measureCompressionError(const Mesh_Animation& animation, const CompressedAnimation& compressed, AnimationCompressionReport& report) {
+		report.maxTranslationError = 0.0f;
+		report.maxRotationError = 0.0f;
+		report.maxScaleError = 0.0f;
+
+		size_t trackIdx = 0u;
+		for (const auto& channel : animation.channels) {
+			if (channel.sampler == 0xffffu || channel.target_node == 0xffffu) continue;
+
+			const Mesh_Animation::AnimationSampler& sampler = animation.samplers[channel.sampler];
+			if (sampler.interpolation == Mesh_Animation::Interpolation::CUBICSPLINE || channel.path == Mesh_Animation::AnimationChannelPath::WEIGHTS || sampler.inputs.empty()) continue;
+
+			const CompressedAnimation::Track& track = compressed.tracks[trackIdx++];
+
+			float& maxError = channel.path == Mesh_Animation::AnimationChannelPath::ROTATION ? report.maxRotationError :
+							  channel.path == Mesh_Animation::AnimationChannelPath::SCALE ? report.maxScaleError : report.maxTranslationError;
+
+			uint32_t cursor = 0u;
+			const auto check = [&](const float time) {
+				vec4f source;
+				vec4f restored;
+				if (sampleSource(sampler, channel.path, time, source) && compressed.sample(track, time, cursor, restored)) {
+					maxError = std::max(maxError, difference(channel.path, source, restored));
+				}
+			};
+
+			for (size_t k = 0u, sz = sampler.inputs.size(); k < sz; ++k) {
+				check(sampler.inputs[k]);
+				if (k + 1u < sz) {
+					check((sampler.inputs[k] + sampler.inputs[k + 1u]) * 0.5f);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../../Core/Math/mathematic.h"
+#include "MeshData.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace engine {
+
+	// compressed Mesh_Animation:
+	// - one track per channel, key times quantized to 16 bit against clip range
+	// - rotations: smallest three, 3 x 15 bit + 2 bit of largest component index (48 bit per key)
+	// - translations and scales: 3 x 16 bit per key against track bounds
+	// - keys which can be restored by interpolation of neighbours within tolerance are removed
+	// - constant tracks store single full precision value
+	struct CompressedAnimation {
+		struct Track {
+			uint32_t firstKey = 0u;		// first key in times / values
+			uint32_t keysCount = 0u;	// 1 - constant track
+			uint16_t target_node = 0xffffu;
+			Mesh_Animation::AnimationChannelPath path = Mesh_Animation::AnimationChannelPath::TRANSLATION;
+			Mesh_Animation::Interpolation interpolation = Mesh_Animation::Interpolation::LINEAR;
+			vec3f rangeMin = vec3f(0.0f);	// dequantization for translation / scale: rangeMin + q * rangeScale
+			vec3f rangeScale = vec3f(0.0f);
+			vec4f constant = vec4f(0.0f);	// value of constant track
+		};
+
+		static constexpr float kTimeQuantization = 65535.0f;
+
+		std::string name;
+		std::vector<Track> tracks;
+		std::vector<uint16_t> times;	// keysCount per track
+		std::vector<uint16_t> values;	// 3 x keysCount per track
+		float start = 0.0f;
+		float end = 0.0f;
+		float duration = 0.0f;
+		uint16_t minTargetNodeId = 0xffffu;
+		uint16_t maxTargetNodeId = 0u;
+
+		[[nodiscard]] inline size_t sizeInBytes() const noexcept {
+			return sizeof(CompressedAnimation) + name.size() + tracks.size() * sizeof(Track) + times.size() * sizeof(uint16_t) + values.size() * sizeof(uint16_t);
+		}
+
+		[[nodiscard]] inline float keyTime(const uint32_t key) const noexcept {
+			return start + static_cast<float>(times[key]) * (duration / kTimeQuantization);
+		}
+
+		// value of track in time, cursor - key from previous sampling (per track, like Mesh_Animation::AnimationSampler::keyFrame)
+		// returns false if time is out of track range
+		bool sample(const Track& track, const float time, uint32_t& cursor, vec4f& result) const noexcept;
+
+		[[nodiscard]] vec4f decodeKey(const Track& track, const uint32_t key) const noexcept;
+	};
+
+	struct AnimationCompressionParams {
+		float translationTolerance = 1e-3f;	// in model units
+		float rotationTolerance = 1e-3f;	// in radians
+		float scaleTolerance = 1e-3f;
+	};
+
+	struct AnimationCompressionReport {
+		size_t sourceBytes = 0u;
+		size_t compressedBytes = 0u;
+		size_t sourceKeys = 0u;
+		size_t compressedKeys = 0u;
+		size_t constantTracks = 0u;
+		size_t skippedChannels = 0u;	// cubic spline and morph weights channels are not supported
+		float maxTranslationError = 0.0f;
+		float maxRotationError = 0.0f;	// in radians
+		float maxScaleError = 0.0f;
+	};
+
+	CompressedAnimation compressAnimation(const Mesh_Animation& animation, const AnimationCompressionParams& params, AnimationCompressionReport* report = nullptr);
+
+	// compressed clip restored as Mesh_Animation: one sampler and channel per track (constant tracks get two equal keys at clip start and end)
+	Mesh_Animation decompressAnimation(const CompressedAnimation& compressed);
+
+	// error of compressed clip against source clip, measured in source keys times and between them
+	void measureCompressionError(const Mesh_Animation& animation, const CompressedAnimation& compressed, AnimationCompressionReport& report);
+}
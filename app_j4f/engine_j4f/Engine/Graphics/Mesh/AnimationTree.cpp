@@ -2,204 +2,81 @@
 #include "MeshData.h"
 #include "Mesh.h"
 
+#include <cmath>
+
 namespace engine {
 
-	bool AnimatorCalculator::_(AnimatorType* animator, const uint8_t i) {
-		const auto& children = animator->children();
-		if (children.empty()) { // calculate single animation values
-			animator->value()(animator->value().getCurrentTime(i), i);
-		} else { // mix children animation values;
-			std::vector<TreeAnimator::Transform>& transforms = animator->value().getTransforms(i);
-			const size_t childrenCount = children.size();
+	namespace {
+		inline vec4f nlerp(const vec4f& q0, const vec4f& q1, const float t) noexcept { // shortest path, vec4 math is simd with glm intrinsics
+			const vec4f r = glm::mix(q0, glm::dot(q0, q1) < 0.0f ? -q1 : q1, t);
+			return r * (1.0f / std::sqrt(glm::dot(r, r)));
+		}
+
+		void mixChildren(HierarchyRaw<MeshAnimator>* animator, const uint8_t i) {
+			MeshAnimator& target = animator->value();
+			target.clearPose(i);
+
 			float w = 0.0f;
+			for (const auto& child : animator->children()) {
+				const MeshAnimator& v = child->value();
+				const float w2 = v.getWeight();
+				if (w2 <= 0.0f) continue; // skip calculate for weight <= 0.0f
 
-			size_t firstNoneZeroWeightChild = 0u;
-			for (size_t n = 0u; n < childrenCount; ++n) {
-				const auto& v = children[n]->value();
-				w = v.getWeight();
-				if (w > 0.0f) { // get first none zero weight value
-					firstNoneZeroWeightChild = n;
-					const std::vector<TreeAnimator::Transform>& ch_transforms = v.getTransforms(i);
-
-                    for (auto& ch_transform : ch_transforms) {
-						if (ch_transform.target_node != 0xff'ffu && ch_transform.target_node < transforms.size()) {
-							memcpy(&transforms[ch_transform.target_node], &ch_transform, sizeof(TreeAnimator::Transform));
-						}
-					}
-
-					break;
-				}
-			}
+				target.blendPose(v, w / (w + w2), i); // first not zero weight child is just copied
+				w += w2;
 
-			if (w < 1.0f) {
-				for (size_t n = firstNoneZeroWeightChild + 1u; n < childrenCount; ++n) { // true animation blend variant?
-					auto& v = children[n]->value();
-					const float w2 = v.getWeight();
-
-					if (w2 <= 0.0f) continue; // skip calculate for weight <= 0.0f
-
-					std::vector<TreeAnimator::Transform>& ch_transforms = v.getTransforms(i);
-					const float mix = w * 1.0f / (w + w2);
-
-                    for (auto& ch_transform : ch_transforms) {
-						if (ch_transform.target_node == 0xff'ffu || ch_transform.target_node >= transforms.size()) continue;
-						TreeAnimator::Transform& tr0 = transforms[ch_transform.target_node];
-						TreeAnimator::Transform& tr1 = ch_transform;
-
-						switch (tr1.mask) {
-							case 0b00'00'00'01u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-							}
-								break;
-							case 0b00'00'00'10u:
-							{
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-							}
-								break;
-							case 0b00'00'01'00u:
-							{
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							case 0b00'00'00'11u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-							}
-								break;
-							case 0b00'00'01'01u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							case 0b00'00'01'10u:
-							{
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							case 0b00'00'01'11u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							default:
-								break;
-						}
-
-						tr0.mask |= tr1.mask;
-						tr1.mask = 0u;
-					}
-
-					w += w2;
-
-					if (w >= 1.0f) break;
-				}
+				if (w >= 1.0f) break;
 			}
 		}
-
-		return true;
 	}
 
-	bool MeshAnimationTree::calculateAnimators(AnimatorType* animator, const uint8_t i) {
-		const auto& children = animator->children();
-		if (children.empty()) { // calculate single animation values
-			animator->value()(animator->value().getCurrentTime(i), i);
-		} else { // mix children animation values;
-			std::vector<TreeAnimator::Transform>& transforms = animator->value().getTransforms(i);
-			const size_t childrenCount = children.size();
-			float w = 0.0f;
+	void MeshAnimator::blendPose(const MeshAnimator& child, const float w0, const uint8_t i) {
+		Pose& pose = _poses[i];
+		const Pose& childPose = child._poses[i];
+		const size_t count = pose.masks.size();
+		const float w1 = 1.0f - w0;
+
+		for (const uint16_t childIdx : childPose.touched) {
+			const size_t node = static_cast<size_t>(child._nodesOffset) + childIdx;
+			if (node < _nodesOffset || node - _nodesOffset >= count) continue;
 
-			size_t firstNoneZeroWeightChild = 0u;
-			for (size_t n = 0u; n < childrenCount; ++n) {
-				const auto& v = children[n]->value();
-				w = v.getWeight();
-				if (w > 0.0f) { // get first none zero weight value
-					firstNoneZeroWeightChild = n;
-					const std::vector<TreeAnimator::Transform>& ch_transforms = v.getTransforms(i);
+			const auto idx = static_cast<uint16_t>(node - _nodesOffset);
+			const uint8_t childMask = childPose.masks[childIdx];
+			uint8_t& mask = pose.mask(idx);
 
-                    for (auto&& ch_transform : ch_transforms) {
-						memcpy(&transforms[ch_transform.target_node], &ch_transform, sizeof(TreeAnimator::Transform));
-					}
+			if (childMask & 0b00'00'00'01u) {
+				pose.translations[idx] = (mask & 0b00'00'00'01u) ? (pose.translations[idx] * w0 + childPose.translations[childIdx] * w1) : childPose.translations[childIdx];
+			}
 
-					break;
-				}
+			if (childMask & 0b00'00'00'10u) {
+				pose.rotations[idx] = (mask & 0b00'00'00'10u) ? nlerp(childPose.rotations[childIdx], pose.rotations[idx], w0) : childPose.rotations[childIdx];
 			}
 
-			if (w < 1.0f) {
-				for (size_t n = firstNoneZeroWeightChild + 1; n < childrenCount; ++n) { // true animation blend variant?
-					auto& v = children[n]->value();
-					const float w2 = v.getWeight();
-
-					if (w2 <= 0.0f) continue; // skip calculate for weight <= 0.0f
-
-					std::vector<TreeAnimator::Transform>& ch_transforms = v.getTransforms(i);
-					const float mix = w * 1.0f / (w + w2);
-
-                    for (auto&& ch_transform : ch_transforms) {
-						TreeAnimator::Transform& tr0 = transforms[ch_transform.target_node];
-						TreeAnimator::Transform& tr1 = ch_transform;
-
-						switch (tr1.mask) {
-							case 0b00'00'00'01u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-							}
-								break;
-							case 0b00'00'00'10u:
-							{
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-							}
-								break;
-							case 0b00'00'01'00u:
-							{
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							case 0b00'00'00'11u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-							}
-								break;
-							case 0b00'00'01'01u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							case 0b00'00'01'10u:
-							{
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							case 0b00'00'01'11u:
-							{
-								tr0.translation = (tr0.mask & 0b00'00'00'01u) ? glm::mix(tr1.translation, tr0.translation, mix) : tr1.translation;
-								tr0.rotation = (tr0.mask & 0b00'00'00'10u) ? glm::normalize(glm::slerp(tr1.rotation, tr0.rotation, mix)) : tr1.rotation;
-								tr0.scale = (tr0.mask & 0b00'00'01'00u) ? glm::mix(tr1.scale, tr0.scale, mix) : tr1.scale;
-							}
-								break;
-							default:
-								break;
-						}
-
-						tr0.mask |= tr1.mask;
-						tr1.mask = 0u;
-					}
-
-					w += w2;
-
-					if (w >= 1.0f) break;
-				}
+			if (childMask & 0b00'00'01'00u) {
+				pose.scales[idx] = (mask & 0b00'00'01'00u) ? (pose.scales[idx] * w0 + childPose.scales[childIdx] * w1) : childPose.scales[childIdx];
 			}
+
+			mask |= childMask;
+		}
+	}
+
+	bool AnimatorCalculator::_(AnimatorType* animator, const uint8_t i) {
+		if (animator->children().empty()) { // calculate single animation values
+			animator->value()(animator->value().getCurrentTime(i), i);
+		} else { // mix children animation values
+			mixChildren(animator, i);
+		}
+
+		return true;
+	}
+
+	bool MeshAnimationTree::calculateAnimators(AnimatorType* animator, const uint8_t i) {
+		if (animator->children().empty()) { // calculate single animation values
+			animator->value()(animator->value().getCurrentTime(i), i);
+		} else { // mix children animation values
+			mixChildren(animator, i);
 		}
 
 		return true;
 	}
-}
\ No newline at end of file
+}
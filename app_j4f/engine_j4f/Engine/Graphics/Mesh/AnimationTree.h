@@ -6,6 +6,7 @@
 #include "../../Utils/Debug/Assert.h"
 #include "MeshData.h"
 #include "Mesh.h"
+#include "AnimationCompression.h"
 
 #include <cstdint>
 #include <memory>
@@ -37,12 +38,36 @@ namespace engine {
 			End = 2u,
 		};
 
-		struct Transform {
-			uint8_t mask = 0u;
-			uint16_t target_node = 0xff'ffu;
-			vec3f scale = vec3f(1.0f);
-			quatf rotation = quatf(1.0f, 0.0f, 0.0f, 0.0f);
-			vec3f translation = vec3f(0.0f);
+		// animator nodes values in structure of arrays form, indexed by node id - nodes offset
+		// rotations are stored as vec4f (x, y, z, w) for simd blending
+		struct Pose {
+			std::vector<uint8_t> masks; // 0b001 - translation, 0b010 - rotation, 0b100 - scale
+			std::vector<vec4f> translations;
+			std::vector<vec4f> rotations;
+			std::vector<vec4f> scales;
+			std::vector<uint16_t> touched; // indices with not zero mask, only these nodes are blended and applied
+
+			inline void resize(const size_t count) {
+				masks.assign(count, 0u);
+				translations.assign(count, vec4f(0.0f));
+				rotations.assign(count, vec4f(0.0f, 0.0f, 0.0f, 1.0f));
+				scales.assign(count, vec4f(1.0f));
+				touched.reserve(count);
+			}
+
+			inline void clear() noexcept {
+				for (const uint16_t idx : touched) {
+					masks[idx] = 0u;
+				}
+				touched.clear();
+			}
+
+			inline uint8_t& mask(const uint16_t idx) {
+				if (masks[idx] == 0u) {
+					touched.push_back(idx);
+				}
+				return masks[idx];
+			}
 		};
 
 		MeshAnimator(float weight, const size_t transformsCount, const uint8_t latency) :
@@ -50,11 +75,11 @@ namespace engine {
 			_time(0.0f),
 			_animation(nullptr),
 			_frameTimes(latency),
-			_transforms(latency),
+			_poses(latency),
 			_infinity(true)
 		{
 			for (size_t i = 0u; i < latency; ++i) {
-				_transforms[i].resize(transformsCount);
+				_poses[i].resize(transformsCount);
 				_frameTimes[i] = 0.0f;
 			}
 		}
@@ -65,25 +90,51 @@ namespace engine {
 			_speed(speed),
 			_animation(animation),
 			_frameTimes(latency),
-			_transforms(latency),
+			_poses(latency),
+			_samplerKeys(latency),
+			_samplerMixes(latency),
+			_nodesOffset(animation->minTargetNodeId),
 			_infinity(infinity)
 		{
 			for (uint16_t i = 0u; i < latency; ++i) {
-				_transforms[i].resize(_animation->maxTargetNodeId - _animation->minTargetNodeId + 1u);
+				_poses[i].resize(targetNodesCount(*_animation));
+				_samplerKeys[i].resize(_animation->samplers.size(), 0u);
+				_samplerMixes[i].resize(_animation->samplers.size(), -1.0f);
+				_frameTimes[i] = 0.0f;
+			}
+		}
+
+		MeshAnimator(const CompressedAnimation* animation, float weight, const uint8_t latency, float speed = 1.0f, bool infinity = true) :
+			_weight(weight),
+			_time(0.0f),
+			_speed(speed),
+			_compressedAnimation(animation),
+			_frameTimes(latency),
+			_poses(latency),
+			_samplerKeys(latency),
+			_nodesOffset(animation->minTargetNodeId),
+			_infinity(infinity)
+		{
+			for (uint16_t i = 0u; i < latency; ++i) {
+				_poses[i].resize(targetNodesCount(*_compressedAnimation));
+				_samplerKeys[i].resize(_compressedAnimation->tracks.size(), 0u);
 				_frameTimes[i] = 0.0f;
 			}
 		}
 
 		inline State update(const float dt, const uint8_t i, std::vector<IAnimationObserver*>& observers) {
-			if (_animation == nullptr) return State::Unknown;
+			if (_animation == nullptr && _compressedAnimation == nullptr) return State::Unknown;
+
+			const float start = _animation ? _animation->start : _compressedAnimation->start;
+			const float duration = _animation ? _animation->duration : _compressedAnimation->duration;
 
 			auto event = _time == 0.0f ? AnimationEvent::NewLoop : AnimationEvent::Unknown;
 			auto state = State::Process;
 
 			_time += _speed * dt;
 
-			if (_time >= _animation->duration) {
-				_time -= _animation->duration;
+			if (_time >= duration) {
+				_time -= duration;
 				if (!_infinity) {
 					state = State::End;
 					event = AnimationEvent::Finish;
@@ -94,7 +145,7 @@ namespace engine {
 				event = (event == AnimationEvent::NewLoop) ? AnimationEvent::NewLoop : AnimationEvent::Process;
 			}
 
-			_frameTimes[i] = _animation->start + _time;
+			_frameTimes[i] = start + _time;
 
             for (auto & observer : observers) {
                 observer->onEvent(event, this);
@@ -105,113 +156,133 @@ namespace engine {
         [[nodiscard]] inline uint8_t getLatency() const { return _frameTimes.size(); }
 
 		[[nodiscard]] inline float getCurrentTime(const uint8_t i) const {
-			if (!_animation) return 0.0f;
+			if (!_animation && !_compressedAnimation) return 0.0f;
 			return _frameTimes[i];
 		}
 
 		inline void operator()(const float time, const uint8_t n) {
+			if (_compressedAnimation) {
+				sampleCompressed(time, n);
+				return;
+			}
+
 			if (_animation == nullptr) return;
 
 			constexpr float epsilon = 1e-5f;
 
-			for (const auto& channel : _animation->channels) {
-				if (channel.sampler == 0xff'ffu || channel.target_node == 0xff'ffu) {
+			// pass 1: keys and mix factors for all samplers (sampler can be shared between channels)
+			const auto& samplers = _animation->samplers;
+			std::vector<uint32_t>& keys = _samplerKeys[n];
+			std::vector<float>& mixes = _samplerMixes[n];
+
+			for (size_t s = 0u, sz = samplers.size(); s < sz; ++s) {
+				const Mesh_Animation::AnimationSampler& sampler = samplers[s];
+				uint32_t& key = keys[s];
+
+				if (!sampler.keyFrame(time, key)) {
+					mixes[s] = -1.0f;
 					continue;
 				}
 
-				Transform& transform = _transforms[n][channel.target_node - _animation->minTargetNodeId];
-				transform.target_node = channel.target_node;
-				const Mesh_Animation::AnimationSampler& sampler = _animation->samplers[channel.sampler];
+				if (sampler.interpolation == Mesh_Animation::Interpolation::LINEAR) {
+					const float t0 = sampler.inputs[key];
+					const float t1 = sampler.inputs[key + 1u];
+					mixes[s] = t1 > t0 ? (time - t0) / (t1 - t0) : 0.0f;
+				} else {
+					mixes[s] = 0.0f;
+				}
+			}
 
-				for (size_t i = 0u, sz = sampler.inputs.size() - 1u; i < sz; ++i) {
+			// pass 2: channels values
+			Pose& pose = _poses[n];
+			pose.clear();
 
-					const float t0 = sampler.inputs[i];
-					const float t1 = sampler.inputs[i + 1u];
+			for (const auto& channel : _animation->channels) {
+				if (channel.sampler == 0xff'ffu || channel.target_node == 0xff'ffu) {
+					continue;
+				}
 
-					if ((time >= t0) && (time <= t1)) {
+				const float mix_c = mixes[channel.sampler];
+				if (mix_c < 0.0f) continue;
 
-						const vec4f& v0 = sampler.outputs[i];
+				const auto idx = static_cast<uint16_t>(channel.target_node - _nodesOffset);
+				const Mesh_Animation::AnimationSampler& sampler = samplers[channel.sampler];
+				const uint32_t key = keys[channel.sampler];
+				const vec4f& v0 = sampler.outputs[key];
 
-						switch (sampler.interpolation) {
-							case Mesh_Animation::Interpolation::LINEAR:
+				switch (sampler.interpolation) {
+					case Mesh_Animation::Interpolation::LINEAR:
+					{
+						const vec4f& v1 = sampler.outputs[key + 1u];
+						switch (channel.path) {
+							case Mesh_Animation::AnimationChannelPath::TRANSLATION:
 							{
-								const vec4f& v1 = sampler.outputs[i + 1u];
-								const float mix_c = (time - t0) / (t1 - t0);
-								switch (channel.path) {
-									case Mesh_Animation::AnimationChannelPath::TRANSLATION:
-									{
-										transform.mask |= 0b00'00'00'01u;
-										if (!compare(v0, v1, epsilon)) {
-											transform.translation = v0;
-										} else {
-											transform.translation = glm::mix(v0, v1, mix_c);
-										}
-									}
-										break;
-									case Mesh_Animation::AnimationChannelPath::ROTATION:
-									{
-										transform.mask |= 0b00'00'00'10u;
-										if (!compare(v0, v1, epsilon)) {
-											transform.rotation = quatf(v0.w, v0.x, v0.y, v0.z);
-										} else {
-											const quatf q1(v0.w, v0.x, v0.y, v0.z);
-											const quatf q2(v1.w, v1.x, v1.y, v1.z);
-											transform.rotation = glm::normalize(glm::slerp(q1, q2, mix_c));
-										}
-									}
-										break;
-									case Mesh_Animation::AnimationChannelPath::SCALE:
-									{
-										transform.mask |= 0b00'00'01'00u;
-										if (!compare(v0, v1, epsilon)) {
-											transform.scale = v0;
-										} else {
-											transform.scale = glm::mix(v0, v1, mix_c);
-										}
-									}
-										break;
-									default:
-										break;
-									}
+								pose.mask(idx) |= 0b00'00'00'01u;
+								pose.translations[idx] = compare(v0, v1, epsilon) ? glm::mix(v0, v1, mix_c) : v0;
 							}
 								break;
-							case Mesh_Animation::Interpolation::STEP:
+							case Mesh_Animation::AnimationChannelPath::ROTATION:
 							{
-								switch (channel.path) {
-									case Mesh_Animation::AnimationChannelPath::TRANSLATION:
-										transform.mask |= 0b00'00'00'01u;
-										transform.translation = v0;
-										break;
-									case Mesh_Animation::AnimationChannelPath::ROTATION:
-										transform.mask |= 0b00'00'00'10u;
-										transform.rotation = quatf(v0.w, v0.x, v0.y, v0.z);
-										break;
-									case Mesh_Animation::AnimationChannelPath::SCALE:
-										transform.mask |= 0b00'00'01'00u;
-										transform.scale = v0;
-										break;
-									default:
-										break;
+								pose.mask(idx) |= 0b00'00'00'10u;
+								if (!compare(v0, v1, epsilon)) {
+									pose.rotations[idx] = v0;
+								} else {
+									const quatf q1(v0.w, v0.x, v0.y, v0.z);
+									const quatf q2(v1.w, v1.x, v1.y, v1.z);
+									const quatf q = glm::normalize(glm::slerp(q1, q2, mix_c));
+									pose.rotations[idx] = vec4f(q.x, q.y, q.z, q.w);
 								}
 							}
 								break;
-							case Mesh_Animation::Interpolation::CUBICSPLINE: // todo!
-                            {
-                                ENGINE_BREAK
-                            }
+							case Mesh_Animation::AnimationChannelPath::SCALE:
+							{
+								pose.mask(idx) |= 0b00'00'01'00u;
+								pose.scales[idx] = compare(v0, v1, epsilon) ? glm::mix(v0, v1, mix_c) : v0;
+							}
 								break;
 							default:
 								break;
-							}
-
+						}
+					}
+						break;
+					case Mesh_Animation::Interpolation::STEP:
+					{
+						switch (channel.path) {
+							case Mesh_Animation::AnimationChannelPath::TRANSLATION:
+								pose.mask(idx) |= 0b00'00'00'01u;
+								pose.translations[idx] = v0;
+								break;
+							case Mesh_Animation::AnimationChannelPath::ROTATION:
+								pose.mask(idx) |= 0b00'00'00'10u;
+								pose.rotations[idx] = v0;
+								break;
+							case Mesh_Animation::AnimationChannelPath::SCALE:
+								pose.mask(idx) |= 0b00'00'01'00u;
+								pose.scales[idx] = v0;
+								break;
+							default:
+								break;
+						}
+					}
 						break;
+					case Mesh_Animation::Interpolation::CUBICSPLINE: // todo!
+					{
+						ENGINE_BREAK
 					}
+						break;
+					default:
+						break;
 				}
 			}
 		}
 
-		inline std::vector<Transform>& getTransforms(const uint8_t i) { return _transforms[i]; }
-        [[nodiscard]] inline const std::vector<Transform>& getTransforms(const uint8_t i) const { return _transforms[i]; }
+		[[nodiscard]] inline const Pose& getPose(const uint8_t i) const { return _poses[i]; }
+		[[nodiscard]] inline uint16_t getNodesOffset() const noexcept { return _nodesOffset; }
+
+		inline void clearPose(const uint8_t i) noexcept { _poses[i].clear(); }
+
+		// blends child pose into this one: existing values keep weight w0, channels which are not set yet are copied
+		void blendPose(const MeshAnimator& child, const float w0, const uint8_t i);
 
         [[nodiscard]] inline float getWeight() const noexcept { return _weight; }
 		inline void setWeight(const float w) noexcept {
@@ -227,71 +298,79 @@ namespace engine {
 		inline void reset() { _time = 0.0f; }
 
         [[nodiscard]] inline ref_ptr<const Mesh_Animation> getAnimation() const noexcept { return _animation; }
+        [[nodiscard]] inline ref_ptr<const CompressedAnimation> getCompressedAnimation() const noexcept { return _compressedAnimation; }
 
-		inline void apply(MeshSkeleton* skeleton, const uint8_t updateFrame) {
-			auto& transforms = _transforms[updateFrame];
+		inline void apply(MeshSkeleton* skeleton, const uint8_t updateFrame) const {
+			const Pose& pose = _poses[updateFrame];
 
-			for (auto& transform : transforms) {
-				if (transform.target_node == 0xffffu) continue;
+			for (const uint16_t idx : pose.touched) {
+				const uint8_t mask = pose.masks[idx];
+				Mesh_Node& target = skeleton->getNode(updateFrame, _nodesOffset + idx);
 
-				Mesh_Node& target = skeleton->getNode(updateFrame, transform.target_node);
+				if (mask & 0b00'00'00'01u) {
+					target.setTranslation(vec3f(pose.translations[idx]));
+				}
 
-				switch (transform.mask) {
-					case 0b00'00'00'01u:
-					{
-						target.setTranslation(transform.translation);
-					}
-						break;
-					case 0b00'00'00'10u:
-					{
-						target.setRotation(transform.rotation);
-					}
-						break;
-					case 0b00'00'01'00u:
-					{
-						target.setScale(transform.scale);
-					}
-						break;
-					case 0b00'00'00'11u:
-					{
-						target.setTranslation(transform.translation);
-						target.setRotation(transform.rotation);
-					}
-						break;
-					case 0b00'00'01'01u:
-					{
-						target.setTranslation(transform.translation);
-						target.setScale(transform.scale);
-					}
+				if (mask & 0b00'00'00'10u) {
+					const vec4f& r = pose.rotations[idx];
+					target.setRotation(quatf(r.w, r.x, r.y, r.z));
+				}
+
+				if (mask & 0b00'00'01'00u) {
+					target.setScale(vec3f(pose.scales[idx]));
+				}
+			}
+		}
+
+	private:
+		template <typename A>
+		[[nodiscard]] static inline uint32_t targetNodesCount(const A& animation) noexcept { // animation without channels has min > max
+			return animation.minTargetNodeId <= animation.maxTargetNodeId ? animation.maxTargetNodeId - animation.minTargetNodeId + 1u : 0u;
+		}
+
+		inline void sampleCompressed(const float time, const uint8_t n) {
+			const auto& tracks = _compressedAnimation->tracks;
+			std::vector<uint32_t>& keys = _samplerKeys[n];
+			Pose& pose = _poses[n];
+			pose.clear();
+			vec4f v;
+
+			for (size_t t = 0u, sz = tracks.size(); t < sz; ++t) {
+				const CompressedAnimation::Track& track = tracks[t];
+				if (!_compressedAnimation->sample(track, time, keys[t], v)) continue;
+
+				const auto idx = static_cast<uint16_t>(track.target_node - _nodesOffset);
+
+				switch (track.path) {
+					case Mesh_Animation::AnimationChannelPath::TRANSLATION:
+						pose.mask(idx) |= 0b00'00'00'01u;
+						pose.translations[idx] = v;
 						break;
-					case 0b00'00'01'10u:
-					{
-						target.setRotation(transform.rotation);
-						target.setScale(transform.scale);
-					}
+					case Mesh_Animation::AnimationChannelPath::ROTATION:
+						pose.mask(idx) |= 0b00'00'00'10u;
+						pose.rotations[idx] = v;
 						break;
-					case 0b00'00'01'11u:
-					{
-						target.setTranslation(transform.translation);
-						target.setRotation(transform.rotation);
-						target.setScale(transform.scale);
-					}
+					case Mesh_Animation::AnimationChannelPath::SCALE:
+						pose.mask(idx) |= 0b00'00'01'00u;
+						pose.scales[idx] = v;
 						break;
 					default:
 						break;
 				}
-
-				transform.mask = 0u;
 			}
 		}
 
-	private:
 		float _weight = 0.0f;
 		float _time = 0.0f;
 		float _speed = 1.0f;
 		ref_ptr<const Mesh_Animation> _animation = nullptr;
+		ref_ptr<const CompressedAnimation> _compressedAnimation = nullptr;
 		std::vector<float> _frameTimes;
-		std::vector<std::vector<Transform>> _transforms;
+		std::vector<Pose> _poses;
+		// per latency frame: sampler key cursors and mix factors (< 0.0f - time out of sampler range)
+		std::vector<std::vector<uint32_t>> _samplerKeys;
+		std::vector<std::vector<float>> _samplerMixes;
+		uint16_t _nodesOffset = 0u; // first node id of animation (blend animators cover all nodes)
 		bool _infinity = true;
 	};
 
@@ -389,6 +468,7 @@ namespace engine {
 
 		MeshAnimationTree(float weight, const size_t transformsCount, const uint8_t latency) : _animator(std::make_unique<AnimatorType>(weight, transformsCount, latency)) { }
 		MeshAnimationTree(const Mesh_Animation* animation, float weight, const uint8_t latency) : _animator(std::make_unique<AnimatorType>(animation, weight, latency)) { }
+		MeshAnimationTree(const CompressedAnimation* animation, float weight, const uint8_t latency) : _animator(std::make_unique<AnimatorType>(animation, weight, latency)) { }
 
 		~MeshAnimationTree() = default;
 
@@ -397,6 +477,23 @@ namespace engine {
 
         [[nodiscard]] inline uint8_t frame() const noexcept { return _updateFrameNum; }
 
+		// single clip tree (root animator with full weight) state, for skeletons poses sharing
+		inline bool poseState(const uint8_t frame, const void*& animation, float& time) const noexcept {
+			const auto& animator = _animator->value();
+			if (animator.getWeight() < 1.0f) return false;
+
+			if (animator.getAnimation()) {
+				animation = animator.getAnimation().get();
+			} else if (animator.getCompressedAnimation()) {
+				animation = animator.getCompressedAnimation().get();
+			} else {
+				return false;
+			}
+
+			time = animator.getCurrentTime(frame);
+			return true;
+		}
+
         inline void setSpeed(const float s) noexcept { _speed = s; }
         [[nodiscard]] inline float getSpeed() const noexcept { return _speed; }
 
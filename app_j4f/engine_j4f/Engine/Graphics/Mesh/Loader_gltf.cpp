@@ -5,6 +5,7 @@
 #include "../../Utils/base64.h"
 #include "../../Utils/Json/Json.h"
 
+#include <algorithm>
 #include <cmath>
 #include <assert.h>
 #include <cstddef>
@@ -204,6 +205,10 @@ namespace gltf {
 		}
 	}
 
+	void Parser::parseNodeName(Node& node, const Json& js) {
+		node.name = js.value("name", "");
+	}
+
 	void Parser::parseMesh(Mesh& mesh, const Json& js, const map_type<std::string, AttributesSemantic>& semantics) {
 		mesh.name = js.value("name", "");
 
@@ -231,7 +236,7 @@ namespace gltf {
 		}
 	}
 
-	void Parser::parseBuffer(Buffer& buffer, const Json& js, const std::string& folder, char* binData) {
+	void Parser::parseBuffer(Buffer& buffer, const Json& js, const std::string& folder, const engine::FileView& binData) {
 		buffer.name = js.value("name", "");
 		buffer.byteLength = js["byteLength"].get<uint32_t>();
 		const std::string& uri = js.value("uri", "");
@@ -241,25 +246,22 @@ namespace gltf {
 			const std::string octetStreamHeader = "data:application/octet-stream;base64,";
 			const std::string bufferHeader = "data:application/gltf-buffer;base64,";
 
+			const auto decode = [&buffer](const std::string& data) {
+				std::byte* bytes;
+				buffer.data = engine::FileView::allocate(buffer.byteLength, bytes);
+				std::memcpy(bytes, data.data(), std::min<size_t>(buffer.byteLength, data.size()));
+			};
+
 			if (uri.find(octetStreamHeader) == 0) {
-				const std::string data = base64_decode(uri.substr(octetStreamHeader.size()));
-				buffer.data = new char[buffer.byteLength + 1];
-				std::memmove(buffer.data, data.data(), buffer.byteLength);
-				buffer.data[buffer.byteLength] = '\0';
+				decode(base64_decode(uri.substr(octetStreamHeader.size())));
 			} else if (uri.find(bufferHeader) == 0) {
-				const std::string data = base64_decode(uri.substr(bufferHeader.size()));
-				buffer.data = new char[buffer.byteLength + 1];
-				std::memmove(buffer.data, data.data(), buffer.byteLength);
-				buffer.data[buffer.byteLength] = '\0';
+				decode(base64_decode(uri.substr(bufferHeader.size())));
 			} else { // is file path
 				auto & fm = engine::Engine::getInstance().getModule<engine::FileManager>();
-				size_t fsize;
-				buffer.data = fm.readFile((folder + uri), fsize);
+				buffer.data = fm.readFileMapped(folder + uri);
 			}
 		} else if (binData) {
-			buffer.data = new char[buffer.byteLength + 1];
-			memcpy(buffer.data, binData, buffer.byteLength);
-			buffer.data[buffer.byteLength] = '\0';
+			buffer.data = binData.subview(0u, buffer.byteLength); // no copy, chunk shares .glb file content
 		}
 	}
 	
@@ -460,6 +462,29 @@ namespace gltf {
 		}
 	}
 
+	static const map_type<std::string, AccessorType> accesorTypes = {
+		{"SCALAR", AccessorType::SCALAR},
+		{"VEC2", AccessorType::VEC2},
+		{"VEC3", AccessorType::VEC3},
+		{"VEC4", AccessorType::VEC4},
+		{"MAT2", AccessorType::MAT2},
+		{"MAT3", AccessorType::MAT3},
+		{"MAT4", AccessorType::MAT4}
+	};
+
+	static const map_type<std::string, AnimationChannelPath> animChannelTypes = {
+		{"translation", AnimationChannelPath::TRANSLATION},
+		{"rotation", AnimationChannelPath::ROTATION},
+		{"scale", AnimationChannelPath::SCALE},
+		{"weights", AnimationChannelPath::WEIGHTS}
+	};
+
+	static const map_type<std::string, Interpolation> interpolationTypes = {
+		{"LINEAR", Interpolation::LINEAR},
+		{"STEP", Interpolation::STEP},
+		{"CUBICSPLINE", Interpolation::CUBICSPLINE}
+	};
+
 	template <typename T, typename F, typename... Args>
 	static void parseArray(std::vector<T>& arr, F&& f, std::string_view name, const Json& js, Args&&... args) {
 		if (auto targetJs = js.find(name); targetJs != js.end()) {
@@ -471,9 +496,8 @@ namespace gltf {
 		}
 	}
 
-	Layout Parser::loadModel(const std::string& file) {
+	Json Parser::readDocument(const std::string& file, std::string& folder, engine::FileView& binData) {
 		using namespace std::literals;
-		std::string folder;
 		const size_t lastDelimeter = file.find_last_of('/');
 		if (lastDelimeter != std::string::npos) {
 			folder = file.substr(0, lastDelimeter + 1);
@@ -487,16 +511,15 @@ namespace gltf {
 
 		Json js;
 
-		char* binData = nullptr;
 		size_t binSize = 0u;
-		std::vector<char> bytes;
 		
 		//
 		if (file.ends_with(".glb"sv)) {
 			auto& fm = engine::Engine::getInstance().getModule<engine::FileManager>();
-			fm.readFile(file, bytes);
+			const engine::FileView bytes = fm.readFileMapped(file);
+			const char* chars = bytes.chars();
 
-			if (bytes[0u] == 'g' && bytes[1u] == 'l' && bytes[2u] == 'T' && bytes[3u] == 'F') {
+			if (bytes.size() >= 20u && chars[0u] == 'g' && chars[1u] == 'l' && chars[2u] == 'T' && chars[3u] == 'F') {
 			} else {
 				return {};
 			}
@@ -542,15 +565,27 @@ namespace gltf {
 			memcpy(&chunk1_format, bytes.data() + header_and_json_size + 4u, 4u);
 			swap4IfBigEndian(chunk1_format);
 
-			binData = bytes.data() + header_and_json_size + 8u;  // 4 bytes (bin_buffer_length) + 4 bytes(bin_buffer_format)
+			binData = bytes.subview(header_and_json_size + 8u, chunk1_length);  // 4 bytes (bin_buffer_length) + 4 bytes(bin_buffer_format)
 			binSize = chunk1_length;
 
-			js = Json::parse(&bytes[headerLength], &bytes[headerLength] + chunk0_length);
+			js = Json::parse(chars + headerLength, chars + headerLength + chunk0_length);
 		} else {
 			engine::JsonLoadingParams jsParams(file);
 			js = engine::Engine::getInstance().getModule<engine::AssetManager>().loadAsset<Json>(jsParams);
 		}
 
+		return js;
+	}
+
+	Layout Parser::loadModel(const std::string& file) {
+		std::string folder;
+		engine::FileView binData;
+
+		const Json js = readDocument(file, folder, binData);
+		if (js.is_null()) {
+			return {};
+		}
+
 		const static map_type<std::string, AttributesSemantic> semantics = {
 			{"POSITION", AttributesSemantic::POSITION},
 			{"NORMAL", AttributesSemantic::NORMAL},
@@ -565,29 +600,6 @@ namespace gltf {
 			{"TEXCOORD_4", AttributesSemantic::TEXCOORD_4}
 		};
 
-		const static map_type<std::string, AccessorType> accesorTypes = {
-			{"SCALAR", AccessorType::SCALAR},
-			{"VEC2", AccessorType::VEC2},
-			{"VEC3", AccessorType::VEC3},
-			{"VEC4", AccessorType::VEC4},
-			{"MAT2", AccessorType::MAT2},
-			{"MAT3", AccessorType::MAT3},
-			{"MAT4", AccessorType::MAT4}
-		};
-
-		const static map_type<std::string, AnimationChannelPath> animChannelTypes = {
-			{"translation", AnimationChannelPath::TRANSLATION},
-			{"rotation", AnimationChannelPath::ROTATION},
-			{"scale", AnimationChannelPath::SCALE},
-			{"weights", AnimationChannelPath::WEIGHTS}
-		};
-
-		const static map_type<std::string, Interpolation> interpolationTypes = {
-			{"LINEAR", Interpolation::LINEAR},
-			{"STEP", Interpolation::STEP},
-			{"CUBICSPLINE", Interpolation::CUBICSPLINE}
-		};
-
 		const static map_type<std::string, MimeType> mimeTypes = {
 			{"image/jpeg", MimeType::JPEG},
 			{"image/png", MimeType::PNG}
@@ -618,4 +630,24 @@ namespace gltf {
 
 		return layout;
 	}
+
+	Layout Parser::loadAnimations(const std::string& file) {
+		std::string folder;
+		engine::FileView binData;
+
+		const Json js = readDocument(file, folder, binData);
+		if (js.is_null()) {
+			return {};
+		}
+
+		// no meshes, skins, materials and images: only animations keys and names of nodes, they are targets of channels
+		Layout layout;
+		parseArray(layout.nodes,		parseNodeName,		"nodes",		js);
+		parseArray(layout.buffers,		parseBuffer,		"buffers",		js, folder, binData);
+		parseArray(layout.bufferViews,	parseBufferView,	"bufferViews",	js);
+		parseArray(layout.accessors,	parseAccessor,		"accessors",	js, accesorTypes);
+		parseArray(layout.animations,	parseAnimation,		"animations",	js, animChannelTypes, interpolationTypes);
+
+		return layout;
+	}
 }
\ No newline at end of file
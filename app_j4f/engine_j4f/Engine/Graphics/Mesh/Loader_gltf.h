@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../../File/FileView.h"
 #include "../../Utils/Json/json.hpp"
 
 #include <array>
@@ -185,31 +186,8 @@ namespace gltf {
 
 	struct Buffer {
 		std::string name;
-		char* data = nullptr;
+		engine::FileView data; // mapped .bin file, bin chunk of .glb or decoded data uri
 		uint32_t byteLength;
-
-		~Buffer() {
-			if (data) {
-				delete data;
-				data = nullptr;
-			}
-		}
-
-		Buffer() = default;
-		Buffer(Buffer&& b) noexcept : name(std::move(b.name)), data(b.data), byteLength(b.byteLength) {
-			b.data = nullptr;
-		}
-
-        Buffer& operator=(Buffer&& b) noexcept {
-			name = std::move(b.name);
-			data = b.data;
-			byteLength = b.byteLength;
-			b.data = nullptr;
-			return *this;
-		}
-
-		Buffer(const Buffer&) = delete;
-        Buffer& operator=(const Buffer&) = delete;
 	};
 
 	struct BufferView {
@@ -382,8 +360,9 @@ namespace gltf {
 		static SamplerWrap parseWrap(const uint16_t w);
 		static void parseScene(Scene& scene, const Json& js);
 		static void parseNode(Node& node, const Json& js);
+		static void parseNodeName(Node& node, const Json& js);
 		static void parseMesh(Mesh& mesh, const Json& js, const map_type<std::string, AttributesSemantic>& semantics);
-		static void parseBuffer(Buffer& buffer, const Json& js, const std::string& folder, char* binData);
+		static void parseBuffer(Buffer& buffer, const Json& js, const std::string& folder, const engine::FileView& binData);
 		static void parseBufferView(BufferView& bufferView, const Json& js);
 		static void parseAccessor(Accessor& accessor, const Json& js, const map_type<std::string, AccessorType>& accesorTypes);
 		static void parseAnimation(Animation& animation, const Json& js, const map_type<std::string, AnimationChannelPath>& animChannelTypes, const map_type<std::string, Interpolation>& interpolationTypes);
@@ -394,7 +373,10 @@ namespace gltf {
 		static void parseTextureInfo(TextureInfo& info, const Json& js);
 		static void parseMaterial(Material& material, const Json& js, const map_type<std::string, AlphaMode>& alphaModes);
 
+		static Json readDocument(const std::string& file, std::string& folder, engine::FileView& binData);
+
 	public:
 		static Layout loadModel(const std::string& file);
+		static Layout loadAnimations(const std::string& file); // nodes (names only), animations and their data
 	};
 }
\ No newline at end of file
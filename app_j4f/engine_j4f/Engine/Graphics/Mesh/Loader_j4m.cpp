@@ -0,0 +1,382 @@
+#include "Loader_j4m.h"
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace j4m {
+
+	namespace {
+		class Writer {
+		public:
+			explicit Writer(std::vector<std::byte>& out) : _out(out) {}
+
+			void bytes(const void* data, const size_t size) {
+				const size_t offset = _out.size();
+				_out.resize(offset + size);
+				if (size) {
+					memcpy(&_out[offset], data, size);
+				}
+			}
+
+			template <typename T>
+			void pod(const T& v) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				bytes(&v, sizeof(T));
+			}
+
+			template <typename T>
+			void array(const std::vector<T>& v) {
+				static_assert(std::is_trivially_copyable_v<T>);
+				pod(static_cast<uint32_t>(v.size()));
+				bytes(v.data(), v.size() * sizeof(T));
+			}
+
+			void string(const std::string& s) {
+				pod(static_cast<uint32_t>(s.size()));
+				bytes(s.data(), s.size());
+			}
+
+			void align() {
+				_out.resize((_out.size() + kAlignment - 1u) & ~size_t(kAlignment - 1u));
+			}
+
+		private:
+			std::vector<std::byte>& _out;
+		};
+
+		class Reader {
+		public:
+			Reader(const std::byte* data, const size_t size) noexcept : _data(data), _size(size) {}
+
+			bool bytes(void* out, const size_t size) noexcept {
+				if (_size - _offset < size) return false;
+				if (size) {
+					memcpy(out, _data + _offset, size);
+				}
+				_offset += size;
+				return true;
+			}
+
+			template <typename T>
+			bool pod(T& v) noexcept {
+				return bytes(&v, sizeof(T));
+			}
+
+			template <typename T>
+			bool array(std::vector<T>& v) {
+				uint32_t count;
+				if (!pod(count) || (_size - _offset) / sizeof(T) < count) return false;
+				v.resize(count);
+				return bytes(v.data(), count * sizeof(T));
+			}
+
+			bool string(std::string& s) {
+				uint32_t length;
+				if (!pod(length) || _size - _offset < length) return false;
+				s.assign(reinterpret_cast<const char*>(_data + _offset), length);
+				_offset += length;
+				return true;
+			}
+
+		private:
+			const std::byte* _data;
+			size_t _size;
+			size_t _offset = 0u;
+		};
+
+		// fixed layouts of serialized structures, they don't depend on glm configuration
+		struct Matrix {
+			float m[16u];
+		};
+
+		struct TrackData {
+			uint32_t firstKey;
+			uint32_t keysCount;
+			uint16_t targetNode;
+			uint8_t path;
+			uint8_t interpolation;
+			float rangeMin[3u];
+			float rangeScale[3u];
+			float constant[4u];
+		};
+
+		static_assert(sizeof(Matrix) == 64u && sizeof(TrackData) == 52u);
+
+		struct NodeTransform {
+			uint16_t mesh;
+			uint16_t skin;
+			float scale[3u];
+			float translation[3u];
+			float rotation[4u];
+		};
+
+		void writeNodes(Writer& w, const Content& content) {
+			w.array(content.sceneNodes);
+			for (const gltf::Node& node : content.nodes) {
+				w.string(node.name);
+				w.pod(NodeTransform{
+					node.mesh, node.skin,
+					{ node.scale.x, node.scale.y, node.scale.z },
+					{ node.translation.x, node.translation.y, node.translation.z },
+					{ node.rotation.x, node.rotation.y, node.rotation.z, node.rotation.w }
+				});
+				w.array(node.weights);
+				w.array(node.children);
+			}
+		}
+
+		void writeSkins(Writer& w, const Content& content) {
+			for (const engine::Mesh_Skin& skin : content.skins) {
+				w.pod(skin.skeletonRoot);
+				w.array(skin.joints);
+				w.pod(static_cast<uint32_t>(skin.inverseBindMatrices.size()));
+				for (const engine::mat4f& matrix : skin.inverseBindMatrices) {
+					Matrix m;
+					for (uint32_t i = 0u; i < 16u; ++i) {
+						m.m[i] = matrix[i / 4u][i % 4u];
+					}
+					w.pod(m);
+				}
+			}
+		}
+
+		void writeAnimations(Writer& w, const Content& content) {
+			for (const engine::CompressedAnimation& animation : content.animations) {
+				w.string(animation.name);
+				w.pod(animation.start);
+				w.pod(animation.end);
+				w.pod(animation.duration);
+				w.pod(animation.minTargetNodeId);
+				w.pod(animation.maxTargetNodeId);
+				w.pod(static_cast<uint32_t>(animation.tracks.size()));
+				for (const auto& track : animation.tracks) {
+					w.pod(TrackData{
+						track.firstKey, track.keysCount, track.target_node,
+						static_cast<uint8_t>(track.path), static_cast<uint8_t>(track.interpolation),
+						{ track.rangeMin.x, track.rangeMin.y, track.rangeMin.z },
+						{ track.rangeScale.x, track.rangeScale.y, track.rangeScale.z },
+						{ track.constant.x, track.constant.y, track.constant.z, track.constant.w }
+					});
+				}
+				w.array(animation.times);
+				w.array(animation.values);
+			}
+		}
+	}
+
+	std::vector<std::byte> write(const Content& content) {
+		constexpr uint32_t sectionsCount = 6u;
+
+		std::vector<std::byte> out;
+		Writer w(out);
+
+		Header header = {};
+		memcpy(header.magic, kMagic, sizeof(kMagic));
+		header.version = kVersion;
+		header.semanticMask = content.semanticMask;
+		header.vertexSize = content.vertexSize;
+		header.vertexCount = content.vertexCount;
+		header.indexCount = static_cast<uint32_t>(content.indices.size());
+		header.meshesCount = content.meshesCount;
+		header.sectionsCount = sectionsCount;
+
+		w.pod(header);
+		const size_t sectionsOffset = out.size();
+		out.resize(sectionsOffset + sectionsCount * sizeof(Section));
+
+		Section sections[sectionsCount];
+		const auto addSection = [&](const uint32_t i, const SectionType type, const uint32_t count, auto&& writeData) {
+			w.align();
+			sections[i].type = type;
+			sections[i].count = count;
+			sections[i].offset = out.size();
+			writeData();
+			sections[i].size = out.size() - sections[i].offset;
+		};
+
+		addSection(0u, SectionType::VERTICES, content.vertexCount, [&]() { w.bytes(content.vertices.data(), content.vertices.size_bytes()); });
+		addSection(1u, SectionType::INDICES, header.indexCount, [&]() { w.bytes(content.indices.data(), content.indices.size_bytes()); });
+		addSection(2u, SectionType::PRIMITIVES, static_cast<uint32_t>(content.primitives.size()), [&]() {
+			w.bytes(content.primitives.data(), content.primitives.size() * sizeof(Primitive));
+		});
+		addSection(3u, SectionType::NODES, static_cast<uint32_t>(content.nodes.size()), [&]() { writeNodes(w, content); });
+		addSection(4u, SectionType::SKINS, static_cast<uint32_t>(content.skins.size()), [&]() { writeSkins(w, content); });
+		addSection(5u, SectionType::ANIMATIONS, static_cast<uint32_t>(content.animations.size()), [&]() { writeAnimations(w, content); });
+
+		memcpy(&out[sectionsOffset], sections, sizeof(sections));
+
+		header.fileSize = out.size();
+		memcpy(out.data(), &header, sizeof(Header));
+
+		return out;
+	}
+
+	bool View::open(const std::byte* data, const size_t size) noexcept {
+		_header = nullptr;
+		if (data == nullptr || size < sizeof(Header) || (reinterpret_cast<uintptr_t>(data) % alignof(Header)) != 0u) return false;
+
+		const auto* header = reinterpret_cast<const Header*>(data);
+		if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion || header->fileSize > size) return false;
+		if ((size - sizeof(Header)) / sizeof(Section) < header->sectionsCount) return false;
+
+		_data = data;
+		_sections = std::span<const Section>(reinterpret_cast<const Section*>(data + sizeof(Header)), header->sectionsCount);
+
+		for (const Section& s : _sections) {
+			if (s.offset > size || s.size > size - s.offset || (s.offset % kAlignment) != 0u) return false;
+		}
+
+		const Section* vertices = section(SectionType::VERTICES);
+		const Section* indices = section(SectionType::INDICES);
+		const Section* primitives = section(SectionType::PRIMITIVES);
+		if (!vertices || !indices || !primitives) return false;
+
+		if (vertices->size != static_cast<uint64_t>(header->vertexCount) * header->vertexSize * sizeof(float) ||
+			indices->size != static_cast<uint64_t>(header->indexCount) * sizeof(uint32_t) ||
+			primitives->size != static_cast<uint64_t>(primitives->count) * sizeof(Primitive)) {
+			return false;
+		}
+
+		_vertices = reinterpret_cast<const float*>(data + vertices->offset);
+		_indices = reinterpret_cast<const uint32_t*>(data + indices->offset);
+		_primitives = std::span<const Primitive>(reinterpret_cast<const Primitive*>(data + primitives->offset), primitives->count);
+
+		for (const Primitive& p : _primitives) {
+			if (p.mesh >= header->meshesCount || p.firstIndex > header->indexCount || p.indexCount > header->indexCount - p.firstIndex) return false;
+		}
+
+		for (uint32_t i = 0u; i < header->indexCount; ++i) { // indices go to gpu as is
+			if (_indices[i] >= header->vertexCount) return false;
+		}
+
+		_header = header;
+		return true;
+	}
+
+	const Section* View::section(const SectionType type) const noexcept {
+		for (const Section& s : _sections) {
+			if (s.type == type) return &s;
+		}
+		return nullptr;
+	}
+
+	bool View::readNodes(std::vector<uint16_t>& sceneNodes, std::vector<gltf::Node>& nodes) const {
+		const Section* s = section(SectionType::NODES);
+		if (!s) return false;
+
+		Reader r(_data + s->offset, s->size);
+		if (!r.array(sceneNodes)) return false;
+
+		nodes.resize(s->count);
+		for (gltf::Node& node : nodes) {
+			NodeTransform t;
+			if (!r.string(node.name) || !r.pod(t) || !r.array(node.weights) || !r.array(node.children)) return false;
+
+			node.mesh = t.mesh;
+			node.skin = t.skin;
+			node.scale = gltf::vec3(t.scale[0u], t.scale[1u], t.scale[2u]);
+			node.translation = gltf::vec3(t.translation[0u], t.translation[1u], t.translation[2u]);
+			node.rotation = gltf::vec4(t.rotation[0u], t.rotation[1u], t.rotation[2u], t.rotation[3u]);
+		}
+
+		for (const uint16_t id : sceneNodes) {
+			if (id >= nodes.size()) return false;
+		}
+
+		const Section* skins = section(SectionType::SKINS);
+		const uint32_t skinsCount = skins ? skins->count : 0u;
+
+		for (const gltf::Node& node : nodes) {
+			if ((node.mesh != 0xffffu && node.mesh >= _header->meshesCount) || (node.skin != 0xffffu && node.skin >= skinsCount)) return false;
+			for (const uint16_t id : node.children) {
+				if (id >= nodes.size()) return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool View::readSkins(std::vector<engine::Mesh_Skin>& skins) const {
+		const Section* s = section(SectionType::SKINS);
+		if (!s) return false;
+
+		const Section* nodes = section(SectionType::NODES);
+		const uint32_t nodesCount = nodes ? nodes->count : 0u;
+
+		Reader r(_data + s->offset, s->size);
+		skins.resize(s->count);
+		for (engine::Mesh_Skin& skin : skins) {
+			uint32_t matricesCount;
+			if (!r.pod(skin.skeletonRoot) || !r.array(skin.joints) || !r.pod(matricesCount) || matricesCount > s->size / sizeof(Matrix)) return false;
+
+			skin.inverseBindMatrices.resize(matricesCount);
+			for (engine::mat4f& matrix : skin.inverseBindMatrices) {
+				Matrix m;
+				if (!r.pod(m)) return false;
+				for (uint32_t i = 0u; i < 16u; ++i) {
+					matrix[i / 4u][i % 4u] = m.m[i];
+				}
+			}
+
+			if (skin.skeletonRoot != 0xffffu && skin.skeletonRoot >= nodesCount) return false;
+			for (const uint16_t joint : skin.joints) {
+				if (joint >= nodesCount) return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool View::readAnimations(std::vector<engine::CompressedAnimation>& animations) const {
+		const Section* s = section(SectionType::ANIMATIONS);
+		if (!s) return false;
+
+		const Section* nodes = section(SectionType::NODES);
+		const uint32_t nodesCount = nodes ? nodes->count : 0u;
+
+		Reader r(_data + s->offset, s->size);
+		animations.resize(s->count);
+		for (engine::CompressedAnimation& animation : animations) {
+			uint32_t tracksCount;
+			if (!r.string(animation.name) || !r.pod(animation.start) || !r.pod(animation.end) || !r.pod(animation.duration) ||
+				!r.pod(animation.minTargetNodeId) || !r.pod(animation.maxTargetNodeId) ||
+				!r.pod(tracksCount) || tracksCount > s->size / sizeof(TrackData)) {
+				return false;
+			}
+
+			animation.tracks.resize(tracksCount);
+			for (auto& track : animation.tracks) {
+				TrackData t;
+				if (!r.pod(t) || t.path > static_cast<uint8_t>(engine::Mesh_Animation::AnimationChannelPath::WEIGHTS) ||
+					t.interpolation > static_cast<uint8_t>(engine::Mesh_Animation::Interpolation::CUBICSPLINE)) {
+					return false;
+				}
+
+				track.firstKey = t.firstKey;
+				track.keysCount = t.keysCount;
+				track.target_node = t.targetNode;
+				track.path = static_cast<engine::Mesh_Animation::AnimationChannelPath>(t.path);
+				track.interpolation = static_cast<engine::Mesh_Animation::Interpolation>(t.interpolation);
+				track.rangeMin = engine::vec3f(t.rangeMin[0u], t.rangeMin[1u], t.rangeMin[2u]);
+				track.rangeScale = engine::vec3f(t.rangeScale[0u], t.rangeScale[1u], t.rangeScale[2u]);
+				track.constant = engine::vec4f(t.constant[0u], t.constant[1u], t.constant[2u], t.constant[3u]);
+			}
+
+			if (!r.array(animation.times) || !r.array(animation.values)) return false;
+
+			for (const auto& track : animation.tracks) {
+				if (track.keysCount == 0u || track.target_node >= nodesCount ||
+					track.target_node < animation.minTargetNodeId || track.target_node > animation.maxTargetNodeId || // pose of animator is sized by the range
+					track.firstKey > animation.times.size() || track.keysCount > animation.times.size() - track.firstKey ||
+					animation.values.size() < (static_cast<size_t>(track.firstKey) + track.keysCount) * 3u) {
+					return false;
+				}
+			}
+
+			if (!animation.tracks.empty() && (animation.maxTargetNodeId >= nodesCount || animation.minTargetNodeId > animation.maxTargetNodeId)) return false;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../../Core/Math/mathematic.h"
+#include "AnimationCompression.h"
+#include "Loader_gltf.h"
+#include "MeshData.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// engine native mesh format (.j4m), written by Tools/meshConverter
+// file is a header, sections table and 16 bytes aligned sections:
+// vertices and indices are stored ready for gpu (interleaved for header semanticMask, as Mesh_Data::loadMeshes does for gltf),
+// so they can be copied from file data (read or mapped) straight into staging buffers;
+// nodes, skins and compressed animations are small serialized sections
+// numbers are little endian
+
+namespace j4m {
+
+	inline constexpr char kMagic[4u] = { 'J', '4', 'M', '\0' };
+	inline constexpr uint16_t kVersion = 2u; // 2: skins matrices and animation tracks are serialized field by field
+	inline constexpr uint32_t kAlignment = 16u;
+
+	enum class SectionType : uint32_t {
+		VERTICES = 0u,		// float[vertexCount * vertexSize]
+		INDICES = 1u,		// uint32_t[indexCount], relative to the first vertex of file
+		PRIMITIVES = 2u,	// Primitive[count]
+		NODES = 3u,
+		SKINS = 4u,
+		ANIMATIONS = 5u
+	};
+
+	struct Header {
+		char magic[4u];
+		uint16_t version;
+		uint16_t semanticMask;	// vertex attributes, in gltf::AttributesSemantic order
+		uint32_t vertexSize;	// in floats
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t meshesCount;
+		uint32_t sectionsCount;
+		uint32_t reserved;
+		uint64_t fileSize;
+	};
+
+	struct Section {
+		SectionType type;
+		uint32_t count;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	struct Primitive {
+		uint16_t mesh;
+		uint8_t mode;		// gltf::PrimitiveMode
+		uint8_t reserved;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float minCorner[3u];
+		float maxCorner[3u];
+	};
+
+	static_assert(sizeof(Header) == 40u && sizeof(Section) == 24u && sizeof(Primitive) == 36u);
+
+	struct Content {
+		uint16_t semanticMask = 0u;
+		uint32_t vertexSize = 0u;
+		uint32_t vertexCount = 0u;
+		uint32_t meshesCount = 0u;
+		std::span<const float> vertices;
+		std::span<const uint32_t> indices;
+		std::vector<Primitive> primitives;
+		std::vector<uint16_t> sceneNodes;
+		std::vector<gltf::Node> nodes;
+		std::vector<engine::Mesh_Skin> skins;
+		std::vector<engine::CompressedAnimation> animations;
+	};
+
+	std::vector<std::byte> write(const Content& content);
+
+	// view over file data, nothing is copied on open: vertices and indices point into data, which must outlive the view
+	class View {
+	public:
+		bool open(const std::byte* data, const size_t size) noexcept;
+
+		[[nodiscard]] inline const Header& header() const noexcept { return *_header; }
+		[[nodiscard]] inline const float* vertices() const noexcept { return _vertices; }
+		[[nodiscard]] inline const uint32_t* indices() const noexcept { return _indices; }
+		[[nodiscard]] inline std::span<const Primitive> primitives() const noexcept { return _primitives; }
+
+		bool readNodes(std::vector<uint16_t>& sceneNodes, std::vector<gltf::Node>& nodes) const;
+		bool readSkins(std::vector<engine::Mesh_Skin>& skins) const;
+		bool readAnimations(std::vector<engine::CompressedAnimation>& animations) const;
+
+	private:
+		[[nodiscard]] const Section* section(const SectionType type) const noexcept;
+
+		const std::byte* _data = nullptr;
+		const Header* _header = nullptr;
+		std::span<const Section> _sections;
+		const float* _vertices = nullptr;
+		const uint32_t* _indices = nullptr;
+		std::span<const Primitive> _primitives;
+	};
+}
@@ -2,8 +2,13 @@
 #include "Mesh.h"
 #include "MeshData.h"
 #include "Loader_gltf.h"
+#include "VertexQuantization.h"
 #include "../Render/RenderHelper.h"
 #include "AnimationTree.h"
+#include "SkeletonPoseCache.h"
+#include "SkeletonAnimationSystem.h"
+#include "../Graphics.h"
+#include "../Animation/AnimationManager.h"
 #include "../VertexAttributes.h"
 #include "../../Utils/Debug/Assert.h"
 #include <limits>
@@ -12,87 +17,87 @@ namespace engine {
 
 	void updateSkeletonAnimation(const CancellationToken& token, MeshSkeleton* skeleton, const float time, const Mesh_Animation* animation, const uint8_t updateFrame) {
         constexpr float epsilon = 1e-5f;
+
+		std::vector<uint32_t>& keys = skeleton->_animationKeys[updateFrame];
+		if (keys.size() != animation->samplers.size()) {
+			keys.assign(animation->samplers.size(), 0u);
+		}
+
 		for (const auto& channel : animation->channels) {
 			if (channel.sampler == 0xffff || channel.target_node == 0xffff) continue;
 
-			Mesh_Node& target = skeleton->getNode(updateFrame, channel.target_node);
 			const Mesh_Animation::AnimationSampler& sampler = animation->samplers[channel.sampler];
+			uint32_t& key = keys[channel.sampler];
+			if (!sampler.keyFrame(time, key)) continue;
 
-			for (size_t i = 0, sz = sampler.inputs.size() - 1; i < sz; ++i) {
-
-				const float t0 = sampler.inputs[i];
-				const float t1 = sampler.inputs[i + 1];
-
-				if ((time >= t0) && (time < t1)) {
-
-					const vec4f& v0 = sampler.outputs[i];
+			Mesh_Node& target = skeleton->getNode(updateFrame, channel.target_node);
 
-					switch (sampler.interpolation) {
-					case Mesh_Animation::Interpolation::LINEAR:
-					{
-						const vec4f& v1 = sampler.outputs[i + 1];
-						const float mix_c = (time - t0) / (t1 - t0);
-						switch (channel.path) {
-						case Mesh_Animation::AnimationChannelPath::TRANSLATION:
-						{
-							if (!compare(v0, v1, epsilon)) {
-								target.setTranslation(v0);
-							} else {
-								target.setTranslation(glm::mix(v0, v1, mix_c));
-							}
-						}
-						break;
-						case Mesh_Animation::AnimationChannelPath::ROTATION:
-						{
-							if (!compare(v0, v1, epsilon)) {
-								target.setRotation(quatf(v0.w, v0.x, v0.y, v0.z));
-							} else {
-								const quatf q1(v0.w, v0.x, v0.y, v0.z);
-								const quatf q2(v1.w, v1.x, v1.y, v1.z);
-								target.setRotation(glm::normalize(glm::slerp(q1, q2, mix_c)));
-							}
-						}
-						break;
-						case Mesh_Animation::AnimationChannelPath::SCALE:
-						{
-							if (!compare(v0, v1, epsilon)) {
-								target.setScale(v0);
-							} else {
-								target.setScale(glm::mix(v0, v1, mix_c));
-							}
-						}
-						break;
-						default:
-							break;
-						}
+			const float t0 = sampler.inputs[key];
+			const float t1 = sampler.inputs[key + 1];
+			const vec4f& v0 = sampler.outputs[key];
+
+			switch (sampler.interpolation) {
+			case Mesh_Animation::Interpolation::LINEAR:
+			{
+				const vec4f& v1 = sampler.outputs[key + 1];
+				const float mix_c = t1 > t0 ? (time - t0) / (t1 - t0) : 0.0f;
+				switch (channel.path) {
+				case Mesh_Animation::AnimationChannelPath::TRANSLATION:
+				{
+					if (!compare(v0, v1, epsilon)) {
+						target.setTranslation(v0);
+					} else {
+						target.setTranslation(glm::mix(v0, v1, mix_c));
 					}
-					break;
-					case Mesh_Animation::Interpolation::STEP:
-					{
-						switch (channel.path) {
-						case Mesh_Animation::AnimationChannelPath::TRANSLATION:
-							target.setTranslation(v0);
-							break;
-						case Mesh_Animation::AnimationChannelPath::ROTATION:
-							target.setRotation(quatf(v0.w, v0.x, v0.y, v0.z));
-							break;
-						case Mesh_Animation::AnimationChannelPath::SCALE:
-							target.setScale(v0);
-							break;
-						default:
-							break;
-						}
+				}
+				break;
+				case Mesh_Animation::AnimationChannelPath::ROTATION:
+				{
+					if (!compare(v0, v1, epsilon)) {
+						target.setRotation(quatf(v0.w, v0.x, v0.y, v0.z));
+					} else {
+						const quatf q1(v0.w, v0.x, v0.y, v0.z);
+						const quatf q2(v1.w, v1.x, v1.y, v1.z);
+						target.setRotation(glm::normalize(glm::slerp(q1, q2, mix_c)));
 					}
-					break;
-					case Mesh_Animation::Interpolation::CUBICSPLINE: // todo!
-						break;
-					default:
-						break;
+				}
+				break;
+				case Mesh_Animation::AnimationChannelPath::SCALE:
+				{
+					if (!compare(v0, v1, epsilon)) {
+						target.setScale(v0);
+					} else {
+						target.setScale(glm::mix(v0, v1, mix_c));
 					}
-
+				}
+				break;
+				default:
 					break;
 				}
 			}
+			break;
+			case Mesh_Animation::Interpolation::STEP:
+			{
+				switch (channel.path) {
+				case Mesh_Animation::AnimationChannelPath::TRANSLATION:
+					target.setTranslation(v0);
+					break;
+				case Mesh_Animation::AnimationChannelPath::ROTATION:
+					target.setRotation(quatf(v0.w, v0.x, v0.y, v0.z));
+					break;
+				case Mesh_Animation::AnimationChannelPath::SCALE:
+					target.setScale(v0);
+					break;
+				default:
+					break;
+				}
+			}
+			break;
+			case Mesh_Animation::Interpolation::CUBICSPLINE: // todo!
+				break;
+			default:
+				break;
+			}
 		}
 
 		if (token) {
@@ -107,6 +112,11 @@ namespace engine {
 	}
 
 	void updateSkeletonAnimationTree(const CancellationToken& token, MeshSkeleton* skeleton, MeshAnimationTree* animTree, const uint8_t updateFrame) {
+		if (skeleton->applySharedPose(animTree, updateFrame)) {
+			skeleton->setUpdatedFrameNum(updateFrame);
+			return;
+		}
+
 		animTree->calculate(updateFrame); // расчет scale, rotation, translation для нодов анимации
 		if (token) return;
 
@@ -120,10 +130,18 @@ namespace engine {
 			skeleton->updateSkins(updateFrame);
 		}
 
+		if (token) return;
+
+		skeleton->storeSharedPose(animTree, updateFrame);
         skeleton->setUpdatedFrameNum(updateFrame);
 	}
 
     void applyAnimationFrameToSkeleton(const CancellationToken& token, MeshSkeleton* skeleton, MeshAnimationTree* animTree, const uint8_t updateFrame) {
+		if (skeleton->applySharedPose(animTree, updateFrame)) {
+			skeleton->setUpdatedFrameNum(updateFrame);
+			return;
+		}
+
         animTree->apply(skeleton, updateFrame);
 
         if (token) return;
@@ -134,6 +152,9 @@ namespace engine {
             skeleton->updateSkins(updateFrame);
         }
 
+		if (token) return;
+
+		skeleton->storeSharedPose(animTree, updateFrame);
 		skeleton->setUpdatedFrameNum(updateFrame);
     }
 
@@ -142,6 +163,8 @@ namespace engine {
 		_nodes(latency),
 		_skinsMatrices(latency),
 		_animCalculationResult(latency),
+		_animationJobs(latency),
+		_animationKeys(latency),
 		_latency(latency)
 	{
 		for (uint8_t i = 0u; i < _latency; ++i) {
@@ -172,8 +195,20 @@ namespace engine {
 	}
 
 	MeshSkeleton::~MeshSkeleton() {
+		if (_animationSystem) {
+			_animationSystem->remove(this);
+		}
+
+		// batch task is shared with other skeletons, only job of this skeleton is taken away from it
 		for (size_t i = 0u; i < _latency; ++i) {
-			if (_animCalculationResult[i]) { _animCalculationResult[i]->cancel(); }
+			if (_animationJobs[i]) {
+				SkeletonAnimationSystem::releaseJob(*_animationJobs[i]);
+			} else if (_animCalculationResult[i]) {
+				_animCalculationResult[i]->cancel();
+				if (_animCalculationResult[i]->state() == TaskState::RUN) {
+					_animCalculationResult[i]->wait();
+				}
+			}
 		}
 	}
 
@@ -206,6 +241,7 @@ namespace engine {
 		const float atime = animation->start + currentAnimTime;
 
 		//_animCalculationResult[_updateFrameNum] = Engine::getInstance().getModule<ThreadPool>()->enqueue(TaskType::COMMON, 0, updateSkeletonAnimation, this, atime, animation, _updateFrameNum);
+		_animationJobs[_updateFrameNum].reset();
 		_animCalculationResult[_updateFrameNum] = Engine::getInstance().getModule<ThreadPool2>().enqueue(TaskType::COMMON, updateSkeletonAnimation, this, atime, animation, _updateFrameNum);
 	}
 
@@ -217,6 +253,7 @@ namespace engine {
 		animTree->update(time, _updateFrameNum); // просто пересчет времени
 
 		//_animCalculationResult[_updateFrameNum] = Engine::getInstance().getModule<ThreadPool>()->enqueue(TaskType::COMMON, 0, updateSkeletonAnimationTree, this, animTree, _updateFrameNum);
+		_animationJobs[_updateFrameNum].reset();
 		_animCalculationResult[_updateFrameNum] = Engine::getInstance().getModule<ThreadPool2>().enqueue(TaskType::COMMON, updateSkeletonAnimationTree, this, animTree, _updateFrameNum);
 	}
 
@@ -233,8 +270,7 @@ namespace engine {
             }
 
             _updateFrameNum = frameNum;
-            _animCalculationResult[_updateFrameNum] = Engine::getInstance().getModule<ThreadPool2>().enqueue(
-                    TaskType::COMMON, applyAnimationFrameToSkeleton, this, animTree, _updateFrameNum);
+            Engine::getInstance().getModule<Graphics>().getAnimationManager()->getSkeletonAnimationSystem().submit(this, animTree, _updateFrameNum);
         }
     }
 
@@ -269,6 +305,91 @@ namespace engine {
 		}
 	}
 
+	bool MeshSkeleton::applySharedPose(const MeshAnimationTree* animTree, const uint8_t updateFrame) {
+		const void* animation = nullptr;
+		float time = 0.0f;
+		if (_poseCache == nullptr || !animTree->poseState(updateFrame, animation, time)) return false;
+
+		const auto pose = _poseCache->find(_poseCache->makeKey(&_skins, animation, time, _useRootTransform));
+		if (!pose) return false;
+
+		auto& nodes = _nodes[updateFrame];
+		for (size_t i = 0u, sz = nodes.size(); i < sz; ++i) {
+			Mesh_Node& node = nodes[i];
+			node.modelMatrix = pose->nodesMatrices[i];
+			node.dirtyModelTransform = true;
+			node.dirtyLocalTransform = true; // full recalculation, when skeleton calculates own pose again
+		}
+
+		auto& skinsMatrices = _skinsMatrices[updateFrame];
+		for (size_t i = 0u, sz = skinsMatrices.size(); i < sz; ++i) {
+			memcpy(skinsMatrices[i].data(), pose->skinsMatrices[i].data(), skinsMatrices[i].size() * sizeof(mat4f));
+		}
+
+		_dirtySkins = true;
+		return true;
+	}
+
+	void MeshSkeleton::storeSharedPose(const MeshAnimationTree* animTree, const uint8_t updateFrame) {
+		const void* animation = nullptr;
+		float time = 0.0f;
+		if (_poseCache == nullptr || !animTree->poseState(updateFrame, animation, time)) return;
+
+		auto pose = std::make_shared<SkeletonPoseCache::Pose>();
+
+		const auto& nodes = _nodes[updateFrame];
+		pose->nodesMatrices.resize(nodes.size());
+		for (size_t i = 0u, sz = nodes.size(); i < sz; ++i) {
+			pose->nodesMatrices[i] = nodes[i].modelMatrix;
+		}
+
+		pose->skinsMatrices = _skinsMatrices[updateFrame];
+
+		_poseCache->store(_poseCache->makeKey(&_skins, animation, time, _useRootTransform), std::move(pose));
+	}
+
+	void MeshSkeleton::storeLodPose(const uint8_t updateFrame) {
+		std::swap(_lod.poses[0u], _lod.poses[1u]);
+		std::vector<mat4f>& pose = _lod.poses[1u];
+		pose.clear();
+
+		for (const Mesh_Node& node : _nodes[updateFrame]) {
+			pose.push_back(node.modelMatrix);
+		}
+
+		for (const auto& skinMatrices : _skinsMatrices[updateFrame]) {
+			pose.insert(pose.end(), skinMatrices.begin(), skinMatrices.end());
+		}
+
+		_lod.storedPoses = std::min(_lod.storedPoses + 1u, 2u);
+	}
+
+	void MeshSkeleton::interpolateLodPose(const uint8_t updateFrame, const float alpha) {
+		// linear matrices interpolation, poses of sparse updates are close enough for it
+		// result is delayed by one update interval: it goes from previous to the last evaluated pose
+		if (_lod.storedPoses < 2u) return;
+
+		const mat4f* p0 = _lod.poses[0u].data();
+		const mat4f* p1 = _lod.poses[1u].data();
+
+		for (Mesh_Node& node : _nodes[updateFrame]) {
+			node.modelMatrix = *p0 + (*p1 - *p0) * alpha;
+			node.dirtyModelTransform = true;
+			node.dirtyLocalTransform = true; // full recalculation on next evaluation
+			++p0; ++p1;
+		}
+
+		for (auto& skinMatrices : _skinsMatrices[updateFrame]) {
+			for (mat4f& m : skinMatrices) {
+				m = *p0 + (*p1 - *p0) * alpha;
+				++p0; ++p1;
+			}
+		}
+
+		_dirtySkins = true;
+		setUpdatedFrameNum(updateFrame);
+	}
+
 	void MeshSkeleton::updateTransforms(const uint8_t updateFrame) {
 		for (auto & node : _nodes[updateFrame]) {
 			node.dirtyModelTransform = false;
@@ -293,6 +414,8 @@ namespace engine {
         uint8_t primitiveMode = 0xffu;
 		_renderDescriptor.renderData.reserve(renderDataCount);
 
+		const VkIndexType indexType = _meshData->indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
 		for (size_t i = 0u; i < renderDataCount; ++i) {
             auto & r_data = _renderDescriptor.renderData.emplace_back(std::make_unique<vulkan::RenderData>());
             const size_t partsCount = _meshData->renderData[i].layouts.size();
@@ -310,9 +433,10 @@ namespace engine {
 													layout.firstIndex,	// firstIndex
 													layout.indexCount,	// indexCount
 													0u,					// vertexCount (parameter no used with indexed render)
-													0u,					// firstVertex
+													layout.firstVertex,	// firstVertex
 													layout.vbOffset,	// vbOffset
-													layout.ibOffset		// ibOffset
+													layout.ibOffset,	// ibOffset
+													indexType			// indexType
 				};
 
 				// min & max corners calculation
@@ -393,20 +517,47 @@ namespace engine {
 //	std::vector<VkVertexInputAttributeDescription> Mesh::getVertexInputAttributes() const {
     VertexAttributes Mesh::getVertexInputAttributes() const {
         VertexAttributes attributes;
+		const uint8_t quantization = _meshData ? _meshData->quantizationMask : 0u;
 		for (uint8_t i = 0u; i < std::min(static_cast<uint8_t>(16u), static_cast<uint8_t>(gltf::AttributesSemantic::SEMANTICS_COUNT)); ++i) {
 			if (_semanticMask & (1u << i)) {
 				switch (static_cast<gltf::AttributesSemantic>(i)) {
 					case gltf::AttributesSemantic::POSITION:
+					{
+						if (hasQuantization(quantization, VertexQuantization::POSITION_SNORM16)) {
+							attributes.set<int16_t, 0u>(4u, true);
+						} else if (hasQuantization(quantization, VertexQuantization::POSITION_HALF)) {
+							attributes.set<HalfFloat, 0u>(4u);
+						} else {
+							attributes.set<float, 0u>(3u);
+						}
+					}
+						break;
 					case gltf::AttributesSemantic::NORMAL:
 					{
-                        attributes.set<float, 0u>(3u);
+						if (hasQuantization(quantization, VertexQuantization::NORMAL_OCTAHEDRAL)) {
+							attributes.set<int16_t, 0u>(2u, true);
+						} else {
+							attributes.set<float, 0u>(3u);
+						}
 					}
 						break;
 					case gltf::AttributesSemantic::TANGENT:
+					{
+						if (hasQuantization(quantization, VertexQuantization::NORMAL_OCTAHEDRAL)) {
+							attributes.set<int16_t, 0u>(4u, true);
+						} else {
+							attributes.set<float, 0u>(4u);
+						}
+					}
+						break;
 					case gltf::AttributesSemantic::JOINTS:
 					case gltf::AttributesSemantic::WEIGHT:
 					{
-                        attributes.set<float, 0u>(4u);
+						if (hasQuantization(quantization, VertexQuantization::SKIN_8)) { // joints - uint, weights - unorm
+							attributes.set<uint8_t, 0u>(4u, static_cast<gltf::AttributesSemantic>(i) == gltf::AttributesSemantic::WEIGHT);
+						} else {
+							attributes.set<float, 0u>(4u);
+						}
 					}
 						break;
                     case gltf::AttributesSemantic::COLOR:
@@ -420,7 +571,11 @@ namespace engine {
 					case gltf::AttributesSemantic::TEXCOORD_3:
 					case gltf::AttributesSemantic::TEXCOORD_4:
 					{
-                        attributes.set<float, 0u>(2u);
+						if (hasQuantization(quantization, VertexQuantization::TEXCOORD_UNORM16)) {
+							attributes.set<uint16_t, 0u>(2u, true);
+						} else {
+							attributes.set<float, 0u>(2u);
+						}
 					}
 						break;
 					default:
@@ -462,6 +617,9 @@ namespace engine {
 			r_data->setParamForLayout(_fixedGpuLayouts[0u].first, &const_cast<mat4f&>(cameraMatrix), false, 1u);
 
 			mat4f model = worldMatrix * node.modelMatrix;
+			if (node.skinIndex == 0xff'ffu && hasQuantization(_meshData->quantizationMask, VertexQuantization::POSITION_SNORM16)) {
+				model *= _meshData->positionDequantization; // skinned vertices have it in skin matrices
+			}
 			r_data->setParamForLayout(_fixedGpuLayouts[1u].first, &model, true, 1u);
 
 			r_data->prepareRender(/*commandBuffer*/);
@@ -473,6 +631,12 @@ namespace engine {
 		if (!_skeleton) return;
         _skeleton->_requestAnimUpdate = true;
 
+		if (worldMatrixChanged) {
+			const vec3f halfSize = (_maxCorner - _minCorner) * 0.5f;
+			const float scale = std::max(std::max(glm::length(vec3f(worldMatrix[0u])), glm::length(vec3f(worldMatrix[1u]))), glm::length(vec3f(worldMatrix[2u])));
+			_skeleton->setLodBounds(vec3f(worldMatrix * vec4f(_minCorner + halfSize, 1.0f)), glm::length(halfSize) * scale);
+		}
+
 		_modelMatrixChanged |= worldMatrixChanged;
 
         // old variant
@@ -507,6 +671,9 @@ namespace engine {
 
 			if (node.dirtyModelTransform || _modelMatrixChanged) {
 				mat4f model = worldMatrix * node.modelMatrix;
+				if (node.skinIndex == 0xff'ffu && hasQuantization(_meshData->quantizationMask, VertexQuantization::POSITION_SNORM16)) {
+					model *= _meshData->positionDequantization; // skinned vertices have it in skin matrices
+				}
 				r_data->setParamForLayout(_fixedGpuLayouts[1u].first, &model, true, 1u);
 			}
 		}
@@ -12,6 +12,8 @@
 namespace engine {
 
 	class MeshAnimationTree;
+	class SkeletonPoseCache;
+	class SkeletonAnimationSystem;
 
 	struct Mesh_Node {
         inline static constexpr float epsilon = 1e-5f;
@@ -95,6 +97,7 @@ namespace engine {
 
 	class MeshSkeleton {
 		friend class Mesh;
+		friend class SkeletonAnimationSystem;
 		friend void updateSkeletonAnimation(const CancellationToken& token, MeshSkeleton* skeleton, const float time, const Mesh_Animation* animation, const uint8_t updateFrame);
 		friend void updateSkeletonAnimationTree(const CancellationToken& token, MeshSkeleton* skeleton, MeshAnimationTree* animTree, const uint8_t updateFrame);
         friend void applyAnimationFrameToSkeleton(const CancellationToken& token, MeshSkeleton* skeleton, MeshAnimationTree* animTree, const uint8_t updateFrame);
@@ -141,6 +144,22 @@ namespace engine {
         [[nodiscard]] inline uint8_t getLatency() const noexcept { return _latency; }
         [[nodiscard]] inline bool dirtySkins() const noexcept { return _dirtySkins; }
 
+		[[nodiscard]] inline const std::vector<mat4f>& getSkinMatrices(const uint8_t frame, const uint16_t skinId) const noexcept {
+			return _skinsMatrices[frame][skinId];
+		}
+
+		// skeletons with the same pose cache share evaluated poses for single clip animation trees
+		// (skeleton nodes must not be modified outside of animation)
+		inline void setPoseCache(SkeletonPoseCache* cache) noexcept { _poseCache = cache; }
+		[[nodiscard]] inline SkeletonPoseCache* getPoseCache() const noexcept { return _poseCache; }
+
+		// world bounds for animation update rate tiers (see SkeletonAnimationSystem), set by mesh render data update
+		inline void setLodBounds(const vec3f& center, const float radius) noexcept {
+			_lod.center = center;
+			_lod.radius = radius;
+		}
+		[[nodiscard]] inline uint8_t getLodInterval() const noexcept { return _lod.interval; }
+
 		inline void setUseRootTransform(const bool use) noexcept { _useRootTransform = use; }
 		[[nodeiscard]] inline bool getUseRootTransform() const noexcept { return _useRootTransform; }
 
@@ -150,6 +169,12 @@ namespace engine {
 		void updateSkins(const uint8_t updateFrame);
 		void updateTransforms(const uint8_t updateFrame);
 
+		bool applySharedPose(const MeshAnimationTree* animTree, const uint8_t updateFrame);
+		void storeSharedPose(const MeshAnimationTree* animTree, const uint8_t updateFrame);
+
+		void storeLodPose(const uint8_t updateFrame);
+		void interpolateLodPose(const uint8_t updateFrame, const float alpha);
+
         inline void setUpdatedFrameNum(const uint8_t frame) noexcept {
             _updatedFrameNum.store(frame, std::memory_order_relaxed);
         }
@@ -162,6 +187,21 @@ namespace engine {
 
 		std::vector<std::vector<std::vector<mat4f>>> _skinsMatrices;
 		std::vector<linked_ptr<Task2<void>>> _animCalculationResult;
+		std::vector<std::shared_ptr<std::atomic_uint8_t>> _animationJobs; // job states in animation system batches, empty for own tasks
+		std::vector<std::vector<uint32_t>> _animationKeys; // per latency frame sampler key cursors for simple animation update
+		SkeletonPoseCache* _poseCache = nullptr;
+		SkeletonAnimationSystem* _animationSystem = nullptr; // set while frame is waiting for batch dispatch
+
+		struct AnimationLod {
+			vec3f center = vec3f(0.0f);
+			float radius = 0.0f;
+			uint32_t evaluationTick = 0u;	// animation system tick of the last full evaluation
+			uint8_t interval = 1u;			// ticks between full evaluations
+			bool interpolate = false;		// pose between full evaluations is interpolated, otherwise it steps
+			uint8_t storedPoses = 0u;
+			bool carried = false;			// due evaluation is carried to the next tick over budget
+			std::vector<mat4f> poses[2u];	// nodes and skins matrices of two last full evaluations
+		} _lod;
 
 		uint8_t _latency = 1u;
 		uint8_t _updateFrameNum = 0u;
@@ -1,13 +1,316 @@
 #include "MeshData.h"
 #include "Loader_gltf.h"
+#include "Loader_j4m.h"
+#include "VertexQuantization.h"
 #include "../../Core/Engine.h"
 #include "../Graphics.h"
 #include "../Vulkan/vkRenderer.h"
+#include "../../Core/AssetManager.h"
+#include "../../Core/Threads/ParallelFor.h"
+#include "../Render/IndexPacking.h"
+
+#include <cstring>
 
 namespace engine {
 
+	namespace {
+		// vertices of primitive are filled with one strided pass per attribute, ranges of vertices and indices are filled in parallel
+		struct InterleaveAttribute {
+			enum class Kind : uint8_t {
+				COPY = 0u,
+				JOINTS = 1u,	// uint16 x 4 -> float
+				COLOR = 2u,		// float x 4 -> packed rgba8 in first component
+				WEIGHT = 3u		// no data: first weight = 1.0f
+			};
+
+			const void* data;
+			uint32_t offset;	// in floats inside vertex
+			uint32_t dimension;
+			Kind kind;
+		};
+
+		// interleaved float vertex -> quantized vertex (VertexQuantization.h)
+		struct QuantizeAttribute {
+			enum class Kind : uint8_t {
+				COPY = 0u,
+				POSITION_HALF = 1u,
+				POSITION_SNORM16 = 2u,
+				NORMAL_OCTAHEDRAL = 3u,
+				TANGENT_OCTAHEDRAL = 4u,
+				TEXCOORD_UNORM16 = 5u,
+				JOINTS_8 = 6u,
+				WEIGHTS_8 = 7u
+			};
+
+			uint32_t srcOffset;	// in floats inside interleaved vertex
+			uint32_t dstOffset;	// in 32 bit words inside quantized vertex
+			uint32_t size;		// in 32 bit words
+			Kind kind;
+		};
+
+		struct InterleavePrimitive {
+			size_t firstFloat;
+			uint32_t vertexSize;		// stored vertex, in 32 bit words
+			uint32_t interleavedSize;	// interleaved float vertex, differs from vertexSize for quantized vertices only
+			uint32_t vertexCount;
+			uint32_t attributesBegin;
+			uint32_t attributesEnd;
+			uint32_t quantizeBegin;
+			uint32_t quantizeEnd;
+
+			const uint8_t* indexData;
+			gltf::AccessorComponentType indexType;
+			uint32_t firstIndex;	// even for 16 bit indices, so jobs never share 32 bit words of index buffer
+			uint32_t indexCount;
+		};
+
+		struct InterleaveJob {
+			uint32_t primitive;
+			uint32_t begin;
+			uint32_t end;
+			bool indices;
+		};
+
+		struct InterleaveData {
+			const InterleaveAttribute* attributes;
+			const QuantizeAttribute* quantize;
+			vec4f positionBounds;	// center, scale for POSITION_SNORM16
+			float* vertices;
+			uint32_t* indices;		// packed indices of indexSize bytes
+			uint8_t indexSize;
+		};
+
+		constexpr uint32_t kInterleaveVerticesPerJob = 4096u;
+		constexpr uint32_t kInterleaveIndicesPerJob = 16384u;
+
+		template <uint32_t N>
+		inline void copyStrided(float* dst, const uint32_t stride, const float* src, const uint32_t begin, const uint32_t end) {
+			for (uint32_t v = begin; v < end; ++v) {
+				for (uint32_t c = 0u; c < N; ++c) {
+					dst[static_cast<size_t>(v - begin) * stride + c] = src[static_cast<size_t>(v) * N + c];
+				}
+			}
+		}
+
+		inline void copyStrided(float* dst, const uint32_t stride, const float* src, const uint32_t n, const uint32_t begin, const uint32_t end) {
+			for (uint32_t v = begin; v < end; ++v) {
+				memcpy(&dst[static_cast<size_t>(v - begin) * stride], &src[static_cast<size_t>(v) * n], n * sizeof(float));
+			}
+		}
+
+		void interleaveAttribute(float* dst, const uint32_t stride, const InterleaveAttribute& a, const uint32_t begin, const uint32_t end) {
+			dst += a.offset;
+			switch (a.kind) {
+				case InterleaveAttribute::Kind::COPY:
+				{
+					const auto* src = static_cast<const float*>(a.data);
+					switch (a.dimension) {
+						case 2u: copyStrided<2u>(dst, stride, src, begin, end); break;
+						case 3u: copyStrided<3u>(dst, stride, src, begin, end); break;
+						case 4u: copyStrided<4u>(dst, stride, src, begin, end); break;
+						default: copyStrided(dst, stride, src, a.dimension, begin, end); break;
+					}
+				}
+					break;
+				case InterleaveAttribute::Kind::JOINTS:
+				{
+					const auto* src = static_cast<const uint16_t*>(a.data);
+					for (uint32_t v = begin; v < end; ++v) {
+						for (uint32_t c = 0u; c < 4u; ++c) {
+							dst[static_cast<size_t>(v - begin) * stride + c] = static_cast<float>(src[static_cast<size_t>(v) * 4u + c]);
+						}
+					}
+				}
+					break;
+				case InterleaveAttribute::Kind::COLOR:
+				{
+					const auto* src = static_cast<const float*>(a.data);
+					for (uint32_t v = begin; v < end; ++v) {
+						const float* c = &src[static_cast<size_t>(v) * 4u];
+						const uint32_t color = static_cast<uint8_t>(c[0] * 255.0f) << 24 |
+											   static_cast<uint8_t>(c[1] * 255.0f) << 16 |
+											   static_cast<uint8_t>(c[2] * 255.0f) << 8 |
+											   static_cast<uint8_t>(c[3] * 255.0f) << 0;
+						dst[static_cast<size_t>(v - begin) * stride] = static_cast<float>(color);
+					}
+				}
+					break;
+				case InterleaveAttribute::Kind::WEIGHT:
+					for (uint32_t v = begin; v < end; ++v) {
+						dst[static_cast<size_t>(v - begin) * stride] = 1.0f;
+					}
+					break;
+			}
+		}
+
+		template <typename T, typename D>
+		inline void copyIndices(uint8_t* dst, const uint8_t* src, const uint32_t begin, const uint32_t end) {
+			for (uint32_t i = begin; i < end; ++i) {
+				T v;
+				memcpy(&v, src + static_cast<size_t>(i) * sizeof(T), sizeof(T)); // gltf data is little endian, as all targets
+				const auto d = static_cast<D>(v);
+				memcpy(dst + static_cast<size_t>(i) * sizeof(D), &d, sizeof(D));
+			}
+		}
+
+		template <typename T>
+		inline void convertIndices(uint8_t* dst, const uint8_t indexSize, const uint8_t* src, const uint32_t begin, const uint32_t end) {
+			if (indexSize == sizeof(uint16_t)) {
+				copyIndices<T, uint16_t>(dst, src, begin, end);
+			} else {
+				copyIndices<T, uint32_t>(dst, src, begin, end);
+			}
+		}
+
+		QuantizeAttribute quantizeAttribute(const gltf::AttributesSemantic semantic, const uint32_t dimension, const uint8_t mask) {
+			using Kind = QuantizeAttribute::Kind;
+			switch (semantic) {
+				case gltf::AttributesSemantic::POSITION:
+					if (hasQuantization(mask, VertexQuantization::POSITION_SNORM16)) return { 0u, 0u, 2u, Kind::POSITION_SNORM16 };
+					if (hasQuantization(mask, VertexQuantization::POSITION_HALF)) return { 0u, 0u, 2u, Kind::POSITION_HALF };
+					break;
+				case gltf::AttributesSemantic::NORMAL:
+					if (hasQuantization(mask, VertexQuantization::NORMAL_OCTAHEDRAL)) return { 0u, 0u, 1u, Kind::NORMAL_OCTAHEDRAL };
+					break;
+				case gltf::AttributesSemantic::TANGENT:
+					if (hasQuantization(mask, VertexQuantization::NORMAL_OCTAHEDRAL)) return { 0u, 0u, 2u, Kind::TANGENT_OCTAHEDRAL };
+					break;
+				case gltf::AttributesSemantic::JOINTS:
+					if (hasQuantization(mask, VertexQuantization::SKIN_8)) return { 0u, 0u, 1u, Kind::JOINTS_8 };
+					break;
+				case gltf::AttributesSemantic::WEIGHT:
+					if (hasQuantization(mask, VertexQuantization::SKIN_8)) return { 0u, 0u, 1u, Kind::WEIGHTS_8 };
+					break;
+				case gltf::AttributesSemantic::COLOR:
+					return { 0u, 0u, 1u, Kind::COPY }; // packed rgba8 in the first component, as Mesh::getVertexInputAttributes describes it
+				case gltf::AttributesSemantic::TEXCOORD_0:
+				case gltf::AttributesSemantic::TEXCOORD_1:
+				case gltf::AttributesSemantic::TEXCOORD_2:
+				case gltf::AttributesSemantic::TEXCOORD_3:
+				case gltf::AttributesSemantic::TEXCOORD_4:
+					if (hasQuantization(mask, VertexQuantization::TEXCOORD_UNORM16)) return { 0u, 0u, 1u, Kind::TEXCOORD_UNORM16 };
+					break;
+				default:
+					break;
+			}
+
+			return { 0u, 0u, dimension, Kind::COPY };
+		}
+
+		void quantize(const float* src, const uint32_t srcStride, float* dst, const uint32_t dstStride, const QuantizeAttribute& a, const vec4f& positionBounds, const uint32_t count) {
+			using namespace quantization;
+			using Kind = QuantizeAttribute::Kind;
+
+			src += a.srcOffset;
+			dst += a.dstOffset;
+
+			for (uint32_t v = 0u; v < count; ++v, src += srcStride, dst += dstStride) {
+				switch (a.kind) {
+					case Kind::COPY:
+						memcpy(dst, src, a.size * sizeof(float));
+						break;
+					case Kind::POSITION_HALF:
+					{
+						const uint16_t q[4u] = { halfBits(src[0u]), halfBits(src[1u]), halfBits(src[2u]), halfBits(1.0f) };
+						store(dst, q);
+					}
+						break;
+					case Kind::POSITION_SNORM16:
+					{
+						const float scale = 1.0f / positionBounds.w;
+						const int16_t q[4u] = {
+							snorm16((src[0u] - positionBounds.x) * scale),
+							snorm16((src[1u] - positionBounds.y) * scale),
+							snorm16((src[2u] - positionBounds.z) * scale),
+							32767
+						};
+						store(dst, q);
+					}
+						break;
+					case Kind::NORMAL_OCTAHEDRAL:
+					{
+						const vec2f e = octahedral(src[0u], src[1u], src[2u]);
+						const int16_t q[2u] = { snorm16(e.x), snorm16(e.y) };
+						store(dst, q);
+					}
+						break;
+					case Kind::TANGENT_OCTAHEDRAL:
+					{
+						const vec2f e = octahedral(src[0u], src[1u], src[2u]);
+						const int16_t q[4u] = { snorm16(e.x), snorm16(e.y), snorm16(src[3u] < 0.0f ? -1.0f : 1.0f), 0 };
+						store(dst, q);
+					}
+						break;
+					case Kind::TEXCOORD_UNORM16:
+					{
+						const uint16_t q[2u] = { unorm16(src[0u]), unorm16(src[1u]) };
+						store(dst, q);
+					}
+						break;
+					case Kind::JOINTS_8:
+					{
+						uint8_t q[4u];
+						for (uint8_t c = 0u; c < 4u; ++c) {
+							q[c] = static_cast<uint8_t>(std::min(src[c], 255.0f));
+						}
+						store(dst, q);
+					}
+						break;
+					case Kind::WEIGHTS_8:
+					{
+						uint8_t q[4u];
+						weights8(src, q);
+						store(dst, q);
+					}
+						break;
+				}
+			}
+		}
+
+		void interleave(const InterleaveJob& job, const InterleavePrimitive& p, const InterleaveData& data) {
+			if (job.indices) {
+				uint8_t* dst = reinterpret_cast<uint8_t*>(data.indices) + static_cast<size_t>(p.firstIndex) * data.indexSize;
+				switch (p.indexType) {
+					case gltf::AccessorComponentType::UNSIGNED_INT:
+						convertIndices<uint32_t>(dst, data.indexSize, p.indexData, job.begin, job.end);
+						break;
+					case gltf::AccessorComponentType::UNSIGNED_SHORT:
+						convertIndices<uint16_t>(dst, data.indexSize, p.indexData, job.begin, job.end);
+						break;
+					case gltf::AccessorComponentType::UNSIGNED_BYTE:
+						convertIndices<uint8_t>(dst, data.indexSize, p.indexData, job.begin, job.end);
+						break;
+					default:
+						break;
+				}
+				return;
+			}
+
+			float* vertices = data.vertices + p.firstFloat + static_cast<size_t>(job.begin) * p.vertexSize;
+
+			if (p.quantizeBegin == p.quantizeEnd) {
+				for (uint32_t a = p.attributesBegin; a < p.attributesEnd; ++a) {
+					interleaveAttribute(vertices, p.vertexSize, data.attributes[a], job.begin, job.end);
+				}
+				return;
+			}
+
+			// interleave range of vertices to floats, then quantize it to the place
+			thread_local std::vector<float> interleaved;
+			interleaved.assign(static_cast<size_t>(job.end - job.begin) * p.interleavedSize, 0.0f);
+
+			for (uint32_t a = p.attributesBegin; a < p.attributesEnd; ++a) {
+				interleaveAttribute(interleaved.data(), p.interleavedSize, data.attributes[a], job.begin, job.end);
+			}
+
+			for (uint32_t a = p.quantizeBegin; a < p.quantizeEnd; ++a) {
+				quantize(interleaved.data(), p.interleavedSize, vertices, p.vertexSize, data.quantize[a], data.positionBounds, job.end - job.begin);
+			}
+		}
+	}
+
 	size_t Mesh_Data::loadMeshes(const gltf::Layout& layout, const std::vector<gltf::AttributesSemantic>& allowedAttributes,
-		size_t& vbOffset, const size_t ibOffset, const bool useOffsetsInRenderData) {
+		size_t& vbOffset, const size_t ibOffset, const bool useOffsetsInRenderData, const CancellationToken* token) {
 
 		size_t vertex_offset = 0u;
 
@@ -23,15 +326,37 @@ namespace engine {
 			std::vector<uint8_t> buffersDimensions(semanticsCount);
 			std::vector<bool> allowedAttributesFound(allowedAttributesCount);
 
+			std::vector<InterleaveAttribute> attributes;
+			std::vector<QuantizeAttribute> quantizeAttributes;
+			std::vector<InterleavePrimitive> primitives;
+			std::vector<InterleaveJob> jobs;
+
+			vec3f positionsMin(std::numeric_limits<float>::max());
+			vec3f positionsMax(std::numeric_limits<float>::lowest());
+
+			// indices are local for primitive (render part firstVertex is added to them), so 16 bit ones are used if every primitive fits them
+			uint32_t maxPrimitiveVertexCount = 0u;
+			for (auto&& mesh : gltf_meshes) {
+				for (auto&& primitive : mesh.primitives) {
+					if (auto it = primitive.attributes.find(gltf::AttributesSemantic::POSITION); it != primitive.attributes.end()) {
+						maxPrimitiveVertexCount = std::max(maxPrimitiveVertexCount, layout.accessors[it->second].count);
+					}
+				}
+			}
+			indexSize = indexSizeForVertexCount(maxPrimitiveVertexCount);
+
 			uint32_t commonVertexCount = 0u;
+			size_t vertexBufferSize = vertexBuffer.size();
+			size_t indexBufferSize = indexCount;
 
+			// layout of vertices and indices, data is filled after
 			for (auto&& mesh : gltf_meshes) {
 				meshes.emplace_back(); // insert object with default constructor
 				MeshRenderParams render_data;
 
 				for (auto&& primitive : mesh.primitives) {
-					const auto firstIndex = static_cast<uint32_t>(indexBuffer.size());
-					const auto firstVertex = static_cast<uint32_t>(vertexBuffer.size());
+					const auto firstIndex = static_cast<uint32_t>(indexSize == sizeof(uint16_t) ? (indexBufferSize + 1u) & ~size_t(1u) : indexBufferSize);
+					const auto firstVertex = static_cast<uint32_t>(vertexBufferSize);
 
 					uint32_t mesh_vertexCount = 0u;
 					uint32_t mesh_indexCount = 0u;
@@ -120,75 +445,70 @@ namespace engine {
 						}
 					}
 
-					vertexBuffer.resize(firstVertex + mesh_vertexSize * mesh_vertexCount);
-
+					// attributes order inside vertex: allowed attributes order (missed ones are defaults) or all attributes in semantics order
+					const auto attributesBegin = static_cast<uint32_t>(attributes.size());
 					uint32_t idx = 0u;
 
 					if (allowedAttributesCount != 0u) { // use only allowed attributes
-						for (size_t v = 0u; v < mesh_vertexCount; ++v) {
-							for (uint8_t i = 0u; i < allowedAttributesCount; ++i) {
-								const auto a_idx = static_cast<uint8_t>(allowedAttributes[i]);
-								const uint32_t dataSize = buffersDimensions[a_idx];
-
-								if (const float* buffer = buffers[a_idx]) {
-									if (a_idx == static_cast<uint8_t>(gltf::AttributesSemantic::JOINTS)) {
-										const auto* jointIndicesBuffer = reinterpret_cast<const uint16_t*>(buffer);
-										vertexBuffer[firstVertex + idx + 0] = jointIndicesBuffer[v * 4 + 0];
-										vertexBuffer[firstVertex + idx + 1] = jointIndicesBuffer[v * 4 + 1];
-										vertexBuffer[firstVertex + idx + 2] = jointIndicesBuffer[v * 4 + 2];
-										vertexBuffer[firstVertex + idx + 3] = jointIndicesBuffer[v * 4 + 3];
-									} else if (a_idx == static_cast<uint8_t>(gltf::AttributesSemantic::COLOR)) {
-                                        uint32_t color = static_cast<uint8_t>(buffer[v * 4 + 0] * 255.0f) << 24 |
-                                                         static_cast<uint8_t>(buffer[v * 4 + 1] * 255.0f) << 16 |
-                                                         static_cast<uint8_t>(buffer[v * 4 + 2] * 255.0f) << 8 |
-                                                         static_cast<uint8_t>(buffer[v * 4 + 3] * 255.0f) << 0;
-                                        vertexBuffer[firstVertex + idx] = static_cast<float>(color);
-                                    } else {
-										memcpy(&vertexBuffer[firstVertex + idx], &buffer[v * dataSize], dataSize * sizeof(float));
-									}
-								} else {
-									if (a_idx == static_cast<uint8_t>(gltf::AttributesSemantic::WEIGHT)) {
-										vertexBuffer[firstVertex + idx + 0] = 1.0f; // first weight = 1.0f
-										for (uint32_t c = 1u; c < dataSize; ++c) {
-											vertexBuffer[firstVertex + idx + c] = 0.0f;
-										}
-									} else {
-										for (uint32_t c = 0u; c < dataSize; ++c) {
-											vertexBuffer[firstVertex + idx + c] = 0.0f;
-										}
-									}
+						for (uint8_t i = 0u; i < allowedAttributesCount; ++i) {
+							const auto a_idx = static_cast<uint8_t>(allowedAttributes[i]);
+							const uint32_t dataSize = buffersDimensions[a_idx];
+
+							if (const float* buffer = buffers[a_idx]) {
+								InterleaveAttribute::Kind kind = InterleaveAttribute::Kind::COPY;
+								if (a_idx == static_cast<uint8_t>(gltf::AttributesSemantic::JOINTS)) {
+									kind = InterleaveAttribute::Kind::JOINTS;
+								} else if (a_idx == static_cast<uint8_t>(gltf::AttributesSemantic::COLOR)) {
+									kind = InterleaveAttribute::Kind::COLOR;
 								}
+								attributes.push_back({ buffer, idx, dataSize, kind });
+							} else if (a_idx == static_cast<uint8_t>(gltf::AttributesSemantic::WEIGHT)) {
+								attributes.push_back({ nullptr, idx, dataSize, InterleaveAttribute::Kind::WEIGHT });
+							} // other missed attributes are zeros
 
-								idx += dataSize;
-							}
+							idx += dataSize;
 						}
 					} else {
-						for (size_t v = 0u; v < mesh_vertexCount; ++v) {
-							for (uint8_t i = 0u; i < semanticsCount; ++i) {
-								if (const float* buffer = buffers[i]) {
-									const uint32_t dataSize = buffersDimensions[i];
-									if (i == static_cast<uint8_t>(gltf::AttributesSemantic::JOINTS)) {
-										const auto* jointIndicesBuffer = reinterpret_cast<const uint16_t*>(buffer);
-										vertexBuffer[firstVertex + idx + 0] = jointIndicesBuffer[v * 4 + 0];
-										vertexBuffer[firstVertex + idx + 1] = jointIndicesBuffer[v * 4 + 1];
-										vertexBuffer[firstVertex + idx + 2] = jointIndicesBuffer[v * 4 + 2];
-										vertexBuffer[firstVertex + idx + 3] = jointIndicesBuffer[v * 4 + 3];
-									} else {
-										memcpy(&vertexBuffer[firstVertex + idx], &buffer[v * dataSize], dataSize * sizeof(float));
-									}
-									idx += dataSize;
-								}
+						for (uint8_t i = 0u; i < semanticsCount; ++i) {
+							if (const float* buffer = buffers[i]) {
+								const uint32_t dataSize = buffersDimensions[i];
+								const auto kind = (i == static_cast<uint8_t>(gltf::AttributesSemantic::JOINTS)) ? InterleaveAttribute::Kind::JOINTS : InterleaveAttribute::Kind::COPY;
+								attributes.push_back({ buffer, idx, dataSize, kind });
+								idx += dataSize;
 							}
 						}
 					}
 
+					// quantized vertex is made from interleaved one, attributes in the same order
+					const uint32_t interleavedSize = mesh_vertexSize;
+					const auto quantizeBegin = static_cast<uint32_t>(quantizeAttributes.size());
+					if (quantizationMask != 0u) {
+						uint32_t srcOffset = 0u;
+						mesh_vertexSize = 0u;
+						for (const gltf::AttributesSemantic semantic : allowedAttributes) {
+							const uint32_t dataSize = buffersDimensions[static_cast<uint8_t>(semantic)];
+							QuantizeAttribute& q = quantizeAttributes.emplace_back(quantizeAttribute(semantic, dataSize, quantizationMask));
+							q.srcOffset = srcOffset;
+							q.dstOffset = mesh_vertexSize;
+							srcOffset += dataSize;
+							mesh_vertexSize += q.size;
+						}
+					}
+
+					vertexBufferSize = firstVertex + mesh_vertexSize * mesh_vertexCount;
+
+					if (mesh_vertexCount != 0u) {
+						positionsMin = glm::min(positionsMin, minCorner);
+						positionsMax = glm::max(positionsMax, maxCorner);
+					}
+
 					// indexes
 					const gltf::Accessor& accessor = layout.accessors[primitive.indices];
 					const gltf::BufferView& bufferView = layout.bufferViews[accessor.bufferView];
 					const gltf::Buffer& buffer = layout.buffers[bufferView.buffer];
 					mesh_indexCount = accessor.count;
 
-					indexBuffer.resize(firstIndex + mesh_indexCount);
+					indexBufferSize = firstIndex + mesh_indexCount;
 
 					if (!useOffsetsInRenderData) {
 						const auto vertex_size_change = vbOffset % (mesh_vertexSize * sizeof(float)); // ��������� � ����������� ������, ������������ � ������, ���� ����������� �� ������� - ����� ������� �������������� ��������
@@ -201,65 +521,151 @@ namespace engine {
 					}
 
 					const uint32_t startVertex = (useOffsetsInRenderData ? 0u : (vbOffset / (mesh_vertexSize * sizeof(float))));
-					const uint32_t startIndex = (useOffsetsInRenderData ? 0u : (ibOffset / (sizeof(uint32_t))));
-
-					switch (accessor.componentType) {
-						case gltf::AccessorComponentType::UNSIGNED_INT:
-							for (uint32_t index = 0u; index < mesh_indexCount; ++index) {
-								const size_t offset = accessor.offset + bufferView.offset + index * sizeof(uint32_t);
-								const auto v1 = static_cast<uint8_t>(buffer.data[offset + 0]);
-								const auto v2 = static_cast<uint8_t>(buffer.data[offset + 1]);
-								const auto v3 = static_cast<uint8_t>(buffer.data[offset + 2]);
-								const auto v4 = static_cast<uint8_t>(buffer.data[offset + 3]);
-								const auto v = static_cast<uint32_t>((static_cast<uint32_t>(v1) << 0) | 
-									(static_cast<uint32_t>(v2) << 8) | (static_cast<uint32_t>(v3) << 16) | 
-									(static_cast<uint32_t>(v4) << 24));
-								indexBuffer[firstIndex + index] = startVertex + commonVertexCount + v;
-							}
-								break;
-						case gltf::AccessorComponentType::UNSIGNED_SHORT:
-							for (uint32_t index = 0u; index < mesh_indexCount; ++index) {
-								const size_t offset = accessor.offset + bufferView.offset + index * sizeof(uint16_t);
-								const auto v1 = static_cast<uint8_t>(buffer.data[offset + 0]);
-								const auto v2 = static_cast<uint8_t>(buffer.data[offset + 1]);
-								const auto v = static_cast<uint16_t>((static_cast<uint16_t>(v1) << 0) | 
-									(static_cast<uint16_t>(v2) << 8));
-								indexBuffer[firstIndex + index] = startVertex + commonVertexCount + v;
-							}
-								break;
-						case gltf::AccessorComponentType::UNSIGNED_BYTE:
-							for (uint32_t index = 0u; index < mesh_indexCount; ++index) {
-								indexBuffer[firstIndex + index] = startVertex + commonVertexCount + 
-									buffer.data[accessor.offset + bufferView.offset + index];
-							}
-							break;
-						default:
-							break;
+					const uint32_t startIndex = (useOffsetsInRenderData ? 0u : (ibOffset / indexSize));
+
+					const auto primitiveId = static_cast<uint32_t>(primitives.size());
+					primitives.push_back({
+						firstVertex, mesh_vertexSize, interleavedSize, mesh_vertexCount,
+						attributesBegin, static_cast<uint32_t>(attributes.size()), quantizeBegin, static_cast<uint32_t>(quantizeAttributes.size()),
+						reinterpret_cast<const uint8_t*>(&buffer.data[accessor.offset + bufferView.offset]), accessor.componentType,
+						firstIndex, mesh_indexCount
+					});
+
+					for (uint32_t begin = 0u; begin < mesh_vertexCount; begin += kInterleaveVerticesPerJob) {
+						jobs.push_back({ primitiveId, begin, std::min(begin + kInterleaveVerticesPerJob, mesh_vertexCount), false });
 					}
 
-					commonVertexCount += mesh_vertexCount;
+					for (uint32_t begin = 0u; begin < mesh_indexCount; begin += kInterleaveIndicesPerJob) {
+						jobs.push_back({ primitiveId, begin, std::min(begin + kInterleaveIndicesPerJob, mesh_indexCount), true });
+					}
 
 					render_data.layouts.emplace_back(Mesh_Data::MeshRenderParams::Layout{
 							static_cast<uint8_t>(primitive.mode),
 							firstIndex + startIndex,					// firstIndex
 							mesh_indexCount,							// indexCount
+							startVertex + commonVertexCount,			// firstVertex
 							(useOffsetsInRenderData ? vbOffset : 0u),	// vbOffset
 							(useOffsetsInRenderData ? ibOffset : 0u),	// ibOffset
 							minCorner,
 							maxCorner
 						});
+
+					commonVertexCount += mesh_vertexCount;
 				}
 
 				renderData.push_back(render_data);
 			}
 
-			indexCount = static_cast<uint32_t>(indexBuffer.size());
+			vertexBuffer.resize(vertexBufferSize); // zeros for missed attributes
+			indexBuffer.resize(indexRangeSize(indexBufferSize, indexSize) / sizeof(uint32_t));
+
+			vec4f positionBounds(0.0f, 0.0f, 0.0f, 1.0f);
+			if (hasQuantization(quantizationMask, VertexQuantization::POSITION_SNORM16) && commonVertexCount != 0u) {
+				// uniform scale, so skinned normals keep their directions (shaders normalize them)
+				const vec3f center = (positionsMin + positionsMax) * 0.5f;
+				const vec3f extent = (positionsMax - positionsMin) * 0.5f;
+				const float scale = std::max(std::max(extent.x, extent.y), std::max(extent.z, std::numeric_limits<float>::min()));
+				positionBounds = vec4f(center, scale);
+				positionDequantization = glm::scale(glm::translate(mat4f(1.0f), center), vec3f(scale));
+
+				for (Mesh_Skin& skin : skins) { // skins are loaded before meshes
+					for (mat4f& m : skin.inverseBindMatrices) {
+						m = m * positionDequantization;
+					}
+				}
+			}
+
+			const InterleaveData data = { attributes.data(), quantizeAttributes.data(), positionBounds, vertexBuffer.data(), indexBuffer.data(), indexSize };
+			const auto fill = [&jobs, &primitives, &data, token](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					if (token && *token) return;
+					interleave(jobs[i], primitives[jobs[i].primitive], data);
+				}
+			};
+
+			if (auto* pool = Engine::getInstance().getModule<AssetManager>().getThreadPool(); pool && jobs.size() > 1u) {
+				parallel_for(*pool, jobs.size(), 1u, fill);
+			} else {
+				fill(0u, jobs.size());
+			}
+
+			indexCount = static_cast<uint32_t>(indexBufferSize);
 			vertexCount = commonVertexCount;
 		}
 
 		return vertex_offset;
 	}
 
+	size_t Mesh_Data::loadMeshes(const j4m::View& view, size_t& vbOffset, const size_t ibOffset, const bool useOffsetsInRenderData) {
+		const j4m::Header& header = view.header();
+		const size_t vertexBytes = header.vertexSize * sizeof(float);
+
+		size_t vertex_offset = 0u;
+		if (!useOffsetsInRenderData && vertexBytes != 0u) { // the same alignment of vertices in shared buffer as for gltf
+			const auto vertex_size_change = vbOffset % vertexBytes;
+			vertex_offset = vertex_size_change ? vertexBytes - vertex_size_change : 0u;
+		}
+
+		vbOffset += vertex_offset;
+		vertexSize = header.vertexSize;
+		vertexCount = header.vertexCount;
+		indexCount = header.indexCount;
+
+		indexSize = indexSizeForVertexCount(vertexCount);
+
+		// file indices start from 0, render parts firstVertex is the place in shared buffer
+		const uint32_t startVertex = (useOffsetsInRenderData || vertexBytes == 0u) ? 0u : static_cast<uint32_t>(vbOffset / vertexBytes);
+		const uint32_t startIndex = useOffsetsInRenderData ? 0u : static_cast<uint32_t>(ibOffset / indexSize);
+
+		if (indexSize == sizeof(uint16_t)) {
+			indexBuffer.resize(indexRangeSize(indexCount, indexSize) / sizeof(uint32_t));
+			packIndices16(view.indices(), indexCount, indexBuffer.data());
+		}
+
+		meshes.resize(header.meshesCount);
+		renderData.resize(header.meshesCount);
+
+		for (const j4m::Primitive& primitive : view.primitives()) {
+			renderData[primitive.mesh].layouts.emplace_back(Mesh_Data::MeshRenderParams::Layout{
+					primitive.mode,
+					primitive.firstIndex + startIndex,
+					primitive.indexCount,
+					startVertex,
+					(useOffsetsInRenderData ? vbOffset : 0u),
+					(useOffsetsInRenderData ? ibOffset : 0u),
+					vec3f(primitive.minCorner[0u], primitive.minCorner[1u], primitive.minCorner[2u]),
+					vec3f(primitive.maxCorner[0u], primitive.maxCorner[1u], primitive.maxCorner[2u])
+				});
+		}
+
+		return vertex_offset;
+	}
+
+	bool Mesh_Data::loadNodes(const j4m::View& view) {
+		if (!view.readNodes(sceneNodes, nodes)) return false;
+
+		for (const uint16_t nodeId : sceneNodes) {
+			initMeshNodeId(nodeId);
+		}
+		return true;
+	}
+
+	bool Mesh_Data::loadSkins(const j4m::View& view) {
+		return view.readSkins(skins);
+	}
+
+	bool Mesh_Data::loadAnimations(const j4m::View& view) {
+		std::vector<CompressedAnimation> compressed;
+		if (!view.readAnimations(compressed)) return false;
+
+		animations.clear();
+		animations.reserve(compressed.size());
+		for (const CompressedAnimation& animation : compressed) {
+			animations.push_back(decompressAnimation(animation));
+		}
+		return true;
+	}
+
 	void Mesh_Data::initMeshNodeId(const uint16_t nodeId) {
 		const gltf::Node& node = nodes[nodeId];
 
@@ -301,6 +707,10 @@ namespace engine {
 	}
 
 	void Mesh_Data::loadAnimations(const gltf::Layout& layout) {
+		loadMeshAnimations(layout, animations);
+	}
+
+	void loadMeshAnimations(const gltf::Layout& layout, std::vector<Mesh_Animation>& animations) {
 		const size_t animsCount = layout.animations.size();
 		animations.resize(animsCount);
 
@@ -387,32 +797,18 @@ namespace engine {
 		}
 	}
 
-	void Mesh_Data::uploadGpuData(std::unique_ptr<vulkan::VulkanBuffer>& vertices, std::unique_ptr<vulkan::VulkanBuffer>& indices, const size_t vbOffset, const size_t ibOffset) {
-		const uint32_t vertexBufferSize = static_cast<uint32_t>(vertexBuffer.size()) * sizeof(float);
-		const uint32_t indexBufferSize = static_cast<uint32_t>(indexBuffer.size()) * sizeof(uint32_t);
+	void Mesh_Data::uploadGpuData(std::unique_ptr<vulkan::VulkanBuffer>& vertices, std::unique_ptr<vulkan::VulkanBuffer>& indices, const size_t vbOffset, const size_t ibOffset,
+								  std::function<void(const bool)>&& uploaded) {
+		uploadGpuData(vertices, indices, vbOffset, ibOffset, vertexBuffer.data(), vertexBuffer.size() * sizeof(float), indexBuffer.data(), indexBuffer.size() * sizeof(uint32_t), std::move(uploaded));
+	}
+
+	void Mesh_Data::uploadGpuData(std::unique_ptr<vulkan::VulkanBuffer>& vertices, std::unique_ptr<vulkan::VulkanBuffer>& indices, const size_t vbOffset, const size_t ibOffset,
+								  const void* vertexData, const size_t vertexDataSize, const void* indexData, const size_t indexDataSize, std::function<void(const bool)>&& uploaded) {
+		const auto vertexBufferSize = static_cast<uint32_t>(vertexDataSize);
+		const auto indexBufferSize = static_cast<uint32_t>(indexDataSize);
 
 		auto&& renderer = Engine::getInstance().getModule<Graphics>().getRenderer();
 
-		stage_vertices = std::make_unique<vulkan::VulkanBuffer>();
-		stage_indices = std::make_unique<vulkan::VulkanBuffer>();
-
-		renderer->getDevice()->createBuffer(
-			VK_SHARING_MODE_EXCLUSIVE,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			stage_vertices.get(),
-			vertexBufferSize
-		);
-
-		renderer->getDevice()->createBuffer(
-			VK_SHARING_MODE_EXCLUSIVE,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			stage_indices.get(),
-			indexBufferSize
-		);
-
-		//
 		if (vertices == nullptr) {
 			vertices = std::make_unique<vulkan::VulkanBuffer>();
 			renderer->getDevice()->createBuffer(
@@ -435,37 +831,31 @@ namespace engine {
 			);
 		}
 
-		stage_vertices->upload(&vertexBuffer[0], vertexBufferSize, 0, false);
-		stage_indices->upload(&indexBuffer[0], indexBufferSize, 0, false);
-
-		destroyBuffers();
-
-		indicesBuffer = indices.get();
-		verticesBuffer = vertices.get();
 		gpu_ibOffset = ibOffset;
 		gpu_vbOffset = vbOffset;
-	}
 
-	void Mesh_Data::fillGpuData() {
-		if (stage_vertices == nullptr || stage_indices == nullptr) return;
-
-		auto&& renderer = Engine::getInstance().getModule<Graphics>().getRenderer();
-		auto&& copyPool = renderer->getDevice()->getCommandPool(vulkan::GPUQueueFamily::F_GRAPHICS);
-		auto&& cmdBuffer = renderer->getDevice()->createVulkanCommandBuffer(VK_COMMAND_BUFFER_LEVEL_PRIMARY, copyPool);
-		cmdBuffer.begin();
-
-		VkBufferCopy regionV{ 0, gpu_vbOffset, stage_vertices->m_size };
-		VkBufferCopy regionI{ 0, gpu_ibOffset, stage_indices->m_size };
-		cmdBuffer.cmdCopyBuffer(*stage_vertices, *verticesBuffer, &regionV);
-		cmdBuffer.cmdCopyBuffer(*stage_indices, *indicesBuffer, &regionI);
-
-		cmdBuffer.flush(renderer->getMainQueue());
-
-		stage_vertices->destroy();
-		stage_indices->destroy();
+		// copies are recorded by render thread with other uploads of frame, indices go after vertices in the same queue,
+		// so data is ready with the last of them; cpu data is already staged then
+		auto done = [this, vb = vertices.get(), ib = indices.get(), uploaded = std::move(uploaded)](const bool recorded) {
+			destroyBuffers();
+			if (recorded) {
+				indicesBuffer = ib;
+				verticesBuffer = vb;
+			}
+			if (uploaded) { uploaded(recorded); }
+		};
+
+		auto&& uploadManager = renderer->getUploadManager();
+		if (indexBufferSize != 0u) {
+			uploadManager.uploadBuffer(vertices.get(), vbOffset, vertexData, vertexBufferSize);
+			uploadManager.uploadBuffer(indices.get(), ibOffset, indexData, indexBufferSize, std::move(done));
+		} else {
+			uploadManager.uploadBuffer(vertices.get(), vbOffset, vertexData, vertexBufferSize, std::move(done));
+		}
+	}
 
-		stage_vertices = nullptr;
-		stage_indices = nullptr;
+	size_t Mesh_Data::indexDataSize() const noexcept {
+		return indexRangeSize(indexCount, indexSize);
 	}
 
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "../../Core/Math/mathematic.h"
 #include "../../Core/ref_ptr.h"
 
+#include <algorithm>
+#include <functional>
 #include <limits>
 #include <string>
 #include <vector>
@@ -18,12 +20,18 @@ namespace gltf {
 	enum class AttributesSemantic : uint8_t;
 }
 
+namespace j4m {
+	class View;
+}
+
 namespace vulkan {
 	struct VulkanBuffer;
 }
 
 namespace engine {
 
+	class CancellationToken;
+
 	struct Mesh_Geometry {
 		//struct Primitive {
 		//
@@ -53,9 +61,30 @@ namespace engine {
 		};
 
 		struct AnimationSampler {
+			static constexpr uint8_t kCursorMaxSteps = 4u;
+
 			std::vector<float> inputs;
 			std::vector<vec4f> outputs;
 			Interpolation interpolation = Interpolation::LINEAR;
+
+			// search key k with inputs[k] <= time <= inputs[k + 1], cursor - key from previous search
+			// forward playback moves cursor by a few keys, seeks and loops use binary search
+			// returns false if time is out of sampler range (cursor is not changed)
+			inline bool keyFrame(const float time, uint32_t& cursor) const noexcept {
+				const size_t keysCount = inputs.size();
+				if (keysCount < 2u || time < inputs.front() || time > inputs.back()) return false;
+
+				if (cursor < keysCount - 1u && inputs[cursor] <= time) {
+					for (uint8_t step = 0u; step < kCursorMaxSteps; ++step) {
+						if (time <= inputs[cursor + 1u]) return true;
+						if (++cursor == keysCount - 1u) break;
+					}
+				}
+
+				const auto it = std::upper_bound(inputs.begin(), inputs.end(), time);
+				cursor = static_cast<uint32_t>(std::min<ptrdiff_t>(std::max<ptrdiff_t>(std::distance(inputs.begin(), it) - 1, 0), keysCount - 2u));
+				return true;
+			}
 		};
 
 		struct AnimationChannel {
@@ -80,6 +109,7 @@ namespace engine {
 				uint8_t primitiveMode;
 				uint32_t firstIndex;	// номер первого индекса
 				uint32_t indexCount;	// количество индексов
+				uint32_t firstVertex;	// added to indices, they are local for primitive (gltf) or file (j4m)
 				size_t vbOffset;		// оффсет в вершинном буфере
 				size_t ibOffset;		// оффсет в индексном буфере
 				vec3f minCorner;
@@ -97,20 +127,21 @@ namespace engine {
 		std::vector<Mesh_Animation> animations;
 
 		std::vector<float> vertexBuffer;
-		std::vector<uint32_t> indexBuffer;
+		std::vector<uint32_t> indexBuffer; // indices of indexSize bytes, packed to 32 bit words
 
 		ref_ptr<vulkan::VulkanBuffer> verticesBuffer = nullptr;
 		ref_ptr<vulkan::VulkanBuffer> indicesBuffer = nullptr;
 
-		std::unique_ptr<vulkan::VulkanBuffer> stage_vertices = nullptr;
-		std::unique_ptr<vulkan::VulkanBuffer> stage_indices = nullptr;
-
 		size_t gpu_vbOffset = 0u;
 		size_t gpu_ibOffset = 0u;
 
-		uint32_t vertexSize = 0u;
+		uint32_t vertexSize = 0u; // in 32 bit words (floats or packed quantized components)
 		uint32_t vertexCount = 0u;
 		uint32_t indexCount = 0u;
+		uint8_t indexSize = sizeof(uint32_t); // 2 or 4 bytes, chosen by loadMeshes (IndexPacking.h)
+
+		uint8_t quantizationMask = 0u; // VertexQuantization bits, set before loadMeshes
+		mat4f positionDequantization = mat4f(1.0f); // for VertexQuantization::POSITION_SNORM16, already applied to skins
 
 		// functions
 		~Mesh_Data() = default;
@@ -119,16 +150,33 @@ namespace engine {
 
 		void loadNodes(const gltf::Layout& layout);
 
+		// token stops decoding of vertices and indices, data is incomplete then
 		size_t loadMeshes(const gltf::Layout& layout, const std::vector<gltf::AttributesSemantic>& allowedAttributes,
-			size_t& vbOffset, const size_t ibOffset, const bool useOffsetsInRenderData);
+			size_t& vbOffset, const size_t ibOffset, const bool useOffsetsInRenderData, const CancellationToken* token = nullptr);
 
 		void loadAnimations(const gltf::Layout& layout);
 
+		// .j4m: vertices stay in file data (upload them with view.vertices()),
+		// indices are copied to indexBuffer only if they are packed to 16 bit; false - section is broken
+		bool loadSkins(const j4m::View& view);
+
+		bool loadNodes(const j4m::View& view);
+
+		size_t loadMeshes(const j4m::View& view, size_t& vbOffset, const size_t ibOffset, const bool useOffsetsInRenderData);
+
+		bool loadAnimations(const j4m::View& view);
+
 		void initMeshNodeId(const uint16_t nodeId);
 
-		void uploadGpuData(std::unique_ptr<vulkan::VulkanBuffer>& vertices, std::unique_ptr<vulkan::VulkanBuffer>& indices, const size_t vbOffset, const size_t ibOffset);
+		// data is ready for rendering when copies are recorded by render thread: buffers are set and uploaded is called on it (false - copies are cancelled)
+		void uploadGpuData(std::unique_ptr<vulkan::VulkanBuffer>& vertices, std::unique_ptr<vulkan::VulkanBuffer>& indices, const size_t vbOffset, const size_t ibOffset,
+						   std::function<void(const bool)>&& uploaded);
+
+		void uploadGpuData(std::unique_ptr<vulkan::VulkanBuffer>& vertices, std::unique_ptr<vulkan::VulkanBuffer>& indices, const size_t vbOffset, const size_t ibOffset,
+						   const void* vertexData, const size_t vertexDataSize, const void* indexData, const size_t indexDataSize, std::function<void(const bool)>&& uploaded);
 
-		void fillGpuData();
+		// size of indices in graphics buffer, ranges are padded to 32 bit words
+		[[nodiscard]] size_t indexDataSize() const noexcept;
 
 		inline void destroyBuffers() {
 			vertexBuffer.clear();
@@ -136,4 +184,7 @@ namespace engine {
 		}
 	};
 
+	// animations of gltf layout, channels target nodes of layout
+	void loadMeshAnimations(const gltf::Layout& layout, std::vector<Mesh_Animation>& animations);
+
 }
\ No newline at end of file
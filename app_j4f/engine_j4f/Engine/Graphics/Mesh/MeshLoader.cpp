@@ -5,6 +5,8 @@
 #include "../../Core/FakeCopyable.h"
 #include "../Graphics.h"
 #include "MeshData.h"
+#include "Loader_j4m.h"
+#include "../../File/FileManager.h"
 #include "Mesh.h"
 #include "../../Utils/Debug/Profiler.h"
 
@@ -30,6 +32,14 @@ namespace engine {
 		);
 	}
 
+	MeshGraphicsDataBuffer::~MeshGraphicsDataBuffer() {
+		if (vb || ib) {
+			auto&& uploadManager = Engine::getInstance().getModule<Graphics>().getRenderer()->getUploadManager();
+			uploadManager.cancelUploads(vb.get());
+			uploadManager.cancelUploads(ib.get());
+		}
+	}
+
     MeshLoader::DataLoadingCallback::DataLoadingCallback(std::unique_ptr<Mesh>&& m, const MeshLoadingCallback& c, uint16_t msk, uint8_t l, uint8_t t) :
     mesh(std::move(m)), callback(c), semanticMask(msk), latency(l), targetThreadId(t) { }
 
@@ -58,15 +68,21 @@ namespace engine {
 			}
 		}
 
+		deliverCallbacks(std::move(callbacks), m, result);
+	}
+
+	void MeshLoader::deliverCallbacks(std::vector<DataLoadingCallback>&& callbacks, Mesh_Data* m, const AssetLoadingResult result) {
         auto && engine = Engine::getInstance();
         auto && threadCommutator = engine.getModule<WorkerThreadsCommutator>();
 
 		for (auto&& c : callbacks) {
-			c.mesh->createWithData(m, c.semanticMask, c.latency);
+			if (result == AssetLoadingResult::LOADING_SUCCESS) {
+				c.mesh->createWithData(m, c.semanticMask, c.latency);
+			}
 
-            CopyWrapper execute([callback = std::move(c.callback), mesh = std::move(c.mesh)]() mutable {
+            CopyWrapper execute([callback = std::move(c.callback), mesh = std::move(c.mesh), result]() mutable {
                 if (callback) {
-                    callback(std::move(mesh), AssetLoadingResult::LOADING_SUCCESS);
+                    callback(std::move(mesh), result);
                 }
             });
 
@@ -74,7 +90,165 @@ namespace engine {
 		}
 	}
 
-	void MeshLoader::fillMeshData(Mesh_Data* mData, const MeshLoadingParams& params) {
+	bool MeshLoader::cancelLoading(Mesh_Data* mData, const MeshLoadingParams& params, const CancellationToken* token) {
+		if (!params.cancelled() && !(token && *token)) {
+			return false;
+		}
+
+		std::vector<DataLoadingCallback> callbacks;
+		{
+			AtomicLock lock(_callbacksLock);
+			auto it = _callbacks.find(mData);
+			if (it != _callbacks.end()) {
+				if (it->second.size() > 1u) {
+					return false;
+				}
+				callbacks = std::move(it->second);
+				_callbacks.erase(it);
+			}
+
+			*mData = Mesh_Data(); // space reserved in graphics buffer is given back by caller
+			_cancelledData.insert(mData);
+		}
+
+		deliverCallbacks(std::move(callbacks), mData, AssetLoadingResult::LOADING_CANCELED);
+		return true;
+	}
+
+	void MeshLoader::failLoading(Mesh_Data* mData) {
+		std::vector<DataLoadingCallback> callbacks;
+		{
+			AtomicLock lock(_callbacksLock);
+			auto it = _callbacks.find(mData);
+			if (it != _callbacks.end()) {
+				callbacks = std::move(it->second);
+				_callbacks.erase(it);
+			}
+
+			*mData = Mesh_Data();
+			_cancelledData.insert(mData);
+		}
+
+		deliverCallbacks(std::move(callbacks), mData, AssetLoadingResult::LOADING_ERROR);
+	}
+
+	bool MeshLoader::reserveRange(MeshGraphicsDataBuffer& buffer, const GraphicsBufferRange& range) {
+		if ((buffer.vb && range.vbEnd > buffer.vb->m_size) || (buffer.ib && range.ibEnd > buffer.ib->m_size)) {
+			return false;
+		}
+
+		buffer.vbOffset = range.vbEnd;
+		buffer.ibOffset = range.ibEnd;
+		return true;
+	}
+
+	void MeshLoader::releaseRange(MeshGraphicsDataBuffer& buffer, const GraphicsBufferRange& range) {
+		AtomicLock lock(_graphicsBuffersOffsetsLock);
+		if (buffer.vbOffset == range.vbEnd && buffer.ibOffset == range.ibEnd) {
+			buffer.vbOffset = range.vbBegin;
+			buffer.ibOffset = range.ibBegin;
+		}
+	}
+
+	std::function<void(const bool)> MeshLoader::uploadedCallback(Mesh_Data* mData) {
+		return [mData](const bool recorded) {
+			if (recorded) {
+				executeCallbacks(mData, AssetLoadingResult::LOADING_SUCCESS);
+			} else {
+				failLoading(mData);
+			}
+		};
+	}
+
+	void MeshLoader::fillMeshDataJ4m(Mesh_Data* mData, const MeshLoadingParams& params, const CancellationToken* token, const FileView& file) {
+		PROFILE_TIME_SCOPED_M(meshDataLoading, params.file)
+
+		auto&& engine = Engine::getInstance();
+
+		const FileView bytes = file ? file : engine.getModule<FileManager>().readFileMapped(params.file);
+		j4m::View view;
+		if (!bytes || !view.open(bytes.data(), bytes.size())) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "can't load j4m file %s", params.file.c_str());
+			failLoading(mData);
+			return;
+		}
+
+		if (params.semanticMask != 0u && params.semanticMask != view.header().semanticMask) { // vertex attributes are built from requested mask
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "j4m file %s: vertex layout (semantic mask %u) differs from requested semantic mask %u", params.file.c_str(),
+						  static_cast<uint32_t>(view.header().semanticMask), static_cast<uint32_t>(params.semanticMask));
+			failLoading(mData);
+			return;
+		}
+
+		if (params.quantizationMask != 0u) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "j4m file %s: vertices quantization is not supported, float vertices are used", params.file.c_str());
+		}
+
+		if (!mData->loadSkins(view) || !mData->loadAnimations(view)) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "j4m file %s: broken skins or animations", params.file.c_str());
+			failLoading(mData);
+			return;
+		}
+
+		if (!params.graphicsBuffer) {
+			executeCallbacks(mData, AssetLoadingResult::LOADING_SUCCESS);
+			return;
+		}
+
+		VkDeviceSize vbOffset;
+		VkDeviceSize ibOffset;
+
+		auto& graphicsBuffer = const_cast<MeshGraphicsDataBuffer&>(*params.graphicsBuffer);
+
+		GraphicsBufferRange range;
+		bool reserved;
+
+		{
+			AtomicLock lock(_graphicsBuffersOffsetsLock);
+			vbOffset = params.graphicsBuffer->vbOffset;
+			ibOffset = params.graphicsBuffer->ibOffset;
+
+			const auto vertex_offset = mData->loadMeshes(view, vbOffset, ibOffset, params.useOffsetsInRenderData);
+
+			range = { graphicsBuffer.vbOffset, graphicsBuffer.vbOffset + mData->vertexSize * mData->vertexCount * sizeof(float) + vertex_offset,
+					  graphicsBuffer.ibOffset, graphicsBuffer.ibOffset + mData->indexDataSize() };
+			reserved = reserveRange(graphicsBuffer, range);
+		}
+
+		if (!reserved) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "j4m file %s: no space in graphics buffer", params.file.c_str());
+			failLoading(mData);
+			return;
+		}
+
+		if (!mData->loadNodes(view)) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "j4m file %s: broken nodes", params.file.c_str());
+			releaseRange(graphicsBuffer, range);
+			failLoading(mData);
+			return;
+		}
+
+		if (cancelLoading(mData, params, token)) {
+			releaseRange(graphicsBuffer, range);
+			return;
+		}
+
+		// vertices (and not packed indices) go from file data straight into staging ring
+		const uint32_t* indices = mData->indexBuffer.empty() ? view.indices() : mData->indexBuffer.data();
+		mData->uploadGpuData(graphicsBuffer.vb, graphicsBuffer.ib, vbOffset, ibOffset,
+							 view.vertices(), mData->vertexSize * mData->vertexCount * sizeof(float), indices, mData->indexDataSize(), uploadedCallback(mData));
+	}
+
+	void MeshLoader::fillMeshData(Mesh_Data* mData, const MeshLoadingParams& params, const CancellationToken* token, const FileView& file) {
+		if (cancelLoading(mData, params, token)) {
+			return;
+		}
+
+		if (params.file.ends_with(".j4m")) {
+			fillMeshDataJ4m(mData, params, token, file);
+			return;
+		}
+
 		PROFILE_TIME_SCOPED_M(meshDataLoading, params.file)
 
 		using namespace gltf;
@@ -98,33 +272,59 @@ namespace engine {
 			}
 		}
 
+		if (params.quantizationMask != 0u && allowedAttributes.empty()) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "mesh %s: vertices quantization needs semantic mask, float vertices are used", params.file.c_str());
+		} else {
+			mData->quantizationMask = params.quantizationMask;
+		}
+
+		if (cancelLoading(mData, params, token)) { // json and buffers are read, vertices aren't decoded
+			return;
+		}
+
 		VkDeviceSize vbOffset;
 		VkDeviceSize ibOffset;
 			
 		auto& graphicsBuffer = const_cast<MeshGraphicsDataBuffer&>(*params.graphicsBuffer);
 
+		GraphicsBufferRange range;
+		bool stopped;
+		bool reserved = false;
+
 		{
 			AtomicLock lock(_graphicsBuffersOffsetsLock);
 			vbOffset = params.graphicsBuffer->vbOffset;
 			ibOffset = params.graphicsBuffer->ibOffset;
 
-			const auto vertex_offset = mData->loadMeshes(layout, allowedAttributes, vbOffset, ibOffset, params.useOffsetsInRenderData);
+			const auto vertex_offset = mData->loadMeshes(layout, allowedAttributes, vbOffset, ibOffset, params.useOffsetsInRenderData, token);
 
-			graphicsBuffer.vbOffset += mData->vertexSize * mData->vertexCount * sizeof(float) + vertex_offset;
-			graphicsBuffer.ibOffset += mData->indexCount * sizeof(uint32_t);
+			range = { graphicsBuffer.vbOffset, graphicsBuffer.vbOffset + mData->vertexSize * mData->vertexCount * sizeof(float) + vertex_offset,
+					  graphicsBuffer.ibOffset, graphicsBuffer.ibOffset + mData->indexDataSize() };
+			stopped = token && *token; // partly decoded data doesn't take space
+			reserved = !stopped && reserveRange(graphicsBuffer, range);
 		}
 
-		mData->loadNodes(layout);
+		if (!stopped && !reserved) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, MESH, "mesh %s: no space in graphics buffer", params.file.c_str());
+			failLoading(mData);
+			return;
+		}
 
-		mData->uploadGpuData(graphicsBuffer.vb, graphicsBuffer.ib, vbOffset, ibOffset);
+		mData->loadNodes(layout);
 
-        auto && engine = Engine::getInstance();
-        auto && threadCommutator = engine.getModule<WorkerThreadsCommutator>();
+		if (token && *token) { // decoding could be stopped by token
+			if (reserved) {
+				releaseRange(graphicsBuffer, range);
+			}
 
-        threadCommutator.enqueue(engine.getThreadCommutationId(Engine::Workers::RENDER_THREAD),
-                                  [mData](){ mData->fillGpuData(); });
+			if (!cancelLoading(mData, params, token)) { // other requests wait for data, it's loaded again without cancellation
+				*mData = Mesh_Data();
+				fillMeshData(mData, params, nullptr);
+			}
+			return;
+		}
 
-		executeCallbacks(mData, AssetLoadingResult::LOADING_SUCCESS);
+		mData->uploadGpuData(graphicsBuffer.vb, graphicsBuffer.ib, vbOffset, ibOffset, uploadedCallback(mData));
 	}
 
 	void MeshLoader::loadAsset(Mesh*& v, const MeshLoadingParams& params, const MeshLoadingCallback& callback) {
@@ -141,7 +341,16 @@ namespace engine {
                     callback(std::move(mesh), AssetLoadingResult::LOADING_SUCCESS);
                 }
 			} else {
-				addCallback(mData, std::move(mesh), callback, params.semanticMask, params.latency, params.callbackThreadId);
+				bool restart;
+				{
+					AtomicLock lock(_callbacksLock);
+					restart = _cancelledData.erase(mData) != 0u; // loading of data was cancelled
+					_callbacks[mData].emplace_back(std::move(mesh), callback, params.semanticMask, params.latency, params.callbackThreadId);
+				}
+
+				if (restart) {
+					startLoading(mData, params);
+				}
 			}
 			return;
 		}
@@ -153,24 +362,31 @@ namespace engine {
                 ) {
 			auto* mData = new Mesh_Data();
 			addCallback(mData, std::move(v), callback, params.semanticMask, params.latency, params.callbackThreadId);
+			startLoading(mData, params);
+			return mData;
+		}, std::move(mesh), params, callback);
+	}
 
-			if (params.flags->async) {
-                Engine::getInstance().getModule<AssetManager>().getThreadPool()->enqueue(
-                        TaskType::COMMON,
-                         [](const CancellationToken& token,
-                               const MeshLoadingParams params, Mesh_Data* mData) {
-					fillMeshData(mData, params);
+	void MeshLoader::startLoading(Mesh_Data* mData, const MeshLoadingParams& params) {
+		if (params.flags->async) {
+			auto&& assetManager = Engine::getInstance().getModule<AssetManager>();
+			if (params.file.ends_with(".j4m")) { // single file, loader thread starts when it is read
+				assetManager.enqueueLoadingWithFiles(params, { params.file }, [params, mData](const CancellationToken& token, const std::vector<FileView>& files) {
+					fillMeshData(mData, params, &token, files[0]);
+				});
+			} else { // gltf buffers are known after json parsing, files are read on loader thread
+				assetManager.enqueueLoading(params, [](const CancellationToken& token, const MeshLoadingParams params, Mesh_Data* mData) {
+					fillMeshData(mData, params, &token);
 				}, params, mData);
-			} else {
-				fillMeshData(mData, params);
 			}
-
-			return mData;
-		}, std::move(mesh), params, callback);
+		} else {
+			fillMeshData(mData, params, nullptr);
+		}
 	}
 
     void MeshLoader::cleanUp() noexcept {
         AtomicLock lock(_callbacksLock);
         _callbacks.clear();
+        _cancelledData.clear();
     }
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-﻿#pragma once
+#pragma once
 
 #include "../../Core/AssetManager.h"
 #include "../../Core/Threads/ThreadPool.h"
@@ -7,11 +7,13 @@
 #include "../Vulkan/vkBuffer.h"
 
 #include "Loader_gltf.h"
+#include "VertexQuantization.h"
 
 #include <string>
 #include <vector>
 #include <atomic>
 #include <memory>
+#include <unordered_set>
 
 namespace engine {
 
@@ -40,7 +42,7 @@ namespace engine {
 		MeshGraphicsDataBuffer() : vb(nullptr), ib(nullptr), vbOffset(0), ibOffset(0) { }
 		MeshGraphicsDataBuffer(const size_t vbSize, const size_t ibSize);
 
-		~MeshGraphicsDataBuffer() = default;
+		~MeshGraphicsDataBuffer(); // not recorded copies into buffers are cancelled
 
 		std::unique_ptr<vulkan::VulkanBuffer> vb;
 		std::unique_ptr<vulkan::VulkanBuffer> ib;
@@ -53,6 +55,7 @@ namespace engine {
 	struct AssetLoadingParams<Mesh> : public AssetLoadingFlags {
 		std::string file;
 		uint16_t semanticMask = 0u;
+		uint8_t quantizationMask = 0u; // VertexQuantization bits, used with none zero semanticMask only
 		uint8_t latency = 1u;
 		uint8_t callbackThreadId = 0u;
 		ref_ptr<MeshGraphicsDataBuffer> graphicsBuffer = nullptr;
@@ -88,11 +91,35 @@ namespace engine {
 
         static void addCallback(Mesh_Data*, std::unique_ptr<Mesh>&& mesh, const MeshLoadingCallback&, uint16_t mask, uint8_t l, uint8_t thread);
 		static void executeCallbacks(Mesh_Data*, const AssetLoadingResult);
+		static void deliverCallbacks(std::vector<DataLoadingCallback>&& callbacks, Mesh_Data*, const AssetLoadingResult);
+		// true - loading is stopped, data is cleared and stays in cache for next request; cancellation is ignored while other requests wait for data
+		static bool cancelLoading(Mesh_Data*, const MeshLoadingParams&, const CancellationToken* token);
+		// data is cleared and stays in cache for next request, all waiting requests get LOADING_ERROR
+		static void failLoading(Mesh_Data*);
+		// callbacks of data get result when its gpu copies are recorded, mesh isn't rendered before
+		static std::function<void(const bool)> uploadedCallback(Mesh_Data*);
+
+		// part of graphics buffer taken by one mesh data
+		struct GraphicsBufferRange {
+			VkDeviceSize vbBegin;
+			VkDeviceSize vbEnd;
+			VkDeviceSize ibBegin;
+			VkDeviceSize ibEnd;
+		};
+
+		// called under _graphicsBuffersOffsetsLock; false - buffer has no space for range, offsets aren't changed
+		static bool reserveRange(MeshGraphicsDataBuffer&, const GraphicsBufferRange&);
+		// range is given back if nothing was reserved after it
+		static void releaseRange(MeshGraphicsDataBuffer&, const GraphicsBufferRange&);
 
-		static void fillMeshData(Mesh_Data*, const MeshLoadingParams&);
+		static void startLoading(Mesh_Data*, const MeshLoadingParams&);
+		// file - already read content of params.file (empty - file is read here)
+		static void fillMeshData(Mesh_Data*, const MeshLoadingParams&, const CancellationToken* token, const FileView& file = {});
+		static void fillMeshDataJ4m(Mesh_Data*, const MeshLoadingParams&, const CancellationToken* token, const FileView& file);
 
 		inline static std::atomic_bool _graphicsBuffersOffsetsLock;
 		inline static std::atomic_bool _callbacksLock;
 		inline static std::unordered_map<Mesh_Data*, std::vector<DataLoadingCallback>> _callbacks;
+		inline static std::unordered_set<Mesh_Data*> _cancelledData; // loading was cancelled or failed, next request loads data again
 	};
 }
\ No newline at end of file
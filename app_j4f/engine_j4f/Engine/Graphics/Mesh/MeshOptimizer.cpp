@@ -0,0 +1,577 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace engine::mesh_optimizer {
+
+	namespace {
+		constexpr uint32_t kInvalidIndex = 0xffffffffu;
+
+		// triangles adjacency in compressed form: triangles of vertex v are data[offsets[v] .. offsets[v] + counts[v]]
+		struct Adjacency {
+			std::vector<uint32_t> counts;
+			std::vector<uint32_t> offsets;
+			std::vector<uint32_t> data;
+
+			void build(const uint32_t* indices, const size_t indexCount, const size_t vertexCount) {
+				counts.assign(vertexCount, 0u);
+				offsets.resize(vertexCount);
+				data.resize(indexCount);
+
+				for (size_t i = 0u; i < indexCount; ++i) {
+					++counts[indices[i]];
+				}
+
+				uint32_t offset = 0u;
+				for (size_t v = 0u; v < vertexCount; ++v) {
+					offsets[v] = offset;
+					offset += counts[v];
+				}
+
+				std::vector<uint32_t> fill(offsets);
+				for (size_t i = 0u; i < indexCount; ++i) {
+					data[fill[indices[i]]++] = static_cast<uint32_t>(i / 3u);
+				}
+			}
+		};
+	}
+
+	CacheStatistic analyzeVertexCache(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const uint32_t cacheSize) {
+		CacheStatistic result;
+		if (indexCount < 3u || vertexCount == 0u) return result;
+
+		// timestamps fifo: vertex is in cache if it was pushed less then cacheSize pushes ago
+		std::vector<uint32_t> timestamps(vertexCount, 0u);
+		uint32_t timestamp = cacheSize + 1u;
+
+		for (size_t i = 0u; i < indexCount; ++i) {
+			const uint32_t v = indices[i];
+			if (timestamp - timestamps[v] > cacheSize) {
+				timestamps[v] = timestamp++;
+				++result.misses;
+			}
+		}
+
+		result.acmr = static_cast<float>(result.misses) / static_cast<float>(indexCount / 3u);
+		result.atvr = static_cast<float>(result.misses) / static_cast<float>(vertexCount);
+		return result;
+	}
+
+	void optimizeVertexCache(uint32_t* dst, const uint32_t* indices, const size_t indexCount, const size_t vertexCount) {
+		constexpr uint32_t kCacheSize = 32u;
+		constexpr float kCacheDecayPower = 1.5f;
+		constexpr float kLastTriScore = 0.75f;
+		constexpr float kValenceBoostScale = 2.0f;
+		constexpr float kValenceBoostPower = 0.5f;
+
+		const size_t triangleCount = indexCount / 3u;
+		if (triangleCount == 0u) return;
+
+		std::vector<uint32_t> source(indices, indices + indexCount); // dst may be equal indices
+
+		Adjacency adjacency;
+		adjacency.build(source.data(), indexCount, vertexCount);
+
+		std::vector<uint32_t> liveTriangles(adjacency.counts);
+		std::vector<int32_t> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount, 0.0f);
+		std::vector<float> triangleScore(triangleCount, 0.0f);
+		std::vector<bool> emitted(triangleCount, false);
+
+		const auto calculateScore = [&](const uint32_t v) -> float {
+			const uint32_t live = liveTriangles[v];
+			if (live == 0u) return -1.0f;
+
+			float score = 0.0f;
+			const int32_t position = cachePosition[v];
+			if (position >= 0) {
+				if (position < 3) {
+					score = kLastTriScore;
+				} else {
+					const float scaler = 1.0f / static_cast<float>(kCacheSize - 3u);
+					score = powf(1.0f - static_cast<float>(position - 3) * scaler, kCacheDecayPower);
+				}
+			}
+
+			return score + kValenceBoostScale * powf(static_cast<float>(live), -kValenceBoostPower);
+		};
+
+		for (size_t v = 0u; v < vertexCount; ++v) {
+			vertexScore[v] = calculateScore(static_cast<uint32_t>(v));
+		}
+
+		for (size_t t = 0u; t < triangleCount; ++t) {
+			triangleScore[t] = vertexScore[source[t * 3u + 0u]] + vertexScore[source[t * 3u + 1u]] + vertexScore[source[t * 3u + 2u]];
+		}
+
+		std::vector<uint32_t> cache;
+		std::vector<uint32_t> newCache;
+		cache.reserve(kCacheSize + 3u);
+		newCache.reserve(kCacheSize + 3u);
+
+		size_t inputCursor = 0u;
+		size_t outputTriangle = 0u;
+
+		uint32_t bestTriangle = kInvalidIndex;
+		float bestScore = -1.0f;
+
+		while (outputTriangle < triangleCount) {
+			if (bestTriangle == kInvalidIndex) { // no candidates in cache, take next not emitted triangle
+				while (inputCursor < triangleCount && emitted[inputCursor]) {
+					++inputCursor;
+				}
+				if (inputCursor == triangleCount) break;
+				bestTriangle = static_cast<uint32_t>(inputCursor);
+			}
+
+			emitted[bestTriangle] = true;
+			const uint32_t* tri = &source[bestTriangle * 3u];
+			memcpy(&dst[outputTriangle * 3u], tri, 3u * sizeof(uint32_t));
+			++outputTriangle;
+
+			// update cache: emitted triangle vertices go first
+			newCache.clear();
+			for (uint8_t k = 0u; k < 3u; ++k) {
+				const uint32_t v = tri[k];
+				newCache.push_back(v);
+
+				// remove triangle from vertex live list (move it to the end of the vertex range)
+				uint32_t* vertexTriangles = &adjacency.data[adjacency.offsets[v]];
+				const uint32_t live = liveTriangles[v];
+				for (uint32_t n = 0u; n < live; ++n) {
+					if (vertexTriangles[n] == bestTriangle) {
+						std::swap(vertexTriangles[n], vertexTriangles[live - 1u]);
+						break;
+					}
+				}
+				--liveTriangles[v];
+			}
+
+			for (const uint32_t v : cache) {
+				if (v != tri[0u] && v != tri[1u] && v != tri[2u]) {
+					newCache.push_back(v);
+				}
+			}
+
+			const auto updateScore = [&](const uint32_t v) { // vertex score and scores of its live triangles
+				const float score = calculateScore(v);
+				const float delta = score - vertexScore[v];
+				vertexScore[v] = score;
+
+				const uint32_t* vertexTriangles = &adjacency.data[adjacency.offsets[v]];
+				for (uint32_t n = 0u, live = liveTriangles[v]; n < live; ++n) {
+					triangleScore[vertexTriangles[n]] += delta;
+				}
+			};
+
+			// vertices pushed out of cache lose cache score
+			for (size_t i = kCacheSize; i < newCache.size(); ++i) {
+				cachePosition[newCache[i]] = -1;
+				updateScore(newCache[i]);
+			}
+
+			if (newCache.size() > kCacheSize) {
+				newCache.resize(kCacheSize);
+			}
+			std::swap(cache, newCache);
+
+			// update scores for vertices in cache and their triangles, search best candidate
+			bestTriangle = kInvalidIndex;
+			bestScore = -1.0f;
+
+			for (size_t i = 0u; i < cache.size(); ++i) {
+				cachePosition[cache[i]] = static_cast<int32_t>(i);
+			}
+
+			for (const uint32_t v : cache) {
+				updateScore(v);
+			}
+
+			for (const uint32_t v : cache) { // scores are final only after all vertices are updated
+				const uint32_t* vertexTriangles = &adjacency.data[adjacency.offsets[v]];
+				for (uint32_t n = 0u, live = liveTriangles[v]; n < live; ++n) {
+					const uint32_t t = vertexTriangles[n];
+					if (triangleScore[t] > bestScore) {
+						bestScore = triangleScore[t];
+						bestTriangle = t;
+					}
+				}
+			}
+		}
+	}
+
+	size_t buildVertexFetchRemap(uint32_t* remap, const uint32_t* indices, const size_t indexCount, const size_t vertexCount) {
+		std::fill(remap, remap + vertexCount, kInvalidIndex);
+
+		uint32_t next = 0u;
+		for (size_t i = 0u; i < indexCount; ++i) {
+			const uint32_t v = indices[i];
+			if (remap[v] == kInvalidIndex) {
+				remap[v] = next++;
+			}
+		}
+
+		return next;
+	}
+
+	void remapIndexBuffer(uint32_t* dst, const uint32_t* indices, const size_t indexCount, const uint32_t* remap) {
+		for (size_t i = 0u; i < indexCount; ++i) {
+			dst[i] = remap[indices[i]];
+		}
+	}
+
+	void remapVertexBuffer(void* dst, const void* vertices, const size_t vertexCount, const size_t vertexSize, const uint32_t* remap) {
+		const auto* src = static_cast<const uint8_t*>(vertices);
+		auto* out = static_cast<uint8_t*>(dst);
+		for (size_t v = 0u; v < vertexCount; ++v) {
+			if (remap[v] != kInvalidIndex) {
+				memcpy(out + remap[v] * vertexSize, src + v * vertexSize, vertexSize);
+			}
+		}
+	}
+
+	namespace {
+		struct Quadric { // symmetric 4x4 matrix
+			double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+			double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+			double a22 = 0.0, a23 = 0.0;
+			double a33 = 0.0;
+			double w = 0.0;
+
+			inline void addPlane(const double a, const double b, const double c, const double d, const double w) noexcept {
+				a00 += w * a * a; a01 += w * a * b; a02 += w * a * c; a03 += w * a * d;
+				a11 += w * b * b; a12 += w * b * c; a13 += w * b * d;
+				a22 += w * c * c; a23 += w * c * d;
+				a33 += w * d * d;
+				this->w += w;
+			}
+
+			inline void add(const Quadric& q) noexcept {
+				a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+				a11 += q.a11; a12 += q.a12; a13 += q.a13;
+				a22 += q.a22; a23 += q.a23;
+				a33 += q.a33;
+				w += q.w;
+			}
+
+			[[nodiscard]] inline double error(const float* p) const noexcept {
+				const double x = p[0u], y = p[1u], z = p[2u];
+				const double r = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x +
+								 a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y +
+								 a22 * z * z + 2.0 * a23 * z +
+								 a33;
+				return w > 0.0 ? std::abs(r) / w : std::abs(r); // squared distance averaged by planes area
+			}
+		};
+
+		struct Collapse {
+			uint32_t from;
+			uint32_t to;
+			double cost;
+		};
+
+		inline void cross(const float* a, const float* b, const float* c, float* n) noexcept {
+			const float e1[3u] = { b[0u] - a[0u], b[1u] - a[1u], b[2u] - a[2u] };
+			const float e2[3u] = { c[0u] - a[0u], c[1u] - a[1u], c[2u] - a[2u] };
+			n[0u] = e1[1u] * e2[2u] - e1[2u] * e2[1u];
+			n[1u] = e1[2u] * e2[0u] - e1[0u] * e2[2u];
+			n[2u] = e1[0u] * e2[1u] - e1[1u] * e2[0u];
+		}
+
+		float skinDistance(const uint16_t* joints, const float* weights, const uint32_t a, const uint32_t b) {
+			// influences difference as sum of |wa(joint) - wb(joint)| over all joints, zero weights slots are ignored
+			uint16_t influenceJoints[8u];
+			float influenceWeights[8u];
+			uint8_t count = 0u;
+
+			const auto addInfluences = [&](const uint32_t v, const float sign) {
+				for (uint8_t i = 0u; i < 4u; ++i) {
+					const float w = weights[v * 4u + i];
+					if (w == 0.0f) continue;
+
+					const uint16_t joint = joints[v * 4u + i];
+					uint8_t j = 0u;
+					while (j < count && influenceJoints[j] != joint) { ++j; }
+					if (j == count) {
+						influenceJoints[count] = joint;
+						influenceWeights[count++] = 0.0f;
+					}
+					influenceWeights[j] += sign * w;
+				}
+			};
+
+			addInfluences(a, 1.0f);
+			addInfluences(b, -1.0f);
+
+			float distance = 0.0f;
+			for (uint8_t i = 0u; i < count; ++i) {
+				distance += std::abs(influenceWeights[i]);
+			}
+
+			return distance * 0.5f; // [0.0f, 1.0f] for normalized weights
+		}
+	}
+
+	size_t simplify(uint32_t* dst, const uint32_t* indices, const size_t indexCount,
+					const float* positions, const size_t vertexCount, const size_t positionsStride,
+					const SimplifyParams& params, float* resultError) {
+		std::vector<uint32_t> current(indices, indices + indexCount);
+		if (resultError) { *resultError = 0.0f; }
+
+		// normalized positions, so errors are relative to the mesh extents
+		std::vector<float> points(vertexCount * 3u);
+		float minCorner[3u] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+		float maxCorner[3u] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+
+		for (size_t v = 0u; v < vertexCount; ++v) {
+			const auto* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * positionsStride);
+			for (uint8_t c = 0u; c < 3u; ++c) {
+				points[v * 3u + c] = p[c];
+				minCorner[c] = std::min(minCorner[c], p[c]);
+				maxCorner[c] = std::max(maxCorner[c], p[c]);
+			}
+		}
+
+		const float extent = std::max(std::max(maxCorner[0u] - minCorner[0u], maxCorner[1u] - minCorner[1u]), maxCorner[2u] - minCorner[2u]);
+		const float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+		for (size_t v = 0u; v < vertexCount; ++v) {
+			for (uint8_t c = 0u; c < 3u; ++c) {
+				points[v * 3u + c] = (points[v * 3u + c] - minCorner[c]) * scale;
+			}
+		}
+
+		// locked vertices: seams (several vertices with the same position, split by uv or normal) and open borders
+		std::vector<bool> locked(vertexCount, false);
+		{
+			struct PositionHash {
+				inline size_t operator()(const std::array<uint32_t, 3u>& p) const noexcept {
+					return (p[0u] * 73856093u) ^ (p[1u] * 19349663u) ^ (p[2u] * 83492791u);
+				}
+			};
+
+			std::unordered_map<std::array<uint32_t, 3u>, uint32_t, PositionHash> positionsMap;
+			positionsMap.reserve(vertexCount);
+			for (size_t v = 0u; v < vertexCount; ++v) {
+				std::array<uint32_t, 3u> key;
+				memcpy(key.data(), &points[v * 3u], sizeof(key));
+				auto [it, inserted] = positionsMap.emplace(key, static_cast<uint32_t>(v));
+				if (!inserted) {
+					locked[v] = true;
+					locked[it->second] = true;
+				}
+			}
+
+			if (params.lockBorder) {
+				std::unordered_map<uint64_t, uint32_t> edges;
+				edges.reserve(indexCount);
+				for (size_t i = 0u; i < indexCount; i += 3u) {
+					for (uint8_t k = 0u; k < 3u; ++k) {
+						const uint32_t a = current[i + k];
+						const uint32_t b = current[i + (k + 1u) % 3u];
+						const uint64_t key = (static_cast<uint64_t>(std::min(a, b)) << 32u) | std::max(a, b);
+						++edges[key];
+					}
+				}
+
+				for (auto&& [key, count] : edges) {
+					if (count == 1u) {
+						locked[static_cast<uint32_t>(key >> 32u)] = true;
+						locked[static_cast<uint32_t>(key & 0xffffffffu)] = true;
+					}
+				}
+			}
+		}
+
+		// vertex quadrics
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0u; i < indexCount; i += 3u) {
+			const float* p0 = &points[current[i + 0u] * 3u];
+			const float* p1 = &points[current[i + 1u] * 3u];
+			const float* p2 = &points[current[i + 2u] * 3u];
+
+			float n[3u];
+			cross(p0, p1, p2, n);
+			const double length = std::sqrt(static_cast<double>(n[0u]) * n[0u] + static_cast<double>(n[1u]) * n[1u] + static_cast<double>(n[2u]) * n[2u]);
+			if (length == 0.0) continue;
+
+			const double a = n[0u] / length, b = n[1u] / length, c = n[2u] / length;
+			const double d = -(a * p0[0u] + b * p0[1u] + c * p0[2u]);
+			const double area = length * 0.5;
+
+			for (uint8_t k = 0u; k < 3u; ++k) {
+				quadrics[current[i + k]].addPlane(a, b, c, d, area);
+			}
+		}
+
+		const bool useSkin = params.joints && params.weights;
+		const double maxCost = static_cast<double>(params.targetError) * static_cast<double>(params.targetError);
+		double achievedCost = 0.0;
+
+		Adjacency adjacency;
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+
+		// check that moving vertex from to position of vertex to don't flip any of remaining triangles
+		const auto flips = [&](const uint32_t from, const uint32_t to) -> bool {
+			const uint32_t* triangles = &adjacency.data[adjacency.offsets[from]];
+			for (uint32_t n = 0u, count = adjacency.counts[from]; n < count; ++n) {
+				const uint32_t* tri = &current[triangles[n] * 3u];
+				if (tri[0u] == to || tri[1u] == to || tri[2u] == to) continue; // triangle will be collapsed
+
+				const float* p[3u] = { &points[tri[0u] * 3u], &points[tri[1u] * 3u], &points[tri[2u] * 3u] };
+				float before[3u];
+				cross(p[0u], p[1u], p[2u], before);
+
+				for (uint8_t k = 0u; k < 3u; ++k) {
+					if (tri[k] == from) { p[k] = &points[to * 3u]; }
+				}
+
+				float after[3u];
+				cross(p[0u], p[1u], p[2u], after);
+
+				if (before[0u] * after[0u] + before[1u] * after[1u] + before[2u] * after[2u] <= 0.0f) {
+					return true;
+				}
+			}
+			return false;
+		};
+
+		while (current.size() > params.targetIndexCount) {
+			const size_t currentCount = current.size();
+			adjacency.build(current.data(), currentCount, vertexCount);
+
+			// collapse candidates
+			collapses.clear();
+			for (size_t i = 0u; i < currentCount; i += 3u) {
+				for (uint8_t k = 0u; k < 3u; ++k) {
+					const uint32_t a = current[i + k];
+					const uint32_t b = current[i + (k + 1u) % 3u];
+					if (a > b && !locked[a] && !locked[b]) continue; // edge will be visited from other triangle
+
+					Quadric q = quadrics[a];
+					q.add(quadrics[b]);
+
+					double skinCost = 0.0;
+					if (useSkin) {
+						const float distance = skinDistance(params.joints, params.weights, a, b);
+						skinCost = static_cast<double>(params.skinWeight) * distance * distance * maxCost; // in units of geometric error
+					}
+
+					const double costAB = locked[a] ? std::numeric_limits<double>::max() : q.error(&points[b * 3u]) + skinCost;
+					const double costBA = locked[b] ? std::numeric_limits<double>::max() : q.error(&points[a * 3u]) + skinCost;
+
+					if (costAB == std::numeric_limits<double>::max() && costBA == std::numeric_limits<double>::max()) continue;
+
+					if (costAB <= costBA) {
+						collapses.push_back({ a, b, costAB });
+					} else {
+						collapses.push_back({ b, a, costBA });
+					}
+				}
+			}
+
+			if (collapses.empty()) break;
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& c1, const Collapse& c2) { return c1.cost < c2.cost; });
+
+			for (size_t v = 0u; v < vertexCount; ++v) {
+				remap[v] = static_cast<uint32_t>(v);
+			}
+			std::fill(touched.begin(), touched.end(), false);
+
+			const size_t trianglesToRemove = (currentCount - params.targetIndexCount) / 3u;
+			size_t removedTriangles = 0u;
+			size_t applied = 0u;
+
+			for (const auto& collapse : collapses) {
+				if (collapse.cost > maxCost) break;
+				if (removedTriangles >= trianglesToRemove) break;
+				if (touched[collapse.from] || touched[collapse.to]) continue;
+				if (flips(collapse.from, collapse.to)) continue;
+
+				// apply collapse, lock 1-ring of removed vertex for this pass
+				const uint32_t* triangles = &adjacency.data[adjacency.offsets[collapse.from]];
+				for (uint32_t n = 0u, count = adjacency.counts[collapse.from]; n < count; ++n) {
+					const uint32_t* tri = &current[triangles[n] * 3u];
+					if (tri[0u] == collapse.to || tri[1u] == collapse.to || tri[2u] == collapse.to) {
+						++removedTriangles;
+					}
+					touched[tri[0u]] = true;
+					touched[tri[1u]] = true;
+					touched[tri[2u]] = true;
+				}
+
+				remap[collapse.from] = collapse.to;
+				quadrics[collapse.to].add(quadrics[collapse.from]);
+				achievedCost = std::max(achievedCost, collapse.cost);
+				++applied;
+			}
+
+			if (applied == 0u) break;
+
+			// apply remap, filter degenerate triangles
+			size_t write = 0u;
+			for (size_t i = 0u; i < currentCount; i += 3u) {
+				const uint32_t a = remap[current[i + 0u]];
+				const uint32_t b = remap[current[i + 1u]];
+				const uint32_t c = remap[current[i + 2u]];
+				if (a != b && b != c && a != c) {
+					current[write + 0u] = a;
+					current[write + 1u] = b;
+					current[write + 2u] = c;
+					write += 3u;
+				}
+			}
+			current.resize(write);
+		}
+
+		if (resultError) {
+			*resultError = static_cast<float>(std::sqrt(achievedCost));
+		}
+
+		memcpy(dst, current.data(), current.size() * sizeof(uint32_t));
+		return current.size();
+	}
+
+	std::vector<std::vector<uint32_t>> generateLods(const std::vector<uint32_t>& indices, const float* positions, const size_t vertexCount,
+													const size_t positionsStride, const uint8_t lodsCount, const float lodReduction,
+													const SimplifyParams& params, std::vector<float>* lodErrors) {
+		std::vector<std::vector<uint32_t>> lods;
+		lods.reserve(lodsCount + 1u);
+		lods.push_back(indices);
+
+		if (lodErrors) {
+			lodErrors->assign(1u, 0.0f);
+		}
+
+		for (uint8_t lod = 1u; lod <= lodsCount; ++lod) {
+			const auto& previous = lods.back();
+			const size_t targetTriangles = static_cast<size_t>(static_cast<float>(previous.size() / 3u) * lodReduction);
+
+			SimplifyParams lodParams = params;
+			lodParams.targetIndexCount = targetTriangles * 3u;
+
+			std::vector<uint32_t> result(previous.size());
+			float error = 0.0f;
+			// simplify from previous level: each level keeps the collapses of previous one
+			result.resize(simplify(result.data(), previous.data(), previous.size(), positions, vertexCount, positionsStride, lodParams, &error));
+
+			if (result.size() == previous.size()) break; // no more reduction possible with given error
+
+			optimizeVertexCache(result.data(), result.data(), result.size(), vertexCount);
+			lods.push_back(std::move(result));
+
+			if (lodErrors) {
+				lodErrors->push_back(error);
+			}
+		}
+
+		return lods;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// offline mesh processing: post-transform cache / vertex fetch ordering and lod generation
+// all functions work with raw triangle lists and have no dependencies from graphics api,
+// so they are shared between engine and Tools/meshOptimizer
+
+namespace engine::mesh_optimizer {
+
+	inline constexpr uint32_t kDefaultCacheSize = 16u;
+
+	struct CacheStatistic {
+		float acmr = 0.0f; // average cache miss ratio (transformed vertices per triangle), best ~0.5, worst 3.0
+		float atvr = 0.0f; // average transformed vertex ratio (transformed vertices per vertex), best 1.0
+		uint32_t misses = 0u;
+	};
+
+	// fifo post-transform cache simulation
+	CacheStatistic analyzeVertexCache(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const uint32_t cacheSize = kDefaultCacheSize);
+
+	// triangles reordering for post-transform cache (Tom Forsyth "Linear-Speed Vertex Cache Optimisation"), dst may be equal indices
+	void optimizeVertexCache(uint32_t* dst, const uint32_t* indices, const size_t indexCount, const size_t vertexCount);
+
+	// vertices reordering for vertex fetch locality: vertices are placed in order of first use by index buffer
+	// remap[oldVertex] = newVertex or 0xffffffff for unused vertices, returns count of used vertices
+	size_t buildVertexFetchRemap(uint32_t* remap, const uint32_t* indices, const size_t indexCount, const size_t vertexCount);
+	void remapIndexBuffer(uint32_t* dst, const uint32_t* indices, const size_t indexCount, const uint32_t* remap);
+	void remapVertexBuffer(void* dst, const void* vertices, const size_t vertexCount, const size_t vertexSize, const uint32_t* remap);
+
+	struct SimplifyParams {
+		size_t targetIndexCount = 0u;
+		float targetError = 1e-2f;			// max error relative to mesh extents
+		bool lockBorder = true;				// don't move vertices on open borders
+		// optional skin data (4 joints + 4 weights per vertex, tightly packed), collapses between vertices
+		// with different skin influences get additional cost, so skinned parts don't "float" between bones
+		const uint16_t* joints = nullptr;
+		const float* weights = nullptr;
+		float skinWeight = 1.0f;			// cost of collapse between completely different influences relative to targetError^2
+	};
+
+	// quadric error metrics simplification with half-edge collapses: collapsed vertex always moves to existing one,
+	// so result indices reference source vertex buffer and all vertex attributes (uv, normals, skin weights) stay untouched
+	// positions - vertexCount * positionsStride bytes, first 3 floats of each vertex are position
+	// returns result index count, resultError (optional) - achieved error relative to mesh extents
+	size_t simplify(uint32_t* dst, const uint32_t* indices, const size_t indexCount,
+					const float* positions, const size_t vertexCount, const size_t positionsStride,
+					const SimplifyParams& params, float* resultError = nullptr);
+
+	// helper for lod chain generation: lodIndices[0] is source indices, every next level has lodReduction of previous triangles count
+	std::vector<std::vector<uint32_t>> generateLods(const std::vector<uint32_t>& indices, const float* positions, const size_t vertexCount,
+													const size_t positionsStride, const uint8_t lodsCount, const float lodReduction,
+													const SimplifyParams& params, std::vector<float>* lodErrors = nullptr);
+}
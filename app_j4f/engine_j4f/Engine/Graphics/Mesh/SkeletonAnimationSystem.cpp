@@ -0,0 +1,194 @@
+#include "SkeletonAnimationSystem.h"
+#include "Mesh.h"
+#include "../../Core/Engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace engine {
+
+	void SkeletonAnimationSystem::submit(MeshSkeleton* skeleton, MeshAnimationTree* animTree, const uint8_t frame) {
+		skeleton->_animationSystem = this;
+		skeleton->_lod.carried = false; // new frame replaces carried one
+		_jobs.push_back({ &skeleton->_skins, skeleton, animTree, 0u, -1.0f, frame });
+	}
+
+	void SkeletonAnimationSystem::remove(const MeshSkeleton* skeleton) noexcept {
+		const auto same = [skeleton](const Job& job) { return job.skeleton == skeleton; };
+		_jobs.erase(std::remove_if(_jobs.begin(), _jobs.end(), same), _jobs.end());
+		_carried.erase(std::remove_if(_carried.begin(), _carried.end(), same), _carried.end());
+	}
+
+	void SkeletonAnimationSystem::releaseJob(std::atomic_uint8_t& state) noexcept {
+		uint8_t expected = JOB_PENDING;
+		if (state.compare_exchange_strong(expected, JOB_REMOVED, std::memory_order_acq_rel, std::memory_order_acquire)) return;
+
+		while (state.load(std::memory_order_acquire) == JOB_RUNNING) {
+			std::this_thread::yield();
+		}
+	}
+
+	const SkeletonAnimationSystem::LodTier* SkeletonAnimationSystem::selectTier(const MeshSkeleton* skeleton) const noexcept {
+		if (_tiers.empty()) return nullptr;
+
+		const float distance = glm::length(skeleton->_lod.center - _viewerPosition);
+		const float screenSize = skeleton->_lod.radius * _projectionScale / std::max(distance, 1e-3f);
+
+		for (const LodTier& tier : _tiers) {
+			if (distance <= tier.maxDistance && screenSize >= tier.minScreenSize) {
+				return &tier;
+			}
+		}
+
+		return &_tiers.back();
+	}
+
+	void SkeletonAnimationSystem::schedule() {
+		const auto busy = [](MeshSkeleton* skeleton) noexcept {
+			for (uint8_t i = 0u; i < skeleton->getLatency(); ++i) {
+				if (skeleton->needSkipAnimCalculation(i)) return true;
+			}
+			return false;
+		};
+
+		++_tick;
+
+		if (const uint32_t measured = _evaluationsCount.exchange(0u, std::memory_order_relaxed); measured > 0u) {
+			const float cost = static_cast<float>(_evaluationTime.exchange(0u, std::memory_order_relaxed)) * 1e-3f / static_cast<float>(measured);
+			_evaluationCost = _evaluationCost > 0.0f ? (_evaluationCost * 0.9f + cost * 0.1f) : cost;
+		}
+
+		size_t dueCount = 0u;
+		for (Job& job : _jobs) {
+			auto& lod = job.skeleton->_lod;
+
+			const LodTier* tier = selectTier(job.skeleton);
+			const uint8_t interval = tier ? std::max(tier->interval, uint8_t(1u)) : 1u;
+			job.behind = _tick - lod.evaluationTick;
+
+			if ((interval > 1u || lod.interval > 1u) && busy(job.skeleton)) { // interpolation poses are shared between latency frames
+				job.alpha = 2.0f;
+				continue;
+			}
+
+			const bool interpolate = tier && tier->interpolate && interval > 1u;
+			if (interval != lod.interval || interpolate != lod.interpolate) {
+				lod.interval = interval;
+				lod.interpolate = interpolate;
+				lod.storedPoses = 0u;
+			}
+
+			if (job.behind >= interval) {
+				job.alpha = -1.0f;
+				++dueCount;
+			} else {
+				job.alpha = interpolate ? static_cast<float>(job.behind) / static_cast<float>(interval) : 2.0f;
+			}
+		}
+
+		// most lagging skeletons are evaluated first, the rest of due ones keep the last pose until the next tick
+		std::stable_sort(_jobs.begin(), _jobs.end(), [](const Job& a, const Job& b) {
+			return (a.alpha < 0.0f) == (b.alpha < 0.0f) ? a.behind > b.behind : a.alpha < 0.0f;
+		});
+
+		size_t evaluations = dueCount;
+		if (_budget > 0u && _evaluationCost > 0.0f && dueCount > 0u) {
+			evaluations = std::clamp(static_cast<size_t>(static_cast<float>(_budget) / _evaluationCost), size_t(1u), dueCount);
+		}
+
+		for (size_t i = 0u; i < _jobs.size(); ++i) {
+			Job& job = _jobs[i];
+			if (i < evaluations) {
+				job.skeleton->_lod.evaluationTick = _tick;
+			} else if (i < dueCount) { // pose isn't touched this tick, evaluation is carried at the same frame and time
+				job.skeleton->_animationSystem = this;
+				job.skeleton->_lod.carried = true;
+				_carried.push_back(job);
+				job.alpha = 2.0f;
+			}
+		}
+
+		_jobs.erase(std::remove_if(_jobs.begin(), _jobs.end(), [](const Job& job) {
+			return job.alpha > 1.0f || (job.alpha >= 0.0f && job.skeleton->_lod.storedPoses < 2u);
+		}), _jobs.end());
+
+		_lastEvaluationsCount = static_cast<uint32_t>(evaluations);
+	}
+
+	void SkeletonAnimationSystem::dispatch() {
+		_lastBatchesCount = 0u;
+
+		for (const Job& job : _carried) {
+			if (job.skeleton->_lod.carried) {
+				job.skeleton->_lod.carried = false;
+				_jobs.push_back(job);
+			}
+		}
+		_carried.clear();
+
+		if (_jobs.empty()) return;
+
+		for (const Job& job : _jobs) {
+			job.skeleton->_animationSystem = nullptr;
+		}
+
+		schedule();
+
+		std::stable_sort(_jobs.begin(), _jobs.end(), [](const Job& a, const Job& b) { return a.layout < b.layout; });
+
+		auto&& threadPool = Engine::getInstance().getModule<ThreadPool2>();
+		const size_t batchesMax = std::max(threadPool.threadsCount(), size_t(1u)) * 2u;
+		const size_t batchSize = std::max(static_cast<size_t>(kMinBatchSize), (_jobs.size() + batchesMax - 1u) / batchesMax);
+
+		for (size_t first = 0u; first < _jobs.size(); first += batchSize) {
+			auto batch = std::make_shared<Batch>();
+			batch->jobs.assign(_jobs.begin() + first, _jobs.begin() + std::min(first + batchSize, _jobs.size()));
+			batch->states = std::make_unique<std::atomic_uint8_t[]>(batch->jobs.size()); // JOB_PENDING
+
+			auto task = threadPool.enqueue(TaskType::COMMON, [this, batch](const CancellationToken& token) {
+				uint64_t evaluationTime = 0u;
+				uint32_t evaluationsCount = 0u;
+
+				for (size_t i = 0u; i < batch->jobs.size(); ++i) {
+					if (token) break;
+
+					uint8_t state = JOB_PENDING;
+					if (!batch->states[i].compare_exchange_strong(state, JOB_RUNNING, std::memory_order_acq_rel, std::memory_order_acquire)) {
+						continue; // skeleton is destroyed
+					}
+
+					const Job& job = batch->jobs[i];
+					if (job.alpha >= 0.0f) {
+						job.skeleton->interpolateLodPose(job.frame, job.alpha);
+					} else {
+						const auto start = std::chrono::steady_clock::now();
+						applyAnimationFrameToSkeleton(token, job.skeleton, job.animTree, job.frame);
+						evaluationTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+						++evaluationsCount;
+
+						if (job.skeleton->_lod.interpolate) { // stepping tiers show evaluated pose at once
+							job.skeleton->storeLodPose(job.frame);
+							job.skeleton->interpolateLodPose(job.frame, 0.0f); // display is delayed by one interval
+						}
+					}
+
+					batch->states[i].store(JOB_DONE, std::memory_order_release);
+				}
+
+				_evaluationTime.fetch_add(evaluationTime, std::memory_order_relaxed);
+				_evaluationsCount.fetch_add(evaluationsCount, std::memory_order_relaxed);
+			});
+
+			for (size_t i = 0u; i < batch->jobs.size(); ++i) {
+				const Job& job = batch->jobs[i];
+				job.skeleton->_animCalculationResult[job.frame] = task;
+				job.skeleton->_animationJobs[job.frame] = JobStatePtr(batch, &batch->states[i]);
+			}
+
+			++_lastBatchesCount;
+		}
+
+		_jobs.clear();
+	}
+}
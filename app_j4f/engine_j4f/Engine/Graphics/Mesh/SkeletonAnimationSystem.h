@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../../Core/Math/mathematic.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace engine {
+
+	class MeshSkeleton;
+	class MeshAnimationTree;
+
+	// collects skeletons due for update during animation manager update and evaluates them in batches:
+	// one pool task (and one completion signal) per batch instead of one task per skeleton,
+	// skeletons of the same mesh data go to the same batch
+	//
+	// update rate level of detail: invisible skeletons are not submitted at all (no render data update),
+	// visible ones get the interval of the first tier they fit by distance to viewer and screen size,
+	// between full evaluations pose is interpolated; per tick evaluation budget schedules the most lagging skeletons first,
+	// due skeletons over budget keep their current pose and are carried to the next tick, unless they are submitted again
+	// level of detail is opt-in: without setLodTiers every submitted skeleton is evaluated every tick,
+	// application sets tiers once and updates viewer on its camera changes (see example application)
+	class SkeletonAnimationSystem {
+	public:
+		inline static constexpr uint32_t kMinBatchSize = 8u;
+
+		struct LodTier {
+			float maxDistance;
+			float minScreenSize;	// projected bounds radius, in units of projection scale (pixels, if scale is in pixels)
+			uint8_t interval;		// ticks between full evaluations
+			bool interpolate;
+		};
+
+		// state of skeleton job in dispatched batch, shared by batch and skeleton
+		enum JobState : uint8_t {
+			JOB_PENDING = 0u,
+			JOB_RUNNING = 1u,
+			JOB_DONE = 2u,
+			JOB_REMOVED = 3u
+		};
+		using JobStatePtr = std::shared_ptr<std::atomic_uint8_t>;
+
+		void submit(MeshSkeleton* skeleton, MeshAnimationTree* animTree, const uint8_t frame);
+		void remove(const MeshSkeleton* skeleton) noexcept;
+		void dispatch();
+
+		// destroyed skeleton: pending job is skipped by its batch, running one is waited for, the rest of batch isn't touched
+		static void releaseJob(std::atomic_uint8_t& state) noexcept;
+
+		// projectionScale: projection[1][1] * viewport height * 0.5 for screen size in pixels
+		inline void setViewer(const vec3f& position, const float projectionScale) noexcept {
+			_viewerPosition = position;
+			_projectionScale = projectionScale;
+		}
+
+		// tiers are checked in order, skeletons which fit no tier use the last one; no tiers - every skeleton every tick
+		inline void setLodTiers(std::vector<LodTier> tiers) { _tiers = std::move(tiers); }
+		[[nodiscard]] inline const std::vector<LodTier>& getLodTiers() const noexcept { return _tiers; }
+
+		// full evaluations cost budget per tick (summary cpu time of all workers), 0 - unlimited
+		inline void setBudget(const uint32_t microseconds) noexcept { _budget = microseconds; }
+		[[nodiscard]] inline uint32_t getBudget() const noexcept { return _budget; }
+
+		[[nodiscard]] inline size_t pending() const noexcept { return _jobs.size() + _carried.size(); }
+		[[nodiscard]] inline uint32_t lastBatchesCount() const noexcept { return _lastBatchesCount; }
+		[[nodiscard]] inline uint32_t lastEvaluationsCount() const noexcept { return _lastEvaluationsCount; }
+		[[nodiscard]] inline float evaluationCost() const noexcept { return _evaluationCost; } // estimated microseconds per skeleton
+
+	private:
+		struct Job {
+			const void* layout;
+			MeshSkeleton* skeleton;
+			MeshAnimationTree* animTree;
+			uint32_t behind;	// ticks since last full evaluation
+			float alpha;		// interpolation factor, negative for full evaluation
+			uint8_t frame;
+		};
+
+		struct Batch {
+			std::vector<Job> jobs;
+			std::unique_ptr<std::atomic_uint8_t[]> states;
+		};
+
+		[[nodiscard]] const LodTier* selectTier(const MeshSkeleton* skeleton) const noexcept;
+		void schedule();
+
+		std::vector<Job> _jobs;
+		std::vector<Job> _carried;
+		std::vector<LodTier> _tiers;
+		vec3f _viewerPosition = vec3f(0.0f);
+		float _projectionScale = 1.0f;
+		uint32_t _budget = 0u;
+		uint32_t _tick = 0u;
+
+		float _evaluationCost = 0.0f;
+		std::atomic<uint64_t> _evaluationTime = { 0u }; // nanoseconds, measured by batches since last dispatch
+		std::atomic<uint32_t> _evaluationsCount = { 0u };
+
+		uint32_t _lastBatchesCount = 0u;
+		uint32_t _lastEvaluationsCount = 0u;
+	};
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../../Core/Hash.h"
+#include "../../Core/Math/mathematic.h"
+#include "../../Core/Threads/Synchronisations.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace engine {
+
+	// evaluated poses shared between skeletons of the same mesh data, which play the same clip at (nearly) the same time:
+	// first skeleton calculates nodes and skins matrices and stores them, others copy result instead of calculation
+	// direct mapped table: collision just replaces the slot, so memory is bounded by slots count
+	class SkeletonPoseCache {
+	public:
+		struct Key {
+			const void* layout = nullptr;		// nodes and skins source (Mesh_Data skins)
+			const void* animation = nullptr;	// Mesh_Animation or CompressedAnimation
+			uint32_t time = 0u;					// quantized animation time
+			bool useRootTransform = true;		// skins matrices are relative to skeleton root or not
+
+			inline bool operator==(const Key& k) const noexcept = default;
+		};
+
+		struct Pose {
+			std::vector<mat4f> nodesMatrices;
+			std::vector<std::vector<mat4f>> skinsMatrices;
+		};
+
+		explicit SkeletonPoseCache(const float timeStep = 1.0f / 60.0f, const uint32_t slotsCount = 256u) :
+			_slots(std::make_unique<Slot[]>(slotsCount)),
+			_slotsCount(slotsCount),
+			_timeScale(1.0f / timeStep) {}
+
+		[[nodiscard]] inline Key makeKey(const void* layout, const void* animation, const float time, const bool useRootTransform) const noexcept {
+			return { layout, animation, static_cast<uint32_t>(std::max(time, 0.0f) * _timeScale + 0.5f), useRootTransform };
+		}
+
+		[[nodiscard]] inline std::shared_ptr<const Pose> find(const Key& key) noexcept {
+			Slot& slot = _slots[slotIndex(key)];
+			std::shared_ptr<const Pose> pose;
+			{
+				AtomicLockF lock(slot.lock);
+				if (slot.pose && slot.key == key) {
+					pose = slot.pose;
+				}
+			}
+
+			(pose ? _hits : _misses).fetch_add(1u, std::memory_order_relaxed);
+			return pose;
+		}
+
+		inline void store(const Key& key, std::shared_ptr<const Pose> pose) noexcept {
+			Slot& slot = _slots[slotIndex(key)];
+			AtomicLockF lock(slot.lock);
+			slot.key = key;
+			slot.pose = std::move(pose); // previous pose is released after its last reader
+		}
+
+		inline void clear() noexcept {
+			for (uint32_t i = 0u; i < _slotsCount; ++i) {
+				AtomicLockF lock(_slots[i].lock);
+				_slots[i].pose = nullptr;
+			}
+		}
+
+		[[nodiscard]] inline uint64_t hits() const noexcept { return _hits.load(std::memory_order_relaxed); }
+		[[nodiscard]] inline uint64_t misses() const noexcept { return _misses.load(std::memory_order_relaxed); }
+
+	private:
+		struct Slot {
+			std::atomic_flag lock;
+			Key key;
+			std::shared_ptr<const Pose> pose;
+		};
+
+		[[nodiscard]] inline uint32_t slotIndex(const Key& key) const noexcept {
+			return static_cast<uint32_t>(hash_combine(key.layout, key.animation, key.time, key.useRootTransform) % _slotsCount);
+		}
+
+		std::unique_ptr<Slot[]> _slots;
+		uint32_t _slotsCount;
+		float _timeScale;
+		std::atomic<uint64_t> _hits = { 0u };
+		std::atomic<uint64_t> _misses = { 0u };
+	};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "../../Core/Math/mathematic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+// quantized mesh vertex layouts (MeshLoadingParams::quantizationMask), every attribute stays 4 bytes aligned,
+// so Mesh_Data::vertexSize is still counted in 32 bit words:
+// - POSITION_HALF:		half x 4, read as vec3 / vec4 in shader
+// - POSITION_SNORM16:	snorm16 x 4 against mesh bounds (uniform scale), read as vec3 in shader,
+//						dequantization is multiplied into skins inverse bind matrices and matrices of not skinned nodes
+// - NORMAL_OCTAHEDRAL:	normal - snorm16 x 2, tangent - snorm16 x 4 (octahedral xy, handedness, 0), shader decodes them with
+//						vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y)); float t = max(-n.z, 0.0); n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0))); n = normalize(n);
+// - TEXCOORD_UNORM16:	unorm16 x 2, texture coordinates must be in [0, 1]
+// - SKIN_8:			joints - uint8 x 4 (uvec4 in shader), weights - unorm8 x 4
+
+namespace engine {
+
+	enum class VertexQuantization : uint8_t {
+		POSITION_HALF = 0u,
+		POSITION_SNORM16 = 1u,
+		NORMAL_OCTAHEDRAL = 2u,
+		TEXCOORD_UNORM16 = 3u,
+		SKIN_8 = 4u,
+		QUANTIZATIONS_COUNT
+	};
+
+	inline void quantizationMask(uint8_t& mask, VertexQuantization q) {
+		mask |= 1u << static_cast<uint8_t>(q);
+	}
+
+	template <typename... Args>
+	inline void quantizationMask(uint8_t& mask, VertexQuantization q, Args&&... args) {
+		mask |= 1u << static_cast<uint8_t>(q);
+		quantizationMask(mask, std::forward<Args>(args)...);
+	}
+
+	template <typename... Args>
+	inline uint8_t makeQuantizationMask(Args&&... args) {
+		uint8_t mask = 0u;
+		quantizationMask(mask, std::forward<Args>(args)...);
+		return mask;
+	}
+
+	[[nodiscard]] inline bool hasQuantization(const uint8_t mask, const VertexQuantization q) noexcept {
+		return mask & (1u << static_cast<uint8_t>(q));
+	}
+
+	namespace quantization {
+		[[nodiscard]] inline int16_t snorm16(const float v) noexcept {
+			return static_cast<int16_t>(std::round(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		[[nodiscard]] inline uint16_t unorm16(const float v) noexcept {
+			return static_cast<uint16_t>(std::round(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+		}
+
+		[[nodiscard]] inline uint8_t unorm8(const float v) noexcept {
+			return static_cast<uint8_t>(std::round(std::clamp(v, 0.0f, 1.0f) * 255.0f));
+		}
+
+		[[nodiscard]] inline uint16_t halfBits(const float v) noexcept {
+			return HalfFloat(v).GetBits();
+		}
+
+		// unit vector -> [-1, 1]^2
+		[[nodiscard]] inline vec2f octahedral(const float x, const float y, const float z) noexcept {
+			const float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+			if (l1 == 0.0f) return vec2f(0.0f);
+
+			vec2f e(x / l1, y / l1);
+			if (z < 0.0f) {
+				e = vec2f((1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f));
+			}
+			return e;
+		}
+
+		[[nodiscard]] inline vec3f octahedralDecode(const vec2f e) noexcept {
+			vec3f n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+			const float t = std::max(-n.z, 0.0f);
+			n.x += n.x >= 0.0f ? -t : t;
+			n.y += n.y >= 0.0f ? -t : t;
+			return glm::normalize(n);
+		}
+
+		// weights summed to exactly 255 after rounding
+		inline void weights8(const float* w, uint8_t* out) noexcept {
+			int32_t sum = 0;
+			uint8_t largest = 0u;
+			for (uint8_t i = 0u; i < 4u; ++i) {
+				out[i] = unorm8(w[i]);
+				sum += out[i];
+				if (out[i] > out[largest]) largest = i;
+			}
+
+			if (sum != 0) {
+				out[largest] = static_cast<uint8_t>(std::clamp(static_cast<int32_t>(out[largest]) + 255 - sum, 0, 255));
+			}
+		}
+
+		template <typename T, size_t N>
+		inline void store(float* dst, const T(&v)[N]) noexcept {
+			static_assert((sizeof(T) * N) % sizeof(float) == 0u);
+			memcpy(dst, v, sizeof(v));
+		}
+	}
+}
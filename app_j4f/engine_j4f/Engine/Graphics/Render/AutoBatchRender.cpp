@@ -1,5 +1,6 @@
 #include "AutoBatchRender.h"
 #include "RenderHelper.h"
+#include "IndexPacking.h"
 #include "../../Engine/Core/Engine.h"
 
 namespace engine {
@@ -39,6 +40,10 @@ namespace engine {
 			memcpy(&_vtx[vtxSize], vtxData, vtxDataSize);
 		}
 
+		if (vertexSize != 0u) {
+			_vertexCount += vtxDataSize / vertexSize;
+		}
+
         const size_t idxSize = _idx.size();
         _idx.resize(idxSize + idxDataSize / sizeof(uint32_t));
 
@@ -59,13 +64,20 @@ namespace engine {
 
 		const size_t idx_count = _idx.size();
 
+		// batch range with 16 bit indices, if it fits them
+		const uint8_t indexSize = indexSizeForVertexCount(_vertexCount);
+		if (indexSize == sizeof(uint16_t)) {
+			packIndices16(_idx.data(), idx_count, _idx.data());
+		}
+
 		auto&& renderHelper = Engine::getInstance().getModule<Graphics>().getRenderHelper();
 
 		auto&& vBuffer = renderHelper->addDynamicVerteces(&_vtx[0], _vtx.size() * sizeof(float), vOffset);
 		_vtx.clear();
+		_vertexCount = 0u;
 		auto&& iBuffer = renderHelper->addDynamicIndices(
                 &_idx[0],
-                idx_count * sizeof(uint32_t),
+                indexRangeSize(idx_count, indexSize),
                 iOffset);
 
             _idx.clear();
@@ -81,15 +93,15 @@ namespace engine {
 
 		renderData->vertexes = &vBuffer;
 		renderData->indexes = &iBuffer;
-        renderData->indexType = VK_INDEX_TYPE_UINT32;
 
 		vulkan::RenderData::RenderPart renderPart{
-													static_cast<uint32_t>(iOffset / sizeof(uint32_t)),	// firstIndex
+													static_cast<uint32_t>(iOffset / indexSize),			// firstIndex
 													static_cast<uint32_t>(idx_count),					// indexCount
 													0,												// vertexCount (parameter no used with indexed render)
 													0,												// firstVertex
 													vOffset,											// vbOffset
-													0													// ibOffset
+													0,													// ibOffset
+													indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32 // indexType
 		};
 
 		renderData->replaceParams(_params);
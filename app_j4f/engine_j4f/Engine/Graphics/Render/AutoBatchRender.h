@@ -44,7 +44,8 @@ namespace engine {
 
 		std::unordered_map<vulkan::VulkanPipeline*, vulkan::RenderData*> _render_data_map;
 		std::vector<float> _vtx;
-        std::vector<uint32_t> _idx;
+        std::vector<uint32_t> _idx; // packed to uint16 pairs at draw, if batch vertices fit 16 bit indices
+		size_t _vertexCount = 0u;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 16 bit indices are used for every mesh or batch range which fits them,
+// ranges of packed indices are padded to 32 bit words, so ranges of both types can follow each other in one index buffer
+// (offsets in buffer stay aligned for any index type)
+
+namespace engine {
+
+	inline constexpr uint32_t kMaxIndex16VertexCount = 0xffffu; // index 0xffff is left for primitive restart
+
+	[[nodiscard]] inline constexpr uint8_t indexSizeForVertexCount(const size_t vertexCount) noexcept {
+		return vertexCount <= kMaxIndex16VertexCount ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
+	// bytes of indexCount indices, padded to 32 bit words
+	[[nodiscard]] inline constexpr size_t indexRangeSize(const size_t indexCount, const uint8_t indexSize) noexcept {
+		return (indexCount * indexSize + (sizeof(uint32_t) - 1u)) & ~(sizeof(uint32_t) - 1u);
+	}
+
+	// uint32 indices -> uint16 pairs in 32 bit words (little endian, as all targets), dst can be equal to src
+	inline void packIndices16(const uint32_t* src, const size_t count, uint32_t* dst) noexcept {
+		const size_t pairs = count / 2u;
+		for (size_t i = 0u; i < pairs; ++i) {
+			dst[i] = (src[2u * i] & 0xffffu) | (src[2u * i + 1u] << 16u);
+		}
+
+		if (count & 1u) {
+			dst[pairs] = src[count - 1u] & 0xffffu;
+		}
+	}
+}
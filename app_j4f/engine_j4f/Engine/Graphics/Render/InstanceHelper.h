@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../Vulkan/vkGPUProgram.h"
+#include "../Mesh/AnimationBaker.h"
 #include "Engine/Core/Math/mathematic.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <vector>
 #include <memory>
@@ -27,12 +30,70 @@ namespace engine {
 		inline void updateGPUTransfromsData(const std::vector<vulkan::VulkanGpuProgram*>& programs) const {}
 	};
 
+	// instanced skinned meshes animated on gpu with baked palettes (BakedAnimation::Format::Matrix3x4 layout of mesh_skin_instance_baked.vsh)
+	// per instance data is only (clip, time offset), so crowd costs no cpu skeleton updates
+	// one batch draws at most maxInstances instances of at most BakedAnimation::maxClips clips, larger crowds are split into several renderers
+	class BakedAnimationInstanceStrategy {
+	public:
+		static constexpr uint32_t maxInstances = BakedAnimation::maxInstances;
+
+		BakedAnimationInstanceStrategy(const std::vector<mat4f>& transforms, const std::vector<vulkan::VulkanGpuProgram*>& programs,
+									   const BakedAnimation* animation, const std::vector<BakedAnimationInstance>& instances) {
+			assert(transforms.size() <= maxInstances && animation->clips.size() <= BakedAnimation::maxClips);
+
+			const size_t instancesCount = std::min({ transforms.size(), instances.size(), static_cast<size_t>(maxInstances) });
+			const size_t clipsCount = std::min(animation->clips.size(), static_cast<size_t>(BakedAnimation::maxClips));
+
+			std::vector<vec4f> instancesData(instancesCount);
+			for (size_t i = 0u; i < instancesCount; ++i) {
+				const uint32_t clip = std::min(instances[i].clip, static_cast<uint32_t>(std::max(clipsCount, size_t(1u)) - 1u));
+				instancesData[i] = vec4f(static_cast<float>(clip), instances[i].timeOffset, 0.0f, 0.0f);
+			}
+
+			std::vector<glm::uvec4> clipsData(clipsCount);
+			for (size_t i = 0u; i < clipsCount; ++i) {
+				clipsData[i] = glm::uvec4(animation->clips[i].firstFrame, animation->clips[i].framesCount, 0u, 0u);
+			}
+
+			for (auto&& p : programs) {
+				p->setValueByName("models", transforms.data(), nullptr, vulkan::VulkanGpuProgram::UNDEFINED, sizeof(mat4f) * instancesCount, true);
+				p->setValueByName("instances", instancesData.data(), nullptr, vulkan::VulkanGpuProgram::UNDEFINED, sizeof(vec4f) * instancesData.size(), true);
+				p->setValueByName("clips", clipsData.data(), nullptr, vulkan::VulkanGpuProgram::UNDEFINED, sizeof(glm::uvec4) * clipsData.size(), true);
+				p->setValueByName("sample_rate", &animation->sampleRate, nullptr, vulkan::VulkanGpuProgram::UNDEFINED, sizeof(float), true);
+				p->setValueByName("joints_count", &animation->jointsCount, nullptr, vulkan::VulkanGpuProgram::UNDEFINED, sizeof(uint32_t), true);
+				p->setValueByName("palettes", animation->texels.data(), nullptr, vulkan::VulkanGpuProgram::UNDEFINED, sizeof(vec4f) * animation->texels.size(), true);
+			}
+		}
+
+		inline void setTime(const float time) noexcept { _time = time; }
+		inline void addTime(const float delta) noexcept { _time += delta; }
+
+		inline void updateGPUTransfromsData(const std::vector<vulkan::VulkanGpuProgram*>& programs) const {
+			for (auto&& p : programs) {
+				p->setValueByName("animation_time", &_time, nullptr, vulkan::VulkanGpuProgram::UNDEFINED, sizeof(float), true);
+			}
+		}
+
+	private:
+		float _time = 0.0f;
+	};
+
+	// instances count of one draw, strategies with per draw arrays of fixed size declare maxInstances
+	template <typename Strategy>
+	inline uint32_t instanceCountFor(const size_t count) noexcept {
+		if constexpr (requires { Strategy::maxInstances; }) {
+			return static_cast<uint32_t>(std::min(count, static_cast<size_t>(Strategy::maxInstances)));
+		} else {
+			return static_cast<uint32_t>(count);
+		}
+	}
+
 	template <typename T, typename Strategy>
 	class InstanceRenderer {
 	public:
 		template <typename... Args>
 		InstanceRenderer(const std::vector<mat4f>& transforms, T* graphics, Args&&...args) :
-			_instanceCount(transforms.size()), 
+			_instanceCount(instanceCountFor<Strategy>(transforms.size())), 
 			_graphics(graphics),
 			_strategy(std::make_unique<Strategy>(transforms, std::forward<Args>(args)...))
 		{
@@ -41,7 +102,7 @@ namespace engine {
 
 		template <typename... Args>
 		InstanceRenderer(std::vector<mat4f>&& transforms, T* graphics, Args&&...args) :
-			_instanceCount(transforms.size()), 
+			_instanceCount(instanceCountFor<Strategy>(transforms.size())), 
 			_graphics(graphics),
 			_strategy(std::make_unique<Strategy>(transforms, std::forward<Args>(args)...))
 		{
@@ -79,6 +140,9 @@ namespace engine {
 			return _graphics->setProgram(program, renderPass);
 		}
 
+		inline const Strategy* getStrategy() const noexcept { return _strategy.get(); }
+		inline Strategy* getStrategy() noexcept { return _strategy.get(); }
+
 		inline const RenderDescriptor& getRenderDescriptor() const { return _graphics->getRenderDescriptor(); }
 		inline RenderDescriptor& getRenderDescriptor() { return _graphics->getRenderDescriptor(); }
 
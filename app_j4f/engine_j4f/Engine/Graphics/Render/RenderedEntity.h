@@ -194,7 +194,6 @@ namespace engine {
 
 				dst->vertexSize = src->vertexSize;
 				dst->batchingParams = src->batchingParams;
-				dst->indexType = src->indexType;
 
 				dst->renderPartsCount = src->renderPartsCount;
 				dst->renderParts = new vulkan::RenderData::RenderPart[dst->renderPartsCount];
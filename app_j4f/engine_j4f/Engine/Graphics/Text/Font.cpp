@@ -13,15 +13,14 @@
 
 namespace engine {
 
-    FontData::FontData(char* data, const size_t size) : fdata(data), fileSize(size) { }
+    FontData::FontData(char* data, const size_t size) :
+            file(std::shared_ptr<const char[]>(data), reinterpret_cast<const std::byte*>(data), size), fdata(data), fileSize(size) { }
 
-    FontData::FontData(const std::string& path) {
-        fdata = Engine::getInstance().getModule<FileManager>().readFile(path, fileSize);
-    }
+    FontData::FontData(const std::string& path) : file(Engine::getInstance().getModule<FileManager>().readFileMapped(path)), fdata(file.chars()), fileSize(file.size()) { }
 
     FT_Error ftc_face_requester(FTC_FaceID faceID, FT_Library lib, FT_Pointer reqData, FT_Face* face) {
         Font* f = reinterpret_cast<Font*>(reqData);
-        return FT_New_Memory_Face(lib, reinterpret_cast<FT_Byte*>(f->fontData->fdata), f->fontData->fileSize, 0, face);
+        return FT_New_Memory_Face(lib, reinterpret_cast<const FT_Byte*>(f->fontData->fdata), f->fontData->fileSize, 0, face);
     }
 
     Font::Font(FT_Library library, FontData* data) : fontData(data), ftcLibrary(library) {
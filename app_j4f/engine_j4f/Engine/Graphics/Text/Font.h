@@ -4,6 +4,8 @@
 #include FT_FREETYPE_H
 #include <freetype/ftcache.h> // to enable native freetype cache system
 
+#include "../../File/FileView.h"
+
 #include <cstdint>
 #include <string>
 #include <string_view>
@@ -16,14 +18,12 @@ namespace vulkan {
 namespace engine {
 
 	struct FontData {
-		char* fdata = nullptr;
+		FileView file;
+		const char* fdata = nullptr;
 		size_t fileSize = 0;
 
-		FontData(char* data, const size_t size);
+		FontData(char* data, const size_t size); // takes new[] allocated data
 		FontData(const std::string& path);
-		~FontData() {
-			delete[] fdata; // or use cache for it?
-		}
 	};
 
 	struct Font {
@@ -3,33 +3,11 @@
 #include "../../Core/Cache.h"
 #include "../Graphics.h"
 #include "../../Core/Threads/ThreadPool.h"
-#include "../../Core/Threads/Synchronisations.h"
 #include "../../Utils/Debug/Profiler.h"
 #include <string>
 
 namespace engine {
 
-	void FontLoader::addCallback(Font* f, const FontLoadingCallback& c) {
-		AtomicLock lock(_callbacksLock);
-		_callbacks[f].emplace_back(c);
-	}
-
-	void FontLoader::executeCallbacks(Font* f, const AssetLoadingResult result) {
-		std::vector<FontLoadingCallback> callbacks;
-		{
-			AtomicLock lock(_callbacksLock);
-			auto it = _callbacks.find(f);
-			if (it != _callbacks.end()) {
-				callbacks = std::move(it->second);
-				_callbacks.erase(it);
-			}
-		}
-
-		for (auto&& c : callbacks) {
-			c(f, result);
-		}
-	}
-
 	void FontLoader::loadAsset(Font*& v, const FontLoadingParams& params, const FontLoadingCallback& callback) {
 		PROFILE_TIME_SCOPED_M(fontLoading, params.file)
 		auto&& engine = Engine::getInstance();
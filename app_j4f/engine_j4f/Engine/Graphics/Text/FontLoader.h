@@ -3,7 +3,7 @@
 #include "Font.h"
 #include "../../Core/AssetManager.h"
 
-#include <atomic>
+#include <string>
 #include <string_view>
 
 namespace engine {
@@ -23,12 +23,7 @@ namespace engine {
 		using asset_type = Font*;
 		static void loadAsset(Font*& v, const FontLoadingParams& params, const FontLoadingCallback& callback);
         static void cleanUp() noexcept {}
-	private:
-		static void addCallback(Font*, const FontLoadingCallback&);
-		static void executeCallbacks(Font*, const AssetLoadingResult);
-
-		inline static std::atomic_bool _callbacksLock;
-		inline static std::unordered_map<Font*, std::vector<FontLoadingCallback>> _callbacks;
+		static std::string requestKey(const FontLoadingParams& params) { return params.file; }
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "BlockDecoder.h"
+#include "Ktx2Format.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace engine {
+
+	namespace {
+		inline uint16_t read16(const uint8_t* p) noexcept { return static_cast<uint16_t>(p[0u] | (p[1u] << 8u)); }
+
+		inline uint64_t read64(const uint8_t* p) noexcept {
+			uint64_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		// bc1 color block (8 bytes), fourColors - 4 colors even if c0 <= c1 (bc3), alphaBlack - 3 colors + transparent black (bc1 rgba)
+		void decodeColors(const uint8_t* block, uint8_t* rgba, const bool alphaBlack, const bool fourColors) noexcept {
+			const uint16_t c0 = read16(block);
+			const uint16_t c1 = read16(block + 2u);
+
+			uint8_t colors[4u][4u];
+			const auto expand = [](const uint16_t c, uint8_t* out) {
+				const uint32_t r = (c >> 11u) & 31u;
+				const uint32_t g = (c >> 5u) & 63u;
+				const uint32_t b = c & 31u;
+				out[0u] = static_cast<uint8_t>((r << 3u) | (r >> 2u));
+				out[1u] = static_cast<uint8_t>((g << 2u) | (g >> 4u));
+				out[2u] = static_cast<uint8_t>((b << 3u) | (b >> 2u));
+				out[3u] = 255u;
+			};
+
+			expand(c0, colors[0u]);
+			expand(c1, colors[1u]);
+
+			if (fourColors || c0 > c1) {
+				for (uint32_t i = 0u; i < 3u; ++i) {
+					colors[2u][i] = static_cast<uint8_t>((2u * colors[0u][i] + colors[1u][i] + 1u) / 3u);
+					colors[3u][i] = static_cast<uint8_t>((colors[0u][i] + 2u * colors[1u][i] + 1u) / 3u);
+				}
+				colors[2u][3u] = colors[3u][3u] = 255u;
+			} else {
+				for (uint32_t i = 0u; i < 3u; ++i) {
+					colors[2u][i] = static_cast<uint8_t>((colors[0u][i] + colors[1u][i] + 1u) / 2u);
+					colors[3u][i] = 0u;
+				}
+				colors[2u][3u] = 255u;
+				colors[3u][3u] = alphaBlack ? 0u : 255u;
+			}
+
+			uint32_t indices = block[4u] | (block[5u] << 8u) | (block[6u] << 16u) | (static_cast<uint32_t>(block[7u]) << 24u);
+			for (uint32_t i = 0u; i < 16u; ++i, indices >>= 2u) {
+				memcpy(rgba + i * 4u, colors[indices & 3u], 4u);
+			}
+		}
+
+		// bc4 channel block (8 bytes) -> channel of rgba texels
+		void decodeChannel(const uint8_t* block, uint8_t* rgba, const uint32_t channel) noexcept {
+			const uint32_t v0 = block[0u];
+			const uint32_t v1 = block[1u];
+
+			uint8_t values[8u] = { static_cast<uint8_t>(v0), static_cast<uint8_t>(v1) };
+			if (v0 > v1) {
+				for (uint32_t i = 1u; i < 7u; ++i) {
+					values[i + 1u] = static_cast<uint8_t>(((7u - i) * v0 + i * v1 + 3u) / 7u);
+				}
+			} else {
+				for (uint32_t i = 1u; i < 5u; ++i) {
+					values[i + 1u] = static_cast<uint8_t>(((5u - i) * v0 + i * v1 + 2u) / 5u);
+				}
+				values[6u] = 0u;
+				values[7u] = 255u;
+			}
+
+			uint64_t indices = read64(block) >> 16u;
+			for (uint32_t i = 0u; i < 16u; ++i, indices >>= 3u) {
+				rgba[i * 4u + channel] = values[indices & 7u];
+			}
+		}
+
+		///////////////////////////////////////////////////////////
+		// bc7, modes as in d3d11 / vulkan block compression spec
+
+		struct Bc7Mode {
+			uint8_t subsets;
+			uint8_t partitionBits;
+			uint8_t rotationBits;
+			uint8_t indexSelectionBits;
+			uint8_t colorBits;
+			uint8_t alphaBits;
+			uint8_t endpointPBits;
+			uint8_t sharedPBits;
+			uint8_t indexBits;
+			uint8_t indexBits2;
+		};
+
+		constexpr Bc7Mode kBc7Modes[8u] = {
+			{ 3u, 4u, 0u, 0u, 4u, 0u, 1u, 0u, 3u, 0u },
+			{ 2u, 6u, 0u, 0u, 6u, 0u, 0u, 1u, 3u, 0u },
+			{ 3u, 6u, 0u, 0u, 5u, 0u, 0u, 0u, 2u, 0u },
+			{ 2u, 6u, 0u, 0u, 7u, 0u, 1u, 0u, 2u, 0u },
+			{ 1u, 0u, 2u, 1u, 5u, 6u, 0u, 0u, 2u, 3u },
+			{ 1u, 0u, 2u, 0u, 7u, 8u, 0u, 0u, 2u, 2u },
+			{ 1u, 0u, 0u, 0u, 7u, 7u, 1u, 0u, 4u, 0u },
+			{ 2u, 6u, 0u, 0u, 5u, 5u, 1u, 0u, 2u, 0u }
+		};
+
+		// subset of texel, bit i of 2 subsets partition
+		constexpr uint16_t kPartitions2[64u] = {
+			0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+			0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+			0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+			0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+		};
+
+		// 3 subsets partitions, 2 bits per texel
+		constexpr uint32_t kPartitions3[64u] = {
+			0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+			0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+			0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+			0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+			0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+			0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+			0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+			0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+		};
+
+		// anchor texel of subset 1 (2 subsets), subsets 1 and 2 (3 subsets), anchor of subset 0 is texel 0
+		constexpr uint8_t kAnchors2[64u] = {
+			15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+			15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+			15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+			 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+		};
+
+		constexpr uint8_t kAnchors3a[64u] = {
+			 3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+			 3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+			 8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+			 3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3
+		};
+
+		constexpr uint8_t kAnchors3b[64u] = {
+			15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+			15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+			15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+			15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8
+		};
+
+		constexpr uint8_t kWeights2[4u] = { 0, 21, 43, 64 };
+		constexpr uint8_t kWeights3[8u] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+		constexpr uint8_t kWeights4[16u] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		class BitReader {
+		public:
+			explicit BitReader(const uint8_t* block) noexcept : _low(read64(block)), _high(read64(block + 8u)) {}
+
+			uint32_t read(const uint32_t count) noexcept {
+				if (count == 0u) return 0u;
+				const uint32_t v = static_cast<uint32_t>(_low & ((1ull << count) - 1u));
+				_low = (_low >> count) | (_high << (64u - count));
+				_high >>= count;
+				return v;
+			}
+
+		private:
+			uint64_t _low;
+			uint64_t _high;
+		};
+
+		inline const uint8_t* bc7Weights(const uint32_t bits) noexcept {
+			return bits == 2u ? kWeights2 : (bits == 3u ? kWeights3 : kWeights4);
+		}
+
+		inline uint8_t interpolate(const uint32_t e0, const uint32_t e1, const uint32_t w) noexcept {
+			return static_cast<uint8_t>(((64u - w) * e0 + w * e1 + 32u) >> 6u);
+		}
+
+		void decodeBc7(const uint8_t* block, uint8_t* rgba) noexcept {
+			uint32_t modeIndex = 0u;
+			while (modeIndex < 8u && ((block[0u] >> modeIndex) & 1u) == 0u) {
+				++modeIndex;
+			}
+
+			if (modeIndex == 8u) { // reserved mode, spec says decode to transparent black
+				memset(rgba, 0, 64u);
+				return;
+			}
+
+			const Bc7Mode& mode = kBc7Modes[modeIndex];
+			BitReader bits(block);
+			bits.read(modeIndex + 1u);
+
+			const uint32_t partition = bits.read(mode.partitionBits);
+			const uint32_t rotation = bits.read(mode.rotationBits);
+			const uint32_t indexSelection = bits.read(mode.indexSelectionBits);
+
+			// endpoints[subset * 2 + e][channel]
+			uint32_t endpoints[6u][4u] = {};
+			const uint32_t endpointsCount = mode.subsets * 2u;
+
+			for (uint32_t c = 0u; c < 3u; ++c) {
+				for (uint32_t e = 0u; e < endpointsCount; ++e) {
+					endpoints[e][c] = bits.read(mode.colorBits);
+				}
+			}
+
+			for (uint32_t e = 0u; e < endpointsCount; ++e) {
+				endpoints[e][3u] = mode.alphaBits ? bits.read(mode.alphaBits) : 255u;
+			}
+
+			uint32_t colorBits = mode.colorBits;
+			uint32_t alphaBits = mode.alphaBits;
+
+			if (mode.endpointPBits || mode.sharedPBits) {
+				uint32_t pbits[6u];
+				if (mode.endpointPBits) {
+					for (uint32_t e = 0u; e < endpointsCount; ++e) {
+						pbits[e] = bits.read(1u);
+					}
+				} else {
+					for (uint32_t s = 0u; s < mode.subsets; ++s) {
+						pbits[s * 2u] = pbits[s * 2u + 1u] = bits.read(1u);
+					}
+				}
+
+				for (uint32_t e = 0u; e < endpointsCount; ++e) {
+					for (uint32_t c = 0u; c < (mode.alphaBits ? 4u : 3u); ++c) {
+						endpoints[e][c] = (endpoints[e][c] << 1u) | pbits[e];
+					}
+				}
+
+				++colorBits;
+				if (alphaBits) ++alphaBits;
+			}
+
+			for (uint32_t e = 0u; e < endpointsCount; ++e) {
+				for (uint32_t c = 0u; c < 3u; ++c) {
+					endpoints[e][c] = (endpoints[e][c] << (8u - colorBits)) | (endpoints[e][c] >> (2u * colorBits - 8u));
+				}
+				if (alphaBits) {
+					endpoints[e][3u] = (endpoints[e][3u] << (8u - alphaBits)) | (endpoints[e][3u] >> (2u * alphaBits - 8u));
+				}
+			}
+
+			const auto subsetOf = [&mode, partition](const uint32_t texel) -> uint32_t {
+				switch (mode.subsets) {
+					case 2u: return (kPartitions2[partition] >> texel) & 1u;
+					case 3u: return (kPartitions3[partition] >> (texel * 2u)) & 3u;
+					default: return 0u;
+				}
+			};
+
+			const auto isAnchor = [&mode, partition](const uint32_t texel) -> bool {
+				if (texel == 0u) return true;
+				switch (mode.subsets) {
+					case 2u: return texel == kAnchors2[partition];
+					case 3u: return texel == kAnchors3a[partition] || texel == kAnchors3b[partition];
+					default: return false;
+				}
+			};
+
+			uint8_t indices[16u];
+			for (uint32_t i = 0u; i < 16u; ++i) {
+				indices[i] = static_cast<uint8_t>(bits.read(mode.indexBits - (isAnchor(i) ? 1u : 0u)));
+			}
+
+			uint8_t indices2[16u] = {};
+			if (mode.indexBits2) {
+				for (uint32_t i = 0u; i < 16u; ++i) {
+					indices2[i] = static_cast<uint8_t>(bits.read(mode.indexBits2 - (i == 0u ? 1u : 0u)));
+				}
+			}
+
+			const uint8_t* colorWeights = bc7Weights(mode.indexBits);
+			const uint8_t* alphaWeights = colorWeights;
+			const uint8_t* colorIndices = indices;
+			const uint8_t* alphaIndices = indices;
+
+			if (mode.indexBits2) {
+				alphaWeights = bc7Weights(mode.indexBits2);
+				alphaIndices = indices2;
+				if (indexSelection) {
+					std::swap(colorWeights, alphaWeights);
+					std::swap(colorIndices, alphaIndices);
+				}
+			}
+
+			for (uint32_t i = 0u; i < 16u; ++i) {
+				const uint32_t s = subsetOf(i);
+				const uint32_t* e0 = endpoints[s * 2u];
+				const uint32_t* e1 = endpoints[s * 2u + 1u];
+				uint8_t* texel = rgba + i * 4u;
+
+				const uint32_t cw = colorWeights[colorIndices[i]];
+				for (uint32_t c = 0u; c < 3u; ++c) {
+					texel[c] = interpolate(e0[c], e1[c], cw);
+				}
+				texel[3u] = interpolate(e0[3u], e1[3u], alphaWeights[alphaIndices[i]]);
+
+				if (rotation) {
+					std::swap(texel[3u], texel[rotation - 1u]);
+				}
+			}
+		}
+	}
+
+	bool canDecodeBlocks(const uint32_t format) noexcept {
+		switch (format) {
+			case ktx2::BC1_RGB_UNORM:
+			case ktx2::BC1_RGB_SRGB:
+			case ktx2::BC1_RGBA_UNORM:
+			case ktx2::BC1_RGBA_SRGB:
+			case ktx2::BC3_UNORM:
+			case ktx2::BC3_SRGB:
+			case ktx2::BC4_UNORM:
+			case ktx2::BC5_UNORM:
+			case ktx2::BC7_UNORM:
+			case ktx2::BC7_SRGB:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool decodeBlock(const uint32_t format, const uint8_t* block, uint8_t* rgba) noexcept {
+		switch (format) {
+			case ktx2::BC1_RGB_UNORM:
+			case ktx2::BC1_RGB_SRGB:
+				decodeColors(block, rgba, false, false);
+				return true;
+			case ktx2::BC1_RGBA_UNORM:
+			case ktx2::BC1_RGBA_SRGB:
+				decodeColors(block, rgba, true, false);
+				return true;
+			case ktx2::BC3_UNORM:
+			case ktx2::BC3_SRGB:
+				decodeColors(block + 8u, rgba, false, true);
+				decodeChannel(block, rgba, 3u);
+				return true;
+			case ktx2::BC4_UNORM:
+				for (uint32_t i = 0u; i < 16u; ++i) {
+					rgba[i * 4u + 1u] = rgba[i * 4u + 2u] = 0u;
+					rgba[i * 4u + 3u] = 255u;
+				}
+				decodeChannel(block, rgba, 0u);
+				return true;
+			case ktx2::BC5_UNORM:
+				for (uint32_t i = 0u; i < 16u; ++i) {
+					rgba[i * 4u + 2u] = 0u;
+					rgba[i * 4u + 3u] = 255u;
+				}
+				decodeChannel(block, rgba, 0u);
+				decodeChannel(block + 8u, rgba, 1u);
+				return true;
+			case ktx2::BC7_UNORM:
+			case ktx2::BC7_SRGB:
+				decodeBc7(block, rgba);
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool decodeBlocks(const uint32_t format, const uint8_t* blocks, const uint32_t width, const uint32_t height, uint8_t* rgba) noexcept {
+		if (!canDecodeBlocks(format)) return false;
+
+		const size_t blockSize = ktx2::formatInfo(format).blockSize;
+		const uint32_t blocksX = (width + 3u) / 4u;
+		const uint32_t blocksY = (height + 3u) / 4u;
+
+		uint8_t texels[64u];
+		for (uint32_t by = 0u; by < blocksY; ++by) {
+			for (uint32_t bx = 0u; bx < blocksX; ++bx, blocks += blockSize) {
+				decodeBlock(format, blocks, texels);
+
+				// blocks on right / bottom edges are partially out of image
+				const uint32_t w = std::min(4u, width - bx * 4u);
+				const uint32_t h = std::min(4u, height - by * 4u);
+				for (uint32_t y = 0u; y < h; ++y) {
+					memcpy(rgba + ((static_cast<size_t>(by) * 4u + y) * width + bx * 4u) * 4u, texels + y * 16u, w * 4u);
+				}
+			}
+		}
+
+		return true;
+	}
+
+}
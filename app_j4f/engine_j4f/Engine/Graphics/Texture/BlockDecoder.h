@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace engine {
+
+	// cpu decoding of block compressed textures into rgba8, for gpus without support of block format
+	// formats are VkFormat values (ktx2::Format): bc1, bc3, bc4, bc5, bc7
+	// bc4 / bc5 are decoded as gpu samples them: (r, 0, 0, 1) / (r, g, 0, 1)
+	[[nodiscard]] bool canDecodeBlocks(const uint32_t format) noexcept;
+
+	// one block -> 4x4 texels, rows of 16 bytes
+	bool decodeBlock(const uint32_t format, const uint8_t* block, uint8_t* rgba) noexcept;
+
+	// blocks of image with width x height texels -> width * height * 4 bytes
+	bool decodeBlocks(const uint32_t format, const uint8_t* blocks, const uint32_t width, const uint32_t height, uint8_t* rgba) noexcept;
+
+}
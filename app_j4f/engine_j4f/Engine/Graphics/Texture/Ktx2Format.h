@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// ktx2 texture container (khronos KTX 2.0), written by Tools/textureConverter:
+// header, level index (level 0 first), data format descriptor, levels data (smallest level first in file)
+// data of level: layers one by one, faces (6 for cube) of layer one by one, images are tightly packed blocks
+// only not supercompressed files are loaded: blocks go to gpu as is, without transcoding
+// numbers are little endian
+
+namespace engine::ktx2 {
+
+	inline constexpr uint8_t kIdentifier[12u] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	enum class Supercompression : uint32_t {
+		NONE = 0u,
+		BASIS_LZ = 1u,
+		ZSTD = 2u,
+		ZLIB = 3u
+	};
+
+	struct Header {
+		uint8_t identifier[12u];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;	// 0 - not array
+		uint32_t faceCount;		// 1 or 6
+		uint32_t levelCount;	// 0 - mip levels should be generated
+		Supercompression supercompressionScheme;
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	struct LevelIndex {
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	static_assert(sizeof(Header) == 80u && sizeof(LevelIndex) == 24u);
+
+	// VkFormat values of formats, which are known to loader (vulkan.h isn't needed for tools)
+	enum Format : uint32_t {
+		R8G8B8A8_UNORM = 37u,
+		R8G8B8A8_SRGB = 43u,
+		BC1_RGB_UNORM = 131u,
+		BC1_RGB_SRGB = 132u,
+		BC1_RGBA_UNORM = 133u,
+		BC1_RGBA_SRGB = 134u,
+		BC3_UNORM = 137u,
+		BC3_SRGB = 138u,
+		BC4_UNORM = 139u,
+		BC5_UNORM = 141u,
+		BC7_UNORM = 145u,
+		BC7_SRGB = 146u,
+		ASTC_4x4_UNORM = 157u,
+		ASTC_12x12_SRGB = 184u
+	};
+
+	struct FormatInfo {
+		uint8_t blockWidth = 0u;	// 0 - format isn't supported
+		uint8_t blockHeight = 0u;
+		uint8_t blockSize = 0u;		// bytes
+		bool srgb = false;
+	};
+
+	[[nodiscard]] inline constexpr FormatInfo formatInfo(const uint32_t format) noexcept {
+		switch (format) {
+			case R8G8B8A8_UNORM: return { 1u, 1u, 4u, false };
+			case R8G8B8A8_SRGB: return { 1u, 1u, 4u, true };
+			case BC1_RGB_UNORM:
+			case BC1_RGBA_UNORM:
+			case BC4_UNORM: return { 4u, 4u, 8u, false };
+			case BC1_RGB_SRGB:
+			case BC1_RGBA_SRGB: return { 4u, 4u, 8u, true };
+			case BC3_UNORM:
+			case BC5_UNORM:
+			case BC7_UNORM: return { 4u, 4u, 16u, false };
+			case BC3_SRGB:
+			case BC7_SRGB: return { 4u, 4u, 16u, true };
+			default: break;
+		}
+
+		if (format >= ASTC_4x4_UNORM && format <= ASTC_12x12_SRGB) { // unorm, srgb pairs of 14 block sizes
+			constexpr uint8_t blocks[14u][2u] = { {4,4}, {5,4}, {5,5}, {6,5}, {6,6}, {8,5}, {8,6}, {8,8}, {10,5}, {10,6}, {10,8}, {10,10}, {12,10}, {12,12} };
+			const uint32_t i = format - ASTC_4x4_UNORM;
+			return { blocks[i / 2u][0u], blocks[i / 2u][1u], 16u, (i & 1u) != 0u };
+		}
+
+		return {};
+	}
+
+	[[nodiscard]] inline constexpr bool isAstc(const uint32_t format) noexcept { return format >= ASTC_4x4_UNORM && format <= ASTC_12x12_SRGB; }
+	[[nodiscard]] inline constexpr bool isBc(const uint32_t format) noexcept { return format >= BC1_RGB_UNORM && format <= BC7_SRGB; }
+
+	// result = a * b, false - result doesn't fit in uint64
+	[[nodiscard]] inline constexpr bool checkedMul(const uint64_t a, const uint64_t b, uint64_t& result) noexcept {
+		if (a != 0u && b > UINT64_MAX / a) return false;
+		result = a * b;
+		return true;
+	}
+
+	// bytes of one image (face of layer) of level with width x height texels, UINT64_MAX - doesn't fit in uint64
+	[[nodiscard]] inline constexpr uint64_t imageSize(const FormatInfo& info, const uint32_t width, const uint32_t height) noexcept {
+		const uint64_t blocksX = (static_cast<uint64_t>(width) + info.blockWidth - 1u) / info.blockWidth;
+		const uint64_t blocksY = (static_cast<uint64_t>(height) + info.blockHeight - 1u) / info.blockHeight;
+		uint64_t blocks = 0u;
+		uint64_t bytes = 0u;
+		return checkedMul(blocksX, blocksY, blocks) && checkedMul(blocks, info.blockSize, bytes) ? bytes : UINT64_MAX;
+	}
+
+}
@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace engine {
 
@@ -15,6 +16,28 @@ namespace engine {
         bool storeForever = false;
     };
 
+    // cacheName or names of all texture files
+    template <typename Params>
+    std::string textureCacheKey(const Params& params) {
+        if (!params.cacheName.empty()) { return params.cacheName; }
+
+        size_t length = 0u;
+        for (auto&& f : params.files) {
+            length += f.length();
+        }
+
+        std::string key;
+        key.reserve(length);
+        for (auto&& f : params.files) {
+            key += f;
+        }
+
+        return key;
+    }
+
+    // textures, which aren't used anymore (cache holds only reference), are erased at once or,
+    // with budget, are kept in least recently used order while their bytes fit into budget;
+    // used textures are pinned with their reference counter, ForeverInCache textures aren't evicted
     class TextureCache final : public ICache {
     public:
         using key_type = std::string;
@@ -39,34 +62,164 @@ namespace engine {
         }
 
         template <typename KEY = key_type>
-        inline const value_type& getValue(KEY&& key) noexcept { return _map.getValue(key); }
+        inline value_type getValue(KEY&& key) noexcept {
+            value_type value = _map.getValueCopy(key); // copy pins texture before it may be evicted
+            if (value) {
+                _hits.fetch_add(1u, std::memory_order_relaxed);
+                onTextureUse(value.get());
+            } else {
+                _misses.fetch_add(1u, std::memory_order_relaxed);
+            }
+            return value;
+        }
 
         template <typename KEY = key_type, typename F, typename ...Args>
-        inline const value_type& getOrSetValue(KEY&& key, F&& f, CacheParams const & p, Args&&... args) {
-            auto && [name, pointer] = *_map.getOrCreateExt(key, std::forward<F>(f), std::forward<Args>(args)...);
-            value_type & ptr = const_cast<value_type &>(pointer);
-            ptr->m_key = name;
-            ptr->m_flags = p.storeForever ? TextureHandler::Flags::ForeverInCache : TextureHandler::Flags::Cached;
-            return ptr;
+        inline value_type getOrSetValue(KEY&& key, F&& f, CacheParams const & p, Args&&... args) {
+            value_type result;
+            bool created = false;
+            _map.getOrCreateExtWithCallback(key, [&result, &created, &p](auto & entry, const bool isNew) {
+                auto && [name, pointer] = entry;
+                value_type & ptr = const_cast<value_type &>(pointer);
+                if (isNew) {
+                    ptr->m_key = name;
+                    ptr->m_flags = p.storeForever ? TextureHandler::Flags::ForeverInCache : TextureHandler::Flags::Cached;
+                }
+                result = ptr;
+                created = isNew;
+            }, std::forward<F>(f), std::forward<Args>(args)...);
+
+            if (created) {
+                _misses.fetch_add(1u, std::memory_order_relaxed);
+            } else {
+                _hits.fetch_add(1u, std::memory_order_relaxed);
+                onTextureUse(result.get());
+            }
+
+            return result;
         }
 
-        inline void onTextureFree(value_type const & value) noexcept {
+        inline void onTextureFree(value_type & value) noexcept {
             onTextureFree(value.get());
         }
 
-        inline void onTextureFree(value_type::element_type const * value) noexcept {
-            if (value->m_flags == TextureHandler::Flags::Cached) {
-                _map.erase(value->m_key);
+        // called by release of last user with taken value->m_releasing, it is given back after value has been read:
+        // since then value may be erased by another releaser or eviction, so only copies of its fields are used
+        inline void onTextureFree(value_type::element_type * value) noexcept {
+            const bool cached = value->m_flags == TextureHandler::Flags::Cached;
+            const size_t budget = _budget.load(std::memory_order_relaxed);
+            std::string key = cached ? std::string(value->m_key) : std::string();
+            const size_t bytes = cached && budget != 0u ? value->get()->memorySize() : 0u;
+            value->m_releasing.fetch_sub(1u, std::memory_order_release);
+
+            if (!cached) return;
+
+            if (budget == 0u) {
+                eraseUnused(key);
+                return;
             }
+
+            {
+                AtomicLock lock(_lruLock);
+                _unused.add(std::move(key), bytes);
+            }
+
+            evict(budget);
         }
 
         inline void eraseTexture(value_type::element_type * value) noexcept { // force erase (for erase forever stored values available)
             value->m_flags = TextureHandler::Flags::None;
+            {
+                AtomicLock lock(_lruLock);
+                _unused.remove(std::string(value->m_key));
+            }
             _map.erase(value->m_key);
         }
 
+        // bytes of unused textures, which are kept in cache, 0 - unused textures are erased at once
+        inline void setBudget(const size_t budget) noexcept {
+            _budget.store(budget, std::memory_order_relaxed);
+            evict(budget);
+        }
+
+        [[nodiscard]] inline size_t getBudget() const noexcept { return _budget.load(std::memory_order_relaxed); }
+
+        [[nodiscard]] CacheStats getStats() noexcept {
+            CacheStats stats;
+            stats.hits = _hits.load(std::memory_order_relaxed);
+            stats.misses = _misses.load(std::memory_order_relaxed);
+            stats.evictions = _evictions.load(std::memory_order_relaxed);
+            stats.budget = _budget.load(std::memory_order_relaxed);
+            AtomicLock lock(_lruLock);
+            stats.bytes = _unused.bytes();
+            return stats;
+        }
+
     private:
+        inline void onTextureUse(value_type::element_type const * value) noexcept {
+            if (value->m_flags != TextureHandler::Flags::Cached || _budget.load(std::memory_order_relaxed) == 0u) return;
+            AtomicLock lock(_lruLock);
+            _unused.remove(std::string(value->m_key));
+        }
+
+        // erases texture, if cache holds its only reference and no releaser can read it,
+        // inRelease - texture isn't erased only because its releaser hasn't finished yet
+        inline bool eraseUnused(const std::string& key, bool* inRelease = nullptr) noexcept {
+            return _map.eraseIf(key, [inRelease](const value_type & value) {
+                if (value->m_counter.load(std::memory_order_acquire) != 1u || value->m_flags != TextureHandler::Flags::Cached) {
+                    return false;
+                }
+                const bool releasing = value->m_releasing.load(std::memory_order_acquire) != 0u;
+                if (inRelease) *inRelease = releasing;
+                return !releasing;
+            });
+        }
+
+        void evict(const size_t budget) noexcept {
+            std::vector<std::pair<std::string, size_t>> releasing;
+            size_t releasingBytes = 0u;
+
+            while (true) {
+                std::vector<std::pair<std::string, size_t>> victims;
+                {
+                    AtomicLock lock(_lruLock);
+                    _unused.popLeastRecent(budget > releasingBytes ? budget - releasingBytes : 0u, [&victims](std::string&& key, const size_t bytes) {
+                        victims.emplace_back(std::move(key), bytes);
+                    });
+                }
+
+                if (victims.empty()) break;
+
+                for (auto && [key, bytes] : victims) {
+                    // texture may be taken again after it has became unused, used texture comes back with its next free
+                    bool inRelease = false;
+                    const bool erased = eraseUnused(key, &inRelease);
+
+                    if (erased) {
+                        _evictions.fetch_add(1u, std::memory_order_relaxed);
+                    } else if (inRelease) {
+                        releasingBytes += bytes;
+                        releasing.emplace_back(std::move(key), bytes);
+                    }
+                }
+            }
+
+            if (!releasing.empty()) {
+                AtomicLock lock(_lruLock);
+                for (auto && [key, bytes] : releasing) {
+                    _unused.add(key, bytes);
+                }
+            }
+        }
+
         TsUnorderedMap<key_type, value_type, Hasher<key_type>, std::equal_to<>> _map;
+
+        std::atomic_uint64_t _hits = 0u;
+        std::atomic_uint64_t _misses = 0u;
+        std::atomic_uint64_t _evictions = 0u;
+
+        std::atomic_size_t _budget = 0u;
+        std::atomic_bool _lruLock = false;
+        LruTracker<std::string> _unused; // unused textures by keys
     };
 
 }
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include "TextureData.h"
+#include "BlockDecoder.h"
+#include "Ktx2Format.h"
 
 #include "../../Core/Engine.h"
 #include "../../File/FileManager.h"
+#include "../../Log/Log.h"
+#include "../Graphics.h"
+#include "../Vulkan/vkRenderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <string>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -10,9 +19,35 @@
 
 namespace engine {
 
+	// ktx2 formats are VkFormat values
+	static_assert(ktx2::R8G8B8A8_UNORM == static_cast<uint32_t>(VK_FORMAT_R8G8B8A8_UNORM) && ktx2::R8G8B8A8_SRGB == static_cast<uint32_t>(VK_FORMAT_R8G8B8A8_SRGB));
+	static_assert(ktx2::BC1_RGB_UNORM == static_cast<uint32_t>(VK_FORMAT_BC1_RGB_UNORM_BLOCK) && ktx2::BC7_SRGB == static_cast<uint32_t>(VK_FORMAT_BC7_SRGB_BLOCK));
+	static_assert(ktx2::ASTC_4x4_UNORM == static_cast<uint32_t>(VK_FORMAT_ASTC_4x4_UNORM_BLOCK) && ktx2::ASTC_12x12_SRGB == static_cast<uint32_t>(VK_FORMAT_ASTC_12x12_SRGB_BLOCK));
+
 	///////////////////////////////////////////////////////////
+	inline bool isKtx2(const void* data, const size_t size) {
+		return size >= sizeof(ktx2::Header) && memcmp(data, ktx2::kIdentifier, sizeof(ktx2::kIdentifier)) == 0;
+	}
+
+	inline bool getKtx2Info(const void* data, const size_t size, int* w, int* h, int* c) {
+		if (!isKtx2(data, size)) return false;
+
+		ktx2::Header header;
+		memcpy(&header, data, sizeof(header));
+		*w = static_cast<int>(header.pixelWidth);
+		*h = static_cast<int>(header.pixelHeight);
+		*c = 4;
+		return true;
+	}
+
 	inline void getTextureInfo(const char* file, int* w, int* h, int* c) {
-		stbi_info(file, w, h, c); // texture dimensions + channels without load
+		if (stbi_info(file, w, h, c)) return; // texture dimensions + channels without load
+
+		// file isn't on disk (packed) or it is ktx2, read it through file manager
+		if (const FileView data = Engine::getInstance().getModule<engine::FileManager>().readFileMapped(file)) {
+			if (getKtx2Info(data.data(), data.size(), w, h, c)) return;
+			stbi_info_from_memory(reinterpret_cast<const stbi_uc*>(data.data()), static_cast<int>(data.size()), w, h, c);
+		}
 	}
 
 	inline unsigned char* loadImageDataFromBuffer(const unsigned char* buffer, const size_t size, int* w, int* h, int* c) {
@@ -22,32 +57,61 @@ namespace engine {
 	inline void freeImageData(unsigned char* img) {
 		stbi_image_free(img);
 	}
+
+	// block formats need enabled device feature, format properties don't say it
+	inline bool gpuSupportsFormat(const VkFormat format) {
+		const vulkan::VulkanDevice* device = Engine::getInstance().getModule<Graphics>().getRenderer()->getDevice();
+		if (ktx2::isBc(format) && device->enabledFeatures.textureCompressionBC != VK_TRUE) return false;
+		if (ktx2::isAstc(format) && device->enabledFeatures.textureCompressionASTC_LDR != VK_TRUE) return false;
+		return device->checkImageFormatSupported(format);
+	}
 	///////////////////////////////////////////////////////////
 
 	TextureData::TextureData(const std::string& path, const TextureFormatType ft) {
 		auto&& engine = Engine::getInstance();
 		auto& fm = engine.getModule<engine::FileManager>();
 
-		size_t fsize;
-		
-		if (const char* imgBuffer = fm.readFile(path, fsize)) {
-			_data = loadImageDataFromBuffer(reinterpret_cast<const unsigned char*>(imgBuffer), fsize, &_width, &_height, &_channels);
-			_bpp = 32; // todo!
-
-			switch (ft) {
-				case TextureFormatType::SRGB:
-					_format = VK_FORMAT_R8G8B8A8_SRGB; // todo!
-					break;
-				default: 
-					_format = VK_FORMAT_R8G8B8A8_UNORM; // todo! check bits
-					break;
+		if (FileView file = fm.readFileMapped(path)) {
+			if (isKtx2(file.data(), file.size())) {
+				if (!loadKtx2(std::move(file))) {
+					LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "can't load ktx2 texture %s", path.c_str());
+				}
+				return;
 			}
 
-			delete imgBuffer;
+			loadImage(reinterpret_cast<const unsigned char*>(file.data()), file.size(), ft);
 		}
 	}
 
 	TextureData::TextureData(const unsigned char* buffer, const size_t size, const TextureFormatType ft) {
+		if (isKtx2(buffer, size)) { // buffer isn't owned, ktx2 levels are kept in own copy of it
+			std::byte* data;
+			FileView file = FileView::allocate(size, data);
+			memcpy(data, buffer, size);
+			loadKtx2(std::move(file));
+			return;
+		}
+
+		loadImage(buffer, size, ft);
+	}
+
+	TextureData::TextureData(const FileView& file, const TextureFormatType ft) {
+		if (isKtx2(file.data(), file.size())) {
+			loadKtx2(FileView(file));
+			return;
+		}
+
+		loadImage(reinterpret_cast<const unsigned char*>(file.data()), file.size(), ft);
+	}
+
+	TextureData::~TextureData() {
+		if (_data) {
+			freeImageData(_data);
+			_data = nullptr;
+		}
+	}
+
+	void TextureData::loadImage(const unsigned char* buffer, const size_t size, const TextureFormatType ft) {
 		_data = loadImageDataFromBuffer(buffer, size, &_width, &_height, &_channels);
 		_bpp = 32; // todo!
 		switch (ft) {
@@ -60,14 +124,125 @@ namespace engine {
 		}
 	}
 
-	TextureData::~TextureData() {
-		if (_data) {
-			freeImageData(_data);
-			_data = nullptr;
+	// format of ktx2 texture is taken from file, TextureFormatType isn't applied to it
+	bool TextureData::loadKtx2(FileView&& file) {
+		const auto* bytes = reinterpret_cast<const uint8_t*>(file.data());
+		const size_t size = file.size();
+
+		ktx2::Header header;
+		memcpy(&header, bytes, sizeof(header));
+
+		if (header.supercompressionScheme != ktx2::Supercompression::NONE) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "ktx2 supercompression %u isn't supported, textures should be written without it", static_cast<uint32_t>(header.supercompressionScheme));
+			return false;
+		}
+
+		const ktx2::FormatInfo info = ktx2::formatInfo(header.vkFormat);
+		if (info.blockSize == 0u) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "ktx2 format %u isn't supported", header.vkFormat);
+			return false;
+		}
+
+		const uint32_t width = header.pixelWidth;
+		const uint32_t height = header.pixelHeight;
+		const uint32_t levelCount = std::max(header.levelCount, 1u); // no mip levels are generated for block formats
+		const uint32_t maxLevels = width && height ? static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1u : 0u;
+
+		if (width == 0u || height == 0u || header.pixelDepth > 1u || (header.faceCount != 1u && header.faceCount != 6u) || levelCount > maxLevels ||
+			(header.faceCount == 6u && width != height) || size < sizeof(ktx2::Header) + sizeof(ktx2::LevelIndex) * levelCount) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "ktx2 texture isn't 2d texture or its header is broken");
+			return false;
+		}
+
+		// sizes below are bounded by device limits and are checked for overflow of uint64 and size_t
+		const VkPhysicalDeviceLimits& limits = Engine::getInstance().getModule<Graphics>().getRenderer()->getDevice()->gpuProperties.limits;
+		const uint32_t maxDimension = header.faceCount == 6u ? limits.maxImageDimensionCube : limits.maxImageDimension2D;
+		const uint32_t layerCount = std::max(header.layerCount, 1u);
+		if (width > maxDimension || height > maxDimension || layerCount > limits.maxImageArrayLayers / header.faceCount) {
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "ktx2 texture %ux%u with %u layers is over device limits", width, height, layerCount);
+			return false;
 		}
+
+		const uint32_t layers = layerCount * header.faceCount;
+
+		std::vector<ktx2::LevelIndex> index(levelCount);
+		memcpy(index.data(), bytes + sizeof(ktx2::Header), sizeof(ktx2::LevelIndex) * levelCount);
+
+		for (uint32_t i = 0u; i < levelCount; ++i) {
+			uint64_t levelSize = 0u;
+			if (!ktx2::checkedMul(ktx2::imageSize(info, std::max(width >> i, 1u), std::max(height >> i, 1u)), layers, levelSize) ||
+				index[i].byteLength != levelSize || index[i].byteOffset > size || levelSize > size - index[i].byteOffset) {
+				LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "ktx2 texture level %u is out of file", i);
+				return false;
+			}
+		}
+
+		const auto format = static_cast<VkFormat>(header.vkFormat);
+		_levels.resize(levelCount);
+		_levelSizes.resize(levelCount);
+
+		if (gpuSupportsFormat(format)) { // blocks go to gpu as they are in file
+			for (uint32_t i = 0u; i < levelCount; ++i) {
+				_levels[i] = bytes + index[i].byteOffset;
+				_levelSizes[i] = static_cast<size_t>(index[i].byteLength);
+			}
+			_format = format;
+			_blockSize = info.blockSize;
+			_file = std::move(file);
+		} else if (canDecodeBlocks(format)) { // same mip levels in rgba8
+			uint64_t decodedSize = 0u;
+			for (uint32_t i = 0u; i < levelCount; ++i) {
+				uint64_t texels = 0u;
+				uint64_t levelSize = 0u;
+				if (!ktx2::checkedMul(std::max(width >> i, 1u), std::max(height >> i, 1u), texels) || !ktx2::checkedMul(texels, static_cast<uint64_t>(layers) * 4u, levelSize) ||
+					levelSize > SIZE_MAX - decodedSize) {
+					_levels.clear();
+					_levelSizes.clear();
+					LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "decoded ktx2 texture %ux%u with %u layers is too big", width, height, layers);
+					return false;
+				}
+				_levelSizes[i] = static_cast<size_t>(levelSize);
+				decodedSize += levelSize;
+			}
+
+			_decoded = std::make_unique_for_overwrite<unsigned char[]>(decodedSize);
+
+			unsigned char* dst = _decoded.get();
+			for (uint32_t i = 0u; i < levelCount; ++i) {
+				const uint32_t w = std::max(width >> i, 1u);
+				const uint32_t h = std::max(height >> i, 1u);
+				const size_t srcImageSize = static_cast<size_t>(ktx2::imageSize(info, w, h)); // checked with level size
+				const size_t dstImageSize = _levelSizes[i] / layers;
+
+				_levels[i] = dst;
+				for (uint32_t layer = 0u; layer < layers; ++layer) {
+					decodeBlocks(format, bytes + index[i].byteOffset + srcImageSize * layer, w, h, dst);
+					dst += dstImageSize;
+				}
+			}
+
+			_format = info.srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+			_blockSize = 4u;
+			LOG_TAG_LEVEL(LogLevel::L_DEBUG, GRAPHICS, "ktx2 format %u isn't supported by gpu, texture is decoded on cpu", header.vkFormat);
+		} else {
+			_levels.clear();
+			_levelSizes.clear();
+			LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "ktx2 format %u isn't supported by gpu and can't be decoded on cpu", header.vkFormat);
+			return false;
+		}
+
+		_width = static_cast<int>(width);
+		_height = static_cast<int>(height);
+		_channels = 4;
+		// bits per texel of uncompressed data, block formats have no integer bpp (ASTC 12x12 is 0.89 bits): 0 - unknown, levelSizes and blockSize describe data
+		_bpp = (info.blockWidth * info.blockHeight == 1u || _format != format) ? static_cast<uint8_t>(_blockSize * 8u) : 0u;
+		_layers = layers;
+		_cube = header.faceCount == 6u;
+
+		return true;
 	}
 
 	void TextureData::getInfo(const char* file, int* w, int* h, int* c) {
 		getTextureInfo(file, w, h, c);
 	}
-}
\ No newline at end of file
+}
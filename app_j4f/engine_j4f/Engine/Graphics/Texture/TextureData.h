@@ -1,6 +1,10 @@
 #pragma once
 
+#include "../../File/FileView.h"
+
+#include <memory>
 #include <string>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 namespace engine {
@@ -16,6 +20,8 @@ namespace engine {
 		SRGB = 7
 	};
 
+	// decoded image (png, jpg, webp...) in rgba8 or ktx2 texture with its own mip levels and layers:
+	// ktx2 blocks are used as is from file, if gpu supports their format, else they are decoded into rgba8 on cpu
 	class TextureData {
 	public:
 		static void getInfo(const char* file, int* w, int* h, int* c);
@@ -23,10 +29,13 @@ namespace engine {
 		TextureData() = default;
 		explicit TextureData(const std::string& path, const TextureFormatType ft = TextureFormatType::UNORM);
 		TextureData(const unsigned char* buffer, const size_t size, const TextureFormatType ft = TextureFormatType::UNORM);
+		explicit TextureData(const FileView& file, const TextureFormatType ft = TextureFormatType::UNORM); // ktx2 levels are used from file without copy
 		~TextureData();
 
 		TextureData(const TextureData&) = delete;
-		TextureData(TextureData&& rvalue) noexcept : _data(rvalue._data), _width(rvalue._width), _height(rvalue._height), _channels(rvalue._channels), _bpp(rvalue._bpp), _format(rvalue._format) {
+		TextureData(TextureData&& rvalue) noexcept : _data(rvalue._data), _width(rvalue._width), _height(rvalue._height), _channels(rvalue._channels), _bpp(rvalue._bpp), _format(rvalue._format),
+			_file(std::move(rvalue._file)), _decoded(std::move(rvalue._decoded)), _levels(std::move(rvalue._levels)), _levelSizes(std::move(rvalue._levelSizes)),
+			_layers(rvalue._layers), _blockSize(rvalue._blockSize), _cube(rvalue._cube) {
 			rvalue._data = nullptr;
 		}
 
@@ -38,27 +47,52 @@ namespace engine {
 			_channels = rvalue._channels;
 			_bpp = rvalue._bpp;
 			_format = rvalue._format;
+			_file = std::move(rvalue._file);
+			_decoded = std::move(rvalue._decoded);
+			_levels = std::move(rvalue._levels);
+			_levelSizes = std::move(rvalue._levelSizes);
+			_layers = rvalue._layers;
+			_blockSize = rvalue._blockSize;
+			_cube = rvalue._cube;
 
 			rvalue._data = nullptr;
 			return *this;
 		}
 
-		inline explicit operator bool() const noexcept { return _data != nullptr; }
+		inline explicit operator bool() const noexcept { return _data != nullptr || !_levels.empty(); }
 		[[nodiscard]] inline const unsigned char* data() const noexcept { return _data; }
 
-        [[nodiscard]] inline uint8_t bpp() const noexcept { return _bpp; }
+        [[nodiscard]] inline uint8_t bpp() const noexcept { return _bpp; } // 0 for block compressed formats
         [[nodiscard]] inline VkFormat format() const noexcept { return _format; }
 
         [[nodiscard]] inline int width() const noexcept { return _width; }
         [[nodiscard]] inline int height() const noexcept { return _height; }
         [[nodiscard]] inline int channels() const noexcept { return _channels; }
 
+		// ktx2: data of mip levels (all layers of level one by one), empty - data() is level 0 and mip levels are generated
+		[[nodiscard]] inline const std::vector<const void*>& levels() const noexcept { return _levels; }
+		[[nodiscard]] inline const std::vector<size_t>& levelSizes() const noexcept { return _levelSizes; }
+		[[nodiscard]] inline uint32_t layers() const noexcept { return _layers; }
+		[[nodiscard]] inline uint8_t blockSize() const noexcept { return _blockSize; } // bytes of texel block (texel for not compressed formats)
+		[[nodiscard]] inline bool cube() const noexcept { return _cube; }
+
 	private:
+		bool loadKtx2(FileView&& file);
+		void loadImage(const unsigned char* buffer, const size_t size, const TextureFormatType ft);
+
 		unsigned char* _data = nullptr;
 		int _width = 0;
 		int _height = 0;
 		int _channels = 0;
 		uint8_t _bpp = 0;
 		VkFormat _format = VK_FORMAT_UNDEFINED;
+
+		FileView _file;
+		std::unique_ptr<unsigned char[]> _decoded;
+		std::vector<const void*> _levels;
+		std::vector<size_t> _levelSizes;
+		uint32_t _layers = 1u;
+		uint8_t _blockSize = 0u;
+		bool _cube = false;
 	};
 }
\ No newline at end of file
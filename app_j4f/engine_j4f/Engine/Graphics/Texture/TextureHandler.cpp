@@ -17,10 +17,14 @@ namespace engine {
     }
 
     uint32_t TextureHandler::_decrease_counter() noexcept {
-        auto const count = m_counter.fetch_sub(1u, std::memory_order_release) - 1u;
+        m_releasing.fetch_add(1u, std::memory_order_relaxed);
+        auto const count = m_counter.fetch_sub(1u, std::memory_order_acq_rel) - 1u;
         if (count == 1u) {
+            // cache releases m_releasing and may erase handler, this isn't touched after notification
             m_textureCache.onTextureFree(this);
+            return count;
         }
+        m_releasing.fetch_sub(1u, std::memory_order_release);
         return count;
     }
 
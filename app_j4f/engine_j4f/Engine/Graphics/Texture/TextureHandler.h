@@ -42,6 +42,7 @@ namespace engine {
         TextureCache& evaluateCache() const noexcept;
         value_type m_texture;
         std::atomic_uint32_t m_counter = 0u;
+        std::atomic_uint32_t m_releasing = 0u; // decreases of counter in progress, cache doesn't erase texture while they can read it
         std::string_view m_key;
         TextureCache& m_textureCache;
 
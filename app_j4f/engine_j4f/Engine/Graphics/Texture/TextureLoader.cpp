@@ -5,6 +5,7 @@
 #include "../../File/FileManager.h"
 #include "../Graphics.h"
 #include "../Vulkan/vkTexture.h"
+#include "../../Log/Log.h"
 #include "../../Utils/Debug/Profiler.h"
 
 //
@@ -33,6 +34,28 @@ namespace engine {
 		}
 	}
 
+	bool TextureLoader::fillTexture(vulkan::VulkanTexture* texture, const TextureData* imgs, const size_t count, const bool useMipMaps, const bool deffered, const VkImageViewType forceType) {
+		if (!imgs[0].levels().empty()) {
+			if (count > 1u) {
+				LOG_TAG_LEVEL(LogLevel::L_ERROR, GRAPHICS, "ktx2 texture can't be layer of texture, layers should be in ktx2 file");
+				return false;
+			}
+
+			const TextureData& img = imgs[0];
+			const VkImageViewType viewType = (forceType == VK_IMAGE_VIEW_TYPE_MAX_ENUM && img.cube()) ? (img.layers() > 6u ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE) : forceType;
+			texture->createWithLevels(img.levels().data(), img.levelSizes().data(), static_cast<uint32_t>(img.levels().size()), img.layers(), img.format(), img.blockSize(), deffered, viewType);
+			return true;
+		}
+
+		std::vector<const void*> imgsData(count);
+		for (size_t i = 0; i < count; ++i) {
+			imgsData[i] = imgs[i].data();
+		}
+
+		texture->create(imgsData.data(), static_cast<uint32_t>(count), imgs[0].format(), imgs[0].bpp(), useMipMaps, deffered, forceType);
+		return true;
+	}
+
 	vulkan::VulkanTexture* TextureLoader::createTexture(const TextureLoadingParams& params, const TextureLoadingCallback& callback) {
 		auto&& engine = Engine::getInstance();
 		auto&& renderer = engine.getModule<engine::Graphics>().getRenderer();
@@ -51,7 +74,8 @@ namespace engine {
 		if (params.flags->async) {
 			if (callback) { addCallback(texture, callback); }
 
-			engine.getModule<AssetManager>().getThreadPool()->enqueue(TaskType::COMMON, [params, texture](const CancellationToken& token) {
+			// priority only, cancellation is not supported for not ref counted textures
+			auto load = [params, texture](const std::vector<FileView>& files) {
 				PROFILE_TIME_SCOPED_M(textureLoading, params.files[0])
 				if (params.texData) {
 					if (!params.texData->operator bool()) {
@@ -59,26 +83,27 @@ namespace engine {
 						texture->noGenerate();
 						return;
 					}
-					texture->create(params.texData->data(), params.texData->format(), params.texData->bpp(), params.textureFlags->useMipMaps, true, params.imageViewTypeForce);
+					fillTexture(texture, params.texData, 1u, params.textureFlags->useMipMaps, true, params.imageViewTypeForce);
 				} else {
-					const size_t size = params.files.size();
+					const size_t size = files.size();
 					std::vector<TextureData> imgs;
 					imgs.reserve(size);
-					std::vector<const void*> imgsData(size);
 
 					for (size_t i = 0; i < size; ++i) {
-						imgs.emplace_back(params.files[i], params.formatType);
+						imgs.emplace_back(files[i], params.formatType);
 						
 						if (!imgs[i]) {
 							executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
 							texture->noGenerate();
 							return;
 						}
-
-						imgsData[i] = imgs[i].data();
 					}
 
-					texture->create(imgsData.data(), imgs.size(), imgs[0].format(), imgs[0].bpp(), params.textureFlags->useMipMaps, true, params.imageViewTypeForce);
+					if (!fillTexture(texture, imgs.data(), imgs.size(), params.textureFlags->useMipMaps, true, params.imageViewTypeForce)) {
+						executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
+						texture->noGenerate();
+						return;
+					}
 				}
 
 				if (params.imageLayout != VK_IMAGE_LAYOUT_MAX_ENUM) {
@@ -86,7 +111,14 @@ namespace engine {
 				}
 
 				executeCallbacks(texture, AssetLoadingResult::LOADING_SUCCESS);
-			});
+			};
+
+			auto&& assetManager = engine.getModule<AssetManager>();
+			if (params.texData) {
+				assetManager.enqueueLoading(params, [load](const CancellationToken&) { load({}); });
+			} else { // files are read asynchronously, loader thread only decodes them
+				assetManager.enqueueLoadingWithFiles(params, std::vector<std::string>(params.files), [load](const CancellationToken&, const std::vector<FileView>& files) { load(files); });
+			}
 		} else {
 			PROFILE_TIME_SCOPED_M(textureLoading, params.files[0])
 			if (params.texData) {
@@ -95,12 +127,11 @@ namespace engine {
 					texture->noGenerate();
 					return texture;
 				}
-				texture->create(params.texData->data(), params.texData->format(), params.texData->bpp(), params.textureFlags->useMipMaps, params.textureFlags->deffered, params.imageViewTypeForce);
+				fillTexture(texture, params.texData, 1u, params.textureFlags->useMipMaps, params.textureFlags->deffered, params.imageViewTypeForce);
 			} else {
 				const size_t size = params.files.size();
 				std::vector<TextureData> imgs;
 				imgs.reserve(size);
-				std::vector<const void*> imgsData(size);
 
 				for (size_t i = 0; i < size; ++i) {
 					imgs.emplace_back(params.files[i], params.formatType);
@@ -110,11 +141,13 @@ namespace engine {
 						texture->noGenerate();
 						return texture;
 					}
-
-					imgsData[i] = imgs[i].data();
 				}
 
-				texture->create(imgsData.data(), imgs.size(), imgs[0].format(), imgs[0].bpp(), params.textureFlags->useMipMaps, params.textureFlags->deffered, params.imageViewTypeForce);
+				if (!fillTexture(texture, imgs.data(), imgs.size(), params.textureFlags->useMipMaps, params.textureFlags->deffered, params.imageViewTypeForce)) {
+					if (callback) { callback(texture, AssetLoadingResult::LOADING_ERROR); }
+					texture->noGenerate();
+					return texture;
+				}
 			}
 
 			if (params.imageLayout != VK_IMAGE_LAYOUT_MAX_ENUM) {
@@ -223,4 +256,8 @@ namespace engine {
 		}
 	}
 
+	std::string TextureLoader::requestKey(const TextureLoadingParams& params) {
+		return params.flags->use_cache ? textureCacheKey(params) : std::string(); // not cached textures are created for every request
+	}
+
 }
\ No newline at end of file
@@ -55,6 +55,11 @@ namespace engine {
 		using asset_type = vulkan::VulkanTexture*;
 		static void loadAsset(vulkan::VulkanTexture*& v, const TextureLoadingParams& params, const TextureLoadingCallback& callback);
         static void cleanUp() noexcept {}
+		static std::string requestKey(const TextureLoadingParams& params);
+
+		// images are layers of texture, ktx2 image is uploaded with its own mip levels and layers
+		// false - images can't be layers of one texture
+		static bool fillTexture(vulkan::VulkanTexture* texture, const TextureData* imgs, const size_t count, const bool useMipMaps, const bool deffered, const VkImageViewType forceType);
 	private:
 		static void addCallback(vulkan::VulkanTexture*, const TextureLoadingCallback&);
 		static void executeCallbacks(vulkan::VulkanTexture*, const AssetLoadingResult);
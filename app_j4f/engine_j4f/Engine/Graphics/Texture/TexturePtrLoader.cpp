@@ -1,5 +1,6 @@
 #include "TexturePtrLoader.h"
 #include "TextureHandler.h"
+#include "TextureLoader.h"
 
 #include "../Graphics.h"
 #include "../../File/FileManager.h"
@@ -9,7 +10,24 @@ namespace engine {
 
     void TexturePtrLoader::addCallback(TexturePtr t, const TexturePtrLoadingCallback &c) {
         AtomicLock lock(_callbacksLock);
-        _callbacks[t].emplace_back(c);
+        auto& callbacks = _callbacks[t];
+        if (c) { callbacks.emplace_back(c); }
+    }
+
+    void TexturePtrLoader::addOrExecuteCallback(TexturePtr t, const TexturePtrLoadingCallback &c) {
+        AssetLoadingResult result;
+        {
+            AtomicLock lock(_callbacksLock);
+            auto it = _callbacks.find(t);
+            if (it != _callbacks.end()) {
+                it->second.emplace_back(c);
+                return;
+            }
+            // failed or cancelled loading marks texture before its callbacks are taken
+            result = t->get()->generationState() == vulkan::VulkanTextureCreationState::NO_CREATED ? AssetLoadingResult::LOADING_ERROR : AssetLoadingResult::LOADING_SUCCESS;
+        }
+
+        c(t, result);
     }
 
     void TexturePtrLoader::executeCallbacks(TexturePtr t, const AssetLoadingResult result) {
@@ -28,6 +46,36 @@ namespace engine {
         }
     }
 
+    bool TexturePtrLoader::cancelLoading(TexturePtr t, const TexturePtrLoadingParams &params, const CancellationToken &token) {
+        if (!token && !params.cancelled()) {
+            return false;
+        }
+
+        std::vector<TexturePtrLoadingCallback> callbacks;
+        {
+            AtomicLock lock(_callbacksLock);
+            auto it = _callbacks.find(t);
+            if (it != _callbacks.end()) {
+                if (it->second.size() > 1u) {
+                    return false;
+                }
+                callbacks = std::move(it->second);
+                _callbacks.erase(it);
+            }
+            t->get()->noGenerate(); // requests coming after this get LOADING_ERROR
+        }
+
+        if (params.flags->use_cache) {
+            Engine::getInstance().getModule<CacheManager>().getCache<TextureCache>()->eraseTexture(t.get()); // next request loads it again
+        }
+
+        for (auto &&c: callbacks) {
+            c(t, AssetLoadingResult::LOADING_CANCELED);
+        }
+
+        return true;
+    }
+
     TexturePtr
     TexturePtrLoader::createTexture(const TexturePtrLoadingParams &params, const TexturePtrLoadingCallback &callback) {
         auto &&engine = Engine::getInstance();
@@ -46,42 +94,55 @@ namespace engine {
         }
 
         if (params.flags->async) {
-            if (callback) { addCallback(texture, callback); }
+            addCallback(texture, callback);
+
+            auto load = [params, texture](const CancellationToken &token,
+                                          const std::vector<FileView> &files) mutable {
+                if (cancelLoading(texture, params, token)) {
+                    return;
+                }
 
-            engine.getModule<AssetManager>().getThreadPool()->enqueue(TaskType::COMMON, [params, texture](
-                    const CancellationToken &token) mutable {
                 PROFILE_TIME_SCOPED_M(textureLoading, params.files[0u])
 
                 auto texture_value = texture->get();
 
                 if (params.texData) {
                     if (!params.texData->operator bool()) {
-                        executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
                         texture_value->noGenerate();
+                        executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
                         return;
                     }
-                    texture_value->create(params.texData->data(), params.texData->format(), params.texData->bpp(),
-                                          params.textureFlags->useMipMaps, true, params.imageViewTypeForce);
+                    TextureLoader::fillTexture(texture_value, params.texData, 1u, params.textureFlags->useMipMaps, true,
+                                               params.imageViewTypeForce);
                 } else {
-                    const size_t size = params.files.size();
+                    const size_t size = files.size();
                     std::vector<TextureData> imgs;
                     imgs.reserve(size);
-                    std::vector<const void *> imgsData(size);
 
                     for (size_t i = 0u; i < size; ++i) {
-                        imgs.emplace_back(params.files[i], params.formatType);
+                        if (i != 0u && cancelLoading(texture, params, token)) {
+                            return;
+                        }
+
+                        imgs.emplace_back(files[i], params.formatType);
 
                         if (!imgs[i]) {
-                            executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
                             texture_value->noGenerate();
+                            executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
                             return;
                         }
+                    }
 
-                        imgsData[i] = imgs[i].data();
+                    if (cancelLoading(texture, params, token)) { // decoded data isn't uploaded
+                        return;
                     }
 
-                    texture_value->create(imgsData.data(), imgs.size(), imgs[0].format(), imgs[0].bpp(),
-                                          params.textureFlags->useMipMaps, true, params.imageViewTypeForce);
+                    if (!TextureLoader::fillTexture(texture_value, imgs.data(), imgs.size(), params.textureFlags->useMipMaps,
+                                                    true, params.imageViewTypeForce)) {
+                        texture_value->noGenerate();
+                        executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
+                        return;
+                    }
                 }
 
                 if (params.imageLayout != VK_IMAGE_LAYOUT_MAX_ENUM) {
@@ -89,25 +150,36 @@ namespace engine {
                 }
 
                 executeCallbacks(texture, AssetLoadingResult::LOADING_SUCCESS);
-            });
+            };
+
+            auto &&assetManager = engine.getModule<AssetManager>();
+            if (params.texData) {
+                assetManager.enqueueLoading(params, [load](const CancellationToken &token) mutable {
+                    load(token, {});
+                });
+            } else { // files are read asynchronously, loader thread only decodes them
+                assetManager.enqueueLoadingWithFiles(params, std::vector<std::string>(params.files),
+                                                     [load](const CancellationToken &token,
+                                                            const std::vector<FileView> &files) mutable {
+                    load(token, files);
+                });
+            }
         } else {
             PROFILE_TIME_SCOPED_M(textureLoading, params.files[0u])
 
             auto texture_value = texture->get();
             if (params.texData) {
                 if (!params.texData->operator bool()) {
-                    executeCallbacks(texture, AssetLoadingResult::LOADING_ERROR);
+                    if (callback) { callback(texture, AssetLoadingResult::LOADING_ERROR); }
                     texture_value->noGenerate();
                     return texture;
                 }
-                texture_value->create(params.texData->data(), params.texData->format(), params.texData->bpp(),
-                                      params.textureFlags->useMipMaps, params.textureFlags->deffered,
-                                      params.imageViewTypeForce);
+                TextureLoader::fillTexture(texture_value, params.texData, 1u, params.textureFlags->useMipMaps,
+                                           params.textureFlags->deffered, params.imageViewTypeForce);
             } else {
                 const size_t size = params.files.size();
                 std::vector<TextureData> imgs;
                 imgs.reserve(size);
-                std::vector<const void *> imgsData(size);
 
                 for (size_t i = 0u; i < size; ++i) {
                     imgs.emplace_back(params.files[i], params.formatType);
@@ -117,13 +189,14 @@ namespace engine {
                         texture_value->noGenerate();
                         return texture;
                     }
-
-                    imgsData[i] = imgs[i].data();
                 }
 
-                texture_value->create(imgsData.data(), imgs.size(), imgs[0].format(), imgs[0].bpp(),
-                                      params.textureFlags->useMipMaps, params.textureFlags->deffered,
-                                      params.imageViewTypeForce);
+                if (!TextureLoader::fillTexture(texture_value, imgs.data(), imgs.size(), params.textureFlags->useMipMaps,
+                                                params.textureFlags->deffered, params.imageViewTypeForce)) {
+                    if (callback) { callback(texture, AssetLoadingResult::LOADING_ERROR); }
+                    texture_value->noGenerate();
+                    return texture;
+                }
             }
 
             if (params.imageLayout != VK_IMAGE_LAYOUT_MAX_ENUM) {
@@ -147,17 +220,7 @@ namespace engine {
                 v = cache->getValue(name);
                 if (v) {
                     if (callback) {
-                        switch (v->get()->generationState()) {
-                            case vulkan::VulkanTextureCreationState::NO_CREATED:
-                                callback(v, AssetLoadingResult::LOADING_ERROR);
-                                break;
-                            case vulkan::VulkanTextureCreationState::CREATION_COMPLETE:
-                                callback(v, AssetLoadingResult::LOADING_SUCCESS);
-                                break;
-                            default:
-                                addCallback(v, callback);
-                                break;
-                        }
+                        addOrExecuteCallback(v, callback);
                     }
                     return;
                 }
@@ -167,32 +230,16 @@ namespace engine {
                 }, params.cacheParams, params, callback);
             };
 
-            if (params.cacheName.empty()) {
-                if (params.files.size() > 1u) {
-                    size_t length = 0u;
-                    for (auto&& f : params.files) {
-                        length += f.length();
-                    }
-
-                    std::string cacheKey;
-                    cacheKey.reserve(length);
-
-                    for (auto&& f : params.files) {
-                        cacheKey += f;
-                    }
-
-                    generate(cacheKey);
-                } else {
-                    generate(params.files[0u]);
-                }
-            } else {
-                generate(params.cacheName);
-            }
+            generate(textureCacheKey(params));
         } else {
             v = createTexture(params, callback);
         }
     }
 
+    std::string TexturePtrLoader::requestKey(const TexturePtrLoadingParams& params) {
+        return params.flags->use_cache ? textureCacheKey(params) : std::string(); // not cached textures are created for every request
+    }
+
     void TexturePtrLoader::cleanUp() noexcept {
         AtomicLock lock(_callbacksLock);
         _callbacks.clear();
@@ -56,9 +56,15 @@ namespace engine {
         using asset_type = TexturePtr;
         static void loadAsset(asset_type& v, const TexturePtrLoadingParams& params, const TexturePtrLoadingCallback& callback);
         static void cleanUp() noexcept;
+        static std::string requestKey(const TexturePtrLoadingParams& params);
     private:
+        // texture stays in _callbacks while it's loaded, even without callbacks
         static void addCallback(asset_type, const TexturePtrLoadingCallback&);
+        // callback waits for loading texture or is called at once with result of finished loading
+        static void addOrExecuteCallback(asset_type, const TexturePtrLoadingCallback&);
         static void executeCallbacks(asset_type, const AssetLoadingResult);
+        // true - loading is stopped, texture is erased from cache; cancellation is ignored while other requests wait for texture
+        static bool cancelLoading(asset_type, const TexturePtrLoadingParams& params, const CancellationToken& token);
 
         static asset_type createTexture(const TexturePtrLoadingParams& params, const TexturePtrLoadingCallback& callback);
 
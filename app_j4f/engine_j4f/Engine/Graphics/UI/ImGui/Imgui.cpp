@@ -110,7 +110,6 @@ namespace engine {
         _renderState.vertexDescription.attributes = VulkanAttributesProvider::convert(attributes);
 
         _renderDescriptor.renderData.push_back(std::make_unique<vulkan::RenderData>());
-        _renderDescriptor.renderData[0u]->indexType = VK_INDEX_TYPE_UINT16;
 
         auto &&graphics = Engine::getInstance().getModule<Graphics>();
 
@@ -149,7 +148,7 @@ namespace engine {
             config.FontDataOwnedByAtlas = false;
 
             auto iconRanges = io.Fonts->GetGlyphRangesDefault();
-            _mainFont = io.Fonts->AddFontFromMemoryTTF(font->fontData->fdata, font->fontData->fileSize, size, &config, iconRanges);
+            _mainFont = io.Fonts->AddFontFromMemoryTTF(const_cast<char*>(font->fontData->fdata), font->fontData->fileSize, size, &config, iconRanges); // atlas doesn't own and doesn't change data
         }
 
         unsigned char *pixels = nullptr;
@@ -282,7 +281,8 @@ namespace engine {
                         0u,                                         // vertexCount (parameter no used with indexed render)
                         0u,                                         // firstVertex
                         vOffset,                                    // vbOffset
-                        indexBufferOffset                           // ibOffset
+                        indexBufferOffset,                          // ibOffset
+                        sizeof(ImDrawIdx) == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32 // indexType
                 };
 
                 renderData->setRenderParts(&renderPart, 1u);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Core/Common.h"
+#include "../Core/Math/mathematic.h"
 
 #include <array>
 #include <cstdint>
@@ -22,13 +23,16 @@ namespace engine {
         struct AttributeDescription {
             //template <typename T, typename std::enable_if<std::is_fundamental_v<T>, int>::type = 0>
             template<typename T, uint32_t binding = 0u>
-            requires(std::is_fundamental_v<T>)
+            requires(std::is_fundamental_v<T> || std::is_same_v<T, HalfFloat>)
             static AttributeDescription
             make(uint32_t componentsCount, bool normalized = false, AttributeLayout layout = AttributeLayout::Forward) {
                 AttributeDescription d;
                 if constexpr (std::is_same_v<T, float>) {
                     d.type = static_cast<Type>(componentsCount - 1u);
                     d.sizeInBytes = componentsCount * sizeof(float);
+                } else if constexpr (std::is_same_v<T, HalfFloat>) {
+                    d.type = static_cast<Type>(36u + componentsCount - 1u);
+                    d.sizeInBytes = componentsCount * sizeof(uint16_t);
                 } else if constexpr (std::is_signed_v<T>) {
                     constexpr uint8_t normalizedID = sizeof(T) == 1u ? 8u : 24u;
                     constexpr uint8_t unNormalizedID = sizeof(T) == 1u ? 16u : 32u;
@@ -86,6 +90,10 @@ namespace engine {
                 SINT_2x16,
                 SINT_3x16,
                 SINT_4x16,
+                FLOAT_1x16 = 36u,
+                FLOAT_2x16,
+                FLOAT_3x16,
+                FLOAT_4x16,
             } type = Type::FLOAT_1x32;
 
             bool backward = false;
@@ -213,6 +221,15 @@ namespace engine {
                     return VK_FORMAT_R16G16B16_SINT;
                 case Type::SINT_4x16:
                     return VK_FORMAT_R16G16B16A16_SINT;
+
+                case Type::FLOAT_1x16:
+                    return VK_FORMAT_R16_SFLOAT;
+                case Type::FLOAT_2x16:
+                    return VK_FORMAT_R16G16_SFLOAT;
+                case Type::FLOAT_3x16:
+                    return VK_FORMAT_R16G16B16_SFLOAT;
+                case Type::FLOAT_4x16:
+                    return VK_FORMAT_R16G16B16A16_SFLOAT;
             }
 
             return VK_FORMAT_UNDEFINED;
@@ -392,7 +392,7 @@ namespace vulkan {
 		return VK_NULL_HANDLE;
 	}
 
-	VkShaderModule VulkanDevice::createShaderModule(const VulkanShaderCode& code, const VkAllocationCallbacks* pAllocator) const {
+	VkShaderModule VulkanDevice::createShaderModule(std::span<const std::byte> code, const VkAllocationCallbacks* pAllocator) const {
 		VkShaderModuleCreateInfo moduleCreateInfo;
 		moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 		moduleCreateInfo.flags = 0;
@@ -144,7 +144,7 @@ namespace vulkan {
         [[nodiscard]] VkQueue getQueue(const GPUQueueFamily gpuQueue, const uint32_t idx) const;
         [[nodiscard]] VkQueue getPresentQueue() const;
 
-		VkShaderModule createShaderModule(const VulkanShaderCode& code, const VkAllocationCallbacks* pAllocator = nullptr) const;
+		VkShaderModule createShaderModule(std::span<const std::byte> code, const VkAllocationCallbacks* pAllocator = nullptr) const;
 		void destroyShaderModule(VkShaderModule module, const VkAllocationCallbacks* pAllocator = nullptr) const;
 
 		VkDescriptorSetLayout createDescriptorSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings, const VkAllocationCallbacks* pAllocator = nullptr) const;
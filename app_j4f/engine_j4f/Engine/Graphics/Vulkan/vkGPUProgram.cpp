@@ -96,9 +96,9 @@ namespace vulkan {
 	}
 
 	VulkanShaderModule::VulkanShaderModule(VulkanRenderer* renderer, const ShaderStageInfo& stageInfo) : m_renderer(renderer), m_stage(stageInfo.pipelineStage) {
-		const VulkanShaderCode code = VulkanShaderModule::loadSpirVCode(stageInfo.modulePass);
-		reflectShaderCode(renderer, code);
-		m_module = renderer->getDevice()->createShaderModule(code);
+		const engine::FileView code = engine::Engine::getInstance().getModule<engine::FileManager>().readFileMapped(stageInfo.modulePass);
+		reflectShaderCode(renderer, code.span());
+		m_module = renderer->getDevice()->createShaderModule(code.span());
 	}
 
     VulkanShaderModule::VulkanShaderModule(VulkanRenderer* renderer, const VulkanShaderCode& code, const VkShaderStageFlagBits pipelineStage) :
@@ -119,7 +119,7 @@ namespace vulkan {
 		m_renderer->getDevice()->destroyShaderModule(m_module);
 	}
 
-	void VulkanShaderModule::reflectShaderCode(VulkanRenderer* renderer, const VulkanShaderCode& code) {
+	void VulkanShaderModule::reflectShaderCode(VulkanRenderer* renderer, std::span<const std::byte> code) {
 	
 		SpvReflectShaderModule reflectedModule;
 		SpvReflectResult result = spvReflectCreateShaderModule(code.size(), code.data(), &reflectedModule);
@@ -11,6 +11,7 @@
 #include <vector>
 #include <cstdint>
 #include <fstream>
+#include <span>
 #include <unordered_map>
 #include <string>
 #include <string_view>
@@ -116,7 +117,7 @@ namespace vulkan {
 
 		void reflectShaderCode(
 			VulkanRenderer* renderer,
-			const VulkanShaderCode& code
+			std::span<const std::byte> code
 		);
 
 		VulkanRenderer* m_renderer;
@@ -37,6 +37,7 @@ namespace vulkan {
 		memAlloc.memoryTypeIndex = vulkanDevice->getMemoryType(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 		vkAllocateMemory(vulkanDevice->device, &memAlloc, nullptr, &memory);
 		vkBindImageMemory(vulkanDevice->device, image, memory, 0);
+		memorySize = memReqs.size;
 	}
 
 	void VulkanImage::createImageView(const VkImageViewType viewType, const VkImageAspectFlagBits aspectFlags, const VkComponentMapping components) {
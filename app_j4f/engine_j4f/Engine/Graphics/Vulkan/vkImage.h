@@ -18,6 +18,7 @@ namespace vulkan {
 		VkFormat format = VK_FORMAT_MAX_ENUM;
 		uint32_t mipLevels = 0;
 		uint32_t arrayLayers = 0;
+		VkDeviceSize memorySize = 0; // bytes of allocated memory
 
 		VulkanImage() = default;
 
@@ -33,7 +34,7 @@ namespace vulkan {
 		~VulkanImage();
 
 		VulkanImage(VulkanImage&& img) noexcept : vulkanDevice(img.vulkanDevice), image(img.image), view(img.view), memory(img.memory),
-			usage(img.usage), imageType(img.imageType), format(img.format), mipLevels(img.mipLevels), arrayLayers(img.arrayLayers) {
+			usage(img.usage), imageType(img.imageType), format(img.format), mipLevels(img.mipLevels), arrayLayers(img.arrayLayers), memorySize(img.memorySize) {
 			img.vulkanDevice = nullptr;
 			img.view = VK_NULL_HANDLE;
 			img.image = VK_NULL_HANDLE;
@@ -51,6 +52,7 @@ namespace vulkan {
 			format = img.format;
 			mipLevels = img.mipLevels;
 			arrayLayers = img.arrayLayers;
+			memorySize = img.memorySize;
 
 			img.vulkanDevice = nullptr;
 			img.view = VK_NULL_HANDLE;
@@ -36,6 +36,7 @@ namespace vulkan {
 			uint32_t firstVertex = 0u;				// номер первой вершины
 			VkDeviceSize vbOffset = 0u;				// оффсет в вершинном буфере
 			VkDeviceSize ibOffset = 0u;				// оффсет в индексном буфере
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;	// тип индексов
 		};
 
         uint32_t instanceCount = 1u;				// количество инстансов
@@ -53,7 +54,6 @@ namespace vulkan {
 
         size_t vertexSize = 0u;
         BatchingParams* batchingParams = nullptr;
-        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
 
 		std::vector<VkDescriptorSet> externalDescriptorsSets;
 
@@ -356,7 +356,7 @@ namespace vulkan {
 						0u, dynamicOffsets.size(), dynamicOffsets.data(),
 						externalDescriptorsSets.size(), externalDescriptorsSets.data(),
 						*vertexes, *indexes, part.firstIndex, part.indexCount, part.firstVertex,
-                        instanceCount, firstInstance, part.vbOffset, part.ibOffset, indexType
+                        instanceCount, firstInstance, part.vbOffset, part.ibOffset, part.indexType
 					);
 				}
 			} else {
@@ -217,9 +217,14 @@ namespace vulkan {
             }
         }
 
+        // optional features: block compressed formats of ktx2 textures, without them textures are decoded on cpu
+        VkPhysicalDeviceFeatures deviceFeatures = features;
+        deviceFeatures.textureCompressionBC |= _vulkanDevice->gpuFeatures.textureCompressionBC;
+        deviceFeatures.textureCompressionASTC_LDR |= _vulkanDevice->gpuFeatures.textureCompressionASTC_LDR;
+
 		GPU_DEBUG_MARKERS_INIT(_vulkanDevice, extensions);
 
-		const VkResult res = _vulkanDevice->createDevice(features, extensions, _deviceCreateNextChain);
+		const VkResult res = _vulkanDevice->createDevice(deviceFeatures, extensions, _deviceCreateNextChain);
 
 		GPU_DEBUG_MARKERS_SETUP(_vulkanDevice);
 
@@ -308,6 +313,8 @@ namespace vulkan {
         _texturesToDelete.resize(_swapChainImagesCount);
         _texturesToFree.resize(_swapChainImagesCount);
 
+		_uploadManager.init(this, cfg.upload_ring_size, cfg.upload_frame_budget, _swapChainImagesCount);
+
 		_defaultSampler = getSampler(
 			VK_FILTER_LINEAR,
 			VK_FILTER_LINEAR,
@@ -975,6 +982,8 @@ namespace vulkan {
             _texturesToDelete.resize(_swapChainImagesCount);
             _texturesToFree.resize(_swapChainImagesCount);
 
+			_uploadManager.resetFrames(_swapChainImagesCount);
+
 			_currentFrame = 0u;
             _acquireImageIndex = 0u;
 		}
@@ -992,6 +1001,8 @@ namespace vulkan {
 			return false;
 		}
 
+		_uploadManager.frameCompleted(_currentFrame);
+
         const VkResult acquireImageResult = _swapChain.acquireNextImage(_presentCompleteSemaphores[_currentFrame].semaphore, &_acquireImageIndex);
         if (acquireImageResult != VK_SUCCESS && acquireImageResult != VK_SUBOPTIMAL_KHR) { // acquire failed - skip this frame to present
             LOG_TAG_LEVEL(engine::LogLevel::L_ERROR, GRAPHICS, "VulkanRenderer: swapChain acquireNextImage result = %s", string_VkResult(acquireImageResult));
@@ -1011,17 +1022,14 @@ namespace vulkan {
 			if (!_buffersToDelete.empty() || !_texturesToDelete.empty() || !_texturesToFree.empty()) {
 				std::vector<VulkanBuffer*> buffersToDelete;
                 std::vector<VulkanTexture*> texturesToDelete;
-				std::vector<std::tuple<VulkanTexture*, VulkanBuffer*, uint32_t, uint32_t>> deferredTexturesToGenerate;
 
 				{
 					engine::AtomicLock lock(_lockTmpData);
                     buffersToDelete = std::move(_buffersToDelete[_currentFrame]);
                     texturesToDelete = std::move(_texturesToDelete[_currentFrame]);
-					deferredTexturesToGenerate = std::move(_deferredTexturesToGenerate);
                     _buffersToDelete[_currentFrame].clear();
                     _texturesToDelete[_currentFrame].clear();
                     _texturesToFree[_currentFrame].clear();
-                    _deferredTexturesToGenerate.clear();
 				}
 
 				for (auto* buffer : buffersToDelete) {
@@ -1031,12 +1039,10 @@ namespace vulkan {
                 for (auto* texture : texturesToDelete) {
                     delete texture;
                 }
-
-				for (auto&& [texture, buffer, baseLayer, layersCount] : deferredTexturesToGenerate) {
-                    texture->fillGpuData(buffer, _mainSupportCommandBuffers[_currentFrame], baseLayer, layersCount);
-					markToDelete(buffer);
-				}
 			}
+
+			// all loaded data copies of frame go with frame support command buffer
+			_uploadManager.recordCopies(_mainSupportCommandBuffers[_currentFrame], _currentFrame);
 		}
 
         return true;
@@ -1366,6 +1372,8 @@ namespace vulkan {
 
 				waitWorkComplete();
 
+				_uploadManager.destroy();
+
 				_mainRenderCommandBuffers.destroy();
 				_mainSupportCommandBuffers.destroy();
 
@@ -1388,16 +1396,13 @@ namespace vulkan {
                     // clear tmp frame data
                     std::vector<std::vector<VulkanBuffer *>> buffersToDelete;
                     std::vector<std::vector<VulkanTexture *>> texturesToDelete;
-                    std::vector<std::tuple<VulkanTexture *, VulkanBuffer *, uint32_t, uint32_t>> deferredTexturesToGenerate;
                     {
                         engine::AtomicLock lock(_lockTmpData);
                         buffersToDelete = std::move(_buffersToDelete);
                         texturesToDelete = std::move(_texturesToDelete);
-                        deferredTexturesToGenerate = std::move(_deferredTexturesToGenerate);
                         _buffersToDelete.clear();
                         _texturesToDelete.clear();
                         _texturesToFree.clear();
-                        _deferredTexturesToGenerate.clear();
                     }
 
                     for (auto &&buffers: buffersToDelete) {
@@ -1412,13 +1417,8 @@ namespace vulkan {
                         }
                     }
 
-                    for (auto &&p: deferredTexturesToGenerate) {
-                        delete std::get<VulkanBuffer *>(p);
-                    }
-
                     buffersToDelete.clear();
                     texturesToDelete.clear();
-                    deferredTexturesToGenerate.clear();
                     // clear tmp frame data
                 }
 
@@ -11,6 +11,7 @@
 #include "vkGPUProgram.h"
 #include "vkDescriptorSet.h"
 #include "vkDynamicBuffer.h"
+#include "vkUploadManager.h"
 
 #include "../../Core/Threads/Synchronisations.h"
 #include "../../Engine/Core/Hash.h"
@@ -552,10 +553,7 @@ namespace vulkan {
         void markToDelete(VulkanTexture* texture);
         void markToDelete(VulkanTexture&& texture);
 
-		void addDeferredGenerateTexture(VulkanTexture* t, VulkanBuffer* b, const uint32_t baseLayer, const uint32_t layerCount) {
-			engine::AtomicLock lock(_lockTmpData);
-			_deferredTexturesToGenerate.emplace_back(t, b, baseLayer, layerCount);
-		}
+		inline VulkanUploadManager& getUploadManager() noexcept { return _uploadManager; }
 
 		inline uint32_t getWidth() const noexcept { return _width; }
 		inline uint32_t getHeight() const noexcept { return _height; }
@@ -694,9 +692,10 @@ namespace vulkan {
 		// tmp frame data
 		std::atomic_bool _lockTmpData = {};
 		std::vector<std::vector<VulkanBuffer*>> _buffersToDelete;
-		std::vector<std::tuple<VulkanTexture*, VulkanBuffer*, uint32_t, uint32_t>> _deferredTexturesToGenerate;
         std::vector<std::vector<VulkanTexture*>> _texturesToDelete;
         std::vector<std::vector<VulkanTexture>> _texturesToFree;
+		// uploads of buffers and textures data
+		VulkanUploadManager _uploadManager;
 		// empty data
 		VulkanTexture* _emptyTexture = nullptr;
 		VulkanTexture* _emptyTextureArray = nullptr;
@@ -2,10 +2,13 @@
 #include "vkImage.h"
 #include "vkRenderer.h"
 
+#include <numeric>
+
 namespace vulkan {
 
 	VulkanTexture::~VulkanTexture() {
 		if (_img) { 
+			_renderer->getUploadManager().cancelUploads(this); // deferred copy may wait for frame budget; lock also waits for copy in recording
 			delete _img;
 			_img = nullptr;
 		}
@@ -18,11 +21,11 @@ namespace vulkan {
 
 	void VulkanTexture::create(const void* data, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const bool deffered, const VkImageViewType forceType) {
 		_generationState.store(VulkanTextureCreationState::CREATION_STARTED, std::memory_order_release);
-		VulkanBuffer* staging = generateWithData(&data, 1, format, bpp, createMipMaps, forceType);
-
 		if (deffered) {
-			_renderer->addDeferredGenerateTexture(this, staging, 0, 1);
+			const size_t layerSize = createImage(1, format, bpp, createMipMaps, forceType);
+			_renderer->getUploadManager().uploadTexture(this, &data, 1, layerSize, bpp / 8);
 		} else {
+			VulkanBuffer* staging = generateWithData(&data, 1, format, bpp, createMipMaps, forceType);
 			auto&& cmdBuffer = _renderer->getSupportCommandBuffer();
 			fillGpuData(staging, cmdBuffer, 0, 1);
 			_renderer->markToDelete(staging);
@@ -31,11 +34,47 @@ namespace vulkan {
 
 	void VulkanTexture::create(const void** data, const uint32_t layerCount, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const bool deffered, const VkImageViewType forceType) {
 		_generationState.store(VulkanTextureCreationState::CREATION_STARTED, std::memory_order_release);
-		VulkanBuffer* staging = generateWithData(data, layerCount, format, bpp, createMipMaps, forceType);
+		if (deffered) {
+			const size_t layerSize = createImage(layerCount, format, bpp, createMipMaps, forceType);
+			_renderer->getUploadManager().uploadTexture(this, data, layerCount, layerSize, bpp / 8);
+		} else {
+			VulkanBuffer* staging = generateWithData(data, layerCount, format, bpp, createMipMaps, forceType);
+			auto&& cmdBuffer = _renderer->getSupportCommandBuffer();
+			fillGpuData(staging, cmdBuffer, 0, layerCount);
+			_renderer->markToDelete(staging);
+		}
+	}
+
+	void VulkanTexture::createWithLevels(const void* const* levels, const size_t* levelSizes, const uint32_t levelCount, const uint32_t layerCount, const VkFormat format, const uint8_t blockSize, const bool deffered, const VkImageViewType forceType) {
+		_generationState.store(VulkanTextureCreationState::CREATION_STARTED, std::memory_order_release);
+
+		// levels are placed one by one, buffer offset of image copy must be multiple of block size and 4
+		const VkDeviceSize alignment = std::lcm<VkDeviceSize>(16u, std::max<uint8_t>(blockSize, 1u));
+		VkDeviceSize size = 0u;
+		_levelOffsets.resize(levelCount);
+		for (uint32_t i = 0u; i < levelCount; ++i) {
+			_levelOffsets[i] = size;
+			size = (size + levelSizes[i] + alignment - 1u) / alignment * alignment;
+		}
+
+		createVulkanImage(layerCount, format, levelCount, forceType);
 
 		if (deffered) {
-			_renderer->addDeferredGenerateTexture(this, staging, 0, layerCount);
+			_renderer->getUploadManager().uploadTextureLevels(this, levels, levelSizes, _levelOffsets.data(), levelCount, layerCount, size, blockSize);
 		} else {
+			auto* staging = new VulkanBuffer();
+			_renderer->getDevice()->createBuffer(
+				VK_SHARING_MODE_EXCLUSIVE,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				staging,
+				size
+			);
+
+			for (uint32_t i = 0u; i < levelCount; ++i) {
+				staging->upload(levels[i], levelSizes[i], _levelOffsets[i]);
+			}
+
 			auto&& cmdBuffer = _renderer->getSupportCommandBuffer();
 			fillGpuData(staging, cmdBuffer, 0, layerCount);
 			_renderer->markToDelete(staging);
@@ -43,12 +82,41 @@ namespace vulkan {
 	}
 
 	VulkanBuffer* VulkanTexture::generateWithData(const void** data, const uint32_t count, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const VkImageViewType forceType) {
-		const size_t elementDataSize = _width * _height * (bpp / 8);
+		const size_t elementDataSize = createImage(count, format, bpp, createMipMaps, forceType);
 		const size_t allDataSize = elementDataSize * count;
+
+		auto* staging = new VulkanBuffer();
+		_renderer->getDevice()->createBuffer(
+			VK_SHARING_MODE_EXCLUSIVE,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			staging,
+			allDataSize
+		);
+
+		size_t offset = 0;
+		for (size_t i = 0; i < count; ++i) {
+			staging->upload(data[i], elementDataSize, offset);
+			offset += elementDataSize;
+		}
+
+		return staging;
+	}
+
+	size_t VulkanTexture::createImage(const uint32_t count, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const VkImageViewType forceType) {
+		const size_t elementDataSize = _width * _height * (bpp / 8);
 		const uint8_t mipLevels = (createMipMaps ? (static_cast<uint8_t>(std::floor(std::log2(std::max(_width, _height)))) + 1) : 1);
 
+		createVulkanImage(count, format, mipLevels, forceType);
+
+		return elementDataSize;
+	}
+
+	void VulkanTexture::createVulkanImage(const uint32_t count, const VkFormat format, const uint32_t mipLevels, const VkImageViewType forceType) {
 		_arrayLayers = count;
 
+		const bool cube = forceType == VK_IMAGE_VIEW_TYPE_CUBE || forceType == VK_IMAGE_VIEW_TYPE_CUBE_ARRAY;
+
 		_img = new vulkan::VulkanImage(
 			_renderer->getDevice(),
 			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
@@ -58,7 +126,7 @@ namespace vulkan {
 			_width,
 			_height,
 			1,
-			0,
+			cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0,
 			count
 		);
 
@@ -71,26 +139,9 @@ namespace vulkan {
 		if (_sampler == VK_NULL_HANDLE) { // билинейная фильтрация + MODE_REPEAT по умолчанию
 			_sampler = _renderer->getDefaultSampler();
 		}
-
-		auto* staging = new VulkanBuffer();
-		_renderer->getDevice()->createBuffer(
-			VK_SHARING_MODE_EXCLUSIVE,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			staging,
-			allDataSize
-		);
-
-		size_t offset = 0;
-		for (size_t i = 0; i < count; ++i) {
-			staging->upload(data[i], elementDataSize, offset);
-			offset += elementDataSize;
-		}
-
-		return staging;
 	}
 
-	void VulkanTexture::fillGpuData(VulkanBuffer* staging, VulkanCommandBuffer& cmdBuffer, const uint32_t baseLayer, const uint32_t layerCount) {
+	void VulkanTexture::fillGpuData(const VulkanBuffer* staging, VulkanCommandBuffer& cmdBuffer, const uint32_t baseLayer, const uint32_t layerCount, const VkDeviceSize stagingOffset) {
 		cmdBuffer.begin();
 
 		// image memory barriers for the texture image
@@ -104,20 +155,38 @@ namespace vulkan {
 			VK_PIPELINE_STAGE_HOST_BIT,
 			VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-		VkBufferImageCopy region;
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = baseLayer;
-		region.imageSubresource.layerCount = layerCount;
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = { _width, _height, _depth };
-
-		cmdBuffer.cmdCopyBufferToImage(*staging, *_img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		if (!_levelOffsets.empty()) { // every level from staging, nothing to generate
+			std::vector<VkBufferImageCopy> regions(_levelOffsets.size());
+			for (uint32_t i = 0u; i < regions.size(); ++i) {
+				VkBufferImageCopy& region = regions[i];
+				region.bufferOffset = stagingOffset + _levelOffsets[i];
+				region.bufferRowLength = 0;
+				region.bufferImageHeight = 0;
+				region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				region.imageSubresource.mipLevel = i;
+				region.imageSubresource.baseArrayLayer = baseLayer;
+				region.imageSubresource.layerCount = layerCount;
+				region.imageOffset = { 0, 0, 0 };
+				region.imageExtent = { std::max(_width >> i, 1u), std::max(_height >> i, 1u), _depth };
+			}
+
+			cmdBuffer.cmdCopyBufferToImage(*staging, *_img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+		} else {
+			VkBufferImageCopy region;
+			region.bufferOffset = stagingOffset;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = 0;
+			region.imageSubresource.baseArrayLayer = baseLayer;
+			region.imageSubresource.layerCount = layerCount;
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { _width, _height, _depth };
+
+			cmdBuffer.cmdCopyBufferToImage(*staging, *_img, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		}
 
-		if (_img->mipLevels > 1) { // generate mipmaps
+		if (_img->mipLevels > 1 && _levelOffsets.empty()) { // generate mipmaps
 			generateMipMaps(cmdBuffer);
 		} else {
 			cmdBuffer.changeImageLayout(
@@ -214,6 +283,8 @@ namespace vulkan {
 
     VkImageView VulkanTexture::getImageView() const { return _img->view; }
 
+    VkDeviceSize VulkanTexture::memorySize() const noexcept { return _img ? _img->memorySize : 0u; }
+
 	void VulkanTexture::createSingleDescriptor(const VkImageLayout imageLayout, const uint32_t binding) {
 		if (_generationState.load(std::memory_order_consume) == VulkanTextureCreationState::CREATION_COMPLETE) {
 			VkDescriptorSetLayoutBinding bindingLayout = { binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr };
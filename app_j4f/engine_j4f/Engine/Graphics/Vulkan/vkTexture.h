@@ -4,6 +4,7 @@
 #include <vulkan/vulkan.h>
 
 #include <atomic>
+#include <vector>
 
 namespace vulkan {
 
@@ -42,7 +43,8 @@ namespace vulkan {
             _descriptorPoolId(t._descriptorPoolId),
             _imageLayout(t._imageLayout),
             _binding(t._binding),
-            _arrayLayers(t._arrayLayers) {
+            _arrayLayers(t._arrayLayers),
+            _levelOffsets(std::move(t._levelOffsets)) {
             _generationState = t._generationState.load(std::memory_order_relaxed);
             t._img = nullptr;
             t._descriptor = nullptr;
@@ -62,6 +64,7 @@ namespace vulkan {
             _imageLayout = t._imageLayout;
             _binding = t._binding;
             _arrayLayers = t._arrayLayers ;
+            _levelOffsets = std::move(t._levelOffsets);
             _generationState = t._generationState.load(std::memory_order_relaxed);
             t._img = nullptr;
             t._descriptor = nullptr;
@@ -74,9 +77,12 @@ namespace vulkan {
         ~VulkanTexture();
 
 		VulkanBuffer* generateWithData(const void** data, const uint32_t count, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const VkImageViewType forceType);
+		size_t createImage(const uint32_t count, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const VkImageViewType forceType); // returns size of layer data
 
 		void create(const void* data, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const bool deffered = false, const VkImageViewType forceType = VK_IMAGE_VIEW_TYPE_MAX_ENUM);
 		void create(const void** data, const uint32_t layerCount, const VkFormat format, const uint8_t bpp, const bool createMipMaps, const bool deffered = false, const VkImageViewType forceType = VK_IMAGE_VIEW_TYPE_MAX_ENUM);
+		// precomputed mip levels (ktx2), data of level is all its layers one by one, block formats are uploaded as is
+		void createWithLevels(const void* const* levels, const size_t* levelSizes, const uint32_t levelCount, const uint32_t layerCount, const VkFormat format, const uint8_t blockSize, const bool deffered = false, const VkImageViewType forceType = VK_IMAGE_VIEW_TYPE_MAX_ENUM);
 
 		void createSingleDescriptor(const VkImageLayout imageLayout, const uint32_t binding);
 
@@ -85,7 +91,7 @@ namespace vulkan {
         [[nodiscard]] inline VkSampler getSampler() const { return _sampler; }
         [[nodiscard]] inline VkDescriptorSet getSingleDescriptor() const { return _descriptor; }
 
-		void fillGpuData(VulkanBuffer* staging, VulkanCommandBuffer& cmdBuffer, const uint32_t baseLayer, const uint32_t layerCount);
+		void fillGpuData(const VulkanBuffer* staging, VulkanCommandBuffer& cmdBuffer, const uint32_t baseLayer, const uint32_t layerCount, const VkDeviceSize stagingOffset = 0u);
 
         [[nodiscard]] inline VulkanTextureCreationState generationState() const { return _generationState.load(std::memory_order_consume); }
 		inline void noGenerate() { _generationState.store(VulkanTextureCreationState::NO_CREATED, std::memory_order_release); }
@@ -94,9 +100,11 @@ namespace vulkan {
 
 		inline uint32_t width() const noexcept { return _width; }
 		inline uint32_t height() const noexcept { return _height; }
+		[[nodiscard]] VkDeviceSize memorySize() const noexcept; // 0 - image isn't created
 
 	private:
 
+		void createVulkanImage(const uint32_t count, const VkFormat format, const uint32_t mipLevels, const VkImageViewType forceType);
 		void generateMipMaps(VulkanCommandBuffer& cmdBuffer) const;
 		
 		VulkanRenderer* _renderer = nullptr;
@@ -115,5 +123,6 @@ namespace vulkan {
 		VkImageLayout _imageLayout;
 		uint32_t _binding = 0;
 		uint32_t _arrayLayers = 0;
+		std::vector<VkDeviceSize> _levelOffsets; // offsets of precomputed mip levels in staging data, empty - mip levels are generated
 	};
 }
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "vkUploadManager.h"
+#include "vkRenderer.h"
+#include "vkTexture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace vulkan {
+
+	void VulkanUploadManager::init(VulkanRenderer* renderer, const VkDeviceSize ringSize, const VkDeviceSize frameBudget, const uint32_t framesCount) {
+		_renderer = renderer;
+		_ringSize = ringSize;
+		_frameBudget = frameBudget;
+		_inFlight.resize(framesCount);
+
+		if (_ringSize != 0u) {
+			_renderer->getDevice()->createBuffer(
+				VK_SHARING_MODE_EXCLUSIVE,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				&_ring,
+				_ringSize
+			);
+			_ringMemory = static_cast<uint8_t*>(_ring.map(_ringSize)); // persistently mapped
+		}
+	}
+
+	void VulkanUploadManager::destroy() {
+		engine::AtomicLock lock(_queueLock);
+		takePushed();
+
+		for (Request* r : _queue) {
+			delete r->staging;
+			delete r;
+		}
+		_queue.clear();
+
+		_inFlight.clear();
+		_released.clear();
+
+		if (_ringMemory) {
+			_ring.unmap();
+			_ringMemory = nullptr;
+		}
+		_ring.destroy();
+
+		_head.store(0u, std::memory_order_relaxed);
+		_tail.store(0u, std::memory_order_relaxed);
+		_bytesQueued.store(0u, std::memory_order_relaxed);
+	}
+
+	bool VulkanUploadManager::reserve(Request* request, const VkDeviceSize alignment) {
+		const VkDeviceSize size = request->size;
+		if (_ringMemory == nullptr || size > _ringSize / 4u) return false; // big data doesn't stall ring
+
+		uint64_t head = _head.load(std::memory_order_relaxed);
+		while (true) {
+			uint64_t start = (head + alignment - 1u) / alignment * alignment;
+			if (start % _ringSize + size > _ringSize) { // region can't wrap, skip to ring begin
+				start = (start / _ringSize + 1u) * _ringSize;
+			}
+
+			const uint64_t end = start + size;
+			if (end - _tail.load(std::memory_order_acquire) > _ringSize) return false; // ring is full
+
+			if (_head.compare_exchange_weak(head, end, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				request->ringBegin = head; // alignment and skipped tail of ring are released with region
+				request->ringEnd = end;
+				request->srcOffset = start % _ringSize;
+				return true;
+			}
+		}
+	}
+
+	uint8_t* VulkanUploadManager::stage(Request* request, const VkDeviceSize alignment) {
+		if (reserve(request, alignment)) {
+			return _ringMemory + request->srcOffset;
+		}
+
+		_dedicatedStagings.fetch_add(1u, std::memory_order_relaxed);
+
+		request->staging = new VulkanBuffer();
+		_renderer->getDevice()->createBuffer(
+			VK_SHARING_MODE_EXCLUSIVE,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			request->staging,
+			request->size
+		);
+		request->srcOffset = 0u;
+
+		return static_cast<uint8_t*>(request->staging->map(request->size));
+	}
+
+	void VulkanUploadManager::push(Request* request) {
+		if (request->staging) {
+			request->staging->unmap();
+		}
+
+		_bytesQueued.fetch_add(request->size, std::memory_order_relaxed);
+
+		request->next = _pushed.load(std::memory_order_relaxed);
+		while (!_pushed.compare_exchange_weak(request->next, request, std::memory_order_release, std::memory_order_relaxed)) {}
+	}
+
+	void VulkanUploadManager::takePushed() {
+		if (Request* request = _pushed.exchange(nullptr, std::memory_order_acquire)) {
+			const size_t count = _queue.size();
+			while (request) { // stack -> push order
+				_queue.push_back(request);
+				request = request->next;
+			}
+			std::reverse(_queue.begin() + static_cast<ptrdiff_t>(count), _queue.end());
+		}
+	}
+
+	void VulkanUploadManager::cancelUploads(const VulkanBuffer* dst) {
+		if (dst == nullptr) return;
+
+		engine::AtomicLock lock(_queueLock);
+		takePushed();
+		for (Request* r : _queue) {
+			if (r->dstBuffer == dst) {
+				r->dstBuffer = nullptr;
+			}
+		}
+	}
+
+	void VulkanUploadManager::cancelUploads(const VulkanTexture* dst) {
+		if (dst == nullptr) return;
+
+		engine::AtomicLock lock(_queueLock);
+		takePushed();
+		for (Request* r : _queue) {
+			if (r->dstTexture == dst) {
+				r->dstTexture = nullptr;
+			}
+		}
+	}
+
+	void VulkanUploadManager::uploadBuffer(VulkanBuffer* dst, const VkDeviceSize dstOffset, const void* data, const VkDeviceSize size, UploadCallback&& callback) {
+		if (size == 0u) {
+			if (callback) { callback(true); }
+			return;
+		}
+
+		auto* request = new Request();
+		request->dstBuffer = dst;
+		request->dstOffset = dstOffset;
+		request->size = size;
+		request->callback = std::move(callback);
+
+		memcpy(stage(request, 16u), data, size);
+		push(request);
+	}
+
+	void VulkanUploadManager::uploadTexture(VulkanTexture* dst, const void** data, const uint32_t layerCount, const size_t layerSize, const uint8_t texelSize) {
+		auto* request = new Request();
+		request->dstTexture = dst;
+		request->layerCount = layerCount;
+		request->size = layerSize * layerCount;
+
+		// buffer offset of image copy must be multiple of texel size and 4
+		uint8_t* memory = stage(request, std::lcm<VkDeviceSize>(16u, std::max<uint8_t>(texelSize, 1u)));
+		for (uint32_t i = 0u; i < layerCount; ++i) {
+			memcpy(memory + layerSize * i, data[i], layerSize);
+		}
+		push(request);
+	}
+
+	void VulkanUploadManager::uploadTextureLevels(VulkanTexture* dst, const void* const* levels, const size_t* levelSizes, const VkDeviceSize* offsets, const uint32_t levelCount, const uint32_t layerCount, const VkDeviceSize size, const uint8_t blockSize) {
+		auto* request = new Request();
+		request->dstTexture = dst;
+		request->layerCount = layerCount;
+		request->size = size;
+
+		uint8_t* memory = stage(request, std::lcm<VkDeviceSize>(16u, std::max<uint8_t>(blockSize, 1u)));
+		for (uint32_t i = 0u; i < levelCount; ++i) {
+			memcpy(memory + offsets[i], levels[i], levelSizes[i]);
+		}
+		push(request);
+	}
+
+	void VulkanUploadManager::frameCompleted(const uint32_t frame) {
+		auto& regions = _inFlight[frame];
+		if (regions.empty()) return;
+
+		for (auto&& [begin, end] : regions) {
+			_released.emplace(begin, end);
+		}
+		regions.clear();
+
+		// regions are released in ring order, copies of one frame may go not in order of reservation
+		uint64_t tail = _tail.load(std::memory_order_relaxed);
+		for (auto it = _released.begin(); it != _released.end() && it->first == tail; it = _released.erase(it)) {
+			tail = it->second;
+		}
+		_tail.store(tail, std::memory_order_release);
+	}
+
+	void VulkanUploadManager::recordCopies(VulkanCommandBuffer& cmdBuffer, const uint32_t frame) {
+		const auto start = std::chrono::steady_clock::now();
+		VkDeviceSize frameBytes = 0u;
+		bool buffersCopied = false;
+		std::vector<std::pair<UploadCallback, bool>> callbacks; // called without lock, they can cancel other uploads
+
+		{
+			engine::AtomicLock lock(_queueLock);
+			takePushed();
+
+			while (!_queue.empty()) {
+				Request* r = _queue.front();
+				if (frameBytes != 0u && frameBytes + r->size > _frameBudget) break; // one request is always copied, even over budget
+
+				const VulkanBuffer& src = r->staging ? *r->staging : _ring;
+				if (r->dstBuffer) {
+					cmdBuffer.cmdCopyBuffer(src, *r->dstBuffer, r->srcOffset, r->dstOffset, r->size);
+					buffersCopied = true;
+				} else if (r->dstTexture) {
+					r->dstTexture->fillGpuData(&src, cmdBuffer, 0u, r->layerCount, r->srcOffset);
+				}
+
+				if (r->staging) {
+					_renderer->markToDelete(r->staging);
+				} else {
+					_inFlight[frame].emplace_back(r->ringBegin, r->ringEnd);
+				}
+
+				if (r->callback) {
+					callbacks.emplace_back(std::move(r->callback), r->dstBuffer || r->dstTexture);
+				}
+
+				frameBytes += r->size;
+				_queue.pop_front();
+				delete r;
+			}
+		}
+
+		if (buffersCopied) {
+			VkMemoryBarrier barrier;
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.pNext = nullptr;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+			cmdBuffer.cmdPipelineBarrier(
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+				0,
+				1, &barrier,
+				0, nullptr,
+				0, nullptr
+			);
+		}
+
+		_bytesQueued.fetch_sub(frameBytes, std::memory_order_relaxed);
+		_bytesUploaded += frameBytes;
+		_lastFrameBytes = frameBytes;
+
+		for (auto&& [callback, recorded] : callbacks) {
+			callback(recorded);
+		}
+
+		const auto end = std::chrono::steady_clock::now();
+		_lastRecordTime = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+		_maxRecordTime = std::max(_maxRecordTime, _lastRecordTime);
+
+		_rateBytes += frameBytes;
+		const double elapsed = std::chrono::duration<double>(end - _rateStart).count();
+		if (elapsed >= 1.0) {
+			_uploadRate = static_cast<double>(_rateBytes) / elapsed;
+			_rateBytes = 0u;
+			_rateStart = end;
+		}
+	}
+
+	void VulkanUploadManager::resetFrames(const uint32_t framesCount) {
+		for (uint32_t i = 0u, sz = static_cast<uint32_t>(_inFlight.size()); i < sz; ++i) {
+			frameCompleted(i);
+		}
+		_inFlight.resize(framesCount);
+	}
+
+	VulkanUploadManager::Stats VulkanUploadManager::getStats() const noexcept {
+		Stats stats;
+		stats.bytesUploaded = _bytesUploaded;
+		stats.bytesQueued = _bytesQueued.load(std::memory_order_relaxed);
+		stats.lastFrameBytes = _lastFrameBytes;
+		stats.dedicatedStagings = _dedicatedStagings.load(std::memory_order_relaxed);
+		stats.uploadRate = _uploadRate;
+		stats.lastRecordTime = _lastRecordTime;
+		stats.maxRecordTime = _maxRecordTime;
+		return stats;
+	}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "vkBuffer.h"
+#include "vkCommandBuffer.h"
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+// uploads of buffers and textures data from any thread:
+// - data is written into persistently mapped staging ring, space in ring is reserved with atomic head, without locks,
+//   data which doesn't fit into ring goes through own staging buffer
+// - render thread records copies into frame support command buffer, so all copies of frame go with one submit and frame fence,
+//   bytes of copies per frame are limited with budget, other requests wait for next frames
+// - ring regions are released after fence of frame, in which they were copied
+
+namespace vulkan {
+
+	class VulkanRenderer;
+	class VulkanTexture;
+
+	class VulkanUploadManager {
+	public:
+		struct Stats {
+			uint64_t bytesUploaded = 0u;	// copied to gpu since init
+			uint64_t bytesQueued = 0u;		// waiting for copy
+			uint64_t lastFrameBytes = 0u;
+			uint32_t dedicatedStagings = 0u; // uploads which haven't fit into ring
+			double uploadRate = 0.0;		// bytes per second copied over the last measured second
+			uint32_t lastRecordTime = 0u;	// microseconds of render thread in recordCopies of last frame (cpu side of upload hitch)
+			uint32_t maxRecordTime = 0u;	// the longest recordCopies since init
+		};
+
+		VulkanUploadManager() = default;
+		~VulkanUploadManager() { destroy(); }
+
+		VulkanUploadManager(const VulkanUploadManager&) = delete;
+		VulkanUploadManager& operator= (const VulkanUploadManager&) = delete;
+
+		void init(VulkanRenderer* renderer, const VkDeviceSize ringSize, const VkDeviceSize frameBudget, const uint32_t framesCount);
+		void destroy();
+
+		// called by render thread when copy is recorded (true) or cancelled (false), not called if manager is destroyed before
+		using UploadCallback = std::function<void(const bool recorded)>;
+
+		// any thread
+		void uploadBuffer(VulkanBuffer* dst, const VkDeviceSize dstOffset, const void* data, const VkDeviceSize size, UploadCallback&& callback = nullptr);
+		void uploadTexture(VulkanTexture* dst, const void** data, const uint32_t layerCount, const size_t layerSize, const uint8_t texelSize);
+		// precomputed mip levels, level i is written at offsets[i] of size bytes (VulkanTexture::createWithLevels)
+		void uploadTextureLevels(VulkanTexture* dst, const void* const* levels, const size_t* levelSizes, const VkDeviceSize* offsets, const uint32_t levelCount, const uint32_t layerCount, const VkDeviceSize size, const uint8_t blockSize);
+
+		// any thread, before dst is destroyed: its not recorded copies are dropped, their callbacks get false on render thread
+		void cancelUploads(const VulkanBuffer* dst);
+		void cancelUploads(const VulkanTexture* dst);
+
+		// render thread
+		void frameCompleted(const uint32_t frame); // fence of frame is signaled
+		void recordCopies(VulkanCommandBuffer& cmdBuffer, const uint32_t frame);
+		void resetFrames(const uint32_t framesCount); // after device wait idle (swapchain recreation)
+
+		inline void setFrameBudget(const VkDeviceSize budget) noexcept { _frameBudget = budget; }
+		[[nodiscard]] inline VkDeviceSize getFrameBudget() const noexcept { return _frameBudget; }
+
+		[[nodiscard]] Stats getStats() const noexcept;
+
+	private:
+		struct Request {
+			Request* next = nullptr;
+			VulkanBuffer* dstBuffer = nullptr; // nullptr in both - request is cancelled, its staging is only released
+			VulkanTexture* dstTexture = nullptr;
+			VulkanBuffer* staging = nullptr; // own staging buffer, nullptr - ring
+			VkDeviceSize srcOffset = 0u;
+			VkDeviceSize dstOffset = 0u;
+			VkDeviceSize size = 0u;
+			uint64_t ringBegin = 0u; // reserved region of ring in ring positions (growing, not wrapped)
+			uint64_t ringEnd = 0u;
+			uint32_t layerCount = 0u;
+			UploadCallback callback = nullptr;
+		};
+
+		[[nodiscard]] bool reserve(Request* request, const VkDeviceSize alignment);
+		[[nodiscard]] uint8_t* stage(Request* request, const VkDeviceSize alignment);
+		void push(Request* request);
+		void takePushed(); // under _queueLock
+
+		VulkanRenderer* _renderer = nullptr;
+
+		VulkanBuffer _ring;
+		uint8_t* _ringMemory = nullptr;
+		VkDeviceSize _ringSize = 0u;
+		VkDeviceSize _frameBudget = 0u;
+
+		std::atomic_uint64_t _head = 0u; // next free ring position, producers
+		std::atomic_uint64_t _tail = 0u; // first not released ring position, render thread
+		std::atomic<Request*> _pushed = nullptr; // lock free stack of new requests (newest first)
+		std::atomic_uint64_t _bytesQueued = 0u;
+		std::atomic_uint32_t _dedicatedStagings = 0u;
+
+		std::atomic_bool _queueLock = false; // _queue is taken by render thread and cancelUploads
+		std::deque<Request*> _queue;
+
+		// render thread only
+		std::vector<std::vector<std::pair<uint64_t, uint64_t>>> _inFlight; // ring regions copied in frame
+		std::map<uint64_t, uint64_t> _released; // completed regions, which can't be released before previous ones
+		uint64_t _bytesUploaded = 0u;
+		uint64_t _lastFrameBytes = 0u;
+		uint32_t _lastRecordTime = 0u;
+		uint32_t _maxRecordTime = 0u;
+		double _uploadRate = 0.0;
+		uint64_t _rateBytes = 0u; // bytes copied since _rateStart
+		std::chrono::steady_clock::time_point _rateStart = std::chrono::steady_clock::now();
+	};
+
+}
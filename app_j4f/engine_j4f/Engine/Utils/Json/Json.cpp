@@ -12,7 +12,12 @@ namespace engine {
 		auto&& engine = Engine::getInstance();
 
 		if (params.flags->async) {
-			engine.getModule<AssetManager>().getThreadPool()->enqueue(TaskType::COMMON, [params, callback](const CancellationToken& token) {
+			engine.getModule<AssetManager>().enqueueLoading(params, [params, callback](const CancellationToken& token) {
+				if (params.cancelled()) {
+					if (callback) { callback(Json(), AssetLoadingResult::LOADING_CANCELED); }
+					return;
+				}
+
 				PROFILE_TIME_SCOPED_M(jsonLoading, params.file)
 				auto&& engine = Engine::getInstance();
 				auto&& fm = engine.getModule<FileManager>();
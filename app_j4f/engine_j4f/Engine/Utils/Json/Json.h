@@ -23,6 +23,7 @@ namespace engine {
 		using asset_type = Json;
 		static void loadAsset(Json& v, const JsonLoadingParams& params, const JsonLoadingCallback& callback);
         static void cleanUp() noexcept {}
+		static std::string requestKey(const JsonLoadingParams& params) { return params.file; }
 	private:
 	};
 
@@ -0,0 +1,579 @@
+// offline conversion of gltf / glb models to engine native .j4m:
+// vertices are interleaved for the given attributes exactly as Mesh_Data::loadMeshes does (so shaders and
+// Mesh::getVertexInputAttributes see the same layout), animations are compressed (see AnimationCompression.h)
+//
+// use example: $ ./meshConverter -i ./models/knight.glb -o ./models/knight.j4m -a POSITION,NORMAL,TEXCOORD_0,JOINTS_0,WEIGHTS_0
+//
+// options:
+//   -i input .gltf or .glb
+//   -o output .j4m
+//   -a vertex attributes, comma separated gltf names (must match MeshLoadingParams::semanticMask), default - all attributes of mesh
+//   -t animation compression tolerance (default 0.001), translation and scale in model units, rotation in radians
+//   -b load time benchmark: iterations count of gltf loading (parsing + interleaving) against j4m loading
+
+#include "Graphics/Mesh/Loader_j4m.h"
+#include "Utils/Json/json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+	using Json = nlohmann::json;
+	using namespace engine;
+	using Semantic = gltf::AttributesSemantic;
+
+	constexpr uint8_t kSemanticsCount = static_cast<uint8_t>(Semantic::SEMANTICS_COUNT);
+	constexpr const char* kSemanticNames[kSemanticsCount] = {
+		"POSITION", "NORMAL", "TANGENT", "COLOR", "JOINTS_0", "WEIGHTS_0", "TEXCOORD_0", "TEXCOORD_1", "TEXCOORD_2", "TEXCOORD_3", "TEXCOORD_4"
+	};
+
+	enum class ComponentType : uint16_t {
+		BYTE = 5120,
+		UNSIGNED_BYTE = 5121,
+		SHORT = 5122,
+		UNSIGNED_SHORT = 5123,
+		UNSIGNED_INT = 5125,
+		FLOAT = 5126
+	};
+
+	struct Options {
+		std::string input;
+		std::string output;
+		uint16_t semanticMask = 0u;
+		float tolerance = 1e-3f;
+		uint32_t benchmark = 0u;
+	};
+
+	struct Document {
+		Json js;
+		std::vector<std::vector<uint8_t>> buffers;
+	};
+
+	// converted data, j4m::Content refers to it
+	struct Model {
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		j4m::Content content;
+	};
+
+	size_t componentSize(const uint16_t componentType) {
+		switch (static_cast<ComponentType>(componentType)) {
+			case ComponentType::BYTE:
+			case ComponentType::UNSIGNED_BYTE:
+				return 1u;
+			case ComponentType::SHORT:
+			case ComponentType::UNSIGNED_SHORT:
+				return 2u;
+			case ComponentType::UNSIGNED_INT:
+			case ComponentType::FLOAT:
+				return 4u;
+			default:
+				return 0u;
+		}
+	}
+
+	size_t componentsCount(const std::string& type) {
+		if (type == "SCALAR") return 1u;
+		if (type == "VEC2") return 2u;
+		if (type == "VEC3") return 3u;
+		if (type == "VEC4") return 4u;
+		if (type == "MAT2") return 4u;
+		if (type == "MAT3") return 9u;
+		if (type == "MAT4") return 16u;
+		return 0u;
+	}
+
+	std::string base64Decode(const std::string& in) {
+		static constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string out;
+		out.reserve(in.size() * 3u / 4u);
+
+		uint32_t value = 0u;
+		int32_t bits = -8;
+		for (const char c : in) {
+			const size_t idx = alphabet.find(c);
+			if (idx == std::string_view::npos) break;
+			value = (value << 6u) | static_cast<uint32_t>(idx);
+			bits += 6;
+			if (bits >= 0) {
+				out.push_back(static_cast<char>((value >> bits) & 0xffu));
+				bits -= 8;
+			}
+		}
+
+		return out;
+	}
+
+	template <typename T>
+	bool readFile(const std::filesystem::path& path, std::vector<T>& data) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) return false;
+		const auto size = static_cast<size_t>(file.tellg());
+		data.resize((size + sizeof(T) - 1u) / sizeof(T));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+		return true;
+	}
+
+	bool loadDocument(const std::filesystem::path& path, Document& doc) {
+		std::vector<uint8_t> bytes;
+		if (!readFile(path, bytes)) {
+			fprintf(stderr, "can't read file %s\n", path.string().c_str());
+			return false;
+		}
+
+		std::vector<uint8_t> glbBin;
+		if (path.extension() == ".glb") {
+			if (bytes.size() < 20u || memcmp(bytes.data(), "glTF", 4u) != 0) {
+				fprintf(stderr, "wrong glb header %s\n", path.string().c_str());
+				return false;
+			}
+
+			uint32_t jsonLength;
+			memcpy(&jsonLength, &bytes[12u], 4u);
+			doc.js = Json::parse(bytes.begin() + 20, bytes.begin() + 20 + jsonLength);
+
+			const size_t binChunk = 20u + jsonLength;
+			if (binChunk + 8u <= bytes.size()) {
+				uint32_t binLength;
+				memcpy(&binLength, &bytes[binChunk], 4u);
+				glbBin.assign(bytes.begin() + static_cast<ptrdiff_t>(binChunk + 8u), bytes.begin() + static_cast<ptrdiff_t>(binChunk + 8u + binLength));
+			}
+		} else {
+			doc.js = Json::parse(bytes.begin(), bytes.end());
+		}
+
+		const auto folder = path.parent_path();
+		for (const auto& bufferJs : doc.js.value("buffers", Json::array())) {
+			auto& buffer = doc.buffers.emplace_back();
+			const std::string uri = bufferJs.value("uri", "");
+
+			if (uri.empty()) {
+				buffer = glbBin;
+			} else if (uri.starts_with("data:")) {
+				const std::string decoded = base64Decode(uri.substr(uri.find(',') + 1u));
+				buffer.assign(decoded.begin(), decoded.end());
+			} else if (!readFile(folder / uri, buffer)) {
+				fprintf(stderr, "can't read buffer %s\n", uri.c_str());
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// accessor data converted to float components (normalized integers are mapped to [0, 1])
+	std::vector<float> readAccessor(const Document& doc, const size_t accessorIdx, size_t& components) {
+		const Json& accessorJs = doc.js["accessors"][accessorIdx];
+		const auto componentType = accessorJs["componentType"].get<uint16_t>();
+		const bool normalized = accessorJs.value("normalized", false);
+		const size_t count = accessorJs["count"].get<size_t>();
+		components = componentsCount(accessorJs["type"].get<std::string>());
+
+		std::vector<float> result(count * components, 0.0f);
+		if (!accessorJs.contains("bufferView")) return result;
+
+		const size_t cSize = componentSize(componentType);
+		const Json& viewJs = doc.js["bufferViews"][accessorJs["bufferView"].get<size_t>()];
+		const auto& buffer = doc.buffers[viewJs["buffer"].get<size_t>()];
+		const size_t stride = viewJs.value("byteStride", cSize * components);
+		const size_t offset = viewJs.value("byteOffset", size_t(0u)) + accessorJs.value("byteOffset", size_t(0u));
+
+		for (size_t i = 0u; i < count; ++i) {
+			for (size_t c = 0u; c < components; ++c) {
+				const uint8_t* src = &buffer[offset + i * stride + c * cSize];
+				float& dst = result[i * components + c];
+				switch (static_cast<ComponentType>(componentType)) {
+					case ComponentType::UNSIGNED_BYTE:
+						dst = normalized ? *src / 255.0f : static_cast<float>(*src);
+						break;
+					case ComponentType::UNSIGNED_SHORT:
+					{
+						uint16_t v;
+						memcpy(&v, src, sizeof(v));
+						dst = normalized ? v / 65535.0f : static_cast<float>(v);
+					}
+						break;
+					case ComponentType::UNSIGNED_INT:
+					{
+						uint32_t v;
+						memcpy(&v, src, sizeof(v));
+						dst = static_cast<float>(v);
+					}
+						break;
+					case ComponentType::FLOAT:
+						memcpy(&dst, src, sizeof(float));
+						break;
+					default:
+						break;
+				}
+			}
+		}
+
+		return result;
+	}
+
+	// size of attribute in vertex, when primitive has no data for it (as Mesh_Data::loadMeshes)
+	uint32_t defaultDimension(const Semantic s) {
+		switch (s) {
+			case Semantic::JOINTS:
+			case Semantic::WEIGHT:
+			case Semantic::TANGENT:
+				return 4u;
+			case Semantic::COLOR:
+				return 1u;
+			case Semantic::POSITION:
+			case Semantic::NORMAL:
+				return 3u;
+			default:
+				return 2u;
+		}
+	}
+
+	bool loadMeshes(const Document& doc, const uint16_t semanticMask, Model& model) {
+		const Json& meshes = doc.js.value("meshes", Json::array());
+		model.content.meshesCount = static_cast<uint32_t>(meshes.size());
+
+		for (size_t m = 0u; m < meshes.size(); ++m) {
+			for (const Json& primitiveJs : meshes[m]["primitives"]) {
+				const Json& attributesJs = primitiveJs["attributes"];
+				if (!attributesJs.contains("POSITION") || !primitiveJs.contains("indices")) {
+					fprintf(stderr, "mesh %zu: primitive without positions or indices\n", m);
+					return false;
+				}
+
+				std::vector<float> data[kSemanticsCount];
+				uint32_t dimensions[kSemanticsCount] = {};
+				uint32_t vertexSize = 0u;
+
+				for (uint8_t s = 0u; s < kSemanticsCount; ++s) {
+					const bool allowed = semanticMask == 0u || (semanticMask & (1u << s));
+					if (!allowed) continue;
+
+					if (const auto it = attributesJs.find(kSemanticNames[s]); it != attributesJs.end()) {
+						size_t components;
+						data[s] = readAccessor(doc, it->get<size_t>(), components);
+						dimensions[s] = static_cast<uint32_t>(components);
+					} else if (semanticMask != 0u) {
+						dimensions[s] = defaultDimension(static_cast<Semantic>(s));
+					}
+
+					vertexSize += dimensions[s];
+				}
+
+				if (model.content.vertexSize == 0u) {
+					model.content.vertexSize = vertexSize;
+				} else if (model.content.vertexSize != vertexSize) {
+					fprintf(stderr, "mesh %zu: primitives with different vertex layouts\n", m);
+					return false;
+				}
+
+				const Json& positionJs = doc.js["accessors"][attributesJs["POSITION"].get<size_t>()];
+				const auto vertexCount = positionJs["count"].get<uint32_t>();
+				const auto firstVertex = static_cast<uint32_t>(model.vertices.size() / vertexSize);
+
+				model.vertices.resize(model.vertices.size() + static_cast<size_t>(vertexCount) * vertexSize, 0.0f);
+				float* out = &model.vertices[static_cast<size_t>(firstVertex) * vertexSize];
+
+				for (uint32_t v = 0u; v < vertexCount; ++v) {
+					for (uint8_t s = 0u; s < kSemanticsCount; ++s) {
+						const uint32_t dim = dimensions[s];
+						if (dim == 0u) continue;
+
+						if (!data[s].empty()) {
+							if (s == static_cast<uint8_t>(Semantic::COLOR) && semanticMask != 0u) { // packed rgba8 in the first component
+								const float* c = &data[s][v * dim];
+								const uint32_t color = static_cast<uint8_t>(c[0u] * 255.0f) << 24 |
+													   static_cast<uint8_t>(c[1u] * 255.0f) << 16 |
+													   static_cast<uint8_t>(c[2u] * 255.0f) << 8 |
+													   static_cast<uint8_t>((dim > 3u ? c[3u] : 1.0f) * 255.0f) << 0;
+								out[0u] = static_cast<float>(color);
+							} else {
+								memcpy(out, &data[s][v * dim], dim * sizeof(float));
+							}
+						} else if (s == static_cast<uint8_t>(Semantic::WEIGHT)) {
+							out[0u] = 1.0f; // first weight = 1.0f
+						}
+
+						out += dim;
+					}
+				}
+
+				size_t components;
+				const std::vector<float> indices = readAccessor(doc, primitiveJs["indices"].get<size_t>(), components);
+				const auto firstIndex = static_cast<uint32_t>(model.indices.size());
+				for (const float index : indices) {
+					model.indices.push_back(firstVertex + static_cast<uint32_t>(index));
+				}
+
+				j4m::Primitive primitive = {};
+				primitive.mesh = static_cast<uint16_t>(m);
+				primitive.mode = static_cast<uint8_t>(primitiveJs.value("mode", 4u));
+				primitive.firstIndex = firstIndex;
+				primitive.indexCount = static_cast<uint32_t>(indices.size());
+				for (uint8_t c = 0u; c < 3u; ++c) {
+					primitive.minCorner[c] = positionJs["min"][c].get<float>();
+					primitive.maxCorner[c] = positionJs["max"][c].get<float>();
+				}
+
+				model.content.primitives.push_back(primitive);
+			}
+		}
+
+		model.content.semanticMask = semanticMask;
+		model.content.vertexCount = model.content.vertexSize ? static_cast<uint32_t>(model.vertices.size() / model.content.vertexSize) : 0u;
+		model.content.vertices = model.vertices;
+		model.content.indices = model.indices;
+
+		return true;
+	}
+
+	void loadNodes(const Document& doc, Model& model) {
+		const Json& js = doc.js;
+		const uint16_t scene = js.value("scene", uint16_t(0u));
+		if (js.contains("scenes") && scene < js["scenes"].size()) {
+			model.content.sceneNodes = js["scenes"][scene].value("nodes", std::vector<uint16_t>());
+		}
+
+		for (const Json& nodeJs : js.value("nodes", Json::array())) {
+			gltf::Node& node = model.content.nodes.emplace_back();
+			node.name = nodeJs.value("name", "");
+			node.mesh = nodeJs.value("mesh", 0xffff);
+			node.skin = nodeJs.value("skin", 0xffff);
+			node.weights = nodeJs.value("weights", std::vector<float>());
+			node.children = nodeJs.value("children", std::vector<uint16_t>());
+
+			if (const auto matrixJs = nodeJs.find("matrix"); matrixJs != nodeJs.end()) { // decompose matrix to TRS
+				mat4f m;
+				for (uint8_t i = 0u; i < 16u; ++i) {
+					m[i / 4u][i % 4u] = (*matrixJs)[i].get<float>();
+				}
+
+				const vec3f scale(glm::length(vec3f(m[0u])), glm::length(vec3f(m[1u])), glm::length(vec3f(m[2u])));
+				const quatf rotation = glm::quat_cast(glm::mat3(vec3f(m[0u]) / scale.x, vec3f(m[1u]) / scale.y, vec3f(m[2u]) / scale.z));
+
+				node.scale = gltf::vec3(scale.x, scale.y, scale.z);
+				node.translation = gltf::vec3(m[3u][0u], m[3u][1u], m[3u][2u]);
+				node.rotation = gltf::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+				continue;
+			}
+
+			if (const auto v = nodeJs.find("scale"); v != nodeJs.end()) { node.scale = gltf::vec3((*v)[0], (*v)[1], (*v)[2]); }
+			if (const auto v = nodeJs.find("rotation"); v != nodeJs.end()) { node.rotation = gltf::vec4((*v)[0], (*v)[1], (*v)[2], (*v)[3]); }
+			if (const auto v = nodeJs.find("translation"); v != nodeJs.end()) { node.translation = gltf::vec3((*v)[0], (*v)[1], (*v)[2]); }
+		}
+	}
+
+	void loadSkins(const Document& doc, Model& model) {
+		for (const Json& skinJs : doc.js.value("skins", Json::array())) {
+			Mesh_Skin& skin = model.content.skins.emplace_back();
+			skin.skeletonRoot = skinJs.value("skeleton", 0xffff);
+			skin.joints = skinJs["joints"].get<std::vector<uint16_t>>();
+
+			if (const auto it = skinJs.find("inverseBindMatrices"); it != skinJs.end()) {
+				size_t components;
+				const std::vector<float> matrices = readAccessor(doc, it->get<size_t>(), components);
+				skin.inverseBindMatrices.resize(matrices.size() / 16u);
+				for (size_t i = 0u; i < skin.inverseBindMatrices.size(); ++i) { // column major, as gltf stores them
+					for (uint32_t j = 0u; j < 16u; ++j) {
+						skin.inverseBindMatrices[i][j / 4u][j % 4u] = matrices[i * 16u + j];
+					}
+				}
+			}
+		}
+	}
+
+	// the same Mesh_Animation as Mesh_Data::loadAnimations gives, then compressed
+	void loadAnimations(const Document& doc, const float tolerance, Model& model, AnimationCompressionReport& report) {
+		static const std::unordered_map<std::string, Mesh_Animation::AnimationChannelPath> paths = {
+			{ "translation", Mesh_Animation::AnimationChannelPath::TRANSLATION },
+			{ "rotation", Mesh_Animation::AnimationChannelPath::ROTATION },
+			{ "scale", Mesh_Animation::AnimationChannelPath::SCALE },
+			{ "weights", Mesh_Animation::AnimationChannelPath::WEIGHTS }
+		};
+
+		static const std::unordered_map<std::string, Mesh_Animation::Interpolation> interpolations = {
+			{ "LINEAR", Mesh_Animation::Interpolation::LINEAR },
+			{ "STEP", Mesh_Animation::Interpolation::STEP },
+			{ "CUBICSPLINE", Mesh_Animation::Interpolation::CUBICSPLINE }
+		};
+
+		const AnimationCompressionParams params = { tolerance, tolerance, tolerance };
+
+		for (const Json& animationJs : doc.js.value("animations", Json::array())) {
+			Mesh_Animation animation;
+			animation.name = animationJs.value("name", "");
+
+			for (const Json& samplerJs : animationJs["samplers"]) {
+				auto& sampler = animation.samplers.emplace_back();
+				sampler.interpolation = interpolations.at(samplerJs.value("interpolation", "LINEAR"));
+
+				size_t components;
+				sampler.inputs = readAccessor(doc, samplerJs["input"].get<size_t>(), components);
+				for (const float input : sampler.inputs) {
+					animation.start = std::min(animation.start, input);
+					animation.end = std::max(animation.end, input);
+				}
+				animation.duration = animation.end - animation.start;
+
+				const std::vector<float> outputs = readAccessor(doc, samplerJs["output"].get<size_t>(), components);
+				sampler.outputs.resize(components ? outputs.size() / components : 0u, vec4f(0.0f));
+				for (size_t k = 0u; k < sampler.outputs.size(); ++k) {
+					for (size_t c = 0u; c < std::min(components, size_t(4u)); ++c) {
+						sampler.outputs[k][c] = outputs[k * components + c];
+					}
+				}
+			}
+
+			for (const Json& channelJs : animationJs["channels"]) {
+				auto& channel = animation.channels.emplace_back();
+				channel.sampler = channelJs["sampler"].get<uint16_t>();
+				channel.target_node = channelJs["target"].value("node", 0xffff);
+				channel.path = paths.at(channelJs["target"]["path"].get<std::string>());
+				animation.minTargetNodeId = std::min(animation.minTargetNodeId, channel.target_node);
+				animation.maxTargetNodeId = std::max(animation.maxTargetNodeId, channel.target_node);
+			}
+
+			AnimationCompressionReport clipReport;
+			model.content.animations.push_back(compressAnimation(animation, params, &clipReport));
+
+			report.sourceBytes += clipReport.sourceBytes;
+			report.compressedBytes += clipReport.compressedBytes;
+			report.skippedChannels += clipReport.skippedChannels;
+		}
+	}
+
+	bool loadModel(const std::string& file, const Options& options, Model& model, AnimationCompressionReport& report) {
+		Document doc;
+		if (!loadDocument(file, doc) || !loadMeshes(doc, options.semanticMask, model)) return false;
+
+		loadNodes(doc, model);
+		loadSkins(doc, model);
+		loadAnimations(doc, options.tolerance, model, report);
+		return true;
+	}
+
+	// what MeshLoader does with .j4m file before gpu upload
+	struct J4mData {
+		std::vector<uint16_t> sceneNodes;
+		std::vector<gltf::Node> nodes;
+		std::vector<Mesh_Skin> skins;
+		std::vector<Mesh_Animation> animations;
+	};
+
+	bool loadJ4m(const std::string& file, std::vector<std::byte>& staging, J4mData& data) {
+		std::vector<uint64_t> bytes; // 8 bytes aligned
+		if (!readFile(file, bytes)) return false;
+
+		j4m::View view;
+		if (!view.open(reinterpret_cast<const std::byte*>(bytes.data()), bytes.size() * sizeof(uint64_t))) return false;
+
+		std::vector<CompressedAnimation> compressed;
+		if (!view.readNodes(data.sceneNodes, data.nodes) || !view.readSkins(data.skins) || !view.readAnimations(compressed)) return false;
+
+		data.animations.clear();
+		for (const auto& animation : compressed) {
+			data.animations.push_back(decompressAnimation(animation));
+		}
+
+		const size_t verticesSize = static_cast<size_t>(view.header().vertexCount) * view.header().vertexSize * sizeof(float);
+		const size_t indicesSize = view.header().indexCount * sizeof(uint32_t);
+		staging.resize(verticesSize + indicesSize);
+		memcpy(staging.data(), view.vertices(), verticesSize);
+		memcpy(staging.data() + verticesSize, view.indices(), indicesSize);
+
+		return true;
+	}
+
+	bool parseSemantics(const std::string& list, uint16_t& mask) {
+		size_t begin = 0u;
+		while (begin < list.size()) {
+			const size_t end = std::min(list.find(',', begin), list.size());
+			const std::string name = list.substr(begin, end - begin);
+			const auto it = std::find_if(std::begin(kSemanticNames), std::end(kSemanticNames), [&name](const char* s) { return name == s; });
+			if (it == std::end(kSemanticNames)) {
+				fprintf(stderr, "unknown attribute %s\n", name.c_str());
+				return false;
+			}
+			mask |= 1u << static_cast<uint16_t>(it - std::begin(kSemanticNames));
+			begin = end + 1u;
+		}
+		return true;
+	}
+
+	bool parseOptions(const int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			if (arg == "-i" && hasValue) { options.input = argv[++i]; }
+			else if (arg == "-o" && hasValue) { options.output = argv[++i]; }
+			else if (arg == "-a" && hasValue) { if (!parseSemantics(argv[++i], options.semanticMask)) return false; }
+			else if (arg == "-t" && hasValue) { options.tolerance = std::stof(argv[++i]); }
+			else if (arg == "-b" && hasValue) { options.benchmark = static_cast<uint32_t>(std::stoul(argv[++i])); }
+			else { return false; }
+		}
+
+		return !options.input.empty() && !options.output.empty();
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printf("usage: meshConverter -i input.gltf|glb -o output.j4m [-a POSITION,NORMAL,...] [-t tolerance] [-b iterations]\n");
+		return 1;
+	}
+
+	Model model;
+	AnimationCompressionReport report;
+	if (!loadModel(options.input, options, model, report)) return 1;
+
+	const std::vector<std::byte> bytes = j4m::write(model.content);
+	{
+		std::ofstream file(options.output, std::ios::binary);
+		if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+			fprintf(stderr, "can't write file %s\n", options.output.c_str());
+			return 1;
+		}
+	}
+
+	printf("%s: %zu bytes, vertices %u x %u floats, indices %zu, nodes %zu, skins %zu, animations %zu (%zu -> %zu bytes)\n",
+		   options.output.c_str(), bytes.size(), model.content.vertexCount, model.content.vertexSize, model.indices.size(),
+		   model.content.nodes.size(), model.content.skins.size(), model.content.animations.size(), report.sourceBytes, report.compressedBytes);
+
+	if (options.benchmark == 0u) return 0;
+
+	using clock = std::chrono::steady_clock;
+	const auto ms = [](const clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	clock::duration gltfTime = {};
+	clock::duration j4mTime = {};
+	for (uint32_t i = 0u; i < options.benchmark; ++i) {
+		const auto start = clock::now();
+		Model m;
+		AnimationCompressionReport r;
+		loadModel(options.input, options, m, r);
+		const auto middle = clock::now();
+
+		std::vector<std::byte> staging;
+		J4mData data;
+		if (!loadJ4m(options.output, staging, data)) {
+			fprintf(stderr, "can't load %s\n", options.output.c_str());
+			return 1;
+		}
+
+		j4mTime += clock::now() - middle;
+		gltfTime += middle - start;
+	}
+
+	printf("load time: gltf %.3f ms, j4m %.3f ms (x%.1f)\n", ms(gltfTime) / options.benchmark, ms(j4mTime) / options.benchmark, ms(gltfTime) / std::max(ms(j4mTime), 1e-6));
+	return 0;
+}
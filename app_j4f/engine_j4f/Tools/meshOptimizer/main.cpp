@@ -0,0 +1,791 @@
+// offline mesh optimization for gltf / glb models:
+// post-transform cache and vertex fetch reordering for every triangles primitive + lod chain generation
+// result is written as glb with tightly packed buffer views, as Loader_gltf / MeshLoader expect
+//
+// use example: $ ./meshOptimizer -i ./models/knight.gltf -o ./models/knight.glb -l 3 -r 0.5 -e 0.01
+//              writes knight.glb (optimized lod0) and knight_lod1.glb .. knight_lod3.glb
+//
+// options:
+//   -i input .gltf or .glb
+//   -o output .glb
+//   -l lods count (default 3, 0 - only reorder)
+//   -r triangles reduction per lod (default 0.5)
+//   -e max simplification error relative to mesh extents (default 0.01)
+//   -s skin weight, cost of collapse between vertices with completely different joints influences relative to max error (default 1.0)
+//   -c post-transform cache size for statistic (default 16)
+//   --unlock_border allow simplification of open borders
+
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Utils/Json/json.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+	using Json = nlohmann::json;
+	using namespace engine;
+
+	enum class ComponentType : uint16_t {
+		BYTE = 5120,
+		UNSIGNED_BYTE = 5121,
+		SHORT = 5122,
+		UNSIGNED_SHORT = 5123,
+		UNSIGNED_INT = 5125,
+		FLOAT = 5126
+	};
+
+	enum class BufferTarget : uint16_t {
+		ARRAY_BUFFER = 34962,
+		ELEMENT_ARRAY_BUFFER = 34963
+	};
+
+	struct Options {
+		std::string input;
+		std::string output;
+		uint8_t lods = 3u;
+		float reduction = 0.5f;
+		float error = 1e-2f;
+		float skinWeight = 1.0f;
+		uint32_t cacheSize = mesh_optimizer::kDefaultCacheSize;
+		bool lockBorder = true;
+	};
+
+	struct Document {
+		Json js;
+		std::vector<std::vector<uint8_t>> buffers;
+	};
+
+	struct Accessor { // tightly packed accessor data
+		std::vector<uint8_t> data;
+		size_t elementSize = 0u;
+		size_t count = 0u;
+	};
+
+	struct Primitive {
+		size_t mesh;
+		size_t primitive;
+		size_t vertexCount;
+		std::vector<std::vector<uint32_t>> lods;
+		std::vector<std::pair<std::string, Accessor>> attributes;
+		std::vector<std::vector<std::pair<std::string, Accessor>>> targets;
+	};
+
+	size_t componentSize(const uint16_t componentType) {
+		switch (static_cast<ComponentType>(componentType)) {
+			case ComponentType::BYTE:
+			case ComponentType::UNSIGNED_BYTE:
+				return 1u;
+			case ComponentType::SHORT:
+			case ComponentType::UNSIGNED_SHORT:
+				return 2u;
+			case ComponentType::UNSIGNED_INT:
+			case ComponentType::FLOAT:
+				return 4u;
+			default:
+				return 0u;
+		}
+	}
+
+	size_t componentsCount(const std::string& type) {
+		if (type == "SCALAR") return 1u;
+		if (type == "VEC2") return 2u;
+		if (type == "VEC3") return 3u;
+		if (type == "VEC4") return 4u;
+		if (type == "MAT2") return 4u;
+		if (type == "MAT3") return 9u;
+		if (type == "MAT4") return 16u;
+		return 0u;
+	}
+
+	std::string base64Decode(const std::string& in) {
+		static constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string out;
+		out.reserve(in.size() * 3u / 4u);
+
+		uint32_t value = 0u;
+		int32_t bits = -8;
+		for (const char c : in) {
+			const size_t idx = alphabet.find(c);
+			if (idx == std::string_view::npos) break;
+			value = (value << 6u) | static_cast<uint32_t>(idx);
+			bits += 6;
+			if (bits >= 0) {
+				out.push_back(static_cast<char>((value >> bits) & 0xffu));
+				bits -= 8;
+			}
+		}
+
+		return out;
+	}
+
+	bool readFile(const std::filesystem::path& path, std::vector<uint8_t>& data) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) return false;
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return true;
+	}
+
+	bool loadDocument(const std::filesystem::path& path, Document& doc) {
+		std::vector<uint8_t> bytes;
+		if (!readFile(path, bytes)) {
+			fprintf(stderr, "can't read file %s\n", path.string().c_str());
+			return false;
+		}
+
+		std::vector<uint8_t> glbBin;
+		if (path.extension() == ".glb") {
+			if (bytes.size() < 20u || memcmp(bytes.data(), "glTF", 4u) != 0) {
+				fprintf(stderr, "wrong glb header %s\n", path.string().c_str());
+				return false;
+			}
+
+			// chunk: length, type, data
+			const auto readChunk = [&bytes](const size_t chunk, uint32_t& length, uint32_t& type) {
+				if (chunk + 8u > bytes.size()) return false;
+				memcpy(&length, &bytes[chunk], 4u);
+				memcpy(&type, &bytes[chunk + 4u], 4u);
+				return length <= bytes.size() - chunk - 8u;
+			};
+
+			uint32_t jsonLength, jsonType;
+			if (!readChunk(12u, jsonLength, jsonType) || jsonType != 0x4E4F534Au) { // JSON
+				fprintf(stderr, "wrong glb json chunk %s\n", path.string().c_str());
+				return false;
+			}
+
+			if (!Json::accept(bytes.begin() + 20, bytes.begin() + 20 + jsonLength)) {
+				fprintf(stderr, "wrong json %s\n", path.string().c_str());
+				return false;
+			}
+			doc.js = Json::parse(bytes.begin() + 20, bytes.begin() + 20 + jsonLength);
+
+			const size_t binChunk = 20u + jsonLength;
+			if (binChunk < bytes.size()) {
+				uint32_t binLength, binType;
+				if (!readChunk(binChunk, binLength, binType) || binType != 0x004E4942u) { // BIN
+					fprintf(stderr, "wrong glb bin chunk %s\n", path.string().c_str());
+					return false;
+				}
+				glbBin.assign(bytes.begin() + static_cast<ptrdiff_t>(binChunk + 8u), bytes.begin() + static_cast<ptrdiff_t>(binChunk + 8u + binLength));
+			}
+		} else {
+			if (!Json::accept(bytes.begin(), bytes.end())) {
+				fprintf(stderr, "wrong json %s\n", path.string().c_str());
+				return false;
+			}
+			doc.js = Json::parse(bytes.begin(), bytes.end());
+		}
+
+		if (!doc.js.is_object()) {
+			fprintf(stderr, "wrong gltf document %s\n", path.string().c_str());
+			return false;
+		}
+
+		const auto folder = path.parent_path();
+		for (const auto& bufferJs : doc.js.value("buffers", Json::array())) {
+			auto& buffer = doc.buffers.emplace_back();
+			if (!bufferJs.is_object()) {
+				fprintf(stderr, "wrong buffer %zu\n", doc.buffers.size() - 1u);
+				return false;
+			}
+
+			const std::string uri = bufferJs.value("uri", "");
+
+			if (uri.empty()) {
+				buffer = glbBin;
+			} else if (uri.starts_with("data:")) {
+				const std::string decoded = base64Decode(uri.substr(uri.find(',') + 1u));
+				buffer.assign(decoded.begin(), decoded.end());
+			} else if (!readFile(folder / uri, buffer)) {
+				fprintf(stderr, "can't read buffer %s\n", uri.c_str());
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// ranges of all buffer views and accessors, references which are followed by readAccessor and Writer, data is copied without checks after it
+	bool validateDocument(const Document& doc) {
+		const auto fail = [](const char* what, const size_t idx) {
+			fprintf(stderr, "wrong %s %zu: out of range\n", what, idx);
+			return false;
+		};
+
+		try {
+			const Json& views = doc.js.value("bufferViews", Json::array());
+			const Json& accessors = doc.js.value("accessors", Json::array());
+
+			for (size_t i = 0u; i < views.size(); ++i) {
+				const Json& viewJs = views[i];
+				const size_t bufferIdx = viewJs.at("buffer").get<size_t>();
+				if (bufferIdx >= doc.buffers.size()) return fail("buffer view", i);
+
+				const size_t size = doc.buffers[bufferIdx].size();
+				const size_t offset = viewJs.value("byteOffset", size_t(0u));
+				const size_t length = viewJs.at("byteLength").get<size_t>();
+				if (offset > size || length > size - offset) return fail("buffer view", i);
+			}
+
+			for (size_t i = 0u; i < accessors.size(); ++i) {
+				const Json& accessorJs = accessors[i];
+				const size_t count = accessorJs.at("count").get<size_t>();
+				const size_t elementSize = componentSize(accessorJs.at("componentType").get<uint16_t>()) * componentsCount(accessorJs.at("type").get<std::string>());
+				if (elementSize == 0u || count > std::numeric_limits<size_t>::max() / elementSize) return fail("accessor", i);
+
+				if (accessorJs.contains("sparse")) {
+					const Json& sparseJs = accessorJs["sparse"];
+					if (sparseJs.at("indices").at("bufferView").get<size_t>() >= views.size() ||
+						sparseJs.at("values").at("bufferView").get<size_t>() >= views.size()) return fail("accessor", i);
+				}
+
+				if (!accessorJs.contains("bufferView")) continue; // zero filled
+				const size_t viewIdx = accessorJs["bufferView"].get<size_t>();
+				if (viewIdx >= views.size()) return fail("accessor", i);
+
+				// last element: byteOffset + (count - 1) * stride + elementSize <= byteLength
+				const Json& viewJs = views[viewIdx];
+				const size_t length = viewJs["byteLength"].get<size_t>();
+				const size_t stride = viewJs.value("byteStride", elementSize);
+				const size_t offset = accessorJs.value("byteOffset", size_t(0u));
+				if (stride < elementSize) return fail("accessor", i);
+				if (count != 0u && (offset > length || elementSize > length - offset || (count - 1u) > (length - offset - elementSize) / stride)) return fail("accessor", i);
+			}
+
+			const auto isAccessor = [&accessors](const Json& ref) { return ref.get<size_t>() < accessors.size(); };
+
+			const Json& meshes = doc.js.value("meshes", Json::array());
+			for (size_t m = 0u; m < meshes.size(); ++m) {
+				for (const auto& primitiveJs : meshes[m].at("primitives")) {
+					bool valid = !primitiveJs.contains("indices") || isAccessor(primitiveJs["indices"]);
+					for (const auto& attributeJs : primitiveJs.at("attributes")) { valid = valid && isAccessor(attributeJs); }
+					for (const auto& targetJs : primitiveJs.value("targets", Json::array())) {
+						for (const auto& attributeJs : targetJs) { valid = valid && isAccessor(attributeJs); }
+					}
+					if (!valid) return fail("mesh", m);
+				}
+			}
+
+			const Json& skins = doc.js.value("skins", Json::array());
+			for (size_t i = 0u; i < skins.size(); ++i) {
+				if (skins[i].contains("inverseBindMatrices") && !isAccessor(skins[i]["inverseBindMatrices"])) return fail("skin", i);
+			}
+
+			const Json& animations = doc.js.value("animations", Json::array());
+			for (size_t i = 0u; i < animations.size(); ++i) {
+				for (const auto& samplerJs : animations[i].at("samplers")) {
+					if (!isAccessor(samplerJs.at("input")) || !isAccessor(samplerJs.at("output"))) return fail("animation", i);
+				}
+			}
+
+			const Json& images = doc.js.value("images", Json::array());
+			for (size_t i = 0u; i < images.size(); ++i) {
+				if (images[i].contains("bufferView") && images[i]["bufferView"].get<size_t>() >= views.size()) return fail("image", i);
+			}
+		} catch (const Json::exception& e) {
+			fprintf(stderr, "wrong document: %s\n", e.what());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool readAccessor(const Document& doc, const size_t accessorIdx, Accessor& accessor) {
+		const Json& accessorJs = doc.js["accessors"][accessorIdx];
+		if (accessorJs.contains("sparse")) return false;
+
+		accessor.count = accessorJs["count"].get<size_t>();
+		accessor.elementSize = componentSize(accessorJs["componentType"].get<uint16_t>()) * componentsCount(accessorJs["type"].get<std::string>());
+		accessor.data.assign(accessor.count * accessor.elementSize, 0u);
+
+		if (!accessorJs.contains("bufferView")) return true; // zero filled
+
+		const Json& viewJs = doc.js["bufferViews"][accessorJs["bufferView"].get<size_t>()];
+		const auto& buffer = doc.buffers[viewJs["buffer"].get<size_t>()];
+		const size_t stride = viewJs.value("byteStride", accessor.elementSize);
+		const size_t offset = viewJs.value("byteOffset", size_t(0u)) + accessorJs.value("byteOffset", size_t(0u));
+
+		for (size_t i = 0u; i < accessor.count; ++i) {
+			memcpy(&accessor.data[i * accessor.elementSize], &buffer[offset + i * stride], accessor.elementSize);
+		}
+
+		return true;
+	}
+
+	template <typename T>
+	std::vector<T> convertAccessor(const Document& doc, const size_t accessorIdx, const Accessor& accessor) {
+		const Json& accessorJs = doc.js["accessors"][accessorIdx];
+		const auto componentType = static_cast<ComponentType>(accessorJs["componentType"].get<uint16_t>());
+		const bool normalized = accessorJs.value("normalized", false);
+		const size_t components = componentsCount(accessorJs["type"].get<std::string>());
+
+		std::vector<T> result(accessor.count * components);
+		for (size_t i = 0u; i < result.size(); ++i) {
+			const uint8_t* src = &accessor.data[i * componentSize(static_cast<uint16_t>(componentType))];
+			switch (componentType) {
+				case ComponentType::BYTE:
+				{
+					int8_t v;
+					memcpy(&v, src, sizeof(v));
+					result[i] = normalized ? static_cast<T>(std::max(v / 127.0f, -1.0f)) : static_cast<T>(v);
+				}
+					break;
+				case ComponentType::UNSIGNED_BYTE:
+					result[i] = normalized ? static_cast<T>(*src / 255.0f) : static_cast<T>(*src);
+					break;
+				case ComponentType::UNSIGNED_SHORT:
+				{
+					uint16_t v;
+					memcpy(&v, src, sizeof(v));
+					result[i] = normalized ? static_cast<T>(v / 65535.0f) : static_cast<T>(v);
+				}
+					break;
+				case ComponentType::SHORT:
+				{
+					int16_t v;
+					memcpy(&v, src, sizeof(v));
+					result[i] = normalized ? static_cast<T>(std::max(v / 32767.0f, -1.0f)) : static_cast<T>(v);
+				}
+					break;
+				case ComponentType::UNSIGNED_INT:
+				{
+					uint32_t v;
+					memcpy(&v, src, sizeof(v));
+					result[i] = static_cast<T>(v);
+				}
+					break;
+				case ComponentType::FLOAT:
+				{
+					float v;
+					memcpy(&v, src, sizeof(v));
+					result[i] = static_cast<T>(v);
+				}
+					break;
+				default:
+					break;
+			}
+		}
+
+		return result;
+	}
+
+	bool loadPrimitive(const Document& doc, const size_t meshIdx, const size_t primitiveIdx, const Options& options, Primitive& primitive) {
+		const Json& primitiveJs = doc.js["meshes"][meshIdx]["primitives"][primitiveIdx];
+		if (primitiveJs.value("mode", 4u) != 4u) return false; // triangles only
+		if (!primitiveJs.contains("indices") || primitiveJs.contains("extensions")) return false;
+
+		const Json& attributesJs = primitiveJs["attributes"];
+		if (!attributesJs.contains("POSITION")) return false;
+
+		primitive.mesh = meshIdx;
+		primitive.primitive = primitiveIdx;
+
+		size_t positionIdx = 0u, jointsIdx = 0u, weightsIdx = 0u;
+		for (auto it = attributesJs.begin(); it != attributesJs.end(); ++it) {
+			auto& [name, accessor] = primitive.attributes.emplace_back(it.key(), Accessor());
+			if (!readAccessor(doc, it.value().get<size_t>(), accessor)) return false;
+
+			if (name == "POSITION") { positionIdx = primitive.attributes.size() - 1u; }
+			else if (name == "JOINTS_0") { jointsIdx = primitive.attributes.size(); }
+			else if (name == "WEIGHTS_0") { weightsIdx = primitive.attributes.size(); }
+		}
+
+		for (const auto& targetJs : primitiveJs.value("targets", Json::array())) {
+			auto& target = primitive.targets.emplace_back();
+			for (auto it = targetJs.begin(); it != targetJs.end(); ++it) {
+				auto& [name, accessor] = target.emplace_back(it.key(), Accessor());
+				if (!readAccessor(doc, it.value().get<size_t>(), accessor)) return false;
+			}
+		}
+
+		primitive.vertexCount = primitive.attributes[positionIdx].second.count;
+		if (primitive.attributes[positionIdx].second.elementSize < 3u * sizeof(float)) return false;
+
+		// attributes are remapped by one table
+		for (const auto& [name, accessor] : primitive.attributes) {
+			if (accessor.count != primitive.vertexCount) return false;
+		}
+		for (const auto& target : primitive.targets) {
+			for (const auto& [name, accessor] : target) {
+				if (accessor.count != primitive.vertexCount) return false;
+			}
+		}
+
+		const size_t indicesIdx = primitiveJs["indices"].get<size_t>();
+		Accessor indicesAccessor;
+		if (!readAccessor(doc, indicesIdx, indicesAccessor)) return false;
+		std::vector<uint32_t> indices = convertAccessor<uint32_t>(doc, indicesIdx, indicesAccessor);
+		indices.resize(indices.size() - indices.size() % 3u);
+		if (std::any_of(indices.begin(), indices.end(), [&primitive](const uint32_t idx) { return idx >= primitive.vertexCount; })) return false;
+
+		const auto before = mesh_optimizer::analyzeVertexCache(indices.data(), indices.size(), primitive.vertexCount, options.cacheSize);
+
+		// cache order, then vertex fetch order
+		mesh_optimizer::optimizeVertexCache(indices.data(), indices.data(), indices.size(), primitive.vertexCount);
+
+		std::vector<uint32_t> remap(primitive.vertexCount);
+		const size_t usedVertices = mesh_optimizer::buildVertexFetchRemap(remap.data(), indices.data(), indices.size(), primitive.vertexCount);
+		mesh_optimizer::remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+
+		const auto remapAccessor = [&remap, usedVertices](Accessor& accessor) {
+			std::vector<uint8_t> data(usedVertices * accessor.elementSize);
+			mesh_optimizer::remapVertexBuffer(data.data(), accessor.data.data(), accessor.count, accessor.elementSize, remap.data());
+			accessor.data = std::move(data);
+			accessor.count = usedVertices;
+		};
+
+		for (auto& attribute : primitive.attributes) { remapAccessor(attribute.second); }
+		for (auto& target : primitive.targets) {
+			for (auto& attribute : target) { remapAccessor(attribute.second); }
+		}
+		primitive.vertexCount = usedVertices;
+
+		const auto after = mesh_optimizer::analyzeVertexCache(indices.data(), indices.size(), primitive.vertexCount, options.cacheSize);
+
+		// lods
+		mesh_optimizer::SimplifyParams params;
+		params.targetError = options.error;
+		params.lockBorder = options.lockBorder;
+		params.skinWeight = options.skinWeight;
+
+		std::vector<uint16_t> joints;
+		std::vector<float> weights;
+		if (jointsIdx != 0u && weightsIdx != 0u) {
+			const size_t jointsAccessor = attributesJs["JOINTS_0"].get<size_t>();
+			const size_t weightsAccessor = attributesJs["WEIGHTS_0"].get<size_t>();
+			joints = convertAccessor<uint16_t>(doc, jointsAccessor, primitive.attributes[jointsIdx - 1u].second);
+			weights = convertAccessor<float>(doc, weightsAccessor, primitive.attributes[weightsIdx - 1u].second);
+			if (joints.size() == primitive.vertexCount * 4u && weights.size() == joints.size()) { // 4 influences per vertex
+				params.joints = joints.data();
+				params.weights = weights.data();
+			}
+		}
+
+		const auto& positions = primitive.attributes[positionIdx].second;
+		std::vector<float> lodErrors;
+		primitive.lods = mesh_optimizer::generateLods(indices, reinterpret_cast<const float*>(positions.data.data()), primitive.vertexCount,
+													  positions.elementSize, options.lods, options.reduction, params, &lodErrors);
+
+		printf("mesh %zu primitive %zu: vertices %zu, acmr %.3f -> %.3f, atvr %.3f -> %.3f\n", meshIdx, primitiveIdx, primitive.vertexCount, before.acmr, after.acmr, before.atvr, after.atvr);
+		for (size_t lod = 0u; lod < primitive.lods.size(); ++lod) {
+			const auto lodStatistic = mesh_optimizer::analyzeVertexCache(primitive.lods[lod].data(), primitive.lods[lod].size(), primitive.vertexCount, options.cacheSize);
+			printf("    lod %zu: triangles %zu (%.1f%%), error %.4f, acmr %.3f\n", lod, primitive.lods[lod].size() / 3u,
+				   100.0f * static_cast<float>(primitive.lods[lod].size()) / static_cast<float>(indices.size()), lodErrors[lod], lodStatistic.acmr);
+
+			if (lod != 0u) { // same target, as generateLods has
+				const size_t targetTriangles = static_cast<size_t>(static_cast<float>(primitive.lods[lod - 1u].size() / 3u) * options.reduction);
+				if (primitive.lods[lod].size() / 3u > targetTriangles) {
+					fprintf(stderr, "warning: mesh %zu primitive %zu lod %zu: triangles %zu, target %zu isn't reached within error %.4f (use larger -e, -s or --unlock_border)\n",
+							meshIdx, primitiveIdx, lod, primitive.lods[lod].size() / 3u, targetTriangles, options.error);
+				}
+			}
+		}
+
+		if (primitive.lods.size() < options.lods + 1u) {
+			fprintf(stderr, "warning: mesh %zu primitive %zu: %zu of %u lods are generated, no more triangles can be removed within error %.4f\n",
+					meshIdx, primitiveIdx, primitive.lods.size() - 1u, static_cast<uint32_t>(options.lods), options.error);
+		}
+
+		return true;
+	}
+
+	class Writer {
+	public:
+		Writer(const Document& doc) : _doc(doc), _js(doc.js) {}
+
+		size_t addAccessor(const Json& sourceAccessor, const void* data, const size_t count, const size_t elementSize, const BufferTarget target) {
+			Json& views = _js["bufferViews"];
+			Json view = { {"buffer", 0u}, {"byteLength", count * elementSize}, {"target", static_cast<uint16_t>(target)} };
+			views.push_back(std::move(view));
+
+			const size_t viewIdx = views.size() - 1u;
+			const auto* bytes = static_cast<const uint8_t*>(data);
+			_newViews[viewIdx].assign(bytes, bytes + count * elementSize);
+
+			Json accessor = sourceAccessor;
+			accessor["bufferView"] = viewIdx;
+			accessor["count"] = count;
+			accessor.erase("byteOffset");
+			_js["accessors"].push_back(std::move(accessor));
+			return _js["accessors"].size() - 1u;
+		}
+
+		void setPrimitive(const Primitive& primitive, const std::vector<uint32_t>& lodIndices) {
+			Json& primitiveJs = _js["meshes"][primitive.mesh]["primitives"][primitive.primitive];
+			const Json sourceJs = primitiveJs;
+
+			// lod indices use subset of vertices, so vertex fetch reorder once more
+			std::vector<uint32_t> remap(primitive.vertexCount);
+			const size_t usedVertices = mesh_optimizer::buildVertexFetchRemap(remap.data(), lodIndices.data(), lodIndices.size(), primitive.vertexCount);
+
+			std::vector<uint32_t> indices(lodIndices.size());
+			mesh_optimizer::remapIndexBuffer(indices.data(), lodIndices.data(), lodIndices.size(), remap.data());
+
+			Json indicesAccessor = _js["accessors"][sourceJs["indices"].get<size_t>()];
+			indicesAccessor.erase("min");
+			indicesAccessor.erase("max");
+			if (usedVertices <= std::numeric_limits<uint16_t>::max() + 1u) { // 16 bit indices are enough
+				const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+				indicesAccessor["componentType"] = static_cast<uint16_t>(ComponentType::UNSIGNED_SHORT);
+				primitiveJs["indices"] = addAccessor(indicesAccessor, shortIndices.data(), shortIndices.size(), sizeof(uint16_t), BufferTarget::ELEMENT_ARRAY_BUFFER);
+			} else {
+				indicesAccessor["componentType"] = static_cast<uint16_t>(ComponentType::UNSIGNED_INT);
+				primitiveJs["indices"] = addAccessor(indicesAccessor, indices.data(), indices.size(), sizeof(uint32_t), BufferTarget::ELEMENT_ARRAY_BUFFER);
+			}
+
+			const auto addVertexAccessor = [&](Json sourceAccessor, const Accessor& accessor, const bool isPosition) {
+				std::vector<uint8_t> data(usedVertices * accessor.elementSize);
+				mesh_optimizer::remapVertexBuffer(data.data(), accessor.data.data(), accessor.count, accessor.elementSize, remap.data());
+
+				if (isPosition) { // bounds must be exact for used vertices
+					float minCorner[3u] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+					float maxCorner[3u] = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+					for (size_t v = 0u; v < usedVertices; ++v) {
+						float p[3u];
+						memcpy(p, &data[v * accessor.elementSize], sizeof(p));
+						for (uint8_t c = 0u; c < 3u; ++c) {
+							minCorner[c] = std::min(minCorner[c], p[c]);
+							maxCorner[c] = std::max(maxCorner[c], p[c]);
+						}
+					}
+					sourceAccessor["min"] = minCorner;
+					sourceAccessor["max"] = maxCorner;
+				}
+
+				return addAccessor(sourceAccessor, data.data(), usedVertices, accessor.elementSize, BufferTarget::ARRAY_BUFFER);
+			};
+
+			for (const auto& [name, accessor] : primitive.attributes) {
+				primitiveJs["attributes"][name] = addVertexAccessor(_js["accessors"][sourceJs["attributes"][name].get<size_t>()], accessor, name == "POSITION");
+			}
+
+			for (size_t t = 0u; t < primitive.targets.size(); ++t) {
+				for (const auto& [name, accessor] : primitive.targets[t]) {
+					primitiveJs["targets"][t][name] = addVertexAccessor(_js["accessors"][sourceJs["targets"][t][name].get<size_t>()], accessor, false);
+				}
+			}
+		}
+
+		bool write(const std::filesystem::path& path) {
+			std::vector<uint8_t> bin;
+			compact(bin);
+
+			_js["buffers"] = Json::array({ Json{ {"byteLength", bin.size()} } });
+			_js["asset"]["generator"] = "j4f meshOptimizer";
+
+			std::string jsonChunk = _js.dump();
+			while (jsonChunk.size() % 4u) { jsonChunk.push_back(' '); }
+			while (bin.size() % 4u) { bin.push_back(0u); }
+
+			const auto writeU32 = [](std::ofstream& file, const uint32_t v) { file.write(reinterpret_cast<const char*>(&v), sizeof(v)); };
+
+			std::ofstream file(path, std::ios::binary);
+			if (!file.is_open()) return false;
+
+			const bool hasBin = !bin.empty();
+			writeU32(file, 0x46546C67u); // glTF
+			writeU32(file, 2u);
+			writeU32(file, static_cast<uint32_t>(12u + 8u + jsonChunk.size() + (hasBin ? 8u + bin.size() : 0u)));
+			writeU32(file, static_cast<uint32_t>(jsonChunk.size()));
+			writeU32(file, 0x4E4F534Au); // JSON
+			file.write(jsonChunk.data(), static_cast<std::streamsize>(jsonChunk.size()));
+			if (hasBin) {
+				writeU32(file, static_cast<uint32_t>(bin.size()));
+				writeU32(file, 0x004E4942u); // BIN
+				file.write(reinterpret_cast<const char*>(bin.data()), static_cast<std::streamsize>(bin.size()));
+			}
+
+			return file.good();
+		}
+
+	private:
+		// drop accessors and buffer views which are not referenced anymore, pack all used data into one buffer
+		void compact(std::vector<uint8_t>& bin) {
+			constexpr size_t kUnused = std::numeric_limits<size_t>::max();
+
+			Json& accessors = _js["accessors"];
+			std::vector<size_t> accessorsRemap(accessors.size(), kUnused);
+
+			const auto visitAccessors = [this](auto&& f) {
+				for (auto& mesh : _js["meshes"]) {
+					for (auto& primitive : mesh["primitives"]) {
+						for (auto& attribute : primitive["attributes"]) { f(attribute); }
+						if (primitive.contains("indices")) { f(primitive["indices"]); }
+						if (primitive.contains("targets")) {
+							for (auto& target : primitive["targets"]) {
+								for (auto& attribute : target) { f(attribute); }
+							}
+						}
+					}
+				}
+
+				if (_js.contains("skins")) {
+					for (auto& skin : _js["skins"]) {
+						if (skin.contains("inverseBindMatrices")) { f(skin["inverseBindMatrices"]); }
+					}
+				}
+
+				if (_js.contains("animations")) {
+					for (auto& animation : _js["animations"]) {
+						for (auto& sampler : animation["samplers"]) {
+							f(sampler["input"]);
+							f(sampler["output"]);
+						}
+					}
+				}
+			};
+
+			Json newAccessors = Json::array();
+			visitAccessors([&](Json& ref) {
+				const size_t idx = ref.get<size_t>();
+				if (accessorsRemap[idx] == kUnused) {
+					accessorsRemap[idx] = newAccessors.size();
+					newAccessors.push_back(accessors[idx]);
+				}
+				ref = accessorsRemap[idx];
+			});
+			accessors = std::move(newAccessors);
+
+			if (!_js.contains("bufferViews")) return;
+
+			Json& views = _js["bufferViews"];
+			std::vector<size_t> viewsRemap(views.size(), kUnused);
+			Json newViews = Json::array();
+
+			const auto useView = [&](Json& ref) {
+				const size_t idx = ref.get<size_t>();
+				if (viewsRemap[idx] == kUnused) {
+					Json view = views[idx];
+					while (bin.size() % 4u) { bin.push_back(0u); }
+
+					if (auto it = _newViews.find(idx); it != _newViews.end()) {
+						bin.insert(bin.end(), it->second.begin(), it->second.end());
+					} else {
+						const auto& buffer = _doc.buffers[view["buffer"].get<size_t>()];
+						const size_t offset = view.value("byteOffset", size_t(0u));
+						const size_t length = view["byteLength"].get<size_t>();
+						bin.insert(bin.end(), buffer.begin() + static_cast<ptrdiff_t>(offset), buffer.begin() + static_cast<ptrdiff_t>(offset + length));
+					}
+
+					view["buffer"] = 0u;
+					view["byteOffset"] = bin.size() - view["byteLength"].get<size_t>();
+					viewsRemap[idx] = newViews.size();
+					newViews.push_back(std::move(view));
+				}
+				ref = viewsRemap[idx];
+			};
+
+			for (auto& accessor : accessors) {
+				if (accessor.contains("bufferView")) { useView(accessor["bufferView"]); }
+				if (accessor.contains("sparse")) {
+					useView(accessor["sparse"]["indices"]["bufferView"]);
+					useView(accessor["sparse"]["values"]["bufferView"]);
+				}
+			}
+
+			if (_js.contains("images")) {
+				for (auto& image : _js["images"]) {
+					if (image.contains("bufferView")) { useView(image["bufferView"]); }
+				}
+			}
+
+			views = std::move(newViews);
+		}
+
+		const Document& _doc;
+		Json _js;
+		std::unordered_map<size_t, std::vector<uint8_t>> _newViews;
+	};
+
+	bool parseOptions(const int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			try {
+				if (arg == "--unlock_border") { options.lockBorder = false; }
+				else if (arg == "-i" && hasValue) { options.input = argv[++i]; }
+				else if (arg == "-o" && hasValue) { options.output = argv[++i]; }
+				else if (arg == "-l" && hasValue) { options.lods = static_cast<uint8_t>(std::stoul(argv[++i])); }
+				else if (arg == "-r" && hasValue) { options.reduction = std::stof(argv[++i]); }
+				else if (arg == "-e" && hasValue) { options.error = std::stof(argv[++i]); }
+				else if (arg == "-s" && hasValue) { options.skinWeight = std::stof(argv[++i]); }
+				else if (arg == "-c" && hasValue) { options.cacheSize = static_cast<uint32_t>(std::stoul(argv[++i])); }
+				else { return false; }
+			} catch (const std::exception&) { // not a number or out of range
+				printf("invalid value of %s: %s\n", argv[i - 1], argv[i]);
+				return false;
+			}
+		}
+
+		return !options.input.empty() && !options.output.empty() && options.reduction > 0.0f && options.reduction < 1.0f;
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printf("usage: meshOptimizer -i input.gltf|glb -o output.glb [-l lods] [-r reduction] [-e error] [-s skin_weight] [-c cache_size] [--unlock_border]\n");
+		return 1;
+	}
+
+	Document doc;
+	if (!loadDocument(options.input, doc) || !validateDocument(doc)) return 1;
+
+	std::vector<Primitive> primitives;
+	const Json& meshes = doc.js.value("meshes", Json::array());
+	for (size_t m = 0u; m < meshes.size(); ++m) {
+		for (size_t p = 0u; p < meshes[m]["primitives"].size(); ++p) {
+			Primitive primitive;
+			if (loadPrimitive(doc, m, p, options, primitive)) {
+				primitives.push_back(std::move(primitive));
+			} else {
+				printf("mesh %zu primitive %zu: skipped (not indexed triangles, sparse, compressed or inconsistent data)\n", m, p);
+			}
+		}
+	}
+
+	size_t lodsCount = 1u;
+	for (const auto& primitive : primitives) {
+		lodsCount = std::max(lodsCount, primitive.lods.size());
+	}
+
+	const std::filesystem::path output(options.output);
+	size_t sourceTriangles = 0u;
+
+	for (size_t lod = 0u; lod < lodsCount; ++lod) {
+		Writer writer(doc);
+		size_t triangles = 0u;
+
+		for (const auto& primitive : primitives) { // primitive without lod of this level uses its last one
+			const auto& indices = primitive.lods[std::min(lod, primitive.lods.size() - 1u)];
+			writer.setPrimitive(primitive, indices);
+			triangles += indices.size() / 3u;
+		}
+
+		if (lod == 0u) { sourceTriangles = triangles; }
+
+		std::filesystem::path path = output;
+		if (lod != 0u) {
+			path.replace_filename(output.stem().string() + "_lod" + std::to_string(lod) + ".glb");
+		}
+
+		if (!writer.write(path)) {
+			fprintf(stderr, "can't write file %s\n", path.string().c_str());
+			return 1;
+		}
+
+		printf("%s: triangles %zu (%.1f%%)\n", path.string().c_str(), triangles, sourceTriangles ? 100.0f * static_cast<float>(triangles) / static_cast<float>(sourceTriangles) : 100.0f);
+	}
+
+	return 0;
+}
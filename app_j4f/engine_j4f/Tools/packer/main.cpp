@@ -0,0 +1,204 @@
+// packing of assets directory into one .j4p file for PackFileSystem (format is described in File/PackFormat.h):
+// every file is stored by its path relative to input directory ('/' separated), compressed with lz4 when it pays off,
+// already compressed formats (png, jpg, webp, ktx2, ogg...) are stored raw and read straight from mapping
+//
+// use example: $ ./packer -i ./resources/assets -o ./resources/assets.j4p
+//
+// options:
+//   -i input directory
+//   -o output .j4p
+//   -c codec: lz4 (default) or raw
+//   -r minimal compression ratio (default 0.9), file is stored raw if compressed size > ratio * original size
+//   -v print every entry
+
+#include "File/Lz4.h"
+#include "File/PackFormat.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace {
+	using namespace engine;
+
+	constexpr const char* kCompressedExtensions[] = {
+		".png", ".jpg", ".jpeg", ".webp", ".ktx2", ".ogg", ".mp3", ".zip", ".j4p"
+	};
+
+	struct Options {
+		std::string input;
+		std::string output;
+		pack::Codec codec = pack::Codec::LZ4;
+		float ratio = 0.9f;
+		bool verbose = false;
+	};
+
+	struct Item {
+		std::string path;
+		std::vector<std::byte> data;
+		pack::Entry entry = {};
+	};
+
+	bool isCompressedFormat(std::filesystem::path extension) {
+		std::string ext = extension.string();
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+		return std::find(std::begin(kCompressedExtensions), std::end(kCompressedExtensions), ext) != std::end(kCompressedExtensions);
+	}
+
+	bool readFile(const std::filesystem::path& path, std::vector<std::byte>& data) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) return false;
+
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())));
+	}
+
+	void encode(Item& item, const Options& options) {
+		const size_t originalSize = item.data.size();
+		item.entry.originalSize = originalSize;
+		item.entry.size = originalSize;
+		item.entry.codec = pack::Codec::RAW;
+
+		if (options.codec == pack::Codec::RAW || originalSize == 0u || isCompressedFormat(std::filesystem::path(item.path).extension())) return;
+
+		std::vector<std::byte> compressed(lz4::compressBound(originalSize));
+		const size_t size = lz4::compress(item.data.data(), originalSize, compressed.data(), compressed.size());
+		if (size == 0u || static_cast<float>(size) > options.ratio * static_cast<float>(originalSize)) return;
+
+		compressed.resize(size);
+		item.data = std::move(compressed);
+		item.entry.size = size;
+		item.entry.codec = pack::Codec::LZ4;
+	}
+
+	uint64_t align(const uint64_t offset, const uint64_t alignment) {
+		return (offset + alignment - 1u) / alignment * alignment;
+	}
+
+	bool parseOptions(const int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			if (arg == "-i" && hasValue) { options.input = argv[++i]; }
+			else if (arg == "-o" && hasValue) { options.output = argv[++i]; }
+			else if (arg == "-r" && hasValue) { options.ratio = std::stof(argv[++i]); }
+			else if (arg == "-v") { options.verbose = true; }
+			else if (arg == "-c" && hasValue) {
+				const std::string_view codec = argv[++i];
+				if (codec == "lz4") { options.codec = pack::Codec::LZ4; }
+				else if (codec == "raw") { options.codec = pack::Codec::RAW; }
+				else { return false; }
+			}
+			else { return false; }
+		}
+
+		return !options.input.empty() && !options.output.empty();
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	if (!parseOptions(argc, argv, options)) {
+		printf("usage: packer -i input_directory -o output.j4p [-c lz4|raw] [-r ratio] [-v]\n");
+		return 1;
+	}
+
+	const std::filesystem::path root(options.input);
+	if (!std::filesystem::is_directory(root)) {
+		fprintf(stderr, "%s isn't a directory\n", options.input.c_str());
+		return 1;
+	}
+
+	std::vector<Item> items;
+	for (const auto& it : std::filesystem::recursive_directory_iterator(root)) {
+		if (!it.is_regular_file()) continue;
+
+		Item& item = items.emplace_back();
+		item.path = std::filesystem::relative(it.path(), root).generic_string();
+		if (item.path.size() > std::numeric_limits<uint16_t>::max()) {
+			fprintf(stderr, "path %s is too long\n", item.path.c_str());
+			return 1;
+		}
+
+		if (!readFile(it.path(), item.data)) {
+			fprintf(stderr, "can't read file %s\n", it.path().string().c_str());
+			return 1;
+		}
+
+		item.entry.hash = pack::pathHash(item.path);
+		encode(item, options);
+	}
+
+	std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+		return std::tie(a.entry.hash, a.path) < std::tie(b.entry.hash, b.path);
+	});
+
+	// layout: header, aligned entries data, index, paths
+	pack::Header header = {};
+	memcpy(header.magic, pack::kMagic, sizeof(pack::kMagic));
+	header.version = pack::kVersion;
+	header.entriesCount = static_cast<uint32_t>(items.size());
+
+	uint64_t offset = sizeof(pack::Header);
+	uint64_t pathsSize = 0u;
+	uint64_t originalSize = 0u;
+	for (Item& item : items) {
+		offset = align(offset, pack::kAlignment);
+		item.entry.offset = offset;
+		item.entry.pathOffset = static_cast<uint32_t>(pathsSize);
+		item.entry.pathLength = static_cast<uint16_t>(item.path.size());
+		offset += item.entry.size;
+		pathsSize += item.path.size();
+		originalSize += item.entry.originalSize;
+	}
+
+	if (pathsSize > std::numeric_limits<uint32_t>::max()) {
+		fprintf(stderr, "too many paths\n");
+		return 1;
+	}
+
+	header.indexOffset = align(offset, alignof(pack::Entry));
+	header.pathsOffset = header.indexOffset + items.size() * sizeof(pack::Entry);
+	header.pathsSize = static_cast<uint32_t>(pathsSize);
+	header.fileSize = header.pathsOffset + pathsSize;
+
+	std::vector<std::byte> bytes(header.fileSize);
+	memcpy(bytes.data(), &header, sizeof(pack::Header));
+
+	std::byte* index = bytes.data() + header.indexOffset;
+	char* paths = reinterpret_cast<char*>(bytes.data() + header.pathsOffset);
+	for (const Item& item : items) {
+		memcpy(bytes.data() + item.entry.offset, item.data.data(), item.entry.size);
+		memcpy(index, &item.entry, sizeof(pack::Entry));
+		memcpy(paths + item.entry.pathOffset, item.path.data(), item.path.size());
+		index += sizeof(pack::Entry);
+
+		if (options.verbose) {
+			printf("%s: %s %llu -> %llu\n", item.path.c_str(), item.entry.codec == pack::Codec::LZ4 ? "lz4" : "raw",
+				   static_cast<unsigned long long>(item.entry.originalSize), static_cast<unsigned long long>(item.entry.size));
+		}
+	}
+
+	{
+		std::ofstream file(options.output, std::ios::binary);
+		if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+			fprintf(stderr, "can't write file %s\n", options.output.c_str());
+			return 1;
+		}
+	}
+
+	const size_t compressedCount = std::count_if(items.begin(), items.end(), [](const Item& item) { return item.entry.codec != pack::Codec::RAW; });
+	printf("%s: %zu files (%zu compressed), %llu -> %llu bytes\n", options.output.c_str(), items.size(), compressedCount,
+		   static_cast<unsigned long long>(originalSize), static_cast<unsigned long long>(header.fileSize));
+	return 0;
+}
@@ -0,0 +1,12 @@
+
+if not exist ktx2 mkdir ktx2
+cd png
+
+set format=bc7
+
+for %%f in (*.png) do (
+	%~dp0../textureConverter/build/Release/textureConverter.exe -i %%f -o ../ktx2/%%~nf.ktx2 -f %format% -srgb
+	)
+
+cd ..
+pause
\ No newline at end of file
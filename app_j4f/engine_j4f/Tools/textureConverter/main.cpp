@@ -0,0 +1,542 @@
+// converting of png (or any image, which stb_image reads) into .ktx2 texture with full mip chain (format is described in Graphics/Texture/Ktx2Format.h):
+// mips are built from source with box filter (in linear space for srgb), every level is block compressed,
+// TextureData uploads levels as they are or decodes them on cpu, if gpu doesn't support format
+//
+// use example: $ ./textureConverter -i ./png/vulkan.png -o ./ktx2/vulkan.ktx2 -f bc7 -srgb
+//
+// options:
+//   -i input image
+//   -o output .ktx2
+//   -f format: bc7 (default, color with alpha), bc1 (color without alpha), bc4 (one channel), bc5 (two channels, normal maps), rgba (uncompressed)
+//   -srgb color data is in srgb space (bc7, bc1, rgba)
+//   -nomips only level 0 is written
+//   -v print psnr of every level
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include "Graphics/Texture/BlockDecoder.h"
+#include "Graphics/Texture/Ktx2Format.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+	using namespace engine;
+
+	struct Options {
+		std::string input;
+		std::string output;
+		std::string_view format = "bc7";
+		bool srgb = false;
+		bool mips = true;
+		bool verbose = false;
+	};
+
+	struct Image {
+		uint32_t width = 0u;
+		uint32_t height = 0u;
+		std::vector<uint8_t> rgba;
+	};
+
+	using Block = std::array<uint8_t, 64u>; // 4x4 rgba texels
+
+	///////////////////////////////////////////////////////////
+	// mips
+
+	float toLinear(const uint8_t v) {
+		const float c = static_cast<float>(v) / 255.0f;
+		return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+
+	uint8_t fromLinear(const float v) {
+		const float c = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+		return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+	}
+
+	// 2x2 box filter, last row / column is repeated for odd size
+	Image downsample(const Image& src, const bool srgb) {
+		Image dst;
+		dst.width = std::max(src.width >> 1u, 1u);
+		dst.height = std::max(src.height >> 1u, 1u);
+		dst.rgba.resize(static_cast<size_t>(dst.width) * dst.height * 4u);
+
+		for (uint32_t y = 0u; y < dst.height; ++y) {
+			for (uint32_t x = 0u; x < dst.width; ++x) {
+				const uint32_t x0 = std::min(x * 2u, src.width - 1u), x1 = std::min(x * 2u + 1u, src.width - 1u);
+				const uint32_t y0 = std::min(y * 2u, src.height - 1u), y1 = std::min(y * 2u + 1u, src.height - 1u);
+				const uint8_t* texels[4u] = {
+					&src.rgba[(static_cast<size_t>(y0) * src.width + x0) * 4u], &src.rgba[(static_cast<size_t>(y0) * src.width + x1) * 4u],
+					&src.rgba[(static_cast<size_t>(y1) * src.width + x0) * 4u], &src.rgba[(static_cast<size_t>(y1) * src.width + x1) * 4u]
+				};
+
+				uint8_t* out = &dst.rgba[(static_cast<size_t>(y) * dst.width + x) * 4u];
+				for (uint32_t c = 0u; c < 4u; ++c) {
+					if (srgb && c < 3u) {
+						out[c] = fromLinear((toLinear(texels[0u][c]) + toLinear(texels[1u][c]) + toLinear(texels[2u][c]) + toLinear(texels[3u][c])) * 0.25f);
+					} else {
+						out[c] = static_cast<uint8_t>((texels[0u][c] + texels[1u][c] + texels[2u][c] + texels[3u][c] + 2u) / 4u);
+					}
+				}
+			}
+		}
+
+		return dst;
+	}
+
+	// texels of block at bx, by, texels out of image are repeated from edge
+	Block fetchBlock(const Image& image, const uint32_t bx, const uint32_t by) {
+		Block block;
+		for (uint32_t y = 0u; y < 4u; ++y) {
+			for (uint32_t x = 0u; x < 4u; ++x) {
+				const uint32_t ix = std::min(bx * 4u + x, image.width - 1u);
+				const uint32_t iy = std::min(by * 4u + y, image.height - 1u);
+				memcpy(&block[(y * 4u + x) * 4u], &image.rgba[(static_cast<size_t>(iy) * image.width + ix) * 4u], 4u);
+			}
+		}
+		return block;
+	}
+
+	///////////////////////////////////////////////////////////
+	// encoders: endpoints by principal axis of block texels, nearest palette entry for every texel
+
+	// min / max projections of texels onto principal axis of first channels
+	template <uint32_t Channels>
+	void principalEndpoints(const Block& block, float (&e0)[4u], float (&e1)[4u]) {
+		float mean[4u] = {};
+		for (uint32_t i = 0u; i < 16u; ++i) {
+			for (uint32_t c = 0u; c < Channels; ++c) mean[c] += block[i * 4u + c];
+		}
+		for (uint32_t c = 0u; c < Channels; ++c) mean[c] /= 16.0f;
+
+		float cov[4u][4u] = {};
+		for (uint32_t i = 0u; i < 16u; ++i) {
+			for (uint32_t a = 0u; a < Channels; ++a) {
+				for (uint32_t b = 0u; b < Channels; ++b) cov[a][b] += (block[i * 4u + a] - mean[a]) * (block[i * 4u + b] - mean[b]);
+			}
+		}
+
+		float axis[4u] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for (uint32_t it = 0u; it < 8u; ++it) { // power iteration
+			float next[4u] = {};
+			float length = 0.0f;
+			for (uint32_t a = 0u; a < Channels; ++a) {
+				for (uint32_t b = 0u; b < Channels; ++b) next[a] += cov[a][b] * axis[b];
+				length += next[a] * next[a];
+			}
+			if (length < 1e-6f) break;
+			length = std::sqrt(length);
+			for (uint32_t a = 0u; a < Channels; ++a) axis[a] = next[a] / length;
+		}
+
+		float minT = std::numeric_limits<float>::max(), maxT = std::numeric_limits<float>::lowest();
+		for (uint32_t i = 0u; i < 16u; ++i) {
+			float t = 0.0f;
+			for (uint32_t c = 0u; c < Channels; ++c) t += (block[i * 4u + c] - mean[c]) * axis[c];
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		for (uint32_t c = 0u; c < Channels; ++c) {
+			e0[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+			e1[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	template <uint32_t Channels, size_t N>
+	uint32_t nearest(const uint8_t* texel, const uint8_t (&palette)[N][4u], uint32_t* error = nullptr) {
+		uint32_t best = 0u, bestError = std::numeric_limits<uint32_t>::max();
+		for (uint32_t i = 0u; i < N; ++i) {
+			uint32_t e = 0u;
+			for (uint32_t c = 0u; c < Channels; ++c) {
+				const int d = static_cast<int>(texel[c]) - palette[i][c];
+				e += static_cast<uint32_t>(d * d);
+			}
+			if (e < bestError) {
+				bestError = e;
+				best = i;
+			}
+		}
+		if (error) *error += bestError;
+		return best;
+	}
+
+	void encodeBc1(const Block& block, uint8_t* out) {
+		float e0[4u], e1[4u];
+		principalEndpoints<3u>(block, e0, e1);
+
+		const auto pack565 = [](const float* c) {
+			return static_cast<uint16_t>((static_cast<uint32_t>(c[0u] * 31.0f / 255.0f + 0.5f) << 11u) |
+										 (static_cast<uint32_t>(c[1u] * 63.0f / 255.0f + 0.5f) << 5u) |
+										 static_cast<uint32_t>(c[2u] * 31.0f / 255.0f + 0.5f));
+		};
+
+		uint16_t c0 = pack565(e1), c1 = pack565(e0);
+		if (c0 < c1) std::swap(c0, c1);
+
+		uint32_t indices = 0u;
+		if (c0 != c1) { // c0 > c1: 4 colors mode
+			uint8_t palette[4u][4u];
+			const auto expand = [](const uint16_t c, uint8_t* p) {
+				const uint32_t r = (c >> 11u) & 31u, g = (c >> 5u) & 63u, b = c & 31u;
+				p[0u] = static_cast<uint8_t>((r << 3u) | (r >> 2u));
+				p[1u] = static_cast<uint8_t>((g << 2u) | (g >> 4u));
+				p[2u] = static_cast<uint8_t>((b << 3u) | (b >> 2u));
+			};
+			expand(c0, palette[0u]);
+			expand(c1, palette[1u]);
+			for (uint32_t c = 0u; c < 3u; ++c) {
+				palette[2u][c] = static_cast<uint8_t>((2u * palette[0u][c] + palette[1u][c] + 1u) / 3u);
+				palette[3u][c] = static_cast<uint8_t>((palette[0u][c] + 2u * palette[1u][c] + 1u) / 3u);
+			}
+
+			for (uint32_t i = 0u; i < 16u; ++i) indices |= nearest<3u>(&block[i * 4u], palette) << (i * 2u);
+		}
+
+		memcpy(out, &c0, 2u);
+		memcpy(out + 2u, &c1, 2u);
+		memcpy(out + 4u, &indices, 4u);
+	}
+
+	// one channel 8 values block (bc4, halves of bc5)
+	void encodeChannel(const Block& block, const uint32_t channel, uint8_t* out) {
+		uint8_t minV = 255u, maxV = 0u;
+		for (uint32_t i = 0u; i < 16u; ++i) {
+			minV = std::min(minV, block[i * 4u + channel]);
+			maxV = std::max(maxV, block[i * 4u + channel]);
+		}
+
+		out[0u] = maxV;
+		out[1u] = minV;
+		uint64_t indices = 0u;
+		if (maxV != minV) { // v0 > v1: 6 interpolated values
+			uint8_t palette[8u][4u] = { { maxV }, { minV } };
+			for (uint32_t i = 1u; i < 7u; ++i) palette[i + 1u][0u] = static_cast<uint8_t>(((7u - i) * maxV + i * minV + 3u) / 7u);
+
+			for (uint32_t i = 0u; i < 16u; ++i) {
+				const uint8_t v = block[i * 4u + channel];
+				indices |= static_cast<uint64_t>(nearest<1u>(&v, palette)) << (i * 3u);
+			}
+		}
+
+		memcpy(out + 2u, &indices, 6u);
+	}
+
+	// bc7 mode 6: one subset, rgba 7 bit endpoints + p bit, 4 bit indices
+	class Bc7Mode6 {
+	public:
+		static void encode(const Block& block, uint8_t* out) {
+			float e0[4u], e1[4u];
+			principalEndpoints<4u>(block, e0, e1);
+
+			uint8_t best[16u], indices[16u];
+			uint32_t bestError = encode(block, e0, e1, best, indices);
+
+			// least squares refinement of endpoints by chosen indices
+			for (uint32_t it = 0u; it < 2u; ++it) {
+				float a = 0.0f, b = 0.0f, c = 0.0f, x0[4u] = {}, x1[4u] = {};
+				for (uint32_t i = 0u; i < 16u; ++i) {
+					const float w = kWeights[indices[i]] / 64.0f;
+					a += (1.0f - w) * (1.0f - w);
+					b += (1.0f - w) * w;
+					c += w * w;
+					for (uint32_t ch = 0u; ch < 4u; ++ch) {
+						x0[ch] += (1.0f - w) * block[i * 4u + ch];
+						x1[ch] += w * block[i * 4u + ch];
+					}
+				}
+
+				const float det = a * c - b * b;
+				if (std::abs(det) < 1e-6f) break;
+				for (uint32_t ch = 0u; ch < 4u; ++ch) {
+					e0[ch] = std::clamp((c * x0[ch] - b * x1[ch]) / det, 0.0f, 255.0f);
+					e1[ch] = std::clamp((a * x1[ch] - b * x0[ch]) / det, 0.0f, 255.0f);
+				}
+
+				uint8_t refined[16u];
+				const uint32_t error = encode(block, e0, e1, refined, indices);
+				if (error >= bestError) break;
+				bestError = error;
+				memcpy(best, refined, 16u);
+			}
+
+			memcpy(out, best, 16u);
+		}
+
+	private:
+		static constexpr uint8_t kWeights[16u] = { 0u, 4u, 9u, 13u, 17u, 21u, 26u, 30u, 34u, 38u, 43u, 47u, 51u, 55u, 60u, 64u };
+
+		// 7 bit value + shared p bit, p is chosen by smaller error of 4 channels
+		static void quantize(const float* e, uint8_t* q, uint8_t& p) {
+			uint32_t bestError = std::numeric_limits<uint32_t>::max();
+			for (uint8_t pbit = 0u; pbit < 2u; ++pbit) {
+				uint8_t candidate[4u];
+				uint32_t error = 0u;
+				for (uint32_t c = 0u; c < 4u; ++c) {
+					const int v = std::clamp(static_cast<int>(std::lround((e[c] - pbit) / 2.0f)), 0, 127);
+					candidate[c] = static_cast<uint8_t>(v);
+					const int d = ((v << 1) | pbit) - static_cast<int>(e[c] + 0.5f);
+					error += static_cast<uint32_t>(d * d);
+				}
+				if (error < bestError) {
+					bestError = error;
+					memcpy(q, candidate, 4u);
+					p = pbit;
+				}
+			}
+		}
+
+		// indices - palette indices of texels for e0 -> e1 order (before anchor swap)
+		static uint32_t encode(const Block& block, const float* e0, const float* e1, uint8_t* out, uint8_t (&indices)[16u]) {
+			uint8_t q[2u][4u], p[2u];
+			quantize(e0, q[0u], p[0u]);
+			quantize(e1, q[1u], p[1u]);
+
+			uint8_t palette[16u][4u];
+			for (uint32_t c = 0u; c < 4u; ++c) {
+				const uint32_t v0 = (q[0u][c] << 1u) | p[0u];
+				const uint32_t v1 = (q[1u][c] << 1u) | p[1u];
+				for (uint32_t i = 0u; i < 16u; ++i) palette[i][c] = static_cast<uint8_t>(((64u - kWeights[i]) * v0 + kWeights[i] * v1 + 32u) >> 6u);
+			}
+
+			uint32_t error = 0u;
+			for (uint32_t i = 0u; i < 16u; ++i) indices[i] = static_cast<uint8_t>(nearest<4u>(&block[i * 4u], palette, &error));
+
+			// anchor index is stored without high bit: swap endpoints if it is set
+			uint8_t stored[16u];
+			memcpy(stored, indices, 16u);
+			if (stored[0u] & 8u) {
+				std::swap(q[0u], q[1u]);
+				std::swap(p[0u], p[1u]);
+				for (uint8_t& index : stored) index = static_cast<uint8_t>(15u - index);
+			}
+
+			uint64_t bits[2u] = {};
+			uint32_t position = 0u;
+			const auto write = [&bits, &position](const uint64_t value, const uint32_t count) {
+				for (uint32_t i = 0u; i < count; ++i, ++position) {
+					bits[position >> 6u] |= ((value >> i) & 1u) << (position & 63u);
+				}
+			};
+
+			write(1u << 6u, 7u); // mode 6
+			for (uint32_t c = 0u; c < 4u; ++c) {
+				write(q[0u][c], 7u);
+				write(q[1u][c], 7u);
+			}
+			write(p[0u], 1u);
+			write(p[1u], 1u);
+			write(stored[0u], 3u);
+			for (uint32_t i = 1u; i < 16u; ++i) write(stored[i], 4u);
+
+			memcpy(out, bits, 16u);
+			return error;
+		}
+	};
+
+	///////////////////////////////////////////////////////////
+	// ktx2
+
+	// khronos data format descriptor: basic block with color model and samples of format
+	std::vector<uint32_t> dataFormatDescriptor(const uint32_t format, const bool srgb) {
+		constexpr uint32_t kSampleUpper = 0xFFFFFFFFu;
+		struct Sample { uint32_t channel, offset, length, upper; };
+
+		uint32_t model;
+		std::vector<Sample> samples;
+		switch (format) {
+			case ktx2::BC1_RGB_UNORM: case ktx2::BC1_RGB_SRGB: model = 128u; samples = { { 0u, 0u, 64u, kSampleUpper } }; break;
+			case ktx2::BC4_UNORM: model = 131u; samples = { { 0u, 0u, 64u, kSampleUpper } }; break;
+			case ktx2::BC5_UNORM: model = 132u; samples = { { 0u, 0u, 64u, kSampleUpper }, { 1u, 64u, 64u, kSampleUpper } }; break;
+			case ktx2::BC7_UNORM: case ktx2::BC7_SRGB: model = 134u; samples = { { 0u, 0u, 128u, kSampleUpper } }; break;
+			default: model = 1u; samples = { { 0u, 0u, 8u, 255u }, { 1u, 8u, 8u, 255u }, { 2u, 16u, 8u, 255u }, { 15u | (srgb ? 0x10u : 0u), 24u, 8u, 255u } }; break; // rgbsda, alpha is linear
+		}
+
+		const ktx2::FormatInfo info = ktx2::formatInfo(format);
+		const uint32_t blockSize = 24u + 16u * static_cast<uint32_t>(samples.size());
+
+		std::vector<uint32_t> dfd = {
+			4u + blockSize,											// total size
+			0u,														// vendor khronos, basic descriptor type
+			2u | (blockSize << 16u),								// version 1.3, block size
+			model | (1u << 8u) | ((srgb ? 2u : 1u) << 16u),			// bt709 primaries, srgb / linear transfer, straight alpha
+			(info.blockWidth - 1u) | ((info.blockHeight - 1u) << 8u),
+			info.blockSize,											// bytes of plane 0
+			0u
+		};
+
+		for (const Sample& sample : samples) {
+			dfd.push_back(sample.offset | ((sample.length - 1u) << 16u) | (sample.channel << 24u));
+			dfd.push_back(0u); // sample position
+			dfd.push_back(0u); // lower
+			dfd.push_back(sample.upper);
+		}
+
+		return dfd;
+	}
+
+	uint64_t align(const uint64_t offset, const uint64_t alignment) {
+		return (offset + alignment - 1u) / alignment * alignment;
+	}
+
+	std::vector<uint8_t> compress(const Image& image, const uint32_t format) {
+		const ktx2::FormatInfo info = ktx2::formatInfo(format);
+		if (info.blockWidth == 1u) return image.rgba;
+
+		const uint32_t blocksX = (image.width + 3u) / 4u, blocksY = (image.height + 3u) / 4u;
+		std::vector<uint8_t> data(ktx2::imageSize(info, image.width, image.height));
+
+		uint8_t* out = data.data();
+		for (uint32_t by = 0u; by < blocksY; ++by) {
+			for (uint32_t bx = 0u; bx < blocksX; ++bx, out += info.blockSize) {
+				const Block block = fetchBlock(image, bx, by);
+				switch (format) {
+					case ktx2::BC1_RGB_UNORM: case ktx2::BC1_RGB_SRGB: encodeBc1(block, out); break;
+					case ktx2::BC4_UNORM: encodeChannel(block, 0u, out); break;
+					case ktx2::BC5_UNORM: encodeChannel(block, 0u, out); encodeChannel(block, 1u, out + 8u); break;
+					default: Bc7Mode6::encode(block, out); break;
+				}
+			}
+		}
+
+		return data;
+	}
+
+	// psnr of channels, which format keeps
+	double psnr(const Image& image, const std::vector<uint8_t>& data, const uint32_t format) {
+		std::vector<uint8_t> decoded(image.rgba.size());
+		if (ktx2::formatInfo(format).blockWidth == 1u) {
+			decoded = data;
+		} else {
+			decodeBlocks(format, data.data(), image.width, image.height, decoded.data());
+		}
+
+		const uint32_t channels = format == ktx2::BC4_UNORM ? 1u : format == ktx2::BC5_UNORM ? 2u : ktx2::isBc(format) && format <= ktx2::BC1_RGB_SRGB ? 3u : 4u;
+		double error = 0.0;
+		for (size_t i = 0u; i < image.rgba.size(); i += 4u) {
+			for (uint32_t c = 0u; c < channels; ++c) {
+				const double d = static_cast<double>(image.rgba[i + c]) - decoded[i + c];
+				error += d * d;
+			}
+		}
+
+		error /= static_cast<double>(image.rgba.size() / 4u * channels);
+		return error == 0.0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(255.0 * 255.0 / error);
+	}
+
+	bool parseFormat(const std::string_view name, const bool srgb, uint32_t& format) {
+		if (name == "bc7") { format = srgb ? ktx2::BC7_SRGB : ktx2::BC7_UNORM; }
+		else if (name == "bc1") { format = srgb ? ktx2::BC1_RGB_SRGB : ktx2::BC1_RGB_UNORM; }
+		else if (name == "bc4" && !srgb) { format = ktx2::BC4_UNORM; }
+		else if (name == "bc5" && !srgb) { format = ktx2::BC5_UNORM; }
+		else if (name == "rgba") { format = srgb ? ktx2::R8G8B8A8_SRGB : ktx2::R8G8B8A8_UNORM; }
+		else { return false; }
+		return true;
+	}
+
+	bool parseOptions(const int argc, char** argv, Options& options) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string_view arg = argv[i];
+			const bool hasValue = i + 1 < argc;
+
+			if (arg == "-i" && hasValue) { options.input = argv[++i]; }
+			else if (arg == "-o" && hasValue) { options.output = argv[++i]; }
+			else if (arg == "-f" && hasValue) { options.format = argv[++i]; }
+			else if (arg == "-srgb") { options.srgb = true; }
+			else if (arg == "-nomips") { options.mips = false; }
+			else if (arg == "-v") { options.verbose = true; }
+			else { return false; }
+		}
+
+		return !options.input.empty() && !options.output.empty();
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	uint32_t format;
+	if (!parseOptions(argc, argv, options) || !parseFormat(options.format, options.srgb, format)) {
+		printf("usage: textureConverter -i input.png -o output.ktx2 [-f bc7|bc1|bc4|bc5|rgba] [-srgb] [-nomips] [-v]\n");
+		return 1;
+	}
+
+	int w, h, c;
+	stbi_uc* pixels = stbi_load(options.input.c_str(), &w, &h, &c, 4);
+	if (!pixels) {
+		fprintf(stderr, "can't read image %s\n", options.input.c_str());
+		return 1;
+	}
+
+	std::vector<Image> levels(1u);
+	levels[0u].width = static_cast<uint32_t>(w);
+	levels[0u].height = static_cast<uint32_t>(h);
+	levels[0u].rgba.assign(pixels, pixels + static_cast<size_t>(w) * h * 4u);
+	stbi_image_free(pixels);
+
+	while (options.mips && (levels.back().width > 1u || levels.back().height > 1u)) {
+		levels.push_back(downsample(levels.back(), options.srgb));
+	}
+
+	std::vector<std::vector<uint8_t>> data(levels.size());
+	for (size_t i = 0u; i < levels.size(); ++i) {
+		data[i] = compress(levels[i], format);
+		if (options.verbose) {
+			printf("level %zu: %ux%u, %zu bytes, psnr %.2f\n", i, levels[i].width, levels[i].height, data[i].size(), psnr(levels[i], data[i], format));
+		}
+	}
+
+	// layout: header, level index, dfd, levels from smallest to largest aligned to lcm(4, block size)
+	const ktx2::FormatInfo info = ktx2::formatInfo(format);
+	const std::vector<uint32_t> dfd = dataFormatDescriptor(format, options.srgb);
+	const uint64_t levelAlignment = std::lcm(4u, static_cast<uint32_t>(info.blockSize));
+
+	ktx2::Header header = {};
+	memcpy(header.identifier, ktx2::kIdentifier, sizeof(ktx2::kIdentifier));
+	header.vkFormat = format;
+	header.typeSize = 1u;
+	header.pixelWidth = levels[0u].width;
+	header.pixelHeight = levels[0u].height;
+	header.faceCount = 1u;
+	header.levelCount = static_cast<uint32_t>(levels.size());
+	header.supercompressionScheme = ktx2::Supercompression::NONE;
+	header.dfdByteOffset = static_cast<uint32_t>(sizeof(ktx2::Header) + sizeof(ktx2::LevelIndex) * levels.size());
+	header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+	std::vector<ktx2::LevelIndex> index(levels.size());
+	uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+	for (size_t i = levels.size(); i-- > 0u;) {
+		offset = align(offset, levelAlignment);
+		index[i].byteOffset = offset;
+		index[i].byteLength = index[i].uncompressedByteLength = data[i].size();
+		offset += data[i].size();
+	}
+
+	std::vector<uint8_t> bytes(offset);
+	memcpy(bytes.data(), &header, sizeof(header));
+	memcpy(bytes.data() + sizeof(header), index.data(), sizeof(ktx2::LevelIndex) * index.size());
+	memcpy(bytes.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+	for (size_t i = 0u; i < levels.size(); ++i) {
+		memcpy(bytes.data() + index[i].byteOffset, data[i].data(), data[i].size());
+	}
+
+	{
+		std::ofstream file(options.output, std::ios::binary);
+		if (!file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+			fprintf(stderr, "can't write file %s\n", options.output.c_str());
+			return 1;
+		}
+	}
+
+	printf("%s: %ux%u, %zu levels, %s%s, %zu -> %zu bytes\n", options.output.c_str(), header.pixelWidth, header.pixelHeight, levels.size(),
+		   std::string(options.format).c_str(), options.srgb ? " srgb" : "", levels[0u].rgba.size(), bytes.size());
+	return 0;
+}
@@ -11,6 +11,7 @@
 #include <Engine/Graphics/Texture/TexturePtrLoader.h>
 #include <Engine/Graphics/Mesh/Mesh.h>
 #include <Engine/Graphics/Mesh/MeshLoader.h>
+#include <Engine/Graphics/Mesh/AnimationClipLoader.h>
 #include <Engine/Graphics/Mesh/AnimationTree.h>
 #include <Engine/Graphics/Plane/Plane.h>
 #include <Engine/Core/Math/functions.h>
@@ -51,6 +52,7 @@
 //#include <format>
 
 #include <charconv>
+#include <limits>
 
 #include <unordered_set>
 
@@ -500,6 +502,10 @@ namespace engine {
 			program_mesh_with_stroke->setValueByName("camera_position", &p, nullptr, vulkan::VulkanGpuProgram::UNDEFINED, vulkan::VulkanGpuProgram::UNDEFINED, true);
 			program_mesh_skin_with_stroke->setValueByName("camera_position", &p, nullptr, vulkan::VulkanGpuProgram::UNDEFINED, vulkan::VulkanGpuProgram::UNDEFINED, true);
 			program_mesh_instance->setValueByName("camera_position", &p, nullptr, vulkan::VulkanGpuProgram::UNDEFINED, vulkan::VulkanGpuProgram::UNDEFINED, true);
+
+			// projected radius in pixels for animation update rate tiers
+			const float projectionScale = camera->getProjectionTransform()[1][1] * camera->getSize().y * 0.5f;
+			Engine::getInstance().getModule<Graphics>().getAnimationManager()->getSkeletonAnimationSystem().setViewer(p, projectionScale);
 		}
 
         void onEngineInitComplete() {
@@ -722,6 +728,13 @@ namespace engine {
 			camera->setRotation(targetCameraRotation);
 			camera->setPosition(vec3f(0.0f, -500.0f, 300.0f));
 
+			// near skeletons every tick, farther ones every second tick with interpolation, distant and small ones step every fourth tick
+			Engine::getInstance().getModule<Graphics>().getAnimationManager()->getSkeletonAnimationSystem().setLodTiers({
+				{ 800.0f, 24.0f, 1u, false },
+				{ 1600.0f, 8.0f, 2u, true },
+				{ std::numeric_limits<float>::max(), 0.0f, 4u, false }
+			});
+
 			camera2 = new Camera(width, height);
 			camera2->enableFrustum();
 			camera2->makeOrtho(-float(width) * 0.5f, float(width) * 0.5f, -float(height) * 0.5f, float(height) * 0.5f, 1.0f, 1000.0f);
@@ -1079,28 +1092,32 @@ namespace engine {
 										   animTree = new MeshAnimationTree(0.0f, asset->getNodesCount(),
 											   asset->getSkeleton()->getLatency());
 
-										   MeshLoadingParams anim1;
+										   AnimationClipLoadingParams anim1;
 										   anim1.file = "resources/assets/models/ready/idle_1.gltf";
+										   anim1.skeleton = asset->getMeshData();
 										   anim1.flags->async = 1;
 										   anim1.callbackThreadId = 1;
 
-										   assm.loadAsset<Mesh*>(anim1,
-											   [mainAsset = asset.get()](std::unique_ptr<Mesh>&& asset, const AssetLoadingResult result) {
+										   assm.loadAsset<AnimationClip*>(anim1,
+											   [mainAsset = asset.get()](AnimationClip* const& clip, const AssetLoadingResult result) {
+												   if (result != AssetLoadingResult::LOADING_SUCCESS) return;
 												   animTree->getAnimator()->addChild(new MeshAnimationTree::AnimatorType(
-													   &asset->getMeshData()->animations[0], 1.0f,
+													   &clip->animations[0], 1.0f,
 													   mainAsset->getSkeleton()->getLatency()));
 											   }
 										   );
 
-										   MeshLoadingParams anim2;
+										   AnimationClipLoadingParams anim2;
 										   anim2.file = "resources/assets/models/ready/idle_2.gltf";
+										   anim2.skeleton = asset->getMeshData();
 										   anim2.flags->async = 1;
 										   anim2.callbackThreadId = 1;
 
-										   assm.loadAsset<Mesh*>(anim2,
-											   [mainAsset = asset.get()](std::unique_ptr<Mesh>&& asset, const AssetLoadingResult result) {
+										   assm.loadAsset<AnimationClip*>(anim2,
+											   [mainAsset = asset.get()](AnimationClip* const& clip, const AssetLoadingResult result) {
+												   if (result != AssetLoadingResult::LOADING_SUCCESS) return;
 												   animTree->getAnimator()->addChild(new MeshAnimationTree::AnimatorType(
-													   &asset->getMeshData()->animations[0], 0.0f,
+													   &clip->animations[0], 0.0f,
 													   mainAsset->getSkeleton()->getLatency()));
 											   }
 										   );